@@ -3,8 +3,17 @@
 layout (location = 0) in vec4 a_pos;
 layout (location = 2) in vec3 a_normal;
 layout (location = 3) in vec4 a_normalTangent;
+layout (location = 4) in uint a_drawID;		// Object table entry of the draw (base instance)
 
-uniform mat4 modelTransform;
+struct GPU_ObjectData {		// One entry of the object table, must match the layout of ObjectUniformBlock on the CPU
+	mat4	modelTransform;			// Global space
+	int		materialIndex;			// Entry in the material table
+};
+
+// Per-object data, sub-allocated from a ring buffer and indexed per draw (binding must match STORAGE_BINDING_OBJECTS)
+layout (std430, binding = 1) readonly buffer ObjectTable {
+	GPU_ObjectData objects[];
+};
 
 // Data to geometry shader
 out vec3 worldNormal;
@@ -12,6 +21,8 @@ out vec3 worldTangent;
 flat out float bitangentHandedness;		// Make sure value doesn't get interpolated and always stays as 1 or -1
 
 void main() {
+	mat4 modelTransform = objects[a_drawID].modelTransform;
+
 	// Only output world position so its easier for the geometry shader to calculate debug data
 	gl_Position = modelTransform * a_pos;
 	
@@ -0,0 +1,5 @@
+#version 440 core
+// Depth only, color writes are masked off during the depth prepass
+
+void main() {
+}
\ No newline at end of file
@@ -1,15 +1,44 @@
 #version 440 core
 varying vec2 vertTexCoord;		// Take in interpolated version of tex coordinate passed in by vert shader
 
-uniform vec4		ambient;			// Contains light color and intensity
-uniform sampler2D	texSample;
+// Per-frame data, written once per frame (binding must match UNIFORM_BINDING_FRAME)
+layout (std140, binding = 0) uniform FrameData {
+	mat4	viewTransform;			// View space
+	mat4	projectionTransform;	// Clip space
+	vec3	worldViewerPos;
+	float	time;					// Seconds since startup
+	vec4	globalAmbient;			// Contains light color and intensity
+};
+
+flat in int materialIndex;		// Entry in the material table, from the vertex shader
+
+// NOTE: Only the ambient color and diffuse layer of the material table entry are read, the rest of the struct is declared to keep the layout
+struct GPU_MaterialData {
+	vec4	ambientColor;
+	vec4	diffuseColor;
+	vec4	specular;
+	float	shininessCoefficient;
+	int		useDiffuseMap;
+	int		useSpecularMap;
+	int		useNormalMap;
+	int		diffuseLayer;
+	int		specularLayer;
+	int		normalLayer;
+};
+
+// Every registered material (binding must match STORAGE_BINDING_MATERIALS)
+layout (std430, binding = 0) readonly buffer MaterialTable {
+	GPU_MaterialData materials[];
+};
+
+uniform sampler2DArray	texSample;		// Texture array the diffuse map is packed into
 uniform bool		useTex;				// Whether texture is valid to use or not
 uniform bool		correctGamma;		// Whether to apply gamma correction or not
 
 void main() {
 	// Ambient lighting pass on fragment
 	vec4 finalAmbient = vec4(0.6f, 0.2f, 0.7f, 1.f);	// Set to default 'texture not found' color
-	if (useTex == true) { finalAmbient = ambient * texture(texSample, vertTexCoord); }
+	if (useTex == true) { finalAmbient = globalAmbient * materials[materialIndex].ambientColor * texture(texSample, vec3(vertTexCoord, materials[materialIndex].diffuseLayer)); }	// Combine global ambience with material ambience
 
 	// Apply gamma correction if enabled
 	if (correctGamma) { 
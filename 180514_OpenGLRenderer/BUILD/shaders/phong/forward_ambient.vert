@@ -2,14 +2,36 @@
 // NOTE: Ambient pass only requires a position and texture coordinate
 layout (location = 0)	in vec4 a_pos;		
 layout (location = 1)	in vec2 a_texCoord;
+layout (location = 4)	in uint a_drawID;		// Object table entry of the draw (base instance)
 
-uniform mat4 modelTransform;		// Global space 
-uniform mat4 viewTransform;			// View space
-uniform mat4 projectionTransform;	// Clip space
+// Per-frame data, written once per frame (binding must match UNIFORM_BINDING_FRAME)
+layout (std140, binding = 0) uniform FrameData {
+	mat4	viewTransform;			// View space
+	mat4	projectionTransform;	// Clip space
+	vec3	worldViewerPos;
+	float	time;					// Seconds since startup
+	vec4	globalAmbient;
+};
+
+struct GPU_ObjectData {		// One entry of the object table, must match the layout of ObjectUniformBlock on the CPU
+	mat4	modelTransform;			// Global space
+	int		materialIndex;			// Entry in the material table
+};
+
+// Per-object data, sub-allocated from a ring buffer and indexed per draw (binding must match STORAGE_BINDING_OBJECTS)
+layout (std430, binding = 1) readonly buffer ObjectTable {
+	GPU_ObjectData objects[];
+};
 
 varying vec2 vertTexCoord;			// Use varying instead of out so the fragment shader receives an interpolated version of this
+flat out int materialIndex;			// Entry in the material table, the fragment shader can not read the object table without the draw ID
+
+invariant gl_Position;		// Must match the depth prepass exactly, it is tested with GL_EQUAL
 
 void main() {
+	mat4 modelTransform = objects[a_drawID].modelTransform;
+	materialIndex = objects[a_drawID].materialIndex;
+
 	// Clip space <- view space <- global space <- local space 
 	gl_Position = projectionTransform * viewTransform * modelTransform * a_pos;	// Convert vertice position from local space to Normalized Device Coordinate space
 	
@@ -12,5 +12,5 @@ void main() {
 	SetLightingParameters(diffuseSample, specularSample, normalSample, dirToViewer);
 
 	// Apply directional lighting pass
-	gl_FragColor = CalculateRawLighting( dirLight.base, -dirLight.castDir, normalSample, dirToViewer, diffuseSample, specularSample);
+	gl_FragColor = CalculateRawLighting( dirLight.base, -dirLight.castDir, normalSample, dirToViewer, diffuseSample, specularSample, CalculateDirectionalShadow());
 }
\ No newline at end of file
@@ -37,20 +37,27 @@ struct GPU_Dir_Light {
 	GPU_Light_Base base;
 };
 
-struct GPU_Material {		// Serves as a container of uniform variables, accessed via the instance name and then the variable e.g. "material.ambient"
+struct GPU_MaterialData {	// One entry of the material table, must match the layout of GPUMaterial on the CPU
 	vec4	ambientColor;
 	vec4	diffuseColor;			// Color of object in response to diffuse lighting	(usually same as ambient)
 	vec4	specular;				// Color and intensity of object in response to specular lighting (R, G and B values are usually the same)
 	float	shininessCoefficient;	// How sharp the curve of the specular highlights are [lower = softer and more spread out, higher = sharper and narrower]
 
-	sampler2D		diffuseMap;		// Texture artistically created with baked in lighting
-	bool			useDiffuseMap;	// Check on the CPU if the texture is valid and set this to true or false to determine whether to use it 
+	// Checked on the CPU if the texture is valid, set to 1 or 0 to determine whether to use it (ints because bools are not portable in buffers)
+	int		useDiffuseMap;
+	int		useSpecularMap;
+	int		useNormalMap;
 
-	sampler2D	specularMap;	// Texture in a one color spectrum that defines the highlight points for specular
-	bool		useSpecularMap;
+	// Layer of each map in the texture array it is packed into
+	int		diffuseLayer;
+	int		specularLayer;
+	int		normalLayer;
+};
 
-	sampler2D	normalMap;
-	bool		useNormalMap;
+struct GPU_MaterialMaps {	// Samplers can not be stored in buffers, accessed via the instance name and then the variable e.g. "materialMaps.diffuseMap"
+	sampler2DArray	diffuseMap;		// Texture artistically created with baked in lighting
+	sampler2DArray	specularMap;	// Texture in a one color spectrum that defines the highlight points for specular
+	sampler2DArray	normalMap;
 };
 
 // VARYING NOTE: Vec4s will be treated like colors! Meaning that the w component will be interpolated, leading to possibly incorrect calculations. 
@@ -62,9 +69,32 @@ in vec3 worldNormal;
 in vec3 worldTangent;
 in vec3 worldFragPos;
 
-uniform mat4 modelTransform;
-uniform vec3 worldViewerPos;
-uniform GPU_Material material;
+// Per-frame data, written once per frame (binding must match UNIFORM_BINDING_FRAME)
+layout (std140, binding = 0) uniform FrameData {
+	mat4	viewTransform;			// View space
+	mat4	projectionTransform;	// Clip space
+	vec3	worldViewerPos;
+	float	time;					// Seconds since startup
+	vec4	globalAmbient;
+};
+
+flat in int materialIndex;		// Entry in the material table, from the vertex shader
+
+// Every registered material, indexed with the object's material index (binding must match STORAGE_BINDING_MATERIALS)
+layout (std430, binding = 0) readonly buffer MaterialTable {
+	GPU_MaterialData materials[];
+};
+
+uniform GPU_MaterialMaps materialMaps;
+
+// Shadows of the light being applied, set per light by the shadow atlas (see ShadowAtlas.h)
+#define SHADOW_MAX_VIEWS 6
+
+uniform sampler2DShadow	shadowAtlas;
+uniform int				shadowViewCount;						// 0 when the light has no shadow this frame
+uniform mat4			shadowMatrices[SHADOW_MAX_VIEWS];		// Atlas space <- global space of each view, a cascade or cube face
+uniform vec4			shadowTiles[SHADOW_MAX_VIEWS];			// Bounds of each view's tile in atlas uvs, inset by half a texel
+uniform vec4			shadowCascadeEnds;						// View space distance each cascade ends at, directional lights only
 
 /**
 *	@brief Calculate illumination factor for fragment based on its distance and attenuation data of the light.
@@ -83,6 +113,74 @@ float CalculateIllumination(float a_dist, GPU_Light_Attenuation a_attenuationDat
 	return illumination;
 }
 
+/*
+	@brief Calculate how lit the fragment is in one of the light's shadow views, filtered over 3x3 comparisons.
+	@param a_view is the view to look up.
+	@return 0 when fully shadowed to 1 when fully lit, 1 outside of what the view covers.
+*/
+float CalculateShadow(int a_view) {
+	vec4 atlasPos = shadowMatrices[a_view] * vec4(worldFragPos, 1);
+	atlasPos.xyz /= atlasPos.w;		// Perspective views (cube faces and spot lights)
+
+	vec4 tile = shadowTiles[a_view];
+	if (any(lessThan(atlasPos.xy, tile.xy)) || any(greaterThan(atlasPos.xy, tile.zw)) || atlasPos.z > 1.0) { return 1.0; }
+
+	vec2 texelSize = 1.0 / vec2(textureSize(shadowAtlas, 0));
+
+	// NOTE: Samples are clamped to the tile so they never compare against a neighbouring light's depths
+	float lit = 0.0;
+	for (int x = -1; x <= 1; ++x) {
+		for (int y = -1; y <= 1; ++y) {
+			vec2 uv = clamp(atlasPos.xy + vec2(x, y) * texelSize, tile.xy, tile.zw);
+			lit += texture(shadowAtlas, vec3(uv, atlasPos.z));
+		}
+	}
+
+	return lit / 9.0;
+}
+
+/*
+	@brief Calculate how lit the fragment is by a directional light, from the cascade covering its distance from the viewer.
+	@return 0 when fully shadowed to 1 when fully lit, 1 beyond the last cascade.
+*/
+float CalculateDirectionalShadow() {
+	float viewDepth = -(viewTransform * vec4(worldFragPos, 1)).z;
+
+	for (int i = 0; i < shadowViewCount; ++i) {
+		if (viewDepth < shadowCascadeEnds[i]) { return CalculateShadow(i); }
+	}
+
+	return 1.0;
+}
+
+/*
+	@brief Calculate how lit the fragment is by a point light, from the cube face it is in.
+	@param a_lightPos is the position of the light.
+	@return 0 when fully shadowed to 1 when fully lit.
+*/
+float CalculatePointShadow(vec3 a_lightPos) {
+	if (shadowViewCount == 0) { return 1.0; }
+
+	vec3 dirFromLight	= worldFragPos - a_lightPos;
+	vec3 absDir			= abs(dirFromLight);
+
+	// Faces are ordered +X, -X, +Y, -Y, +Z, -Z, the fragment is in the face of its major axis
+	int face;
+	if (absDir.x >= absDir.y && absDir.x >= absDir.z)	{ face = (dirFromLight.x > 0 ? 0 : 1); }
+	else if (absDir.y >= absDir.z)						{ face = (dirFromLight.y > 0 ? 2 : 3); }
+	else												{ face = (dirFromLight.z > 0 ? 4 : 5); }
+
+	return CalculateShadow(face);
+}
+
+/*
+	@brief Calculate how lit the fragment is by a spot light.
+	@return 0 when fully shadowed to 1 when fully lit.
+*/
+float CalculateSpotShadow() {
+	return (shadowViewCount == 0 ? 1.0 : CalculateShadow(0));
+}
+
 /*
 	@brief Calculate and return color of fragment after applying raw phong lighting (not taking illumination into account)
 	@param a_lightBase is the data to get base phong lighting information from.
@@ -91,22 +189,23 @@ float CalculateIllumination(float a_dist, GPU_Light_Attenuation a_attenuationDat
 	@param a_dirToViewer is the direction from the fragment to the viewer.
 	@param a_diffuseSample is the color of the sampled texel of the diffuse map for this fragment.
 	@param a_specularSample is the color of the sampled texel of the specular map for this fragment.
+	@param a_shadow is how lit the fragment is, only scales the diffuse and specular light.
 	@return vec4 containing color information for a fragment lit by raw phong light.
 */
-vec4 CalculateRawLighting(GPU_Light_Base a_lightBase, vec3 a_dirToLight, vec3 a_normal, vec3 a_dirToViewer, vec4 a_diffuseSample, vec4 a_specularSample) {
+vec4 CalculateRawLighting(GPU_Light_Base a_lightBase, vec3 a_dirToLight, vec3 a_normal, vec3 a_dirToViewer, vec4 a_diffuseSample, vec4 a_specularSample, float a_shadow) {
 	// Calculate ambient
-	vec4 finalAmbient = a_lightBase.ambient * material.ambientColor * a_diffuseSample;
+	vec4 finalAmbient = a_lightBase.ambient * materials[materialIndex].ambientColor * a_diffuseSample;
 
 	// Calculate diffuse
 	float	diffuseScale	= max(dot(a_normal, a_dirToLight), 0.0f);		// How much fragment is impacted by the light based off its direction (fragment -> light source)
-	vec4	finalDiffuse	= a_lightBase.diffuse * diffuseScale * material.diffuseColor * a_diffuseSample;
+	vec4	finalDiffuse	= a_lightBase.diffuse * diffuseScale * materials[materialIndex].diffuseColor * a_diffuseSample;
 
 	// Calculate specular (Blinn-phong model)
 	vec3	halfwayDir		= normalize(a_dirToLight + a_dirToViewer);		// Direction halfway in between normal and light direction, avoids negative specular scale if view angle is greater than 90 degrees
-	float	specularScale	= pow(max(dot(a_normal, halfwayDir), 0.0), material.shininessCoefficient);
-	vec4	finalSpecular	= a_lightBase.specular * specularScale * material.specular * a_specularSample;
+	float	specularScale	= pow(max(dot(a_normal, halfwayDir), 0.0), materials[materialIndex].shininessCoefficient);
+	vec4	finalSpecular	= a_lightBase.specular * specularScale * materials[materialIndex].specular * a_specularSample;
 
-	return (finalAmbient + finalDiffuse + finalSpecular);
+	return (finalAmbient + (finalDiffuse + finalSpecular) * a_shadow);
 }
 
 /*
@@ -116,12 +215,13 @@ vec4 CalculateRawLighting(GPU_Light_Base a_lightBase, vec3 a_dirToLight, vec3 a_
 	@param a_viewerDir is the direction from the fragment to the viewer's position.
 	@param a_diffuseSample is the color of the sampled texel of the diffuse map for this fragment.
 	@param a_specularSample is the color of the sampled texel of the specular map for this fragment.
+	@param a_shadow is how lit the fragment is, only scales the diffuse and specular light.
 	@return vec4 containing color information for a fragment lit by a point light.
 */
-vec4 CalculatePointLighting(GPU_Pt_Light a_lightSource, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample) {
+vec4 CalculatePointLighting(GPU_Pt_Light a_lightSource, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample, float a_shadow) {
 	vec3 dirToLight = normalize(a_lightSource.position.xyz - worldFragPos); 
 	
-	vec4 pointLighting = CalculateRawLighting(a_lightSource.base, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample);
+	vec4 pointLighting = CalculateRawLighting(a_lightSource.base, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample, a_shadow);
 	
 	// Use modified light attenuation equation to get illumination scale for fragment, sourced from: https://imdoingitwrong.wordpress.com/2011/01/31/light-attenuation/
 	float illumination	= CalculateIllumination(length(worldFragPos - a_lightSource.position.xyz), a_lightSource.attenuation);
@@ -138,12 +238,13 @@ vec4 CalculatePointLighting(GPU_Pt_Light a_lightSource, vec3 a_normal, vec3 a_vi
 	@param a_viewerDir is the direction from the fragment to the viewer's position.
 	@param a_diffuseSample is the color of the sampled texel of the diffuse map for this fragment.
 	@param a_specularSample is the color of the sampled texel of the specular map for this fragment.
+	@param a_shadow is how lit the fragment is, only scales the diffuse and specular light.
 	@return vec4 containing color information for a fragment lit by a spot light.
 */
-vec4 CalculateSpotLighting(GPU_Spot_Light a_lightSource, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample) {
+vec4 CalculateSpotLighting(GPU_Spot_Light a_lightSource, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample, float a_shadow) {
 	vec3 dirToLight = normalize(a_lightSource.position.xyz - worldFragPos); 
 	
-	vec4 spotLighting = CalculateRawLighting(a_lightSource.base, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample);
+	vec4 spotLighting = CalculateRawLighting(a_lightSource.base, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample, a_shadow);
 
 	// Apply illumination based off fragment's proximity to the spotlight cone
 	float fragmentAngle = dot(dirToLight, normalize(-a_lightSource.spotDir));							// Get angle of fragment to light in relation to the spot direction. NOTE: Spot direction is negated so fragment is now pointing at light source for the dot product 
@@ -169,7 +270,7 @@ vec3 CalculateNormal() {
 	vec3 B = cross(N, T) * bitangentHandedness;		// Get unknown up axis by getting the cross between the right (tangent)
 													// NOTE: Timesed by the handedness to ensure it always forms a right-handed system with the other axis	
 	// Sample normal map
-	vec3 bumpMapN = texture(material.normalMap, vertTexCoord).rgb;
+	vec3 bumpMapN = texture(materialMaps.normalMap, vec3(vertTexCoord, materials[materialIndex].normalLayer)).rgb;
 
 	bumpMapN = normalize(2.0 * bumpMapN - 1.f);		// Convert sampled normal from color range (0-1) to normal range (-1-1)
 	
@@ -194,14 +295,14 @@ vec3 CalculateNormal() {
 void SetLightingParameters(inout vec4 a_diffuseSample, inout vec4 a_specularSample, inout vec3 a_normalSample, inout vec3 a_dirToViewer) {
 	// Calculate lighting parameters
 	a_diffuseSample = vec4(0.6f, 0.2f, 0.7f, 1.f);	// Set to default 'texture not found' color
-	if (material.useDiffuseMap == true) { a_diffuseSample = texture(material.diffuseMap, vertTexCoord); }
+	if (materials[materialIndex].useDiffuseMap != 0) { a_diffuseSample = texture(materialMaps.diffuseMap, vec3(vertTexCoord, materials[materialIndex].diffuseLayer)); }
 
 	a_specularSample = vec4(1);						// Set to white color so same specular applies to all fragments
-	if (material.useSpecularMap == true) { a_specularSample = texture(material.specularMap, vertTexCoord); }
+	if (materials[materialIndex].useSpecularMap != 0) { a_specularSample = texture(materialMaps.specularMap, vec3(vertTexCoord, materials[materialIndex].specularLayer)); }
 
 	//// Normal map
 	a_normalSample = worldNormal;					// Set to default interpolated normal in world space
-	if (material.useNormalMap == true) { a_normalSample = CalculateNormal(); }
+	if (materials[materialIndex].useNormalMap != 0) { a_normalSample = CalculateNormal(); }
 
 	a_dirToViewer = normalize(worldViewerPos - worldFragPos);		// Fragment pos -> viewer
 }
@@ -12,5 +12,5 @@ void main() {
 	SetLightingParameters(diffuseSample, specularSample, normalSample, dirToViewer);
 
 	// Apply point lighting pass
-	gl_FragColor = CalculatePointLighting( ptLight, normalSample, dirToViewer, diffuseSample, specularSample);
+	gl_FragColor = CalculatePointLighting( ptLight, normalSample, dirToViewer, diffuseSample, specularSample, CalculatePointShadow(ptLight.position.xyz));
 }
\ No newline at end of file
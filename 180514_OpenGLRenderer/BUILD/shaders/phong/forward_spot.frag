@@ -12,5 +12,5 @@ void main() {
 	SetLightingParameters(diffuseSample, specularSample, normalSample, dirToViewer);
 
 	// Apply spot lighting pass
-	gl_FragColor = CalculateSpotLighting( spotLight, normalSample, dirToViewer, diffuseSample, specularSample);
+	gl_FragColor = CalculateSpotLighting( spotLight, normalSample, dirToViewer, diffuseSample, specularSample, CalculateSpotShadow());
 }
\ No newline at end of file
@@ -0,0 +1,5 @@
+#version 440 core
+// NOTE: Depth only, the atlas frame buffers have no color attachments
+
+void main() {
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 440 core
+// NOTE: Reads the geometry pool's position only stream, positions are stored as vec3s so w is always 1
+layout (location = 0)	in vec4 a_pos;
+layout (location = 4)	in uint a_drawID;		// Object table entry of the draw (base instance)
+
+struct GPU_ObjectData {		// One entry of the object table, must match the layout of ObjectUniformBlock on the CPU
+	mat4	modelTransform;			// Global space
+	int		materialIndex;			// Entry in the material table
+};
+
+// Per-object data, sub-allocated from a ring buffer and indexed per draw (binding must match STORAGE_BINDING_OBJECTS)
+// NOTE: Instanced meshes bind their own transform buffer here instead, indexed per instance
+layout (std430, binding = 1) readonly buffer ObjectTable {
+	GPU_ObjectData objects[];
+};
+
+uniform bool isInstanced;		// Every instance of an instanced mesh in one draw
+
+// Projected once per view by the geometry shader
+out vec3 worldPos;
+
+void main() {
+	uint object = (isInstanced ? uint(gl_InstanceID) : a_drawID);
+
+	worldPos = vec3(objects[object].modelTransform * a_pos);
+}
\ No newline at end of file
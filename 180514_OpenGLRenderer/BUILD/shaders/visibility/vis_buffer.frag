@@ -0,0 +1,10 @@
+#version 440 core
+flat in uint drawID;		// Draw table entry, from the vertex shader
+
+// Triangle of the draw and its draw table entry + 1, the buffer is cleared to 0 so pixels nothing covered can be told apart
+layout (location = 0) out uvec2 visibility;
+
+void main() {
+	// NOTE: The primitive ID restarts at 0 for each instance of each draw
+	visibility = uvec2(uint(gl_PrimitiveID), drawID + 1u);
+}
\ No newline at end of file
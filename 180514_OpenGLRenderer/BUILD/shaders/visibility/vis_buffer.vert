@@ -0,0 +1,46 @@
+#version 440 core
+// NOTE: Reads the geometry pool's position only stream, positions are stored as vec3s so w is always 1
+layout (location = 0)	in vec4 a_pos;
+layout (location = 4)	in uint a_drawID;		// Draw table entry of the instance (base instance + instance)
+
+// Per-frame data, written once per frame (binding must match UNIFORM_BINDING_FRAME)
+layout (std140, binding = 0) uniform FrameData {
+	mat4	viewTransform;			// View space
+	mat4	projectionTransform;	// Clip space
+	vec3	worldViewerPos;
+	float	time;					// Seconds since startup
+	vec4	globalAmbient;
+};
+
+struct GPU_ObjectData {		// One entry of the object table, must match the layout of ObjectUniformBlock on the CPU
+	mat4	modelTransform;			// Global space
+	int		materialIndex;			// Entry in the material table
+};
+
+// Per-object data, sub-allocated from a ring buffer and indexed per draw (binding must match STORAGE_BINDING_OBJECTS)
+layout (std430, binding = 1) readonly buffer ObjectTable {
+	GPU_ObjectData objects[];
+};
+
+struct GPU_VisDraw {		// One entry of the draw table, must match the layout of VisDrawData on the CPU
+	uint	objectIndex;			// Entry in the object table
+	uint	firstIndex;
+	int		baseVertex;
+	uint	mapSet;
+};
+
+// One entry per drawn instance (binding must match STORAGE_BINDING_VIS_DRAWS)
+layout (std430, binding = 6) readonly buffer VisDrawTable {
+	GPU_VisDraw visDraws[];
+};
+
+flat out uint drawID;
+
+void main() {
+	mat4 modelTransform = objects[visDraws[a_drawID].objectIndex].modelTransform;
+
+	// Clip space <- view space <- global space <- local space
+	gl_Position = projectionTransform * viewTransform * modelTransform * a_pos;
+
+	drawID = a_drawID;
+}
\ No newline at end of file
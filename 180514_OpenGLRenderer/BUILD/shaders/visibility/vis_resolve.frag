@@ -0,0 +1,341 @@
+#version 440 core
+#define MAX_LIGHTS 8		// Size of each light array, must match VIS_MAX_LIGHTS
+#define VERTEX_FLOATS 13	// Floats per vertex in the geometry pool, must match the layout of Vertex on the CPU
+
+// NOTE: Light and material structs must match the forward pass header so the same uniform setters can be used
+struct GPU_Light_Base {
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+};
+
+struct GPU_Light_Attenuation {
+	float illuminationRadius;	// Coverage distance of light
+	float minIllumination;		// The minimum illumination of the light before it is cut-off
+};
+
+struct GPU_Pt_Light {
+	vec4 position;		// Must have a w component of 1
+
+	GPU_Light_Attenuation attenuation;
+	GPU_Light_Base base;
+};
+
+struct GPU_Spot_Light {
+	vec4	position;
+	vec3	spotDir;						// Direction spotlight is aiming in
+	float	spotInnerCosine;
+	float	spotOuterCosine;
+
+	GPU_Light_Base base;
+};
+
+struct GPU_Dir_Light {
+	vec3	castDir;		// Direction light is pointing in
+
+	GPU_Light_Base base;
+};
+
+struct GPU_MaterialData {	// One entry of the material table, must match the layout of GPUMaterial on the CPU
+	vec4	ambientColor;
+	vec4	diffuseColor;
+	vec4	specular;
+	float	shininessCoefficient;
+	int		useDiffuseMap;
+	int		useSpecularMap;
+	int		useNormalMap;
+	int		diffuseLayer;
+	int		specularLayer;
+	int		normalLayer;
+};
+
+struct GPU_MaterialMaps {
+	sampler2DArray	diffuseMap;
+	sampler2DArray	specularMap;
+	sampler2DArray	normalMap;
+};
+
+// Per-frame data, written once per frame (binding must match UNIFORM_BINDING_FRAME)
+layout (std140, binding = 0) uniform FrameData {
+	mat4	viewTransform;			// View space
+	mat4	projectionTransform;	// Clip space
+	vec3	worldViewerPos;
+	float	time;					// Seconds since startup
+	vec4	globalAmbient;
+};
+
+// Every registered material (binding must match STORAGE_BINDING_MATERIALS)
+layout (std430, binding = 0) readonly buffer MaterialTable {
+	GPU_MaterialData materials[];
+};
+
+struct GPU_ObjectData {		// One entry of the object table, must match the layout of ObjectUniformBlock on the CPU
+	mat4	modelTransform;			// Global space
+	int		materialIndex;			// Entry in the material table
+};
+
+// Per-object data (binding must match STORAGE_BINDING_OBJECTS)
+layout (std430, binding = 1) readonly buffer ObjectTable {
+	GPU_ObjectData objects[];
+};
+
+struct GPU_VisDraw {		// One entry of the draw table, must match the layout of VisDrawData on the CPU
+	uint	objectIndex;			// Entry in the object table
+	uint	firstIndex;				// First index of the draw in the index buffer
+	int		baseVertex;
+	uint	mapSet;					// Resolve pass that shades the draw's pixels
+};
+
+// One entry per drawn instance (binding must match STORAGE_BINDING_VIS_DRAWS)
+layout (std430, binding = 6) readonly buffer VisDrawTable {
+	GPU_VisDraw visDraws[];
+};
+
+// Geometry pool's buffers, read as plain arrays (bindings must match STORAGE_BINDING_VIS_VERTICES and STORAGE_BINDING_VIS_INDICES)
+layout (std430, binding = 7) readonly buffer VertexData {
+	float vertexData[];
+};
+
+layout (std430, binding = 8) readonly buffer IndexData {
+	uint indexData[];
+};
+
+uniform usampler2D			visibilityTex;		// Triangle and draw table entry + 1 of each pixel
+uniform int					mapSet;				// Only pixels of draws using this pass's maps are shaded
+uniform GPU_MaterialMaps	materialMaps;
+
+uniform GPU_Dir_Light	dirLights[MAX_LIGHTS];
+uniform GPU_Pt_Light	ptLights[MAX_LIGHTS];
+uniform GPU_Spot_Light	spotLights[MAX_LIGHTS];
+uniform int				dirLightCount;
+uniform int				ptLightCount;
+uniform int				spotLightCount;
+
+struct VisVertex {
+	vec4 pos;
+	vec2 texCoord;
+	vec3 normal;
+	vec4 normalTangent;		// Handedness of the bitangent in w
+};
+
+// Barycentrics of a pixel and how they change one pixel to the right and one pixel up
+struct Barycentrics {
+	vec3 lambda;
+	vec3 ddx;
+	vec3 ddy;
+};
+
+/**
+*	@brief Read a vertex out of the geometry pool's vertex buffer.
+*	@param a_index is the vertex's index, with the draw's base vertex already added.
+*	@return the vertex.
+*/
+VisVertex FetchVertex(uint a_index) {
+	uint base = a_index * VERTEX_FLOATS;
+
+	VisVertex vert;
+	vert.pos			= vec4(vertexData[base + 0], vertexData[base + 1], vertexData[base + 2], vertexData[base + 3]);
+	vert.texCoord		= vec2(vertexData[base + 4], vertexData[base + 5]);
+	vert.normal			= vec3(vertexData[base + 6], vertexData[base + 7], vertexData[base + 8]);
+	vert.normalTangent	= vec4(vertexData[base + 9], vertexData[base + 10], vertexData[base + 11], vertexData[base + 12]);
+
+	return vert;
+}
+
+/**
+*	@brief Calculate the perspective correct barycentrics of a pixel in a triangle and their screen space derivatives, in place of the rasterizer's interpolation.
+*	Derived from the clip space vertices by interpolating 1/w linearly in screen space (Schied and Dachsbacher, "Deferred Attribute Interpolation").
+*	@param a_clip0, a_clip1, a_clip2 are the triangle's vertices in clip space.
+*	@param a_pixelNDC is the pixel's center in normalized device coordinates.
+*	@param a_pixelSize is the size of a pixel in normalized device coordinates.
+*	@return barycentrics of the pixel and their derivatives.
+*/
+Barycentrics CalculateBarycentrics(vec4 a_clip0, vec4 a_clip1, vec4 a_clip2, vec2 a_pixelNDC, vec2 a_pixelSize) {
+	vec3 invW = 1.0 / vec3(a_clip0.w, a_clip1.w, a_clip2.w);
+
+	vec2 ndc0 = a_clip0.xy * invW.x;
+	vec2 ndc1 = a_clip1.xy * invW.y;
+	vec2 ndc2 = a_clip2.xy * invW.z;
+
+	// Screen space gradients of each vertex's weight divided by its w
+	float invDet	= 1.0 / determinant(mat2(ndc2 - ndc1, ndc0 - ndc1));
+	vec3 ddxW		= vec3(ndc1.y - ndc2.y, ndc2.y - ndc0.y, ndc0.y - ndc1.y) * invDet * invW;
+	vec3 ddyW		= vec3(ndc2.x - ndc1.x, ndc0.x - ndc2.x, ndc1.x - ndc0.x) * invDet * invW;
+	float ddxSum	= dot(ddxW, vec3(1));
+	float ddySum	= dot(ddyW, vec3(1));
+
+	// Interpolate 1/w to the pixel, then undo the division by w
+	vec2 delta			= a_pixelNDC - ndc0;
+	float interpInvW	= invW.x + delta.x * ddxSum + delta.y * ddySum;
+	float interpW		= 1.0 / interpInvW;
+
+	Barycentrics result;
+	result.lambda = interpW * (vec3(invW.x, 0, 0) + delta.x * ddxW + delta.y * ddyW);
+
+	// Same again one pixel over, for texture gradients
+	float interpWdx = 1.0 / (interpInvW + a_pixelSize.x * ddxSum);
+	float interpWdy = 1.0 / (interpInvW + a_pixelSize.y * ddySum);
+
+	result.ddx = interpWdx * (result.lambda * interpInvW + a_pixelSize.x * ddxW) - result.lambda;
+	result.ddy = interpWdy * (result.lambda * interpInvW + a_pixelSize.y * ddyW) - result.lambda;
+
+	return result;
+}
+
+/**
+*	@brief Calculate illumination factor for fragment based on its distance and attenuation data of the light.
+*	@param a_dist is the distance from the fragment to the light.
+*	@param a_attenuationData is the data concerning how the light falls off.
+*	@return illumination factor that can be used to scale the ambient, diffuse and specular light.
+*/
+float CalculateIllumination(float a_dist, GPU_Light_Attenuation a_attenuationData) {
+	float denominator		= a_dist / a_attenuationData.illuminationRadius + 1;
+	float illumination		= 1 / (denominator * denominator);
+
+	illumination = (illumination - a_attenuationData.minIllumination) / (1 - a_attenuationData.minIllumination);
+	illumination = max(illumination, 0);
+
+	return illumination;
+}
+
+/*
+	@brief Calculate color of fragment after applying raw phong lighting, as the forward light passes do.
+	@param a_lightBase is the data to get base phong lighting information from.
+	@param a_material is the fragment's material.
+	@param a_dirToLight is the direction from the fragment to the light.
+	@param a_normal is the direction the fragment is pointing in.
+	@param a_dirToViewer is the direction from the fragment to the viewer.
+	@param a_diffuseSample is the diffuse map's texel for this fragment.
+	@param a_specularSample is the specular map's texel for this fragment.
+	@return vec4 containing color information for a fragment lit by raw phong light.
+*/
+vec4 CalculateRawLighting(GPU_Light_Base a_lightBase, GPU_MaterialData a_material, vec3 a_dirToLight, vec3 a_normal, vec3 a_dirToViewer, vec4 a_diffuseSample, vec4 a_specularSample) {
+	vec4 finalAmbient = a_lightBase.ambient * a_material.ambientColor * a_diffuseSample;
+
+	float	diffuseScale	= max(dot(a_normal, a_dirToLight), 0.0f);
+	vec4	finalDiffuse	= a_lightBase.diffuse * diffuseScale * a_material.diffuseColor * a_diffuseSample;
+
+	// Blinn-phong
+	vec3	halfwayDir		= normalize(a_dirToLight + a_dirToViewer);
+	float	specularScale	= pow(max(dot(a_normal, halfwayDir), 0.0), a_material.shininessCoefficient);
+	vec4	finalSpecular	= a_lightBase.specular * specularScale * a_material.specular * a_specularSample;
+
+	return (finalAmbient + finalDiffuse + finalSpecular);
+}
+
+/*
+	@brief Calculate color of fragment after applying point lighting.
+	@param a_fragPos is the fragment's world space position.
+	@return vec4 containing color information for a fragment lit by a point light.
+*/
+vec4 CalculatePointLighting(GPU_Pt_Light a_lightSource, GPU_MaterialData a_material, vec3 a_fragPos, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample) {
+	vec3 dirToLight = normalize(a_lightSource.position.xyz - a_fragPos);
+
+	vec4 pointLighting = CalculateRawLighting(a_lightSource.base, a_material, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample);
+	pointLighting *= CalculateIllumination(length(a_fragPos - a_lightSource.position.xyz), a_lightSource.attenuation);
+
+	return pointLighting;
+}
+
+/*
+	@brief Calculate color of fragment after applying spot lighting.
+	@param a_fragPos is the fragment's world space position.
+	@return vec4 containing color information for a fragment lit by a spot light.
+*/
+vec4 CalculateSpotLighting(GPU_Spot_Light a_lightSource, GPU_MaterialData a_material, vec3 a_fragPos, vec3 a_normal, vec3 a_viewerDir, vec4 a_diffuseSample, vec4 a_specularSample) {
+	vec3 dirToLight = normalize(a_lightSource.position.xyz - a_fragPos);
+
+	vec4 spotLighting = CalculateRawLighting(a_lightSource.base, a_material, dirToLight, a_normal, a_viewerDir, a_diffuseSample, a_specularSample);
+
+	// Apply illumination based off fragment's proximity to the spotlight cone
+	float fragmentAngle = dot(dirToLight, normalize(-a_lightSource.spotDir));
+	float cutOff		= a_lightSource.spotInnerCosine - a_lightSource.spotOuterCosine;
+	spotLighting		*= clamp((fragmentAngle - a_lightSource.spotOuterCosine) / cutOff, 0.0, 1.0);
+
+	return spotLighting;
+}
+
+void main() {
+	uvec2 visibility = texelFetch(visibilityTex, ivec2(gl_FragCoord.xy), 0).rg;
+	if (visibility.g == 0u) { discard; }		// Nothing was drawn here
+
+	GPU_VisDraw draw = visDraws[visibility.g - 1u];
+	if (draw.mapSet != uint(mapSet)) { discard; }		// Shaded by the resolve of another set of maps
+
+	mat4 modelTransform = objects[draw.objectIndex].modelTransform;
+	GPU_MaterialData material = materials[objects[draw.objectIndex].materialIndex];
+
+	//// Fetch the triangle
+	uint triangleStart = draw.firstIndex + visibility.r * 3u;
+
+	VisVertex vert0 = FetchVertex(uint(int(indexData[triangleStart + 0u]) + draw.baseVertex));
+	VisVertex vert1 = FetchVertex(uint(int(indexData[triangleStart + 1u]) + draw.baseVertex));
+	VisVertex vert2 = FetchVertex(uint(int(indexData[triangleStart + 2u]) + draw.baseVertex));
+
+	vec4 worldPos0 = modelTransform * vert0.pos;
+	vec4 worldPos1 = modelTransform * vert1.pos;
+	vec4 worldPos2 = modelTransform * vert2.pos;
+
+	mat4 projectionView = projectionTransform * viewTransform;
+	vec4 clip0 = projectionView * worldPos0;
+	vec4 clip1 = projectionView * worldPos1;
+	vec4 clip2 = projectionView * worldPos2;
+
+	//// Interpolate
+	vec2 screenSize = vec2(textureSize(visibilityTex, 0));
+	Barycentrics bary = CalculateBarycentrics(clip0, clip1, clip2, gl_FragCoord.xy / screenSize * 2.0 - 1.0, 2.0 / screenSize);
+
+	// Depth the fragment had in the visibility pass, so anything drawn after the resolve is still depth tested
+	vec4 clipPos = bary.lambda.x * clip0 + bary.lambda.y * clip1 + bary.lambda.z * clip2;
+	gl_FragDepth = (clipPos.z / clipPos.w) * 0.5 + 0.5;
+
+	vec3 worldFragPos = (bary.lambda.x * worldPos0 + bary.lambda.y * worldPos1 + bary.lambda.z * worldPos2).xyz;
+
+	mat3x2 texCoords	= mat3x2(vert0.texCoord, vert1.texCoord, vert2.texCoord);
+	vec2 texCoord		= texCoords * bary.lambda;
+	vec2 texCoordDx		= texCoords * bary.ddx;
+	vec2 texCoordDy		= texCoords * bary.ddy;
+
+	vec3 localNormal	= mat3(vert0.normal, vert1.normal, vert2.normal) * bary.lambda;
+	vec3 localTangent	= mat3(vert0.normalTangent.xyz, vert1.normalTangent.xyz, vert2.normalTangent.xyz) * bary.lambda;
+
+	vec3 worldNormal	= normalize(mat3(modelTransform) * localNormal);
+	vec3 worldTangent	= normalize(mat3(modelTransform) * localTangent);
+	float bitangentHandedness = vert2.normalTangent.w;		// Flat values come from the last vertex in the forward passes
+
+	//// Sample the material, with the gradients the rasterizer would have given
+	vec4 diffuseSample = vec4(0.6f, 0.2f, 0.7f, 1.f);		// Default 'texture not found' color
+	if (material.useDiffuseMap != 0) { diffuseSample = textureGrad(materialMaps.diffuseMap, vec3(texCoord, material.diffuseLayer), texCoordDx, texCoordDy); }
+
+	vec4 specularSample = vec4(1);
+	if (material.useSpecularMap != 0) { specularSample = textureGrad(materialMaps.specularMap, vec3(texCoord, material.specularLayer), texCoordDx, texCoordDy); }
+
+	vec3 normal = worldNormal;
+	if (material.useNormalMap != 0) {
+		vec3 T = normalize(worldTangent - dot(worldTangent, worldNormal) * worldNormal);		// Re-orthogonalize
+		vec3 B = cross(worldNormal, T) * bitangentHandedness;
+
+		vec3 bumpMapN = textureGrad(materialMaps.normalMap, vec3(texCoord, material.normalLayer), texCoordDx, texCoordDy).rgb;
+		normal = normalize(mat3(T, B, worldNormal) * normalize(2.0 * bumpMapN - 1.f));
+	}
+
+	vec3 dirToViewer = normalize(worldViewerPos - worldFragPos);
+
+	//// Shade, the sum of what the forward ambient and light passes would have blended together
+	vec4 finalColor = vec4(0.6f, 0.2f, 0.7f, 1.f);
+	if (material.useDiffuseMap != 0) { finalColor = globalAmbient * material.ambientColor * diffuseSample; }
+
+	for (int i = 0; i < dirLightCount; ++i) {
+		finalColor += CalculateRawLighting(dirLights[i].base, material, -dirLights[i].castDir, normal, dirToViewer, diffuseSample, specularSample);
+	}
+
+	for (int i = 0; i < ptLightCount; ++i) {
+		finalColor += CalculatePointLighting(ptLights[i], material, worldFragPos, normal, dirToViewer, diffuseSample, specularSample);
+	}
+
+	for (int i = 0; i < spotLightCount; ++i) {
+		finalColor += CalculateSpotLighting(spotLights[i], material, worldFragPos, normal, dirToViewer, diffuseSample, specularSample);
+	}
+
+	gl_FragColor = finalColor;
+}
\ No newline at end of file
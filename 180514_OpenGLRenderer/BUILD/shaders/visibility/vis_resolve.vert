@@ -0,0 +1,8 @@
+#version 440 core
+// NOTE: Draws a single triangle covering the screen from the vertex index alone, no vertex attributes are read
+
+void main() {
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);		// (0, 0), (2, 0), (0, 2)
+
+	gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
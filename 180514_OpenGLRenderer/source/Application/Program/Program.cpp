@@ -1,16 +1,28 @@
 #include "Program.h"
 #include "Renderer_Utility_Literals.h"
 #include "Renderer_Utility_Funcs.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "MaterialTable.h"
+#include "GeometryPool.h"
+#include "Texture\TextureBinder.h"
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
 
 #include <GLFW/glfw3.h>
 #include <gl_core_4_4.h>
 #include <iostream>
+#include <chrono>
 #include <imgui.h>
 #include <imgui_impl_glfw_gl3.h>
 
 namespace SPRON {
 
-	Program::Program()
+	Program::Program() :
+		m_isSimulationPending(false), m_isSimulationThreadRunning(false), m_simulationDeltaTime(0.f), m_isPipelined(USE_PIPELINED_SIMULATION),
+		m_updateTime(0.f), m_simulationTime(0.f), m_waitTime(0.f), m_renderTime(0.f)
 	{
 	}
 
@@ -31,6 +43,24 @@ namespace SPRON {
 	{
 	}
 
+	/**
+	*	@brief Advance the parts of the scene that need no openGL, IMGUI or window calls, such as moving lights and animating transforms.
+	*	NOTE: Runs on the simulation thread when pipelined, so it must only change state that is published before rendering reads it.
+	*	@param a_dt is the time since the last frame.
+	*	@return void.
+	*/
+	void Program::Simulate(float a_dt)
+	{
+	}
+
+	/**
+	*	@brief Copy the simulated state that rendering reads, called on the main thread while the simulation is idle.
+	*	@return void.
+	*/
+	void Program::Publish()
+	{
+	}
+
 	void Program::Render()
 	{
 	}
@@ -103,9 +133,19 @@ namespace SPRON {
 		}
 #endif
 
+		FrameArena::Initialise();			// Per thread memory for transient data, before anything that allocates from it
+		JobSystem::Initialise(JOB_WORKER_COUNT);	// Workers for frame update, culling and draw building, openGL calls stay on this thread
+		TransformHierarchy::Initialise();	// Must exist before any transforms are created
+
 		/// Rendering initialisation
+		GLStateCache::Initialise();		// Shadow bound state to filter redundant state changes
+		TextureBinder::Initialise();	// Must exist before any textures are created
+		UniformBlocks::Initialise();	// Uniform buffers shared between all shader programs
+		GeometryPool::Initialise();		// Must exist before any meshes are created, after the uniform blocks
+		MaterialTable::Initialise();	// Must exist before any meshes are created
+
 		glClearColor(DEFAULT_CLEAR_COLOR);
-		glEnable(GL_DEPTH_TEST);	// Activate the z-buffer to make sure the closest pixels draw in overlap scenarios
+		GLStateCache::SetDepthTest(true);	// Activate the z-buffer to make sure the closest pixels draw in overlap scenarios
 
 		// Enable anti-aliasing at the sample rate set by the window hint
 		glEnable(GL_MULTISAMPLE);
@@ -116,9 +156,29 @@ namespace SPRON {
 		double lastFrameTime = glfwGetTime();
 		double currFrameTime = 0;
 		double deltaTime = 0;
+		unsigned int frameCount = 0;
+
+		m_isSimulationThreadRunning = true;
+		m_simulationThread = std::thread(&Program::SimulationLoop, this);
 
 		/// Main loop
 		while (glfwWindowShouldClose(window) == false && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS) {		// Window has not been closed and escape key has not been pressed
+			WaitForSimulation();			// NOTE: Before input is polled or any shared state is touched, the simulation started last frame may still be reading them
+
+			// Nothing is running on other threads, safe to free last frame's transient memory
+			AllocationTracker::BeginFrame();
+			FrameArena::BeginFrame();
+
+			// Caches and pools have grown to fit the scene once the first frames have run, any allocation after that is a regression
+			if (ASSERT_FRAME_ALLOCATIONS && ++frameCount == ALLOCATION_WARMUP_FRAMES) { AllocationTracker::SetAsserting(true); }
+
+			GLStateCache::BeginFrame();		// Reset state call counts and forget state changed by IMGUI last frame
+			TextureBinder::BeginFrame();
+			UniformBlocks::BeginFrame();	// Waits for the GPU if it is STREAM_BUFFER_FRAMES frames behind
+			TransformHierarchy::BeginFrame();
+			JobSystem::BeginFrame();
+			GeometryPool::Defragment(GEOMETRY_DEFRAG_BYTES_PER_FRAME);		// Before any draws are recorded so they use the moved ranges
+
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);		// Wipe back buffers and clear z-buffer to indicate we're rendering a new frame
 
 			glfwPollEvents();				// Record input for this frame
@@ -129,23 +189,157 @@ namespace SPRON {
 			deltaTime = currFrameTime - lastFrameTime;
 			lastFrameTime = currFrameTime;
 
-			Update((float)deltaTime);
+			{
+				AllocationTracker::AllowAllocations allow;		// NOTE: Input and UI edits such as changing the worker count may allocate by design
+
+				auto updateStart = std::chrono::high_resolution_clock::now();
+				Update((float)deltaTime);
+				m_updateTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
 
+				ListenIMGUI();
+			}
+
+			if (!m_isPipelined) { RunSimulation((float)deltaTime); }
+
+			// Hand the simulated state to rendering
+			TransformHierarchy::Publish();
+			Publish();
+
+			// Simulate the next frame while this one is rendered, input sampled this frame reaches the screen at most one frame later
+			if (m_isPipelined) { StartSimulation((float)deltaTime); }
+
+			auto renderStart = std::chrono::high_resolution_clock::now();
 			Render();
+			m_renderTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - renderStart).count();
 
 			ImGui::Render();
 			ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
 
+			UniformBlocks::EndFrame();		// Fence this frame's stream regions once everything reading them has been issued
+
 			glfwSwapBuffers(window);	// Back buffer has received draw information from Render, swap with front buffer to display new graphics for this frame
 		}
 
+		// Stop the simulation thread
+		WaitForSimulation();
+
+		AllocationTracker::SetAsserting(false);		// Shutting down frees and allocates freely
+
+		{
+			std::lock_guard<std::mutex> lock(m_simulationMutex);
+			m_isSimulationThreadRunning = false;
+		}
+		m_simulationCondition.notify_all();
+		m_simulationThread.join();
+
 		// Clean up IMGUI
 		ImGui_ImplGlfwGL3_Shutdown();
 		ImGui::DestroyContext();
 
 		Shutdown();
 
+		MaterialTable::Shutdown();
+		GeometryPool::Shutdown();
+		UniformBlocks::Shutdown();
+		TextureBinder::Shutdown();
+		GLStateCache::Shutdown();
+		TransformHierarchy::Shutdown();
+		JobSystem::Shutdown();
+		FrameArena::Shutdown();
+
 		DestroyContextWindow();
 		return EXIT_SUCCESS;
 	}
+
+	/**
+	*	@brief Simulate a frame on the calling thread and propagate the transforms it changed.
+	*	@param a_dt is the time since the last frame.
+	*	@return void.
+	*/
+	void Program::RunSimulation(float a_dt)
+	{
+		auto simulationStart = std::chrono::high_resolution_clock::now();
+
+		Simulate(a_dt);
+
+		TransformHierarchy::Update();	// Propagate every transform changed this frame in one pass, off the main thread when pipelined
+
+		m_simulationTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - simulationStart).count();
+	}
+
+	/**
+	*	@brief Wake the simulation thread to simulate a frame.
+	*	@param a_dt is the time since the last frame.
+	*	@return void.
+	*/
+	void Program::StartSimulation(float a_dt)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_simulationMutex);
+
+			m_simulationDeltaTime = a_dt;
+			m_isSimulationPending = true;
+		}
+
+		m_simulationCondition.notify_all();
+	}
+
+	/**
+	*	@brief Block until the simulation thread has finished the frame it was started on, returns immediately if none was started.
+	*	@return void.
+	*/
+	void Program::WaitForSimulation()
+	{
+		auto waitStart = std::chrono::high_resolution_clock::now();
+
+		std::unique_lock<std::mutex> lock(m_simulationMutex);
+		m_simulationCondition.wait(lock, [this]() { return !m_isSimulationPending; });
+
+		m_waitTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+	}
+
+	/**
+	*	@brief Simulate a frame each time one is started, until the thread is stopped.
+	*	@return void.
+	*/
+	void Program::SimulationLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_simulationMutex);
+
+		while (true) {
+			m_simulationCondition.wait(lock, [this]() { return m_isSimulationPending || !m_isSimulationThreadRunning; });
+
+			if (!m_isSimulationThreadRunning) {
+				FrameArena::ReleaseThreadArena();
+				return;
+			}
+
+			lock.unlock();
+			RunSimulation(m_simulationDeltaTime);
+			lock.lock();
+
+			m_isSimulationPending = false;
+			m_simulationCondition.notify_all();
+		}
+	}
+
+	/**
+	*	@brief Display how long each part of the last frame took and whether the simulation overlapped rendering.
+	*	NOTE: When pipelined the frame time is roughly the larger of the update plus render and the simulation, instead of their sum.
+	*	@return void.
+	*/
+	void Program::ListenIMGUI()
+	{
+		ImGui::Begin("Frame Pipeline");
+
+		ImGui::Checkbox("Pipelined simulation", &m_isPipelined);		// NOTE: Safe to switch here, the simulation is idle until it is started after publishing
+
+		ImGui::Text("Update: %.3f ms", m_updateTime);
+		ImGui::Text("Simulate: %.3f ms (%s)", m_simulationTime, (m_isPipelined ? "simulation thread" : "main thread"));
+		ImGui::Text("Render: %.3f ms", m_renderTime);
+		ImGui::Text("Waited for simulation: %.3f ms", m_waitTime);
+		ImGui::Text("Frame time: %.3f ms", 1000.f / ImGui::GetIO().Framerate);
+
+		ImGui::End();
+	}
 }
\ No newline at end of file
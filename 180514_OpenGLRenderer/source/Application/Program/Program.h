@@ -1,5 +1,9 @@
 #pragma once
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 struct GLFWwindow;
 
 namespace SPRON {
@@ -14,9 +18,35 @@ namespace SPRON {
 		virtual void Shutdown() = 0;
 
 		virtual void Update(float a_dt) = 0;
+		virtual void Simulate(float a_dt);
+		virtual void Publish();
 		virtual void Render() = 0;
 	private:
 		GLFWwindow* InitialiseWindow(const char* a_windowName, int a_width, int a_height);
 		void DestroyContextWindow();
+
+		void RunSimulation(float a_dt);
+		void StartSimulation(float a_dt);
+		void WaitForSimulation();
+		void SimulationLoop();
+
+		void ListenIMGUI();
+
+		/// Simulation thread
+		// NOTE: When pipelined, the next frame is simulated on this thread while the main thread renders the state published for the current frame
+		std::thread					m_simulationThread;
+		std::mutex					m_simulationMutex;
+		std::condition_variable		m_simulationCondition;
+		bool						m_isSimulationPending;		// Simulation has been started and has not finished yet
+		bool						m_isSimulationThreadRunning;
+		float						m_simulationDeltaTime;
+
+		bool	m_isPipelined;			// Simulate on the simulation thread overlapped with rendering, otherwise simulate on the main thread before publishing
+
+		// Statistics
+		float m_updateTime;			// Milliseconds spent in the last Update
+		float m_simulationTime;		// Milliseconds spent in the last simulation, on whichever thread ran it
+		float m_waitTime;			// Milliseconds the main thread waited for the simulation to finish
+		float m_renderTime;			// Milliseconds spent in the last Render
 	};
 }
\ No newline at end of file
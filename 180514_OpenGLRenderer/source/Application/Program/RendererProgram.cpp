@@ -7,12 +7,29 @@
 #include "ShaderWrapper.h"
 #include "VertexFormat.h"
 #include "Mesh.h"
+#include "InstancedMesh.h"
+#include "StaticBatch.h"
+#include "PotentiallyVisibleSet.h"
 #include "Texture\Texture.h"
 #include "Light\PhongLight_Dir.h"
 #include "Light\PhongLight_Point.h"
 #include "Light\PhongLight_Spot.h"
-#include "Model.h"
+#include "ModelAsset.h"
+#include "ModelInstance.h"
+#include "SceneStore.h"
 #include "PostProcessing.h"
+#include "RenderQueue.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "MaterialTable.h"
+#include "GeometryPool.h"
+#include "Texture\TextureBinder.h"
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
+#include "Frustum.h"
+#include "ShadowAtlas.h"
 
 #include <glm/vec4.hpp>
 #include <glm/ext.hpp>
@@ -46,24 +63,35 @@ namespace SPRON {
 		mainCamera->GetTransform()->SetPosition(glm::vec3(0, 5, -5));
 		mainCamera->GetTransform()->SetRotation(glm::vec3(glm::radians(20.f), 0, 0));
 
+		// Render queue
+		renderQueue = new RenderQueue();
+
+		// Shadows
+#if USE_SHADOWS
+		ShadowAtlas::Initialise();
+#endif
+
+		// Scene
+		scene = new SceneStore();
+
 		/// Light initialisation
 #pragma region Lights
 #if ENABLE_DIR_LIGHTS
-		sceneLights.push_back(new PhongLight_Dir(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(0, -1, -1, 0)));
-		sceneLights.push_back(new PhongLight_Dir(glm::vec4(0.f), glm::vec4(0.4f, 0.f, 0.f, 1.f), glm::vec4(0.5f), glm::vec4(1, 0, 0, 0)));
+		scene->AddLight(PhongLight_Dir(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(0, -1, -1, 0)));
+		scene->AddLight(PhongLight_Dir(glm::vec4(0.f), glm::vec4(0.4f, 0.f, 0.f, 1.f), glm::vec4(0.5f), glm::vec4(1, 0, 0, 0)));
 #endif
 
 #if ENABLE_POINT_LIGHTS
-		sceneLights.push_back(new PhongLight_Point(glm::vec4(0.f), glm::vec4(0.8f, 0.f, 0.f, 1.f), glm::vec4(1.f),
+		scene->AddLight(PhongLight_Point(glm::vec4(0.f), glm::vec4(0.8f, 0.f, 0.f, 1.f), glm::vec4(1.f),
 			DEFAULT_LIGHT_POS1, 200.f, DEFAULT_MIN_ILLUMINATION));
-		sceneLights.push_back(new PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1),
+		scene->AddLight(PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1),
 			glm::vec4(0.f, 2.f, 0.f, 1.f), 200.f, DEFAULT_MIN_ILLUMINATION));
-		sceneLights.push_back(new PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(0.f, 12.5f, 4.f, 1.f), 200.f, DEFAULT_MIN_ILLUMINATION));
-		sceneLights.push_back(new PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(4.f, 12.5f, 4.f, 1.f), 200.f, DEFAULT_MIN_ILLUMINATION));
+		scene->AddLight(PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(0.f, 12.5f, 4.f, 1.f), 200.f, DEFAULT_MIN_ILLUMINATION));
+		scene->AddLight(PhongLight_Point(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), glm::vec4(4.f, 12.5f, 4.f, 1.f), 200.f, DEFAULT_MIN_ILLUMINATION));
 #endif
 
 #if ENABLE_SPOT_LIGHTS
-	sceneLights.push_back(new PhongLight_Spot(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), 
+	scene->AddLight(PhongLight_Spot(glm::vec4(0.f), glm::vec4(1.f), glm::vec4(1.f), 
 		glm::vec4(-10.f, 0.f, 0.f, 1.f), glm::vec4(1, 0, 0, 0), 10.f, 14.f));
 #endif
 #pragma endregion
@@ -168,36 +196,54 @@ namespace SPRON {
 		/// Mesh initialisation
 #pragma region Models/VertFormats/Meshes
 		// Models
-		Model* midirModel = new Model("./models/Midir/midir.obj"); midirModel->GetTransform()->SetPosition(glm::vec3(5, 0, 8));
+		ModelInstance* midirModel = new ModelInstance("./models/Midir/midir.obj", !ROTATE_MODELS); midirModel->GetTransform()->SetPosition(glm::vec3(5, 0, 8));
 		sceneModels.push_back(midirModel);
 
-		Model* stormtrooperModel = new Model("./models/stormtrooper/stormtrooper.obj");
+		ModelInstance* stormtrooperModel = new ModelInstance("./models/stormtrooper/stormtrooper.obj");
 		sceneModels.push_back(stormtrooperModel);
 
-		Model* robinModel = new Model("./models/robin/B-AO_X360_HERO_Dick_Grayson_Robin_Arkham_Origins.obj"); robinModel->GetTransform()->SetPosition(glm::vec3(2, 4, 2));
+		// Crowd of the same model, shares the stormtrooper's asset so it is only imported once and drawn as instances
+		for (int i = 0; i < DEFAULT_CROWD_NUM; ++i) {
+			ModelInstance* crowdModel = new ModelInstance("./models/stormtrooper/stormtrooper.obj");
+			crowdModel->GetTransform()->SetPosition(glm::vec3((i % 32) * 1.5f - 24.f, 0, -5.f - (i / 32) * 1.5f));
+			sceneModels.push_back(crowdModel);
+		}
+
+		ModelInstance* robinModel = new ModelInstance("./models/robin/B-AO_X360_HERO_Dick_Grayson_Robin_Arkham_Origins.obj", !ROTATE_MODELS); robinModel->GetTransform()->SetPosition(glm::vec3(2, 4, 2));
 		sceneModels.push_back(robinModel);
 
-		Model* hicksModel = new Model("./models/hicks/A-CM_X360_COLONIAL_MARINE_Dwayne_Hicks_Hostage.obj"); hicksModel->GetTransform()->Translate(glm::vec3(-4, 0, 0));
+		ModelInstance* hicksModel = new ModelInstance("./models/hicks/A-CM_X360_COLONIAL_MARINE_Dwayne_Hicks_Hostage.obj", !ROTATE_MODELS); hicksModel->GetTransform()->Translate(glm::vec3(-4, 0, 0));
 		sceneModels.push_back(hicksModel);
 
-		Model* queenModel = new Model("./models/xenomorph_queen/A-CM_X360_XENOMORPH_Queen.obj"); queenModel->GetTransform()->Translate(glm::vec3(4, 0, 0));
+		ModelInstance* queenModel = new ModelInstance("./models/xenomorph_queen/A-CM_X360_XENOMORPH_Queen.obj", !ROTATE_MODELS); queenModel->GetTransform()->Translate(glm::vec3(4, 0, 0));
 		sceneModels.push_back(queenModel);
 
-		Model* crusherModel = new Model("./models/xenomorph_crusher/A-CM_X360_XENOMORPH_Crusher.obj");
+		ModelInstance* crusherModel = new ModelInstance("./models/xenomorph_crusher/A-CM_X360_XENOMORPH_Crusher.obj", !ROTATE_MODELS);
 		sceneModels.push_back(crusherModel);
 
-		Model* floorModel = new Model("./models/floor/Sci-Fi-Floor-1-BLEND.obj"); floorModel->GetTransform()->SetScale(glm::vec3(10.f, 10.f, 10.f));
+		ModelInstance* floorModel = new ModelInstance("./models/floor/Sci-Fi-Floor-1-BLEND.obj", true); floorModel->GetTransform()->SetScale(glm::vec3(10.f, 10.f, 10.f));
 		sceneModels.push_back(floorModel);
 
-		Model* devilModel = new Model("./models/theatre_devil/BIO-I_PC_N.P.C_Theatre_Devil.obj"); devilModel->GetTransform()->Translate(glm::vec3(10, 0, 0));
+		ModelInstance* devilModel = new ModelInstance("./models/theatre_devil/BIO-I_PC_N.P.C_Theatre_Devil.obj", !ROTATE_MODELS); devilModel->GetTransform()->Translate(glm::vec3(10, 0, 0));
 		sceneModels.push_back(devilModel);
 
-		Model* clarissaModel = new Model("./models/clarissa/Clarissa.obj"); clarissaModel->GetTransform()->SetScale(glm::vec3(0.12, 0.12, 0.12));
+		ModelInstance* clarissaModel = new ModelInstance("./models/clarissa/Clarissa.obj", !ROTATE_MODELS); clarissaModel->GetTransform()->SetScale(glm::vec3(0.12, 0.12, 0.12));
 		sceneModels.push_back(clarissaModel);
 
-		Model* skullModel = new Model("./models/skull/Skull.obj"); skullModel->GetTransform()->Translate(glm::vec3(0, 0, 15)); skullModel->GetTransform()->SetScale(glm::vec3(0.01, 0.01, 0.01));
+		ModelInstance* skullModel = new ModelInstance("./models/skull/Skull.obj", !ROTATE_MODELS); skullModel->GetTransform()->Translate(glm::vec3(0, 0, 15)); skullModel->GetTransform()->SetScale(glm::vec3(0.01, 0.01, 0.01));
 		sceneModels.push_back(skullModel);
 
+		// Merge the static models by material, their transforms must be final by now
+		staticBatches = StaticBatch::Build(sceneModels);
+
+		// Load the static batches' visible sets, baking them if the scene changed since they were saved
+		visibleSet = new PotentiallyVisibleSet();
+		if (USE_PVS && !visibleSet->Load(PVS_FILE_PATH, staticBatches)) {
+			visibleSet->Bake(staticBatches, PVS_CELL_SIZE);
+			visibleSet->Save(PVS_FILE_PATH);
+		}
+		renderQueue->SetVisibleSet(visibleSet);
+
 		// Vertex formats
 		VertexFormat* rectFormat = new VertexFormat(std::vector<unsigned int>{
 			0, 1, 2,	// First triangle
@@ -251,12 +297,20 @@ namespace SPRON {
 				Vertex(glm::vec4(-0.5f,  0.5f, -0.5f,1.f),	glm::vec2(0.f, 1.f), glm::vec4(0.0f,  1.0f,  0.0f, 0.f))
 		};
 
+#if USE_INSTANCED_CUBES
+		// Geometry is shared, so the cube count can be changed at runtime through the benchmark window
+		cubeInstances = new InstancedMesh(cubeVerts, cubeFormat, crateMat);
+		PlaceCubes(cubeNum);
+#else
 		for (int i = 0; i < DEFAULT_CUBE_NUM; ++i) {
-			sceneMeshes.push_back(new Mesh(cubeVerts, cubeFormat, new Transform(), crateMat));
+			Mesh* cubeMesh = new Mesh(cubeVerts, cubeFormat, new Transform(), crateMat);
+
+			cubeMesh->GetTransform()->SetPosition(glm::vec3(i * 2, i * 2, i * 2));
+			cubeMesh->GetTransform()->SetScale(glm::vec3(1));
 
-			sceneMeshes[i]->GetTransform()->SetPosition(glm::vec3(i * 2, i * 2, i * 2));
-			sceneMeshes[i]->GetTransform()->SetScale(glm::vec3(1));
+			scene->AddMesh(cubeMesh);
 		}
+#endif
 #pragma endregion
 
 		/// Draw mode
@@ -277,22 +331,28 @@ namespace SPRON {
 		delete floorTex;
 
 		delete mainCamera;
+		delete renderQueue;
+
+#if USE_SHADOWS
+		ShadowAtlas::Shutdown();
+#endif
 
-		for (int i = 0; i < sceneMeshes.size(); ++i) {
-			delete sceneMeshes[i];
+		delete cubeInstances;
+
+		for (int i = 0; i < staticBatches.size(); ++i) {
+			delete staticBatches[i];
 		}
-		sceneMeshes.clear();
+		staticBatches.clear();
+
+		delete visibleSet;
+
+		delete scene;		// Deletes the scene's meshes and lights
 
 		for (int i = 0; i < sceneModels.size(); ++i) {
 			delete sceneModels[i];
 		}
 		sceneModels.clear();
 
-		for (int i = 0; i < sceneLights.size(); ++i) {
-			delete sceneLights[i];
-		}
-		sceneLights.clear();
-
 		delete ambientProgram;
 		delete directionalProgram;
 		delete spotProgram;
@@ -313,37 +373,32 @@ namespace SPRON {
 
 		// Run update until no more extra time between updates left
 		while (m_accumulatedTime >= m_fixedTimeStep) {
-			InputMonitor* input = InputMonitor::GetInstance();
-
-			mainCamera->Update(m_fixedTimeStep);
-
 			/// Lighting update
-			for (int i = 0; i < sceneLights.size(); ++i) {
+			// NOTE: Lights are stored by type, so each loop only touches the lights it updates
+			std::vector<PhongLight_Spot>& spotLights = scene->GetSpotLights();
+
+			for (int i = 0; i < spotLights.size(); ++i) {
 				// Update spot light position and direction based off camera
-				if (sceneLights[i]->GetType() == SPOT_LIGHT) {
-					PhongLight_Spot* spotLight = (PhongLight_Spot*)sceneLights[i];
+				spotLights[i].SetPos(glm::vec4(mainCamera->GetTransform()->GetPosition(), 1));
+				spotLights[i].SetSpotDir(glm::vec4(mainCamera->GetTransform()->Forward(), 0));
+			}
 
-					spotLight->SetPos(glm::vec4(mainCamera->GetTransform()->GetPosition(), 1));
-					spotLight->SetSpotDir(glm::vec4(mainCamera->GetTransform()->Forward(), 0));
-				}
+			std::vector<PhongLight_Point>& pointLights = scene->GetPointLights();
 
+			for (int i = 0; i < pointLights.size(); ++i) {
 				// Orbit point lights
-				if (sceneLights[i]->GetType() == POINT_LIGHT) {
-
-					PhongLight_Point* ptLight = (PhongLight_Point*)sceneLights[i];
-
-					static float orbitRadius = 2.f;
-					static float orbitHeight = 10.f;
-					static float scale = 1.f;
+				static float orbitRadius = 2.f;
+				static float orbitHeight = 10.f;
+				static float scale = 1.f;
 
-					glm::vec4 orbitVec = glm::vec4(cosf(glfwGetTime()) * orbitRadius * scale, orbitHeight, sinf(glfwGetTime()) * orbitRadius * scale, 0.f);
-				}
+				glm::vec4 orbitVec = glm::vec4(cosf(glfwGetTime()) * orbitRadius * scale, orbitHeight, sinf(glfwGetTime()) * orbitRadius * scale, 0.f);
 			}
 
 			// Rotate models
 			static float rotSpeed = 10.f;
 
 			for (int i = 0; i < sceneModels.size(); ++i) {
+				if (sceneModels[i]->IsStatic()) { continue; }		// Baked into a static batch
 #if ROTATE_MODELS
 				sceneModels[i]->GetTransform()->SetRotation(glm::vec3(0, glm::radians(glfwGetTime()) * rotSpeed, 0));
 #endif
@@ -355,9 +410,28 @@ namespace SPRON {
 	}
 
 
+	/**
+	*	@brief Replace the cube instances with a number of cubes laid out in a grid.
+	*	@param a_cubeNum is the number of cubes to place.
+	*	@return void.
+	*/
+	void RendererProgram::PlaceCubes(int a_cubeNum)
+	{
+		cubeInstances->ClearInstances();
+
+		int gridSize = (int)ceilf(cbrtf((float)a_cubeNum));		// Cubes per side of the grid
+
+		for (int i = 0; i < a_cubeNum; ++i) {
+			glm::vec3 gridPos = glm::vec3(i % gridSize, (i / gridSize) % gridSize, i / (gridSize * gridSize));
+
+			cubeInstances->AddInstance(glm::translate(glm::mat4(1), gridPos * 2.f));
+		}
+	}
+
 	void RendererProgram::Update(float a_dt)
 	{
-		FixedUpdate(a_dt);
+		// NOTE: The camera reads input so it moves on the main thread, the simulation that follows it reads its transform
+		mainCamera->Update(a_dt);
 
 		// Turn flash light on and off
 		InputMonitor* input = InputMonitor::GetInstance();
@@ -370,6 +444,8 @@ namespace SPRON {
 		/// Light properties
 		ImGui::Begin("Lights");
 
+		const std::vector<PhongLight*>& sceneLights = scene->GetLights();
+
 		for (int i = 0; i < sceneLights.size(); ++i) {
 
 			ImGui::PushID(i);
@@ -380,16 +456,19 @@ namespace SPRON {
 		ImGui::End();
 
 		/// Material properties
-		for (int i = 0; i < sceneModels.size(); ++i) {
-			auto meshes = sceneModels[i]->GetModelMeshes();
+		// NOTE: Materials belong to the shared assets, so editing one applies to every instance of the model
+		const std::vector<ModelAsset*>& modelAssets = ModelAsset::GetLoadedAssets();
+
+		for (int i = 0; i < modelAssets.size(); ++i) {
+			const std::vector<InstancedMesh*>& meshes = modelAssets[i]->GetModelMeshes();
 
-			ImGui::Begin(sceneModels[i]->GetDirectory().c_str());
+			ImGui::Begin(modelAssets[i]->GetDirectory().c_str());
 
 			for (int j = 0; j < meshes.size(); ++j) {
-				Material& currMaterial = meshes[j]->GetMaterial();
+				Material& currMaterial = meshes[j]->GetMesh()->GetMaterial();
 
 				ImGui::PushID(j);		// Give material block unique identifier so multiple materials with the same properties can exist
-				meshes[j]->GetMaterial().ListenIMGUI();
+				if (currMaterial.ListenIMGUI()) { meshes[j]->GetMesh()->UpdateMaterial(); }	// Only patch the material table when something changed
 				ImGui::PopID();
 			}
 
@@ -397,16 +476,82 @@ namespace SPRON {
 
 		}
 
+		/// Instancing benchmark
+#if USE_INSTANCED_CUBES
+		ImGui::Begin("Instancing Benchmark");
+
+		if (ImGui::SliderInt("Cubes", &cubeNum, 0, BENCHMARK_MAX_CUBE_NUM)) { PlaceCubes(cubeNum); }
+		if (ImGui::Button("Scale to max")) {
+			cubeNum = BENCHMARK_MAX_CUBE_NUM;
+			PlaceCubes(cubeNum);
+		}
+
+		ImGui::Text("Visible: %u / %u", cubeInstances->GetVisibleCount(), cubeInstances->GetInstanceCount());
+		ImGui::Text("Frame time: %.3f ms (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+		ImGui::End();
+#endif
+
+		/// Render queue statistics
+#if USE_RENDER_QUEUE
+		renderQueue->ListenIMGUI();
+#endif
+
+#if USE_SHADOWS
+		ShadowAtlas::ListenIMGUI();
+#endif
+
+		/// State cache and uniform buffer statistics
+		GLStateCache::ListenIMGUI();
+		UniformBlocks::ListenIMGUI();
+		MaterialTable::ListenIMGUI();
+		GeometryPool::ListenIMGUI();
+		TextureBinder::ListenIMGUI();
+		TransformHierarchy::ListenIMGUI();
+		JobSystem::ListenIMGUI();
+		FrameArena::ListenIMGUI();
+		AllocationTracker::ListenIMGUI();
+		scene->ListenIMGUI();
 #pragma endregion
 
 	}
 
+	/**
+	*	@brief Run the fixed time step simulation, on the simulation thread when pipelined.
+	*	@param a_dt is the time since the last frame.
+	*	@return void.
+	*/
+	void RendererProgram::Simulate(float a_dt)
+	{
+		FixedUpdate(a_dt);
+	}
+
+	/**
+	*	@brief Copy the lights and camera that this frame is rendered with.
+	*	@return void.
+	*/
+	void RendererProgram::Publish()
+	{
+		scene->PublishLights();
+
+		// Camera data is shared between all programs, only calculate and upload it once per frame
+		UniformBlocks::SetFrameData(mainCamera, globalAmbient, (float)glfwGetTime());
+	}
+
 	void RendererProgram::Render()
 	{
 #if ENABLE_POST_PROCESSING
 		PostProcessing::BeginListening();
 #endif
 
+		// Upload materials registered or edited since the last frame
+		MaterialTable::Upload();
+
+		// Gather this frame's published world matrices and bounds for the scene's entities in one pass
+		scene->UpdateBounds();
+
+		const std::vector<PhongLight*>& sceneLights = scene->GetPublishedLights();
+
 		ShaderWrapper* flashLight = (isFlashLightOn ? spotProgram : nullptr);	// Ignore spot light program pass if flash light isn't on
 
 		// Meshes
@@ -416,15 +561,105 @@ namespace SPRON {
 		normalDraw = debugProgram;
 #endif
 
-		for (int i = 0; i < sceneMeshes.size(); ++i) {
-			sceneMeshes[i]->Draw(mainCamera, sceneLights, globalAmbient, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw);
+#if USE_RENDER_QUEUE
+		ForwardPassSet passes;
+		passes.ambientPass = ambientProgram;
+		passes.directionalPass = directionalProgram;
+		passes.pointPass = pointProgram;
+		passes.spotPass = flashLight;
+		passes.debugPass = normalDraw;
+
+		// Collect draws for the frame, sort them by state and depth and then execute them
+		renderQueue->Begin(mainCamera);
+
+		// Simple meshes closest to the camera are rasterized on the CPU first, so everything submitted after them is tested against them
+		renderQueue->AddOccluders(scene);
+
+		if (cubeInstances) { renderQueue->AddOccluders(cubeInstances); }
+
+		for (int i = 0; i < staticBatches.size(); ++i) {
+			renderQueue->AddOccluders(staticBatches[i]);
+		}
+
+		renderQueue->RenderOccluders();
+
+		renderQueue->Submit(scene, passes);
+
+		if (cubeInstances) { renderQueue->Submit(cubeInstances, sceneLights, passes); }
+
+		// Every instance of a model is submitted together by its asset
+		for (int i = 0; i < ModelAsset::GetLoadedAssets().size(); ++i) {
+			ModelAsset::GetLoadedAssets()[i]->Submit(renderQueue, sceneLights, passes);
+		}
+
+		for (int i = 0; i < staticBatches.size(); ++i) {
+			renderQueue->Submit(staticBatches[i], sceneLights, passes);
+		}
+
+		renderQueue->Sort();
+
+		// Shadow maps are brought up to date before the light passes sample them
+#if USE_SHADOWS
+		// Only lights with a pass this frame are shadowed, the flash light keeps no tiles while it is off
+		shadowedLights.clear();
+		for (int i = 0; i < sceneLights.size(); ++i) {
+			if (sceneLights[i]->GetType() == SPOT_LIGHT && !flashLight) { continue; }
+
+			shadowedLights.push_back(sceneLights[i]);
+		}
+
+		ShadowAtlas::Begin(mainCamera, shadowedLights);
+		ShadowAtlas::AddCasters(scene);
+
+		if (cubeInstances) { ShadowAtlas::AddCasters(cubeInstances); }
+
+		for (int i = 0; i < ModelAsset::GetLoadedAssets().size(); ++i) {
+			const std::vector<InstancedMesh*>& meshes = ModelAsset::GetLoadedAssets()[i]->GetModelMeshes();
+
+			for (int j = 0; j < meshes.size(); ++j) {
+				ShadowAtlas::AddCasters(meshes[j]);
+			}
+		}
+
+		for (int i = 0; i < staticBatches.size(); ++i) {
+			ShadowAtlas::AddCasters(staticBatches[i]);
+		}
+
+		ShadowAtlas::Render();
+#endif
+
+		renderQueue->Execute();
+
+		// Next frame's GPU cull tests against the depth just rendered, only the post-processing frame buffer's depth can be sampled
+#if ENABLE_POST_PROCESSING
+		renderQueue->BuildDepthPyramid(PostProcessing::GetDepthTextureID());
+#else
+		renderQueue->BuildDepthPyramid(0);
+#endif
+#else
+		// Only the entities in the view frustum are drawn, in every pass
+		Frustum frustum;
+		frustum.Set(UniformBlocks::GetFrameData().projectionTransform * UniformBlocks::GetFrameData().viewTransform);
+
+		scene->Cull(frustum);
+
+		const std::vector<unsigned int>& visible = scene->GetVisible();
+		for (int i = 0; i < visible.size(); ++i) {
+			scene->GetMesh(visible[i])->Draw(mainCamera, sceneLights, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw);
 		}
 
+		if (cubeInstances) { cubeInstances->Draw(mainCamera, sceneLights, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw); }
+
 		// Models
-		for (int i = 0; i < sceneModels.size(); ++i) {
-			sceneModels[i]->Draw(mainCamera, sceneLights, globalAmbient, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw);
+		for (int i = 0; i < ModelAsset::GetLoadedAssets().size(); ++i) {
+			ModelAsset::GetLoadedAssets()[i]->Draw(mainCamera, sceneLights, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw);
 		}
 
+		for (int i = 0; i < staticBatches.size(); ++i) {
+			staticBatches[i]->Draw(mainCamera, sceneLights, ambientProgram, directionalProgram, pointProgram, flashLight, normalDraw);
+		}
+#endif
+
 		// Post-processing
 #if ENABLE_POST_PROCESSING
 		PostProcessing::Draw();
@@ -8,12 +8,17 @@
 
 namespace SPRON {
 	class Mesh;
-	class Model;
+	class InstancedMesh;
+	class ModelInstance;
+	class StaticBatch;
+	class PotentiallyVisibleSet;
+	class SceneStore;
 	class RenderCamera;
 	class Transform;
 	class Texture;
 	class PhongLight;
 	class ShaderWrapper;
+	class RenderQueue;
 }
 
 namespace SPRON {
@@ -26,15 +31,25 @@ namespace SPRON {
 		virtual void	Shutdown();
 
 		virtual void Update(float a_dt);
+		virtual void Simulate(float a_dt);
+		virtual void Publish();
 		virtual void Render();
 	private:
 		void FixedUpdate(float a_dt);
+		void PlaceCubes(int a_cubeNum);
 
 		/// Rendering
 		RenderCamera* mainCamera;
+		RenderQueue* renderQueue;
 
-		std::vector<Mesh*> sceneMeshes;
-		std::vector<Model*> sceneModels;
+		SceneStore* scene;		// Meshes and lights of the scene, stored as components
+		std::vector<ModelInstance*> sceneModels;
+		std::vector<StaticBatch*> staticBatches;	// Static scene models merged by material
+		PotentiallyVisibleSet* visibleSet;			// Objects of the static batches visible from each region of the scene
+		std::vector<PhongLight*> shadowedLights;	// Published lights shaded this frame, re-used between frames
+
+		InstancedMesh* cubeInstances = nullptr;		// Every cube is an instance of the same mesh
+		int cubeNum = DEFAULT_CUBE_NUM;
 
 		Texture* wallTex;
 		Texture* faceTex;
@@ -59,7 +74,6 @@ namespace SPRON {
 		ShaderWrapper* blurEffect;
 		ShaderWrapper* edgeDetectEffect;
 
-		std::vector<PhongLight*> sceneLights;
 
 		bool isFlashLightOn = true;
 	};
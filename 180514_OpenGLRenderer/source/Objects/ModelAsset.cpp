@@ -1,65 +1,167 @@
-#include "Model.h"
+#include "ModelAsset.h"
+#include "ModelInstance.h"
 #include "Mesh.h"
+#include "InstancedMesh.h"
 #include "Texture/Texture.h"
 #include "VertexFormat.h"
 #include "Transform.h"
+#include "RenderQueue.h"
 #include "Renderer_Utility_Funcs.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <iostream>
+#include <algorithm>
 #include <glm/vec4.hpp>
 #include <math.h>
 
 namespace SPRON {
+	/// Static initialisation
+	std::vector<ModelAsset*> ModelAsset::m_assets;
 
-	Model::Model(const char * a_filePath)
+	ModelAsset::ModelAsset(const char * a_filePath) : m_filePath(a_filePath), m_refCount(0)
 	{
-		// Initialize variables
-		m_modelTransform = new Transform();
-
 		LoadModel(a_filePath);
 	}
 
-	Model::~Model()
+	ModelAsset::~ModelAsset()
 	{
+		// Delete all meshes
+		for (int i = 0; i < m_meshes.size(); ++i) {
+			delete m_meshes[i];
+		}
+
 		// Delete all loaded textures
 		for (int i = 0; i < m_loadedTextures.size(); ++i) {
 			delete m_loadedTextures[i];
 		}
+	}
 
-		// Delete all meshes
-		for (int i = 0; i < m_meshes.size(); ++i) {
-			delete m_meshes[i];
+	/**
+	*	@brief Get the asset for a model file, importing it only if it has not already been loaded.
+	*	@param a_filePath is the path to the model file.
+	*	@return shared asset, to be released with Release.
+	*/
+	ModelAsset * ModelAsset::Acquire(const char * a_filePath)
+	{
+		ModelAsset* asset = nullptr;
+
+		for (unsigned int i = 0; i < m_assets.size(); ++i) {
+			if (m_assets[i]->m_filePath == a_filePath) { asset = m_assets[i]; break; }
+		}
+
+		if (!asset) {
+			asset = new ModelAsset(a_filePath);
+			m_assets.push_back(asset);
 		}
+
+		asset->m_refCount++;
+
+		return asset;
 	}
 
-	void Model::Draw(RenderCamera * a_camera, std::vector<PhongLight*> a_lights, const glm::vec4 & a_globalAmbient, ShaderWrapper * a_ambientPass, 
+	/**
+	*	@brief Stop using an asset, unloading it once nothing uses it.
+	*	@param a_asset is the asset returned by Acquire.
+	*	@return void.
+	*/
+	void ModelAsset::Release(ModelAsset * a_asset)
+	{
+		assert(a_asset->m_refCount > 0 && "ERROR::MODEL_ASSET::RELEASED_TOO_MANY_TIMES");
+
+		if (--a_asset->m_refCount == 0) {
+			m_assets.erase(std::find(m_assets.begin(), m_assets.end(), a_asset));
+			delete a_asset;
+		}
+	}
+
+	/**
+	*	@brief Draw every instance of the model, one draw per mesh per pass.
+	*	@return void.
+	*/
+	void ModelAsset::Draw(RenderCamera * a_camera, const std::vector<PhongLight*>& a_lights, ShaderWrapper * a_ambientPass, 
 		ShaderWrapper * a_directionalPass, ShaderWrapper * a_pointPass, ShaderWrapper * a_spotPass, ShaderWrapper* a_debugPass)
 	{
+		UpdateInstances();
+
 		// Draw all meshes
 		for (int i = 0; i < m_meshes.size(); ++i) {
-			m_meshes[i]->Draw(a_camera, a_lights, a_globalAmbient, a_ambientPass, a_directionalPass, a_pointPass, a_spotPass, a_debugPass);
+			m_meshes[i]->Draw(a_camera, a_lights, a_ambientPass, a_directionalPass, a_pointPass, a_spotPass, a_debugPass);
 		}
 	}
 
-	SPRON::Transform * Model::GetTransform()
+	/**
+	*	@brief Add the draws for every instance of the model to a render queue, one draw per mesh per pass.
+	*	@param a_queue is the render queue to submit to.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void ModelAsset::Submit(RenderQueue * a_queue, const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes)
 	{
-		return m_modelTransform;
+		UpdateInstances();
+
+		for (int i = 0; i < m_meshes.size(); ++i) {
+			a_queue->Submit(m_meshes[i], a_lights, a_passes);
+		}
 	}
 
-	std::vector<Mesh*> Model::GetModelMeshes()
+	const std::string & ModelAsset::GetDirectory() const
 	{
-		return m_meshes;
+		return m_modelDirectory;
 	}
 
-	std::string Model::GetDirectory()
+	/**
+	*	@brief Give a new instance a slot in every mesh.
+	*	@param a_instance is the instance being placed.
+	*	@return slot of the instance.
+	*/
+	unsigned int ModelAsset::AddInstance(ModelInstance * a_instance)
 	{
-		return m_modelDirectory;
+		for (unsigned int i = 0; i < m_meshes.size(); ++i) {
+			m_meshes[i]->AddInstance(a_instance->GetTransform()->GetGlobalMatrix());
+		}
+
+		m_instances.push_back(a_instance);
+
+		return (unsigned int)m_instances.size() - 1;
+	}
+
+	/**
+	*	@brief Free an instance's slot, the last instance is moved into it to keep every mesh's instances in the same order.
+	*	@param a_slot is the slot of the instance being removed.
+	*	@return void.
+	*/
+	void ModelAsset::RemoveInstance(unsigned int a_slot)
+	{
+		for (unsigned int i = 0; i < m_meshes.size(); ++i) {
+			m_meshes[i]->RemoveInstance(a_slot);
+		}
+
+		m_instances[a_slot] = m_instances.back();
+		m_instances[a_slot]->m_slot = a_slot;
+
+		m_instances.pop_back();
+	}
+
+	/**
+	*	@brief Copy every instance's published global matrix into the meshes before they are culled and drawn.
+	*	O(I * M) complexity where I = number of instances and M = number of meshes
+	*	@return void.
+	*/
+	void ModelAsset::UpdateInstances()
+	{
+		for (unsigned int i = 0; i < m_instances.size(); ++i) {
+			glm::mat4 globalMatrix = m_instances[i]->GetTransform()->GetPublishedMatrix();		// Calculated once and shared between the meshes
+
+			for (unsigned int j = 0; j < m_meshes.size(); ++j) {
+				m_meshes[j]->SetInstanceTransform(i, globalMatrix);
+			}
+		}
 	}
 
-	void Model::LoadModel(std::string a_filePath)
+	void ModelAsset::LoadModel(std::string a_filePath)
 	{
 		Assimp::Importer modelImporter;
 
@@ -91,7 +193,7 @@ namespace SPRON {
 	*	@param a_modelScene is the overall data of the model.
 	*	@return void.
 	*/
-	void Model::RecurReadNode(aiNode * a_node, const aiScene * a_modelScene)
+	void ModelAsset::RecurReadNode(aiNode * a_node, const aiScene * a_modelScene)
 	{
 		// NOTE: Assimp stores all the actual data in the model scene and then references to that data inside of the nodes for efficiency
 
@@ -111,9 +213,9 @@ namespace SPRON {
 	*	@brief Read in vertex, indice and material data from mesh in order to create and return a mesh object.
 	*	@brief a_mesh is the mesh to read from.
 	*	@brief a_modelScene is the overall data holder for the model.
-	*	@return constructed Mesh object based on the read in data.
+	*	@return constructed instanced mesh based on the read in data, without any instances.
 	*/
-	SPRON::Mesh* Model::ReadMesh(aiMesh * a_mesh, const aiScene * a_modelScene)
+	SPRON::InstancedMesh* ModelAsset::ReadMesh(aiMesh * a_mesh, const aiScene * a_modelScene)
 	{
 		/// Mesh paramaters to be read into
 		std::vector<Vertex>				readVertices;
@@ -241,8 +343,8 @@ namespace SPRON {
 		}
 #pragma endregion
 
-		// Construct and return mesh object with transform parented to model (TODO: Allow for mesh to mesh parent child relationships instead of just assigning to model)
-		return new Mesh(readVertices, new VertexFormat(readIndices), new Transform(m_modelTransform), materialInfo);
+		// Construct and return mesh object, instances are drawn with their model instance's transform (TODO: Allow for mesh to mesh parent child relationships)
+		return new InstancedMesh(readVertices, new VertexFormat(readIndices), materialInfo);
 	}
 
 	/**
@@ -253,7 +355,7 @@ namespace SPRON {
 	*	@param a_typeName is the type of texture to set the returned object to.
 	*	@return vector of processed textures in the form of created TextureWrappers.
 	*/
-	std::vector<SPRON::Texture*> Model::ReadMaterialTextures(aiMaterial * a_meshMaterial, int a_textureType, std::string a_typeName)
+	std::vector<SPRON::Texture*> ModelAsset::ReadMaterialTextures(aiMaterial * a_meshMaterial, int a_textureType, std::string a_typeName)
 	{
 		std::vector<Texture*> processedTextures;
 
@@ -267,12 +369,12 @@ namespace SPRON {
 			// Check if texture has already been loaded
 			bool skipLoad = false;
 
-			for (unsigned int j = 0; i < m_loadedTextures.size(); ++i) {
+			for (unsigned int j = 0; j < m_loadedTextures.size(); ++j) {
 
-				if (fileName == m_loadedTextures[i]->GetFileName()) {	// Texture has already been loaded
+				if (fileName == m_loadedTextures[j]->GetFileName()) {	// Texture has already been loaded
 
 					// Add already loaded texture, mark texture loading to be skipped, and break out of loop
-					processedTextures.push_back(m_loadedTextures[i]); skipLoad = true; break;
+					processedTextures.push_back(m_loadedTextures[j]); skipLoad = true; break;
 				}
 			}
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <glm/vec4.hpp>
+
+namespace SPRON {
+	class InstancedMesh;
+	class ModelInstance;
+	class Texture;
+	class RenderCamera;
+	class PhongLight;
+	class ShaderWrapper;
+	class RenderQueue;
+	struct ForwardPassSet;
+}
+
+struct aiNode;
+struct aiMesh;
+struct aiScene;
+struct aiMaterial;
+
+namespace SPRON {
+	/**
+	*	@brief Meshes, materials and textures imported from a model file, loaded once and shared by every placement of the model.
+	*	Each mesh is an instanced mesh with one instance per ModelInstance, so all placements of a model are drawn together with one draw per mesh per pass.
+	*	NOTE: Assets are reference counted by their instances and unloaded when the last instance is deleted.
+	*/
+	class ModelAsset {
+	public:
+		static ModelAsset* Acquire(const char* a_filePath);
+		static void Release(ModelAsset* a_asset);
+
+		static const std::vector<ModelAsset*>& GetLoadedAssets() { return m_assets; }
+
+		void Draw(RenderCamera* a_camera,
+			const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
+			ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass);
+		void Submit(RenderQueue* a_queue, const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes);
+
+		const std::vector<InstancedMesh*>& GetModelMeshes() const { return m_meshes; }
+		const std::string& GetFilePath() const { return m_filePath; }
+		const std::string& GetDirectory() const;
+		unsigned int GetInstanceCount() const { return (unsigned int)m_instances.size(); }
+	protected:
+	private:
+		friend class ModelInstance;
+
+		static std::vector<ModelAsset*> m_assets;		// Every loaded asset, searched when a model is placed
+
+		ModelAsset(const char* a_filePath);
+		~ModelAsset();
+
+		unsigned int AddInstance(ModelInstance* a_instance);
+		void RemoveInstance(unsigned int a_slot);
+		void UpdateInstances();
+
+		std::string m_filePath;		// Key the asset is shared by
+
+		std::vector<Texture*> m_loadedTextures;		// Hold onto loaded textures to avoid creating new ones for the same texture files
+		std::vector<InstancedMesh*> m_meshes;
+
+		std::vector<ModelInstance*> m_instances;	// Instance in each slot, the slot is also the instance's index in every mesh
+		unsigned int m_refCount;
+
+		std::string m_modelDirectory;	// Hold onto directory model was loaded in for loading additional files e.g. textures
+
+		/// Model loading functions
+		void LoadModel(std::string a_filePath);
+		void RecurReadNode(aiNode* a_node, const aiScene* a_modelScene);
+		InstancedMesh* ReadMesh(aiMesh* a_mesh, const aiScene* a_modelScene);
+		std::vector<Texture*> ReadMaterialTextures(aiMaterial* a_meshMaterial, int a_textureType, std::string a_typeName);
+	};
+}
\ No newline at end of file
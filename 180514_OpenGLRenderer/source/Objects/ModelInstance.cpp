@@ -0,0 +1,47 @@
+#include "ModelInstance.h"
+#include "ModelAsset.h"
+#include "InstancedMesh.h"
+#include "Transform.h"
+
+#include <assert.h>
+
+namespace SPRON {
+
+	ModelInstance::ModelInstance(const char * a_filePath, bool a_isStatic) : m_slot(~0u), m_isStatic(a_isStatic)
+	{
+		m_transform = new Transform();
+
+		m_asset = ModelAsset::Acquire(a_filePath);		// Only imported the first time the file is placed
+
+		// Static instances are drawn by their static batch instead
+		if (!m_isStatic) { m_slot = m_asset->AddInstance(this); }
+	}
+
+	ModelInstance::~ModelInstance()
+	{
+		if (!m_isStatic) { m_asset->RemoveInstance(m_slot); }
+		ModelAsset::Release(m_asset);
+
+		delete m_transform;
+	}
+
+	/**
+	*	@brief Draw one of the model's meshes with different material parameters for this instance only.
+	*	@param a_meshIndex is the index of the mesh in the asset's meshes.
+	*	@param a_material is the material to use, its texture maps must be in the same texture arrays as the mesh's.
+	*	@return void.
+	*/
+	void ModelInstance::SetMaterialOverride(unsigned int a_meshIndex, const Material & a_material)
+	{
+		assert(!m_isStatic && "ERROR::MODEL_INSTANCE::STATIC_INSTANCES_CAN_NOT_OVERRIDE_MATERIALS");
+
+		m_asset->GetModelMeshes()[a_meshIndex]->SetInstanceMaterial(m_slot, a_material);
+	}
+
+	void ModelInstance::ClearMaterialOverride(unsigned int a_meshIndex)
+	{
+		if (m_isStatic) { return; }
+
+		m_asset->GetModelMeshes()[a_meshIndex]->ResetInstanceMaterial(m_slot);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace SPRON {
+	class ModelAsset;
+	class Transform;
+	struct Material;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Placement of a model in the scene, only holds a transform and material overrides while the meshes are shared through its asset.
+	*	Static instances are never moved after the scene is built, they are not drawn through the asset but merged into static batches by StaticBatch::Build.
+	*	NOTE: Placing the same model file again re-uses the loaded asset instead of importing it again.
+	*/
+	class ModelInstance {
+	public:
+		ModelInstance(const char* a_filePath, bool a_isStatic = false);
+		~ModelInstance();
+
+		Transform* GetTransform() { return m_transform; }
+		ModelAsset* GetAsset() { return m_asset; }
+		bool IsStatic() const { return m_isStatic; }
+
+		void SetMaterialOverride(unsigned int a_meshIndex, const Material& a_material);
+		void ClearMaterialOverride(unsigned int a_meshIndex);
+	protected:
+	private:
+		friend class ModelAsset;
+
+		ModelAsset*		m_asset;
+		Transform*		m_transform;		// Global transform for the model, applied to all of the asset's meshes
+		unsigned int	m_slot;				// Index of this instance in each of the asset's meshes, changes when other instances are removed
+		bool			m_isStatic;			// Transform is baked into a static batch, the instance has no slot
+	};
+}
\ No newline at end of file
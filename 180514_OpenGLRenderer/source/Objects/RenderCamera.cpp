@@ -94,5 +94,8 @@ namespace SPRON {
 	void RenderCamera::SetProjection(float a_fov, float a_aspectRatio, float a_near, float a_far)
 	{
 		m_projectionMatrix = glm::perspective(a_fov, a_aspectRatio, a_near, a_far);
+
+		m_nearPlane = a_near;
+		m_farPlane = a_far;
 	}
 }
\ No newline at end of file
@@ -19,6 +19,8 @@ namespace SPRON {
 		glm::mat4 CalculateProjectionView();
 		glm::mat4 CalculateView();
 		glm::mat4 GetProjection();
+		float GetNearPlane() { return m_nearPlane; }
+		float GetFarPlane() { return m_farPlane; }
 
 		Transform* GetTransform();
 
@@ -30,6 +32,8 @@ namespace SPRON {
 		float m_currentYaw;
 
 		glm::mat4 m_projectionMatrix;
+		float m_nearPlane;
+		float m_farPlane;
 
 		Transform* m_cameraTransform;
 	};
@@ -0,0 +1,362 @@
+#include "SceneStore.h"
+#include "Mesh.h"
+#include "Transform.h"
+#include "Renderer_Utility_Funcs.h"
+#include "Renderer_Utility_Literals.h"
+#include "JobSystem.h"
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#if BENCHMARK_SCENE_LAYOUT
+#include "AllocationTracker.h"
+#endif
+
+#include <imgui.h>
+#include <chrono>
+#include <algorithm>
+#if BENCHMARK_SCENE_LAYOUT
+#include <iostream>
+#endif
+
+namespace SPRON {
+
+	/**
+	*	@brief Move a bounding sphere into world space, scaling the radius by the largest axis scale so the sphere still encloses the entity.
+	*	@param a_sphere is the model space sphere, xyz = center and w = radius.
+	*	@param a_world is the world matrix of the entity.
+	*	@return world space sphere.
+	*/
+	static glm::vec4 TransformSphere(const glm::vec4& a_sphere, const glm::mat4& a_world)
+	{
+		float scale = std::max(glm::length(glm::vec3(a_world[0])), std::max(glm::length(glm::vec3(a_world[1])), glm::length(glm::vec3(a_world[2]))));
+
+		return glm::vec4(glm::vec3(a_world * glm::vec4(glm::vec3(a_sphere), 1.f)), a_sphere.w * scale);
+	}
+
+	SceneStore::SceneStore() : m_tree(AABB_TREE_MARGIN), m_updateTime(0.f), m_cullTime(0.f), m_movedCount(0), m_reinsertedCount(0), m_testedCount(0), m_occludedCount(0)
+	{
+	}
+
+	SceneStore::~SceneStore()
+	{
+		for (unsigned int i = 0; i < m_meshes.size(); ++i) {
+			delete m_meshes[i];
+		}
+	}
+
+	/**
+	*	@brief Add a mesh as a new entity, the store takes ownership of it.
+	*	@param a_mesh is the mesh to add, its transform is tracked as the entity's transform.
+	*	@return index of the entity.
+	*/
+	unsigned int SceneStore::AddMesh(Mesh * a_mesh)
+	{
+		assert(a_mesh && "ERROR::SCENE_STORE::NULL_MESH");
+
+		unsigned int entity = (unsigned int)m_meshes.size();
+		const glm::mat4& world = a_mesh->GetTransform()->GetGlobalMatrix();
+
+		// Bounds were calculated when the mesh was created, only moved into world space here
+		m_transforms.push_back(a_mesh->GetTransform());
+		m_localBounds.push_back(a_mesh->GetBoundingSphere());
+		m_localBoxes.push_back(a_mesh->GetLocalBounds());
+		m_worldMatrices.push_back(world);
+		m_worldBounds.push_back(TransformSphere(a_mesh->GetBoundingSphere(), world));
+		m_worldBoxes.push_back(a_mesh->GetLocalBounds().Transform(world));
+		m_proxies.push_back(m_tree.CreateProxy(m_worldBoxes.back(), entity));
+		m_isMoved.push_back(false);
+		m_meshes.push_back(a_mesh);
+
+		return entity;
+	}
+
+	/**
+	*	@brief Delete an entity's mesh and move the last entity into its index.
+	*	@param a_entity is the index of the entity.
+	*	@return void.
+	*/
+	void SceneStore::RemoveMesh(unsigned int a_entity)
+	{
+		delete m_meshes[a_entity];
+		m_tree.DestroyProxy(m_proxies[a_entity]);
+
+		m_transforms[a_entity] = m_transforms.back();
+		m_localBounds[a_entity] = m_localBounds.back();
+		m_localBoxes[a_entity] = m_localBoxes.back();
+		m_worldMatrices[a_entity] = m_worldMatrices.back();
+		m_worldBounds[a_entity] = m_worldBounds.back();
+		m_worldBoxes[a_entity] = m_worldBoxes.back();
+		m_proxies[a_entity] = m_proxies.back();
+		m_isMoved[a_entity] = m_isMoved.back();
+		m_meshes[a_entity] = m_meshes.back();
+
+		m_transforms.pop_back();
+		m_localBounds.pop_back();
+		m_localBoxes.pop_back();
+		m_worldMatrices.pop_back();
+		m_worldBounds.pop_back();
+		m_worldBoxes.pop_back();
+		m_proxies.pop_back();
+		m_isMoved.pop_back();
+		m_meshes.pop_back();
+
+		if (a_entity < m_proxies.size()) { m_tree.SetUserData(m_proxies[a_entity], a_entity); }		// Queries return the moved entity's new index
+
+		m_visible.clear();		// Indices may have moved
+	}
+
+	void SceneStore::AddLight(const PhongLight_Dir & a_light)
+	{
+		m_dirLights.push_back(a_light);
+		RebuildLightList();
+	}
+
+	void SceneStore::AddLight(const PhongLight_Point & a_light)
+	{
+		m_pointLights.push_back(a_light);
+		RebuildLightList();
+	}
+
+	void SceneStore::AddLight(const PhongLight_Spot & a_light)
+	{
+		m_spotLights.push_back(a_light);
+		RebuildLightList();
+	}
+
+	/**
+	*	@brief Gather every entity's published world matrix from the transform hierarchy, moving the bounds of entities whose matrix changed into world space and refitting the tree.
+	*	O(N) complexity where N = number of entities, split into jobs, plus O(M log N) where M = number of entities that left their enlarged box
+	*	NOTE: Call once per frame after transforms have been changed and before culling.
+	*	@return void.
+	*/
+	void SceneStore::UpdateBounds()
+	{
+		auto updateStart = std::chrono::high_resolution_clock::now();
+
+		JobSystem::ParallelFor((unsigned int)m_transforms.size(), JOB_BATCH_SIZE, [this](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				const glm::mat4& world = m_transforms[i]->GetPublishedMatrix();
+
+				m_isMoved[i] = (world != m_worldMatrices[i]);
+				if (!m_isMoved[i]) { continue; }		// Static entities keep last frame's bounds
+
+				m_worldMatrices[i] = world;
+				m_worldBounds[i] = TransformSphere(m_localBounds[i], world);
+				m_worldBoxes[i] = m_localBoxes[i].Transform(world);
+			}
+		});
+
+		// Refit on this thread as the tree is not thread safe, leaves still inside their enlarged box are left untouched
+		m_movedCount = 0;
+		m_reinsertedCount = 0;
+
+		for (unsigned int i = 0; i < m_isMoved.size(); ++i) {
+			if (!m_isMoved[i]) { continue; }
+
+			m_movedCount++;
+			if (m_tree.MoveProxy(m_proxies[i], m_worldBoxes[i])) { m_reinsertedCount++; }
+		}
+
+		m_updateTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
+	}
+
+	/**
+	*	@brief Walk the tree of world boxes against a frustum and store the indices of the visible entities.
+	*	O(V log N) complexity where V = number of visible entities and N = number of entities, groups entirely inside or outside are not descended into
+	*	NOTE: Visible entities are in tree order, not index order.
+	*	@param a_frustum is the camera frustum.
+	*	@return number of visible entities.
+	*/
+	unsigned int SceneStore::Cull(const Frustum & a_frustum)
+	{
+		auto cullStart = std::chrono::high_resolution_clock::now();
+
+		m_visible.clear();
+		m_testedCount = m_tree.Query(a_frustum, m_visible);
+		m_occludedCount = 0;
+
+		m_cullTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
+
+		return (unsigned int)m_visible.size();
+	}
+
+	/**
+	*	@brief Remove the entities hidden behind occluders from the visible entities of the last Cull.
+	*	O(V) complexity where V = number of visible entities, split into jobs
+	*	@param a_occlusion is the occluders rasterized for the same camera as the last Cull.
+	*	@return number of visible entities left.
+	*/
+	unsigned int SceneStore::CullOccluded(const OcclusionCuller & a_occlusion)
+	{
+		auto cullStart = std::chrono::high_resolution_clock::now();
+
+		m_isUnoccluded.resize(m_visible.size());
+
+		JobSystem::ParallelFor((unsigned int)m_visible.size(), JOB_BATCH_SIZE, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				m_isUnoccluded[i] = a_occlusion.IsVisible(m_worldBoxes[m_visible[i]]);
+			}
+		});
+
+		// Compact in place, keeping the order of the visible entities
+		unsigned int visibleCount = 0;
+		for (unsigned int i = 0; i < m_visible.size(); ++i) {
+			if (m_isUnoccluded[i]) { m_visible[visibleCount++] = m_visible[i]; }
+		}
+
+		m_occludedCount = (unsigned int)m_visible.size() - visibleCount;
+		m_visible.resize(visibleCount);
+
+		m_cullTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
+
+		return visibleCount;
+	}
+
+	/**
+	*	@brief Copy the lights into the published arrays that rendering reads from, so the simulation can move lights while the previous state is drawn.
+	*	NOTE: Must be called while nothing else is changing or reading the lights, between the simulation finishing and rendering starting.
+	*	@return void.
+	*/
+	void SceneStore::PublishLights()
+	{
+		// NOTE: Assigning keeps the capacity, so steady state frames do not re-allocate
+		m_publishedDirLights = m_dirLights;
+		m_publishedPointLights = m_pointLights;
+		m_publishedSpotLights = m_spotLights;
+
+		m_publishedLights.clear();
+
+		for (unsigned int i = 0; i < m_publishedDirLights.size(); ++i) { m_publishedLights.push_back(&m_publishedDirLights[i]); }
+		for (unsigned int i = 0; i < m_publishedPointLights.size(); ++i) { m_publishedLights.push_back(&m_publishedPointLights[i]); }
+		for (unsigned int i = 0; i < m_publishedSpotLights.size(); ++i) { m_publishedLights.push_back(&m_publishedSpotLights[i]); }
+	}
+
+	/**
+	*	@brief Point the combined light list at the typed light arrays again, after adding a light may have moved them.
+	*	@return void.
+	*/
+	void SceneStore::RebuildLightList()
+	{
+		m_lights.clear();
+
+		for (unsigned int i = 0; i < m_dirLights.size(); ++i) { m_lights.push_back(&m_dirLights[i]); }
+		for (unsigned int i = 0; i < m_pointLights.size(); ++i) { m_lights.push_back(&m_pointLights[i]); }
+		for (unsigned int i = 0; i < m_spotLights.size(); ++i) { m_lights.push_back(&m_spotLights[i]); }
+	}
+
+	/**
+	*	@brief Display the number of entities and lights, how many were culled and how long the last update and cull stages took.
+	*	@return void.
+	*/
+	void SceneStore::ListenIMGUI()
+	{
+		ImGui::Begin("Scene Store");
+
+		unsigned int visibleCount = (unsigned int)m_visible.size();
+
+		ImGui::Text("Entities: %u (%u visible, %u culled, %u occluded)", GetEntityCount(), visibleCount, GetEntityCount() - visibleCount - m_occludedCount, m_occludedCount);
+		ImGui::Text("Lights: %u directional, %u point, %u spot", (unsigned int)m_dirLights.size(), (unsigned int)m_pointLights.size(), (unsigned int)m_spotLights.size());
+		ImGui::Text("Tree: %u nodes, height %d, %u tested", m_tree.GetNodeCount(), m_tree.GetHeight(), m_testedCount);
+		ImGui::Text("Moved: %u (%u re-inserted)", m_movedCount, m_reinsertedCount);
+		ImGui::Text("Update bounds: %.3f ms", m_updateTime);
+		ImGui::Text("Cull: %.3f ms", m_cullTime);
+
+#if BENCHMARK_SCENE_LAYOUT
+		ImGui::Separator();
+		if (ImGui::Button("Benchmark layouts")) { BenchmarkLayouts(BENCHMARK_SCENE_LAYOUT_ITERATIONS); }
+
+		ImGui::Text("Moved check: %.3f ms arrays, %.3f ms records", m_layoutTimes[0][0], m_layoutTimes[1][0]);
+		ImGui::Text("Bounds update: %.3f ms arrays, %.3f ms records", m_layoutTimes[0][1], m_layoutTimes[1][1]);
+#endif
+
+		ImGui::End();
+	}
+
+#if BENCHMARK_SCENE_LAYOUT
+	// Every component of an entity in one struct, the array of structures layout the component arrays replaced
+	struct EntityRecord {
+		Transform*		transform;
+		glm::vec4		localBounds;
+		AABB			localBox;
+		glm::mat4		worldMatrix;
+		glm::vec4		worldBounds;
+		AABB			worldBox;
+		unsigned int	proxy;
+		unsigned char	isMoved;
+		Mesh*			mesh;
+	};
+
+	/**
+	*	@brief Time the work of UpdateBounds on the component arrays against the same work on a temporary array of entity records.
+	*	Runs on the calling thread so only the memory layout differs, and writes to scratch copies so the store is left unchanged.
+	*	NOTE: Benchmark only, allocates the records and scratch arrays for every run.
+	*	@param a_iterations is the number of passes to average over.
+	*	@return void.
+	*/
+	void SceneStore::BenchmarkLayouts(unsigned int a_iterations)
+	{
+		AllocationTracker::AllowAllocations allowAllocations;
+
+		unsigned int entityCount = GetEntityCount();
+
+		std::vector<EntityRecord> records(entityCount);
+		for (unsigned int i = 0; i < entityCount; ++i) {
+			EntityRecord& record = records[i];
+			record.transform = m_transforms[i];
+			record.localBounds = m_localBounds[i];
+			record.localBox = m_localBoxes[i];
+			record.worldMatrix = m_worldMatrices[i];
+			record.worldBounds = m_worldBounds[i];
+			record.worldBox = m_worldBoxes[i];
+			record.proxy = m_proxies[i];
+			record.isMoved = false;
+			record.mesh = m_meshes[i];
+		}
+
+		std::vector<unsigned char> isMoved(entityCount);
+		std::vector<glm::vec4> worldBounds(entityCount);
+		std::vector<AABB> worldBoxes(entityCount);
+
+		// Average milliseconds per pass of a loop over every entity
+		auto timePasses = [a_iterations](float& a_time, auto a_pass) {
+			auto passStart = std::chrono::high_resolution_clock::now();
+
+			for (unsigned int n = 0; n < a_iterations; ++n) { a_pass(); }
+
+			a_time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - passStart).count() / a_iterations;
+		};
+
+		/// Checking for moved entities
+		timePasses(m_layoutTimes[0][0], [&]() {
+			for (unsigned int i = 0; i < entityCount; ++i) { isMoved[i] = (m_transforms[i]->GetPublishedMatrix() != m_worldMatrices[i]); }
+		});
+		timePasses(m_layoutTimes[1][0], [&]() {
+			for (unsigned int i = 0; i < entityCount; ++i) { records[i].isMoved = (records[i].transform->GetPublishedMatrix() != records[i].worldMatrix); }
+		});
+
+		/// Re-calculating every entity's bounds
+		timePasses(m_layoutTimes[0][1], [&]() {
+			for (unsigned int i = 0; i < entityCount; ++i) {
+				const glm::mat4& world = m_transforms[i]->GetPublishedMatrix();
+
+				worldBounds[i] = TransformSphere(m_localBounds[i], world);
+				worldBoxes[i] = m_localBoxes[i].Transform(world);
+			}
+		});
+		timePasses(m_layoutTimes[1][1], [&]() {
+			for (unsigned int i = 0; i < entityCount; ++i) {
+				EntityRecord& record = records[i];
+				const glm::mat4& world = record.transform->GetPublishedMatrix();
+
+				record.worldBounds = TransformSphere(record.localBounds, world);
+				record.worldBox = record.localBox.Transform(world);
+			}
+		});
+
+		unsigned int movedCount = 0;		// Read afterwards so the checks are not optimised away
+		for (unsigned int i = 0; i < entityCount; ++i) { movedCount += isMoved[i] + records[i].isMoved; }
+
+		std::cout << "Scene layout benchmark (" << entityCount << " entities, " << movedCount << " moved): moved check " << m_layoutTimes[0][0] << " ms arrays, " <<
+			m_layoutTimes[1][0] << " ms records, bounds update " << m_layoutTimes[0][1] << " ms arrays, " << m_layoutTimes[1][1] << " ms records" << std::endl;
+	}
+#endif
+}
\ No newline at end of file
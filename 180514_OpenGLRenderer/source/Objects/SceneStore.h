@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Light\PhongLight_Dir.h"
+#include "Light\PhongLight_Point.h"
+#include "Light\PhongLight_Spot.h"
+#include "AABBTree.h"
+#include "Renderer_Utility_Literals.h"
+
+#include <vector>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class Mesh;
+	class Transform;
+	class PhongLight;
+	class Frustum;
+	class OcclusionCuller;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Scene objects stored as components in contiguous arrays, one array per property, so each stage of the frame streams through only the data it reads.
+	*	Updating reads transforms and writes world matrices and bounds, culling walks a tree of world bounds, the render queue reads world matrices and meshes of visible entities only.
+	*	Lights are stored by value in one array per light type, so updating them needs no type checks or downcasts.
+	*	Rendering reads published copies of the lights and world matrices, so the simulation can run ahead while the previous state is drawn.
+	*	NOTE: Entities are indices into the arrays, removing an entity moves the last entity into its index.
+	*/
+	class SceneStore {
+	public:
+		SceneStore();
+		~SceneStore();
+
+		/// Entities
+		unsigned int AddMesh(Mesh* a_mesh);
+		void RemoveMesh(unsigned int a_entity);
+
+		Mesh* GetMesh(unsigned int a_entity) { return m_meshes[a_entity]; }
+		unsigned int GetEntityCount() const { return (unsigned int)m_meshes.size(); }
+
+		/// Lights
+		void AddLight(const PhongLight_Dir& a_light);
+		void AddLight(const PhongLight_Point& a_light);
+		void AddLight(const PhongLight_Spot& a_light);
+
+		std::vector<PhongLight_Dir>& GetDirLights() { return m_dirLights; }
+		std::vector<PhongLight_Point>& GetPointLights() { return m_pointLights; }
+		std::vector<PhongLight_Spot>& GetSpotLights() { return m_spotLights; }
+		const std::vector<PhongLight*>& GetLights() const { return m_lights; }
+
+		void PublishLights();
+		const std::vector<PhongLight*>& GetPublishedLights() const { return m_publishedLights; }
+
+		/// Frame stages
+		void UpdateBounds();
+		unsigned int Cull(const Frustum& a_frustum);
+		unsigned int CullOccluded(const OcclusionCuller& a_occlusion);
+
+		const std::vector<unsigned int>& GetVisible() const { return m_visible; }
+		const glm::mat4& GetWorldMatrix(unsigned int a_entity) const { return m_worldMatrices[a_entity]; }
+		const glm::vec4& GetWorldBounds(unsigned int a_entity) const { return m_worldBounds[a_entity]; }
+		const AABB& GetWorldBox(unsigned int a_entity) const { return m_worldBoxes[a_entity]; }
+
+		void ListenIMGUI();
+	protected:
+	private:
+		void RebuildLightList();
+
+#if BENCHMARK_SCENE_LAYOUT
+		void BenchmarkLayouts(unsigned int a_iterations);
+
+		// Milliseconds per pass over every entity, component arrays then entity records, checking for moved entities then re-calculating every bound
+		float m_layoutTimes[2][2] = {};
+#endif
+
+		/// Entity components, indexed by entity
+		std::vector<Transform*>		m_transforms;		// Owned by the meshes
+		std::vector<glm::vec4>		m_localBounds;		// Bounding sphere in model space, xyz = center and w = radius
+		std::vector<AABB>			m_localBoxes;		// Bounding box in model space
+		std::vector<glm::mat4>		m_worldMatrices;	// Gathered once per frame from the transform hierarchy
+		std::vector<glm::vec4>		m_worldBounds;		// Bounding sphere in world space, xyz = center and w = radius
+		std::vector<AABB>			m_worldBoxes;		// Bounding box in world space, kept in the tree
+		std::vector<unsigned int>	m_proxies;			// Leaf of the entity in the tree
+		std::vector<unsigned char>	m_isMoved;			// Whether the world matrix changed in the last UpdateBounds, written by the update jobs
+		std::vector<Mesh*>			m_meshes;			// Geometry and material, only read for visible entities
+
+		AABBTree					m_tree;				// World boxes of every entity, so culling skips whole groups of entities
+		std::vector<unsigned int>	m_visible;			// Entities that passed the last cull
+		std::vector<unsigned char>	m_isUnoccluded;		// Occlusion result per visible entity, written by the occlusion jobs
+
+		/// Light components
+		std::vector<PhongLight_Dir>		m_dirLights;
+		std::vector<PhongLight_Point>	m_pointLights;
+		std::vector<PhongLight_Spot>	m_spotLights;
+		std::vector<PhongLight*>		m_lights;		// Every light, for passes that handle all types, rebuilt when a light is added
+
+		// Copies of the lights as of the last publish, read by rendering while the simulation changes the lights
+		std::vector<PhongLight_Dir>		m_publishedDirLights;
+		std::vector<PhongLight_Point>	m_publishedPointLights;
+		std::vector<PhongLight_Spot>	m_publishedSpotLights;
+		std::vector<PhongLight*>		m_publishedLights;
+
+		// Statistics
+		float m_updateTime;		// Milliseconds spent in the last UpdateBounds
+		float m_cullTime;		// Milliseconds spent in the last Cull
+		unsigned int m_movedCount;		// Entities whose bounds changed in the last UpdateBounds
+		unsigned int m_reinsertedCount;	// Moved entities that left their enlarged box and were re-inserted into the tree
+		unsigned int m_testedCount;		// Tree nodes tested against the frustum in the last Cull
+		unsigned int m_occludedCount;	// Entities in the frustum hidden behind occluders in the last CullOccluded
+	};
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
+
+namespace SPRON {
+	// Axis aligned bounding box, stored as its corners
+	struct AABB {
+	public:
+		AABB(const glm::vec3& a_min = glm::vec3(0.f), const glm::vec3& a_max = glm::vec3(0.f)) : min(a_min), max(a_max) {}
+
+		glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+		glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+		// Half the surface area, only used to compare the cost of boxes
+		float GetPerimeter() const { glm::vec3 size = max - min; return size.x * size.y + size.y * size.z + size.z * size.x; }
+
+		bool Contains(const AABB& a_other) const {
+			return min.x <= a_other.min.x && min.y <= a_other.min.y && min.z <= a_other.min.z &&
+				max.x >= a_other.max.x && max.y >= a_other.max.y && max.z >= a_other.max.z;
+		}
+
+		static AABB Merge(const AABB& a_first, const AABB& a_second) {
+			return AABB(glm::min(a_first.min, a_second.min), glm::max(a_first.max, a_second.max));
+		}
+
+		// Box that encloses this box after it is transformed, without transforming all 8 corners (Arvo's method)
+		AABB Transform(const glm::mat4& a_matrix) const {
+			glm::vec3 center = glm::vec3(a_matrix * glm::vec4(GetCenter(), 1.f));
+			glm::vec3 extents = GetExtents();
+
+			glm::vec3 worldExtents = glm::abs(glm::vec3(a_matrix[0])) * extents.x +
+				glm::abs(glm::vec3(a_matrix[1])) * extents.y +
+				glm::abs(glm::vec3(a_matrix[2])) * extents.z;
+
+			return AABB(center - worldExtents, center + worldExtents);
+		}
+
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+}
\ No newline at end of file
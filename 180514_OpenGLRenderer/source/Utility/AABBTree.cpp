@@ -0,0 +1,339 @@
+#include "AABBTree.h"
+#include "Frustum.h"
+
+#include <assert.h>
+#include <algorithm>
+
+namespace SPRON {
+	static const unsigned int INSIDE_FLAG = 1u << 31;		// Set on stacked nodes whose parent was entirely inside the frustum
+
+	AABBTree::AABBTree(float a_margin) : m_root(NULL_NODE), m_freeList(NULL_NODE), m_freeCount(0), m_proxyCount(0), m_margin(a_margin)
+	{
+	}
+
+	AABBTree::~AABBTree()
+	{
+	}
+
+	/**
+	*	@brief Add an object to the tree as a leaf with an enlarged copy of its box.
+	*	@param a_bounds is the tight world space box of the object.
+	*	@param a_userData is the value returned for the object by queries, e.g. an entity index.
+	*	@return proxy of the object, used to move or destroy it.
+	*/
+	unsigned int AABBTree::CreateProxy(const AABB & a_bounds, unsigned int a_userData)
+	{
+		unsigned int proxy = AllocateNode();
+
+		glm::vec3 margin = glm::vec3(m_margin);
+		m_nodes[proxy].bounds = AABB(a_bounds.min - margin, a_bounds.max + margin);
+		m_nodes[proxy].userData = a_userData;
+		m_nodes[proxy].height = 0;
+
+		InsertLeaf(proxy);
+		m_proxyCount++;
+
+		return proxy;
+	}
+
+	void AABBTree::DestroyProxy(unsigned int a_proxy)
+	{
+		assert(m_nodes[a_proxy].IsLeaf() && "ERROR::AABB_TREE::PROXY_NOT_A_LEAF");
+
+		RemoveLeaf(a_proxy);
+		FreeNode(a_proxy);
+		m_proxyCount--;
+	}
+
+	/**
+	*	@brief Update an object's box, re-inserting its leaf only if the box has left the leaf's enlarged box.
+	*	@param a_proxy is the proxy of the object.
+	*	@param a_bounds is the new tight world space box of the object.
+	*	@return true if the leaf was re-inserted.
+	*/
+	bool AABBTree::MoveProxy(unsigned int a_proxy, const AABB & a_bounds)
+	{
+		assert(m_nodes[a_proxy].IsLeaf() && "ERROR::AABB_TREE::PROXY_NOT_A_LEAF");
+
+		if (m_nodes[a_proxy].bounds.Contains(a_bounds)) { return false; }		// Still covered, the tree is unchanged
+
+		RemoveLeaf(a_proxy);
+
+		glm::vec3 margin = glm::vec3(m_margin);
+		m_nodes[a_proxy].bounds = AABB(a_bounds.min - margin, a_bounds.max + margin);
+
+		InsertLeaf(a_proxy);
+
+		return true;
+	}
+
+	/**
+	*	@brief Walk the tree from the root, skipping every subtree outside the frustum and accepting every subtree inside it without further tests.
+	*	@param a_frustum is the frustum to test against.
+	*	@param a_visible is the list to append the user data of visible objects to.
+	*	@return number of nodes tested against the frustum.
+	*/
+	unsigned int AABBTree::Query(const Frustum & a_frustum, std::vector<unsigned int>& a_visible)
+	{
+		if (m_root == NULL_NODE) { return 0; }
+
+		unsigned int testCount = 0;
+
+		m_stack.clear();
+		m_stack.push_back(m_root);
+
+		while (!m_stack.empty()) {
+			unsigned int entry = m_stack.back();
+			m_stack.pop_back();
+
+			unsigned int nodeIndex = entry & ~INSIDE_FLAG;
+			const Node& node = m_nodes[nodeIndex];
+
+			unsigned int childFlag = entry & INSIDE_FLAG;
+
+			if (!childFlag) {
+				testCount++;
+
+				eFrustumTest result = a_frustum.TestAABB(node.bounds);
+
+				if (result == FRUSTUM_OUTSIDE) { continue; }
+				if (result == FRUSTUM_INSIDE) { childFlag = INSIDE_FLAG; }
+			}
+
+			if (node.IsLeaf()) {
+				a_visible.push_back(node.userData);
+			}
+			else {
+				m_stack.push_back(node.child1 | childFlag);
+				m_stack.push_back(node.child2 | childFlag);
+			}
+		}
+
+		return testCount;
+	}
+
+	/**
+	*	@brief Take a node from the free list, growing the node array if it is empty.
+	*	@return index of the node.
+	*/
+	unsigned int AABBTree::AllocateNode()
+	{
+		if (m_freeList == NULL_NODE) {
+			Node node;
+			node.parent = NULL_NODE;
+			node.height = -1;
+
+			m_nodes.push_back(node);
+			m_freeList = (unsigned int)m_nodes.size() - 1;
+			m_freeCount++;
+
+			assert(m_freeList < INSIDE_FLAG && "ERROR::AABB_TREE::TOO_MANY_NODES");
+		}
+
+		unsigned int index = m_freeList;
+		m_freeList = m_nodes[index].parent;
+		m_freeCount--;
+
+		Node& node = m_nodes[index];
+		node.parent = NULL_NODE;
+		node.child1 = NULL_NODE;
+		node.child2 = NULL_NODE;
+		node.height = 0;
+		node.userData = 0;
+
+		return index;
+	}
+
+	void AABBTree::FreeNode(unsigned int a_node)
+	{
+		m_nodes[a_node].parent = m_freeList;
+		m_nodes[a_node].height = -1;
+		m_freeList = a_node;
+		m_freeCount++;
+	}
+
+	/**
+	*	@brief Pair a leaf with the sibling that increases the tree's total surface area the least, then refit and balance up to the root.
+	*	O(log N) complexity where N = number of leaves, for a balanced tree
+	*	@param a_leaf is the leaf to insert, its box must already be set.
+	*	@return void.
+	*/
+	void AABBTree::InsertLeaf(unsigned int a_leaf)
+	{
+		if (m_root == NULL_NODE) {
+			m_root = a_leaf;
+			m_nodes[m_root].parent = NULL_NODE;
+			return;
+		}
+
+		AABB leafBounds = m_nodes[a_leaf].bounds;
+
+		// Descend towards the cheapest sibling
+		unsigned int index = m_root;
+		while (!m_nodes[index].IsLeaf()) {
+			const Node& node = m_nodes[index];
+
+			float area = node.bounds.GetPerimeter();
+			float combinedArea = AABB::Merge(node.bounds, leafBounds).GetPerimeter();
+
+			float cost = 2.f * combinedArea;					// Cost of pairing the leaf with this node
+			float inheritanceCost = 2.f * (combinedArea - area);	// Minimum cost of pushing the leaf further down, every ancestor grows
+
+			float childCosts[2];
+			unsigned int children[2] = { node.child1, node.child2 };
+
+			for (unsigned int i = 0; i < 2; ++i) {
+				const Node& child = m_nodes[children[i]];
+				float mergedArea = AABB::Merge(child.bounds, leafBounds).GetPerimeter();
+
+				childCosts[i] = child.IsLeaf() ? mergedArea + inheritanceCost : (mergedArea - child.bounds.GetPerimeter()) + inheritanceCost;
+			}
+
+			if (cost < childCosts[0] && cost < childCosts[1]) { break; }
+
+			index = (childCosts[0] < childCosts[1]) ? children[0] : children[1];
+		}
+
+		unsigned int sibling = index;
+
+		// Replace the sibling with a new parent of the sibling and the leaf
+		unsigned int oldParent = m_nodes[sibling].parent;
+		unsigned int newParent = AllocateNode();
+
+		m_nodes[newParent].parent = oldParent;
+		m_nodes[newParent].bounds = AABB::Merge(leafBounds, m_nodes[sibling].bounds);
+		m_nodes[newParent].height = m_nodes[sibling].height + 1;
+		m_nodes[newParent].child1 = sibling;
+		m_nodes[newParent].child2 = a_leaf;
+
+		m_nodes[sibling].parent = newParent;
+		m_nodes[a_leaf].parent = newParent;
+
+		if (oldParent == NULL_NODE) {
+			m_root = newParent;
+		}
+		else if (m_nodes[oldParent].child1 == sibling) {
+			m_nodes[oldParent].child1 = newParent;
+		}
+		else {
+			m_nodes[oldParent].child2 = newParent;
+		}
+
+		RefitAncestors(m_nodes[a_leaf].parent);
+	}
+
+	/**
+	*	@brief Remove a leaf by replacing its parent with its sibling, then refit and balance up to the root.
+	*	@param a_leaf is the leaf to remove, it is not freed.
+	*	@return void.
+	*/
+	void AABBTree::RemoveLeaf(unsigned int a_leaf)
+	{
+		if (a_leaf == m_root) {
+			m_root = NULL_NODE;
+			return;
+		}
+
+		unsigned int parent = m_nodes[a_leaf].parent;
+		unsigned int grandParent = m_nodes[parent].parent;
+		unsigned int sibling = (m_nodes[parent].child1 == a_leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+		if (grandParent == NULL_NODE) {
+			m_root = sibling;
+			m_nodes[sibling].parent = NULL_NODE;
+		}
+		else {
+			if (m_nodes[grandParent].child1 == parent) {
+				m_nodes[grandParent].child1 = sibling;
+			}
+			else {
+				m_nodes[grandParent].child2 = sibling;
+			}
+
+			m_nodes[sibling].parent = grandParent;
+
+			RefitAncestors(grandParent);
+		}
+
+		FreeNode(parent);
+	}
+
+	/**
+	*	@brief Recalculate the boxes and heights of a node and its ancestors after a change below them, balancing each on the way up.
+	*	@param a_node is the first node to refit.
+	*	@return void.
+	*/
+	void AABBTree::RefitAncestors(unsigned int a_node)
+	{
+		unsigned int index = a_node;
+
+		while (index != NULL_NODE) {
+			index = Balance(index);
+
+			Node& node = m_nodes[index];
+			const Node& child1 = m_nodes[node.child1];
+			const Node& child2 = m_nodes[node.child2];
+
+			node.height = 1 + std::max(child1.height, child2.height);
+			node.bounds = AABB::Merge(child1.bounds, child2.bounds);
+
+			index = node.parent;
+		}
+	}
+
+	/**
+	*	@brief Rotate a node's taller child up if its children's heights differ by more than 1.
+	*	@param a_node is the node to balance (A).
+	*	@return index of the node now in A's place.
+	*/
+	unsigned int AABBTree::Balance(unsigned int a_node)
+	{
+		Node& a = m_nodes[a_node];
+		if (a.IsLeaf() || a.height < 2) { return a_node; }
+
+		unsigned int ib = a.child1;
+		unsigned int ic = a.child2;
+
+		int balance = m_nodes[ic].height - m_nodes[ib].height;
+		if (balance >= -1 && balance <= 1) { return a_node; }
+
+		// Rotate the taller child (up) into A's place, A takes the place of up's shorter child
+		unsigned int up = (balance > 1) ? ic : ib;
+
+		Node& upNode = m_nodes[up];
+		unsigned int upChild1 = upNode.child1;
+		unsigned int upChild2 = upNode.child2;
+
+		upNode.child1 = a_node;
+		upNode.parent = a.parent;
+		a.parent = up;
+
+		if (upNode.parent == NULL_NODE) {
+			m_root = up;
+		}
+		else if (m_nodes[upNode.parent].child1 == a_node) {
+			m_nodes[upNode.parent].child1 = up;
+		}
+		else {
+			m_nodes[upNode.parent].child2 = up;
+		}
+
+		// The taller grandchild stays under up, the shorter one replaces up under A
+		unsigned int keep = (m_nodes[upChild1].height > m_nodes[upChild2].height) ? upChild1 : upChild2;
+		unsigned int move = (keep == upChild1) ? upChild2 : upChild1;
+
+		upNode.child2 = keep;
+
+		if (balance > 1) { a.child2 = move; }
+		else { a.child1 = move; }
+		m_nodes[move].parent = a_node;
+
+		a.bounds = AABB::Merge(m_nodes[a.child1].bounds, m_nodes[a.child2].bounds);
+		a.height = 1 + std::max(m_nodes[a.child1].height, m_nodes[a.child2].height);
+
+		upNode.bounds = AABB::Merge(a.bounds, m_nodes[keep].bounds);
+		upNode.height = 1 + std::max(a.height, m_nodes[keep].height);
+
+		return up;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AABB.h"
+
+#include <vector>
+
+namespace SPRON {
+	class Frustum;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Dynamic bounding volume hierarchy of axis aligned boxes, used to cull whole groups of objects with one frustum test.
+	*	Each object is a leaf (proxy) whose box is enlarged by a margin, so small movements only need the tight box checked against it.
+	*	Objects that leave their enlarged box are removed and re-inserted next to the leaf that costs the least surface area, and the
+	*	path back to the root is refit and rotated to keep the tree balanced.
+	*	NOTE: Proxies are indices into the node array, they stay valid until destroyed.
+	*/
+	class AABBTree {
+	public:
+		static const unsigned int NULL_NODE = ~0u;
+
+		AABBTree(float a_margin);
+		~AABBTree();
+
+		unsigned int CreateProxy(const AABB& a_bounds, unsigned int a_userData);
+		void DestroyProxy(unsigned int a_proxy);
+		bool MoveProxy(unsigned int a_proxy, const AABB& a_bounds);
+
+		void SetUserData(unsigned int a_proxy, unsigned int a_userData) { m_nodes[a_proxy].userData = a_userData; }
+		unsigned int GetUserData(unsigned int a_proxy) const { return m_nodes[a_proxy].userData; }
+
+		unsigned int Query(const Frustum& a_frustum, std::vector<unsigned int>& a_visible);
+
+		unsigned int GetProxyCount() const { return m_proxyCount; }
+		unsigned int GetNodeCount() const { return (unsigned int)m_nodes.size() - m_freeCount; }
+		int GetHeight() const { return (m_root == NULL_NODE) ? 0 : m_nodes[m_root].height; }
+	protected:
+	private:
+		struct Node {
+			AABB			bounds;			// Enlarged box for leaves, union of the children's boxes otherwise
+			unsigned int	parent;			// Next free node while the node is unused
+			unsigned int	child1;
+			unsigned int	child2;			// NULL_NODE for leaves
+			int				height;			// 0 for leaves, -1 while the node is unused
+			unsigned int	userData;
+
+			bool IsLeaf() const { return child1 == NULL_NODE; }
+		};
+
+		unsigned int AllocateNode();
+		void FreeNode(unsigned int a_node);
+
+		void InsertLeaf(unsigned int a_leaf);
+		void RemoveLeaf(unsigned int a_leaf);
+		void RefitAncestors(unsigned int a_node);
+		unsigned int Balance(unsigned int a_node);
+
+		std::vector<Node>	m_nodes;
+		unsigned int		m_root;
+		unsigned int		m_freeList;		// First unused node, unused nodes are linked through their parent
+		unsigned int		m_freeCount;
+		unsigned int		m_proxyCount;
+
+		float				m_margin;		// Distance leaf boxes are enlarged by in every direction
+
+		std::vector<unsigned int>	m_stack;	// Nodes left to visit during a query, kept between queries to avoid re-allocating
+	};
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "AllocationTracker.h"
+
+#include <imgui.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <assert.h>
+
+namespace SPRON {
+	/// Static initialisation
+	// NOTE: Constant initialised, so they are ready for allocations made during static initialisation of other files
+	static std::atomic<unsigned int>	s_allocationCount(0);		// Allocations since the start of the frame
+	static std::atomic<unsigned int>	s_allocationBytes(0);
+	static std::atomic<unsigned int>	s_lastFrameAllocations(0);
+	static std::atomic<unsigned int>	s_lastFrameBytes(0);
+	static std::atomic<bool>			s_isAsserting(false);
+
+	static thread_local int t_allowDepth = 0;		// Number of AllowAllocations scopes open on the current thread
+
+	/**
+	*	@brief Count an allocation, asserting if it was made in the frame loop while asserting is enabled.
+	*	@param a_size is the number of bytes allocated.
+	*	@return void.
+	*/
+	static void TrackAllocation(size_t a_size)
+	{
+		s_allocationCount++;
+		s_allocationBytes += (unsigned int)a_size;
+
+		if (s_isAsserting && t_allowDepth == 0) {
+			t_allowDepth++;		// NOTE: Reporting the assert may allocate, which must not assert again
+
+			assert(false && "ERROR::ALLOCATION_TRACKER::ALLOCATION_IN_FRAME_LOOP");
+
+			t_allowDepth--;
+		}
+	}
+
+	AllocationTracker::AllowAllocations::AllowAllocations()
+	{
+		t_allowDepth++;
+	}
+
+	AllocationTracker::AllowAllocations::~AllowAllocations()
+	{
+		t_allowDepth--;
+	}
+
+	/**
+	*	@brief Store the last frame's allocation counts and start counting the new frame.
+	*	@return void.
+	*/
+	void AllocationTracker::BeginFrame()
+	{
+		s_lastFrameAllocations = s_allocationCount.exchange(0);
+		s_lastFrameBytes = s_allocationBytes.exchange(0);
+	}
+
+	/**
+	*	@brief Enable or disable asserting on allocations made outside an AllowAllocations scope.
+	*	@param a_isAsserting is whether to assert, should only be enabled once the frame loop has reached a steady state.
+	*	@return void.
+	*/
+	void AllocationTracker::SetAsserting(bool a_isAsserting)
+	{
+		s_isAsserting = a_isAsserting;
+	}
+
+	bool AllocationTracker::IsAsserting()
+	{
+		return s_isAsserting;
+	}
+
+	unsigned int AllocationTracker::GetFrameAllocations()
+	{
+		return s_lastFrameAllocations;
+	}
+
+	unsigned int AllocationTracker::GetFrameBytes()
+	{
+		return s_lastFrameBytes;
+	}
+
+	/**
+	*	@brief Display the number of heap allocations made last frame, with a control to assert on them.
+	*	@return void.
+	*/
+	void AllocationTracker::ListenIMGUI()
+	{
+		ImGui::Begin("Allocations");
+
+		ImGui::Text("Heap allocations: %u (%.1f KB)", GetFrameAllocations(), GetFrameBytes() / 1024.f);
+
+		bool isAsserting = IsAsserting();
+		if (ImGui::Checkbox("Assert on frame allocations", &isAsserting)) { SetAsserting(isAsserting); }
+
+		ImGui::End();
+	}
+}
+
+/// Global allocation hooks
+// NOTE: The nothrow forms of new forward to these by default, and the sized forms of delete are replaced so they free with the same allocator.
+// The aligned forms (C++17 or /Zc:alignedNew) do not forward to the plain forms, so they are replaced separately.
+void* operator new(size_t a_size)
+{
+	SPRON::TrackAllocation(a_size);
+
+	void* ptr = std::malloc(a_size > 0 ? a_size : 1);		// Zero byte allocations must still return a unique pointer
+	if (!ptr) { throw std::bad_alloc(); }
+
+	return ptr;
+}
+
+void* operator new[](size_t a_size)
+{
+	return operator new(a_size);
+}
+
+void operator delete(void* a_ptr) noexcept
+{
+	std::free(a_ptr);
+}
+
+void operator delete[](void* a_ptr) noexcept
+{
+	std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, size_t) noexcept
+{
+	std::free(a_ptr);
+}
+
+void operator delete[](void* a_ptr, size_t) noexcept
+{
+	std::free(a_ptr);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(size_t a_size, std::align_val_t a_alignment)
+{
+	SPRON::TrackAllocation(a_size);
+
+	if (a_size == 0) { a_size = 1; }
+
+#ifdef _MSC_VER
+	void* ptr = _aligned_malloc(a_size, (size_t)a_alignment);		// NOTE: Must be freed with _aligned_free, not free
+#else
+	void* ptr = std::aligned_alloc((size_t)a_alignment, (a_size + (size_t)a_alignment - 1) & ~((size_t)a_alignment - 1));		// Size must be a multiple of the alignment
+#endif
+	if (!ptr) { throw std::bad_alloc(); }
+
+	return ptr;
+}
+
+void* operator new[](size_t a_size, std::align_val_t a_alignment)
+{
+	return operator new(a_size, a_alignment);
+}
+
+void operator delete(void* a_ptr, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+	_aligned_free(a_ptr);
+#else
+	std::free(a_ptr);
+#endif
+}
+
+void operator delete[](void* a_ptr, std::align_val_t a_alignment) noexcept
+{
+	operator delete(a_ptr, a_alignment);
+}
+
+void operator delete(void* a_ptr, size_t, std::align_val_t a_alignment) noexcept
+{
+	operator delete(a_ptr, a_alignment);
+}
+
+void operator delete[](void* a_ptr, size_t, std::align_val_t a_alignment) noexcept
+{
+	operator delete(a_ptr, a_alignment);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace SPRON {
+	/**
+	*	@brief Counts heap allocations made through operator new, which is replaced for the whole program.
+	*	When asserting is enabled every allocation outside an AllowAllocations scope asserts, to find allocations in the steady state frame loop.
+	*	NOTE: Has no instance, as allocations are counted from before main runs until after every singleton is shut down.
+	*/
+	class AllocationTracker {
+	public:
+		// Allocations made while an instance exists on the current thread never assert, used around work that allocates by design such as loading or UI edits
+		class AllowAllocations {
+		public:
+			AllowAllocations();
+			~AllowAllocations();
+		};
+
+		static void BeginFrame();
+
+		static void SetAsserting(bool a_isAsserting);
+		static bool IsAsserting();
+
+		static unsigned int GetFrameAllocations();
+		static unsigned int GetFrameBytes();
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		AllocationTracker() = delete;
+	};
+}
\ No newline at end of file
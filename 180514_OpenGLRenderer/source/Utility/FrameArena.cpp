@@ -0,0 +1,172 @@
+#include "FrameArena.h"
+#include "Renderer_Utility_Literals.h"
+
+#include <imgui.h>
+#include <assert.h>
+#include <algorithm>
+
+namespace SPRON {
+	/// Static initialisation
+	FrameArena* FrameArena::m_stn = nullptr;
+
+	static thread_local LinearArena* t_arena = nullptr;		// Arena of the current thread, created the first time it is asked for
+
+	LinearArena::LinearArena(size_t a_capacity) : m_capacity(a_capacity), m_offset(0), m_peak(0), m_overflowSize(0)
+	{
+		m_block = new char[m_capacity];
+	}
+
+	LinearArena::~LinearArena()
+	{
+		Reset();
+
+		delete[] m_block;
+	}
+
+	/**
+	*	@brief Bump allocate memory from the block, or from a block of its own if the arena is full.
+	*	@param a_size is the number of bytes to allocate.
+	*	@param a_alignment is the alignment of the allocation, must be a power of 2.
+	*	@return pointer to the allocated memory, valid until the next reset.
+	*/
+	void * LinearArena::Allocate(size_t a_size, size_t a_alignment)
+	{
+		assert((a_alignment & (a_alignment - 1)) == 0 && "ERROR::LINEAR_ARENA::ALIGNMENT_NOT_POWER_OF_2");
+
+		size_t offset = (m_offset + a_alignment - 1) & ~(a_alignment - 1);
+
+		if (offset + a_size > m_capacity) {		// Full, keep the allocation separate until the arena grows on reset
+			char* overflowBlock = new char[a_size + a_alignment];
+			m_overflowBlocks.push_back(overflowBlock);
+			m_overflowSize += a_size + a_alignment;
+
+			return (void*)(((size_t)overflowBlock + a_alignment - 1) & ~(a_alignment - 1));
+		}
+
+		m_offset = offset + a_size;
+
+		return m_block + offset;
+	}
+
+	/**
+	*	@brief Free every allocation, growing the block if anything did not fit since the last reset.
+	*	@return void.
+	*/
+	void LinearArena::Reset()
+	{
+		m_peak = std::max(m_peak, GetUsed());
+
+		if (!m_overflowBlocks.empty()) {
+			for (unsigned int i = 0; i < m_overflowBlocks.size(); ++i) {
+				delete[] m_overflowBlocks[i];
+			}
+			m_overflowBlocks.clear();
+
+			// Grow to fit everything used since the last reset, so the next frame's allocations fit in the block
+			delete[] m_block;
+			m_capacity = std::max(m_capacity * 2, m_offset + m_overflowSize);
+			m_block = new char[m_capacity];
+
+			m_overflowSize = 0;
+		}
+
+		m_offset = 0;
+	}
+
+	FrameArena::FrameArena()
+	{
+	}
+
+	FrameArena::~FrameArena()
+	{
+		for (unsigned int i = 0; i < m_arenas.size(); ++i) {
+			delete m_arenas[i];
+		}
+	}
+
+	/**
+	*	@brief Create singleton.
+	*	NOTE: Any future calls will be ignored.
+	*	@return void.
+	*/
+	void FrameArena::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new FrameArena();
+		}
+	}
+
+	void FrameArena::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Get the calling thread's arena, creating it if this is the thread's first frame allocation.
+	*	NOTE: Creating an arena allocates, so threads should allocate during the first frames rather than only in rare cases.
+	*	@return arena of the calling thread.
+	*/
+	LinearArena * FrameArena::GetThreadArena()
+	{
+		if (!t_arena) {
+			std::lock_guard<std::mutex> lock(m_stn->m_mutex);
+
+			t_arena = new LinearArena(FRAME_ARENA_SIZE);
+			m_stn->m_arenas.push_back(t_arena);
+		}
+
+		return t_arena;
+	}
+
+	/**
+	*	@brief Free the calling thread's arena, if it has one.
+	*	NOTE: Must be called by threads that stop before the program ends (e.g. job workers when the worker count changes), their arenas are otherwise kept until shutdown.
+	*	@return void.
+	*/
+	void FrameArena::ReleaseThreadArena()
+	{
+		if (!t_arena || !m_stn) { return; }
+
+		std::lock_guard<std::mutex> lock(m_stn->m_mutex);
+
+		std::vector<LinearArena*>& arenas = m_stn->m_arenas;
+		arenas.erase(std::remove(arenas.begin(), arenas.end(), t_arena), arenas.end());
+
+		delete t_arena;
+		t_arena = nullptr;
+	}
+
+	/**
+	*	@brief Free every allocation made from the frame arenas last frame.
+	*	NOTE: Must be called while no other thread is allocating, before the simulation or any jobs are started for the frame.
+	*	@return void.
+	*/
+	void FrameArena::BeginFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_stn->m_mutex);
+
+		for (unsigned int i = 0; i < m_stn->m_arenas.size(); ++i) {
+			m_stn->m_arenas[i]->Reset();
+		}
+	}
+
+	/**
+	*	@brief Display how much of each thread's arena was used.
+	*	@return void.
+	*/
+	void FrameArena::ListenIMGUI()
+	{
+		ImGui::Begin("Frame Arenas");
+
+		std::lock_guard<std::mutex> lock(m_stn->m_mutex);
+
+		for (unsigned int i = 0; i < m_stn->m_arenas.size(); ++i) {
+			const LinearArena* arena = m_stn->m_arenas[i];
+
+			ImGui::Text("Arena %u: %.1f / %.1f KB (peak %.1f KB)", i, arena->GetUsed() / 1024.f, arena->GetCapacity() / 1024.f, arena->GetPeak() / 1024.f);
+		}
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+namespace SPRON {
+	/**
+	*	@brief Block of memory handed out by bumping an offset, every allocation is freed at once by resetting it.
+	*	Allocations that do not fit are given their own block, the arena then grows on its next reset so the same workload fits without them.
+	*	NOTE: Not thread safe, each thread allocates from its own arena.
+	*/
+	class LinearArena {
+	public:
+		LinearArena(size_t a_capacity);
+		~LinearArena();
+
+		void* Allocate(size_t a_size, size_t a_alignment = alignof(std::max_align_t));
+		void Reset();
+
+		size_t GetUsed() const { return m_offset + m_overflowSize; }
+		size_t GetCapacity() const { return m_capacity; }
+		size_t GetPeak() const { return m_peak; }
+	protected:
+	private:
+		char*	m_block;
+		size_t	m_capacity;
+		size_t	m_offset;
+		size_t	m_peak;		// Most bytes used between two resets
+
+		std::vector<char*>	m_overflowBlocks;		// Allocations that did not fit, freed on reset
+		size_t				m_overflowSize;
+	};
+
+	/**
+	*	@brief Standard library allocator that allocates from a linear arena, so containers of transient data make no heap allocations.
+	*	NOTE: Deallocating does nothing, the memory is reclaimed when the arena is reset.
+	*/
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		typedef T value_type;
+
+		ArenaAllocator(LinearArena* a_arena) : m_arena(a_arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& a_other) : m_arena(a_other.GetArena()) {}
+
+		T* allocate(size_t a_count) { return (T*)m_arena->Allocate(sizeof(T) * a_count, alignof(T)); }
+		void deallocate(T*, size_t) {}		// Memory is released when the arena is reset
+
+		LinearArena* GetArena() const { return m_arena; }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& a_other) const { return m_arena == a_other.GetArena(); }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& a_other) const { return m_arena != a_other.GetArena(); }
+	protected:
+	private:
+		LinearArena* m_arena;
+	};
+
+	// Vector of transient data, valid until the arena it was allocated from is reset
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+	/**
+	*	@brief Static singleton class that gives every thread its own linear arena for data that only lives for the current frame.
+	*	NOTE: Every arena is reset at the start of the frame, so nothing allocated from them may be kept past the end of the frame.
+	*/
+	class FrameArena {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static LinearArena* GetThreadArena();
+		static void ReleaseThreadArena();
+
+		static void BeginFrame();
+		static void ListenIMGUI();
+	protected:
+	private:
+		static FrameArena* m_stn;		// Singleton instance
+
+		// Instance variables
+		std::mutex					m_mutex;		// Guards the arena list, only locked when a thread allocates from its arena for the first time
+		std::vector<LinearArena*>	m_arenas;		// One per thread that has allocated from a frame arena
+
+		FrameArena();
+		~FrameArena();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "Frustum.h"
+#include "Renderer_Utility_Funcs.h"
+
+#include <xmmintrin.h>
+#include <glm/common.hpp>
+
+namespace SPRON {
+
+	Frustum::Frustum()
+	{
+		Set(glm::mat4(1.f));
+	}
+
+	/**
+	*	@brief Extract the planes of a projection view matrix and spread them into the per component arrays.
+	*	@param a_projectionView is the projection matrix multiplied by the view matrix.
+	*	@return void.
+	*/
+	void Frustum::Set(const glm::mat4 & a_projectionView)
+	{
+		RendererUtility::ExtractFrustumPlanes(a_projectionView, m_planes);
+
+		for (unsigned int i = 0; i < 8; ++i) {
+			const glm::vec4& plane = m_planes[i < 6 ? i : 5];
+
+			m_normalX[i] = plane.x;
+			m_normalY[i] = plane.y;
+			m_normalZ[i] = plane.z;
+			m_distance[i] = plane.w;
+			m_absNormalX[i] = glm::abs(plane.x);
+			m_absNormalY[i] = glm::abs(plane.y);
+			m_absNormalZ[i] = glm::abs(plane.z);
+		}
+	}
+
+	/**
+	*	@brief Test a box against every plane, 4 planes per instruction.
+	*	The box's center distance to each plane is compared against its extents projected onto the plane normal.
+	*	@param a_bounds is the box to test.
+	*	@return whether the box is outside, crossing or entirely inside the frustum.
+	*/
+	eFrustumTest Frustum::TestAABB(const AABB & a_bounds) const
+	{
+		glm::vec3 center = a_bounds.GetCenter();
+		glm::vec3 extents = a_bounds.GetExtents();
+
+		__m128 centerX = _mm_set1_ps(center.x);
+		__m128 centerY = _mm_set1_ps(center.y);
+		__m128 centerZ = _mm_set1_ps(center.z);
+		__m128 extentX = _mm_set1_ps(extents.x);
+		__m128 extentY = _mm_set1_ps(extents.y);
+		__m128 extentZ = _mm_set1_ps(extents.z);
+
+		int outsideMask = 0;
+		int intersectMask = 0;
+
+		for (unsigned int i = 0; i < 8; i += 4) {
+			// Signed distance of the center = n . c + d
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_normalX[i]), centerX), _mm_mul_ps(_mm_loadu_ps(&m_normalY[i]), centerY)),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_normalZ[i]), centerZ), _mm_loadu_ps(&m_distance[i])));
+
+			// Distance from the center to the corner furthest along the normal = |n| . e
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_absNormalX[i]), extentX), _mm_mul_ps(_mm_loadu_ps(&m_absNormalY[i]), extentY)),
+				_mm_mul_ps(_mm_loadu_ps(&m_absNormalZ[i]), extentZ));
+
+			outsideMask |= _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+			intersectMask |= _mm_movemask_ps(_mm_cmplt_ps(distance, radius));
+		}
+
+		if (outsideMask) { return FRUSTUM_OUTSIDE; }
+
+		return intersectMask ? FRUSTUM_INTERSECTING : FRUSTUM_INSIDE;
+	}
+
+	/**
+	*	@brief Check whether a bounding sphere is at least partly inside the frustum.
+	*	@param a_center is the world space center of the sphere.
+	*	@param a_radius is the world space radius of the sphere.
+	*	@return false if the sphere is entirely outside any plane.
+	*/
+	bool Frustum::IsSphereVisible(const glm::vec3 & a_center, float a_radius) const
+	{
+		return RendererUtility::IsSphereInFrustum(m_planes, a_center, a_radius);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "AABB.h"
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	enum eFrustumTest : unsigned char {
+		FRUSTUM_OUTSIDE,		// Entirely outside at least one plane
+		FRUSTUM_INTERSECTING,	// Crosses at least one plane
+		FRUSTUM_INSIDE			// Entirely inside every plane, nothing it contains needs testing
+	};
+
+	/**
+	*	@brief Six planes of a camera's view volume, stored as one array per plane component so a box is tested against 4 planes at once with SSE.
+	*	NOTE: The 6 planes are padded to 8 by repeating the far plane, so both halves are full SSE registers.
+	*/
+	class Frustum {
+	public:
+		Frustum();
+
+		void Set(const glm::mat4& a_projectionView);
+
+		eFrustumTest TestAABB(const AABB& a_bounds) const;
+		bool IsSphereVisible(const glm::vec3& a_center, float a_radius) const;
+
+		const glm::vec4* GetPlanes() const { return m_planes; }
+	protected:
+	private:
+		glm::vec4 m_planes[6];		// xyz = normal pointing inwards and w = distance, from RendererUtility::ExtractFrustumPlanes
+
+		// Plane components, and absolute normals to project a box's extents onto each normal
+		float m_normalX[8];
+		float m_normalY[8];
+		float m_normalZ[8];
+		float m_distance[8];
+		float m_absNormalX[8];
+		float m_absNormalY[8];
+		float m_absNormalZ[8];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include "JobSystem.h"
+#include "FrameArena.h"
+
+#include <imgui.h>
+#include <algorithm>
+
+namespace SPRON {
+	/// Static initialisation
+	JobSystem* JobSystem::m_stn = nullptr;
+
+	static thread_local unsigned int t_threadIndex = 0;		// Queue of the current thread, threads not started by the job system such as the main thread share queue 0
+
+	JobSystem::JobSystem() : m_isRunning(false), m_queuedCount(0), m_jobCount(0), m_stealCount(0)
+	{
+	}
+
+	JobSystem::~JobSystem()
+	{
+		for (unsigned int i = 0; i < m_queues.size(); ++i) {
+			delete m_queues[i];
+		}
+	}
+
+	/**
+	*	@brief Create singleton and start the worker threads.
+	*	NOTE: Any future calls will be ignored, use SetWorkerCount to change the number of workers.
+	*	@param a_workerCount is the number of worker threads, -1 to use one per hardware thread besides the main thread.
+	*	@return void.
+	*/
+	void JobSystem::Initialise(int a_workerCount)
+	{
+		if (!m_stn) {
+			m_stn = new JobSystem();
+
+			SetWorkerCount(a_workerCount);
+		}
+	}
+
+	void JobSystem::Shutdown()
+	{
+		StopWorkers();
+
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Stop the worker threads once they are idle and start a new number of them.
+	*	NOTE: Must be called from the main thread while no jobs are in flight.
+	*	@param a_workerCount is the number of worker threads, -1 to use one per hardware thread besides the main thread.
+	*	@return void.
+	*/
+	void JobSystem::SetWorkerCount(int a_workerCount)
+	{
+		if (a_workerCount < 0) { a_workerCount = std::max(0, (int)std::thread::hardware_concurrency() - 1); }
+
+		StopWorkers();
+		StartWorkers((unsigned int)a_workerCount);
+	}
+
+	unsigned int JobSystem::GetThreadIndex()
+	{
+		return t_threadIndex;
+	}
+
+	/**
+	*	@brief Queue a job on the current thread's queue.
+	*	@param a_job is the function to run.
+	*	@param a_counter is the counter to increment now and decrement once the job has run, nullptr if nothing waits on the job.
+	*	@param a_dependency is a counter that must reach zero before the job is queued, nullptr to queue it immediately.
+	*	@return void.
+	*/
+	void JobSystem::Run(const Job & a_job, JobCounter * a_counter, JobCounter * a_dependency)
+	{
+		if (a_counter) { a_counter->m_pending++; }
+
+		QueuedJob queuedJob = { a_job, a_counter };
+
+		if (a_dependency) {
+			std::lock_guard<std::mutex> lock(a_dependency->m_mutex);
+
+			// NOTE: Checked under the lock, the job that finishes the dependency takes the lock before queueing its continuations
+			if (!a_dependency->IsDone()) {
+				a_dependency->m_continuations.push_back({ a_job, a_counter });
+				return;
+			}
+		}
+
+		Push(queuedJob);
+	}
+
+	/**
+	*	@brief Run queued jobs on the current thread until a counter reaches zero.
+	*	@param a_counter is the counter to wait on.
+	*	@return void.
+	*/
+	void JobSystem::Wait(JobCounter * a_counter)
+	{
+		while (!a_counter->IsDone()) {
+			if (!TryRunJob(t_threadIndex)) { std::this_thread::yield(); }		// Remaining jobs are running on other threads
+		}
+
+		// NOTE: The last job decrements the counter under its lock, wait for it to be released before the caller can destroy the counter
+		std::lock_guard<std::mutex> lock(a_counter->m_mutex);
+	}
+
+	/**
+	*	@brief Split a range into batches, run each batch as a job and wait for all of them.
+	*	NOTE: Batches run in any order and on any thread, the job must only write to data owned by the indices it is given.
+	*	@param a_count is the number of indices in the range.
+	*	@param a_batchSize is the number of indices per job, large enough that each job does more work than it costs to queue.
+	*	@param a_job is the function to run on each batch, given the first index and one past the last index of the batch.
+	*	@return void.
+	*/
+	void JobSystem::ParallelFor(unsigned int a_count, unsigned int a_batchSize, const RangeJob & a_job)
+	{
+		if (a_count == 0) { return; }
+
+		a_batchSize = std::max(1u, a_batchSize);
+
+		// Not worth queueing, run on the current thread
+		if (a_count <= a_batchSize || m_stn->m_workers.empty()) {
+			a_job(0, a_count);
+			return;
+		}
+
+		JobCounter counter;
+
+		for (unsigned int begin = 0; begin < a_count; begin += a_batchSize) {
+			unsigned int end = std::min(a_count, begin + a_batchSize);
+
+			Run([&a_job, begin, end]() { a_job(begin, end); }, &counter);
+		}
+
+		Wait(&counter);
+	}
+
+	void JobSystem::BeginFrame()
+	{
+		// Statistics are kept per frame
+		m_stn->m_jobCount = 0;
+		m_stn->m_stealCount = 0;
+	}
+
+	/**
+	*	@brief Create a queue per thread and start the worker threads.
+	*	@param a_workerCount is the number of worker threads.
+	*	@return void.
+	*/
+	void JobSystem::StartWorkers(unsigned int a_workerCount)
+	{
+		for (unsigned int i = 0; i < m_stn->m_queues.size(); ++i) {
+			delete m_stn->m_queues[i];
+		}
+		m_stn->m_queues.clear();
+
+		for (unsigned int i = 0; i <= a_workerCount; ++i) {
+			m_stn->m_queues.push_back(new WorkQueue());
+		}
+
+		m_stn->m_isRunning = true;
+
+		for (unsigned int i = 1; i <= a_workerCount; ++i) {
+			m_stn->m_workers.push_back(std::thread(WorkerLoop, i));
+		}
+	}
+
+	/**
+	*	@brief Wake every worker so it sees the system has stopped, then join them.
+	*	@return void.
+	*/
+	void JobSystem::StopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stn->m_sleepMutex);
+			m_stn->m_isRunning = false;
+		}
+		m_stn->m_wakeCondition.notify_all();
+
+		for (unsigned int i = 0; i < m_stn->m_workers.size(); ++i) {
+			m_stn->m_workers[i].join();
+		}
+		m_stn->m_workers.clear();
+	}
+
+	/**
+	*	@brief Run jobs until the system stops, sleeping while there are none queued.
+	*	@param a_threadIndex is the index of the worker's queue.
+	*	@return void.
+	*/
+	void JobSystem::WorkerLoop(unsigned int a_threadIndex)
+	{
+		t_threadIndex = a_threadIndex;
+
+		while (m_stn->m_isRunning) {
+			if (TryRunJob(a_threadIndex)) { continue; }
+
+			std::unique_lock<std::mutex> lock(m_stn->m_sleepMutex);
+			m_stn->m_wakeCondition.wait(lock, []() { return m_stn->m_queuedCount > 0 || !m_stn->m_isRunning; });
+		}
+
+		FrameArena::ReleaseThreadArena();		// Workers are replaced when the worker count changes
+	}
+
+	/**
+	*	@brief Add a job to the back of the current thread's queue and wake a worker to run or steal it.
+	*	@param a_job is the job to queue.
+	*	@return void.
+	*/
+	void JobSystem::Push(const QueuedJob & a_job)
+	{
+		WorkQueue* queue = m_stn->m_queues[t_threadIndex];
+
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->PushBack(a_job);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_stn->m_sleepMutex);		// NOTE: Locked so a worker can not miss the wake between checking the count and sleeping
+			m_stn->m_queuedCount++;
+		}
+		m_stn->m_wakeCondition.notify_one();
+	}
+
+	/**
+	*	@brief Run the newest job on a thread's own queue, or steal the oldest job from another thread's queue if its own is empty.
+	*	@param a_threadIndex is the index of the thread's queue.
+	*	@return true if a job was run.
+	*/
+	bool JobSystem::TryRunJob(unsigned int a_threadIndex)
+	{
+		QueuedJob job;
+		bool isFound = false;
+		bool isStolen = false;
+
+		// Own queue, newest first as its data is most likely still in cache
+		WorkQueue* ownQueue = m_stn->m_queues[a_threadIndex];
+		{
+			std::lock_guard<std::mutex> lock(ownQueue->mutex);
+
+			if (ownQueue->count > 0) {
+				job = ownQueue->PopBack();
+				isFound = true;
+			}
+		}
+
+		// Steal, oldest first as it is likely to be the largest remaining piece of work
+		for (unsigned int i = 1; !isFound && i < m_stn->m_queues.size(); ++i) {
+			WorkQueue* victimQueue = m_stn->m_queues[(a_threadIndex + i) % m_stn->m_queues.size()];
+
+			std::lock_guard<std::mutex> lock(victimQueue->mutex);
+
+			if (victimQueue->count > 0) {
+				job = victimQueue->PopFront();
+				isFound = isStolen = true;
+			}
+		}
+
+		if (!isFound) { return false; }
+
+		m_stn->m_queuedCount--;
+
+		job.job();
+
+		m_stn->m_jobCount++;
+		if (isStolen) { m_stn->m_stealCount++; }
+
+		if (job.counter) { Finish(job.counter); }
+
+		return true;
+	}
+
+	/**
+	*	@brief Decrement a counter after one of its jobs has run, queueing the jobs that depend on it if it reached zero.
+	*	@param a_counter is the counter of the job that ran.
+	*	@return void.
+	*/
+	void JobSystem::Finish(JobCounter * a_counter)
+	{
+		std::vector<JobCounter::Continuation> continuations;
+
+		{
+			std::lock_guard<std::mutex> lock(a_counter->m_mutex);
+
+			if (--a_counter->m_pending > 0) { return; }
+
+			continuations.swap(a_counter->m_continuations);
+		}
+
+		// NOTE: The counter may be destroyed by its waiting thread from here on, only the moved continuations are used
+		for (unsigned int i = 0; i < continuations.size(); ++i) {
+			QueuedJob queuedJob = { continuations[i].job, continuations[i].counter };
+			Push(queuedJob);
+		}
+	}
+
+	/**
+	*	@brief Add a job after the newest job, doubling the ring if it is full.
+	*	@param a_job is the job to add.
+	*	@return void.
+	*/
+	void JobSystem::WorkQueue::PushBack(const QueuedJob & a_job)
+	{
+		if (count == jobs.size()) {		// Full, grow and move the jobs so the oldest is first again
+			std::vector<QueuedJob> grown(std::max<size_t>(16, jobs.size() * 2));
+
+			for (unsigned int i = 0; i < count; ++i) {
+				grown[i] = std::move(jobs[(front + i) % jobs.size()]);
+			}
+
+			jobs.swap(grown);
+			front = 0;
+		}
+
+		jobs[(front + count) % jobs.size()] = a_job;
+		count++;
+	}
+
+	JobSystem::QueuedJob JobSystem::WorkQueue::PopBack()
+	{
+		count--;
+
+		return std::move(jobs[(front + count) % jobs.size()]);		// NOTE: Moved out so the slot does not keep the job's captures alive
+	}
+
+	JobSystem::QueuedJob JobSystem::WorkQueue::PopFront()
+	{
+		QueuedJob job = std::move(jobs[front]);
+
+		front = (front + 1) % jobs.size();
+		count--;
+
+		return job;
+	}
+
+	/**
+	*	@brief Display the number of worker threads and how many jobs ran and were stolen this frame, with a control to measure scaling.
+	*	@return void.
+	*/
+	void JobSystem::ListenIMGUI()
+	{
+		ImGui::Begin("Job System");
+
+		int workerCount = (int)GetWorkerCount();
+		int maxWorkerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+		if (ImGui::SliderInt("Workers", &workerCount, 0, maxWorkerCount)) { SetWorkerCount(workerCount); }
+
+		ImGui::Text("Jobs: %u (%u stolen)", m_stn->m_jobCount.load(), m_stn->m_stealCount.load());
+		ImGui::Text("Frame time: %.3f ms", 1000.f / ImGui::GetIO().Framerate);
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
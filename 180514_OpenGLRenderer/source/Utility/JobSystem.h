@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+namespace SPRON {
+	class JobSystem;
+
+	/**
+	*	@brief Number of jobs still to finish, waited on to join a group of jobs.
+	*	Jobs can also be made to depend on a counter, they are only queued once it reaches zero.
+	*	NOTE: A counter must outlive every job that uses it, usually by living on the stack of the function that waits on it.
+	*/
+	class JobCounter {
+	public:
+		JobCounter() : m_pending(0) {}
+
+		bool IsDone() const { return m_pending.load() == 0; }
+	protected:
+	private:
+		friend class JobSystem;
+
+		struct Continuation {
+			std::function<void()>	job;
+			JobCounter*				counter;
+		};
+
+		std::atomic<int>			m_pending;
+		std::mutex					m_mutex;			// Guards the continuations
+		std::vector<Continuation>	m_continuations;	// Jobs that depend on this counter, queued when it reaches zero
+	};
+
+	/**
+	*	@brief Static singleton class that runs jobs on a pool of worker threads, each with its own queue.
+	*	Threads run jobs from the back of their own queue and steal from the front of other threads' queues when theirs is empty,
+	*	threads that wait on a counter keep running jobs instead of blocking, so the main thread helps finish the work it is waiting for.
+	*	NOTE: Jobs must not make openGL calls, the context is only current on the main thread.
+	*/
+	class JobSystem {
+	public:
+		typedef std::function<void()> Job;
+		typedef std::function<void(unsigned int a_begin, unsigned int a_end)> RangeJob;
+
+		static void Initialise(int a_workerCount = -1);
+		static void Shutdown();
+
+		static void SetWorkerCount(int a_workerCount);
+		static unsigned int GetWorkerCount() { return (unsigned int)m_stn->m_workers.size(); }
+		static unsigned int GetThreadIndex();
+
+		static void Run(const Job& a_job, JobCounter* a_counter = nullptr, JobCounter* a_dependency = nullptr);
+		static void Wait(JobCounter* a_counter);
+		static void ParallelFor(unsigned int a_count, unsigned int a_batchSize, const RangeJob& a_job);
+
+		static void BeginFrame();
+		static void ListenIMGUI();
+	protected:
+	private:
+		static JobSystem* m_stn;		// Singleton instance
+
+		struct QueuedJob {
+			Job				job;
+			JobCounter*		counter;
+		};
+
+		// Jobs pushed by one thread, guarded by a lock as stealing is rare compared to running jobs
+		// NOTE: Stored as a ring that only grows, so queueing a job does not allocate once the ring has reached the frame's peak
+		struct WorkQueue {
+			std::mutex				mutex;
+			std::vector<QueuedJob>	jobs;
+			unsigned int			front = 0;		// Index of the oldest job
+			unsigned int			count = 0;
+
+			void PushBack(const QueuedJob& a_job);
+			QueuedJob PopBack();
+			QueuedJob PopFront();
+		};
+
+		static void StartWorkers(unsigned int a_workerCount);
+		static void StopWorkers();
+		static void WorkerLoop(unsigned int a_threadIndex);
+
+		static void Push(const QueuedJob& a_job);
+		static bool TryRunJob(unsigned int a_threadIndex);
+		static void Finish(JobCounter* a_counter);
+
+		// Instance variables
+		std::vector<WorkQueue*>		m_queues;			// One per thread, index 0 is the main thread
+		std::vector<std::thread>	m_workers;
+
+		std::atomic<bool>			m_isRunning;
+		std::atomic<int>			m_queuedCount;		// Jobs waiting in any queue, workers sleep while it is zero
+		std::mutex					m_sleepMutex;
+		std::condition_variable		m_wakeCondition;
+
+		// Statistics
+		std::atomic<unsigned int>	m_jobCount;			// Jobs run this frame
+		std::atomic<unsigned int>	m_stealCount;		// Jobs run by a thread other than the one that pushed them this frame
+
+		JobSystem();
+		~JobSystem();
+	};
+}
\ No newline at end of file
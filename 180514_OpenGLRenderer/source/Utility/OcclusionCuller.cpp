@@ -0,0 +1,302 @@
+#include "OcclusionCuller.h"
+#include "Renderer_Utility_Literals.h"
+#include "JobSystem.h"
+
+#include <xmmintrin.h>
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+namespace SPRON {
+	/// Static initialisation
+	static const unsigned int TILE_WIDTH = 32;		// NOTE: Multiple of 4 so every group of 4 pixels lies in a single tile
+	static const unsigned int TILE_HEIGHT = 16;
+
+	static const float MIN_TRIANGLE_AREA = 1e-6f;	// Triangles with a smaller area in pixels cover no whole pixel
+
+	OcclusionCuller::OcclusionCuller(unsigned int a_width, unsigned int a_height) :
+		m_width(a_width), m_height(a_height), m_projectionView(1.f)
+	{
+		assert(a_width % TILE_WIDTH == 0 && a_height % TILE_HEIGHT == 0 && "ERROR::OCCLUSION_CULLER::SIZE_NOT_A_MULTIPLE_OF_TILE_SIZE");
+
+		m_tileCountX = m_width / TILE_WIDTH;
+		m_tileCountY = m_height / TILE_HEIGHT;
+
+		m_depth.resize(m_width * m_height, 1.f);
+		m_tileMaxDepth.resize(m_tileCountX * m_tileCountY, 1.f);
+	}
+
+	OcclusionCuller::~OcclusionCuller()
+	{
+	}
+
+	/**
+	*	@brief Forget last frame's occluders and start collecting this frame's.
+	*	@param a_projectionView is the projection matrix multiplied by the view matrix of the camera the scene is culled for.
+	*	@return void.
+	*/
+	void OcclusionCuller::Begin(const glm::mat4 & a_projectionView)
+	{
+		m_projectionView = a_projectionView;
+		m_triangles.clear();
+	}
+
+	/**
+	*	@brief Transform an occluder's triangles into buffer space, skipping triangles that cross the near plane or are outside the buffer.
+	*	NOTE: Triangles are only collected, the buffer is written by Rasterize.
+	*	@param a_verts is the model space vertices of the occluder.
+	*	@param a_indices is the draw order of the vertices, the vertices are drawn in order if it has 1 or no entries.
+	*	@param a_world is the world matrix of the occluder.
+	*	@param a_firstIndex is the first index of the occluder's triangles.
+	*	@param a_indexCount is the number of indices of the occluder's triangles, 0 for every index after the first.
+	*	@return false once OCCLUSION_MAX_TRIANGLES triangles have been collected, no more occluders are accepted.
+	*/
+	bool OcclusionCuller::AddOccluder(const std::vector<Vertex>& a_verts, const std::vector<unsigned int>& a_indices, const glm::mat4 & a_world,
+		unsigned int a_firstIndex, unsigned int a_indexCount)
+	{
+		bool isIndexed = (a_indices.size() > 1);
+		unsigned int totalCount = isIndexed ? (unsigned int)a_indices.size() : (unsigned int)a_verts.size();
+
+		if (a_indexCount == 0) { a_indexCount = totalCount - std::min(a_firstIndex, totalCount); }
+
+		glm::mat4 transform = m_projectionView * a_world;
+
+		for (unsigned int i = a_firstIndex; i + 2 < a_firstIndex + a_indexCount; i += 3) {
+			if (m_triangles.size() >= OCCLUSION_MAX_TRIANGLES) { return false; }
+
+			ScreenTriangle triangle;
+			bool isClipped = false;
+
+			for (unsigned int j = 0; j < 3; ++j) {
+				glm::vec4 clip = transform * a_verts[isIndexed ? a_indices[i + j] : i + j].pos;
+
+				// NOTE: Only triangles fully in front of the near plane are used, skipping an occluder never hides anything
+				if (clip.z < -clip.w || clip.w <= 0.f) { isClipped = true; break; }
+
+				float inverseW = 1.f / clip.w;
+				triangle.x[j] = (clip.x * inverseW * 0.5f + 0.5f) * m_width;
+				triangle.y[j] = (clip.y * inverseW * 0.5f + 0.5f) * m_height;
+				triangle.z[j] = std::min(1.f, clip.z * inverseW * 0.5f + 0.5f);
+			}
+
+			if (isClipped) { continue; }
+
+			// Rendering does not cull back faces, so neither does the rasterizer, wind every triangle counter-clockwise
+			float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+
+			if (std::abs(area) < MIN_TRIANGLE_AREA) { continue; }
+
+			if (area < 0.f) {
+				std::swap(triangle.x[1], triangle.x[2]);
+				std::swap(triangle.y[1], triangle.y[2]);
+				std::swap(triangle.z[1], triangle.z[2]);
+			}
+
+			triangle.minX = std::max(0, (int)std::floor(std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]))));
+			triangle.minY = std::max(0, (int)std::floor(std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]))));
+			triangle.maxX = std::min((int)m_width - 1, (int)std::floor(std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]))));
+			triangle.maxY = std::min((int)m_height - 1, (int)std::floor(std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]))));
+
+			if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) { continue; }		// Outside the buffer
+
+			m_triangles.push_back(triangle);
+		}
+
+		return true;
+	}
+
+	/**
+	*	@brief Clear the buffer and rasterize the collected triangles, one job per tile.
+	*	O(T * N) complexity where T = number of tiles and N = number of triangles, triangles that do not overlap a tile are rejected by their bounds
+	*	@return void.
+	*/
+	void OcclusionCuller::Rasterize()
+	{
+		JobSystem::ParallelFor(m_tileCountX * m_tileCountY, 1, [this](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				RasterizeTile(i);
+			}
+		});
+	}
+
+	/**
+	*	@brief Check whether any part of a box could be in front of the occluders.
+	*	NOTE: Reads the buffer only, so it can be called from any number of jobs once Rasterize has returned.
+	*	@param a_bounds is the world space box to test.
+	*	@return false if every pixel the box covers has an occluder in front of the box's nearest point.
+	*/
+	bool OcclusionCuller::IsVisible(const AABB & a_bounds) const
+	{
+		float minX = (float)m_width, minY = (float)m_height, maxX = 0.f, maxY = 0.f;
+		float minDepth = 1.f;
+
+		for (unsigned int i = 0; i < 8; ++i) {
+			glm::vec4 corner = glm::vec4((i & 1) ? a_bounds.max.x : a_bounds.min.x, (i & 2) ? a_bounds.max.y : a_bounds.min.y, (i & 4) ? a_bounds.max.z : a_bounds.min.z, 1.f);
+			glm::vec4 clip = m_projectionView * corner;
+
+			if (clip.z < -clip.w || clip.w <= 0.f) { return true; }		// Crosses the near plane, the box surrounds the camera
+
+			float inverseW = 1.f / clip.w;
+			float x = (clip.x * inverseW * 0.5f + 0.5f) * m_width;
+			float y = (clip.y * inverseW * 0.5f + 0.5f) * m_height;
+
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			maxX = std::max(maxX, x);
+			maxY = std::max(maxY, y);
+			minDepth = std::min(minDepth, clip.z * inverseW * 0.5f + 0.5f);
+		}
+
+		// Every pixel the box touches, not only the pixel centers it covers
+		int pixelMinX = std::max(0, (int)std::floor(minX));
+		int pixelMinY = std::max(0, (int)std::floor(minY));
+		int pixelMaxX = std::min((int)m_width - 1, (int)std::floor(maxX));
+		int pixelMaxY = std::min((int)m_height - 1, (int)std::floor(maxY));
+
+		if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY) { return true; }		// Outside the buffer, left to the frustum test
+
+		__m128 boxDepth = _mm_set1_ps(minDepth);
+		__m128 laneOffsets = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+		__m128 rangeMin = _mm_set1_ps((float)pixelMinX);
+		__m128 rangeMax = _mm_set1_ps((float)pixelMaxX);
+
+		for (int tileY = pixelMinY / (int)TILE_HEIGHT; tileY <= pixelMaxY / (int)TILE_HEIGHT; ++tileY) {
+			for (int tileX = pixelMinX / (int)TILE_WIDTH; tileX <= pixelMaxX / (int)TILE_WIDTH; ++tileX) {
+				// Every pixel of the tile is in front of the box
+				if (minDepth > m_tileMaxDepth[tileY * m_tileCountX + tileX]) { continue; }
+
+				int startY = std::max(pixelMinY, tileY * (int)TILE_HEIGHT);
+				int endY = std::min(pixelMaxY, (tileY + 1) * (int)TILE_HEIGHT - 1);
+				int startX = std::max(pixelMinX, tileX * (int)TILE_WIDTH) & ~3;
+				int endX = std::min(pixelMaxX, (tileX + 1) * (int)TILE_WIDTH - 1);
+
+				for (int y = startY; y <= endY; ++y) {
+					const float* row = &m_depth[y * m_width];
+
+					for (int x = startX; x <= endX; x += 4) {
+						__m128 lanes = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+						__m128 inRange = _mm_and_ps(_mm_cmpge_ps(lanes, rangeMin), _mm_cmple_ps(lanes, rangeMax));
+
+						// Visible if the box is at or in front of the occluder in any pixel
+						if (_mm_movemask_ps(_mm_and_ps(inRange, _mm_cmple_ps(boxDepth, _mm_loadu_ps(&row[x]))))) { return true; }
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	*	@brief Clear a tile, rasterize every triangle overlapping it and store its furthest depth.
+	*	NOTE: Only writes the tile's own pixels, so tiles are rasterized in parallel without locking.
+	*	@param a_tile is the index of the tile.
+	*	@return void.
+	*/
+	void OcclusionCuller::RasterizeTile(unsigned int a_tile)
+	{
+		int tileMinX = (a_tile % m_tileCountX) * TILE_WIDTH;
+		int tileMinY = (a_tile / m_tileCountX) * TILE_HEIGHT;
+		int tileMaxX = tileMinX + TILE_WIDTH - 1;
+		int tileMaxY = tileMinY + TILE_HEIGHT - 1;
+
+		for (int y = tileMinY; y <= tileMaxY; ++y) {
+			std::fill(m_depth.begin() + y * m_width + tileMinX, m_depth.begin() + y * m_width + tileMaxX + 1, 1.f);
+		}
+
+		for (unsigned int i = 0; i < m_triangles.size(); ++i) {
+			const ScreenTriangle& triangle = m_triangles[i];
+
+			if (triangle.maxX < tileMinX || triangle.minX > tileMaxX || triangle.maxY < tileMinY || triangle.minY > tileMaxY) { continue; }
+
+			RasterizeTriangle(triangle, std::max(triangle.minX, tileMinX), std::max(triangle.minY, tileMinY), std::min(triangle.maxX, tileMaxX), std::min(triangle.maxY, tileMaxY));
+		}
+
+		// Furthest depth of the tile, a box behind it is hidden in every pixel of the tile
+		__m128 maxDepth = _mm_setzero_ps();
+
+		for (int y = tileMinY; y <= tileMaxY; ++y) {
+			for (int x = tileMinX; x <= tileMaxX; x += 4) {
+				maxDepth = _mm_max_ps(maxDepth, _mm_loadu_ps(&m_depth[y * m_width + x]));
+			}
+		}
+
+		float lanes[4];
+		_mm_storeu_ps(lanes, maxDepth);
+		m_tileMaxDepth[a_tile] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	}
+
+	/**
+	*	@brief Write a triangle's depth into the pixels of a rectangle that it fully covers, keeping the nearest depth, 4 pixels at a time.
+	*	Coverage is inner-conservative and each pixel takes the triangle's furthest depth over the pixel, so the buffer is never in front of the occluder.
+	*	@param a_triangle is the counter-clockwise triangle to rasterize.
+	*	@param a_minX is the first column, rounded down to a multiple of 4.
+	*	@param a_minY is the first row.
+	*	@param a_maxX is the last column, groups of 4 may pass it but never leave the tile.
+	*	@param a_maxY is the last row.
+	*	@return void.
+	*/
+	void OcclusionCuller::RasterizeTriangle(const ScreenTriangle & a_triangle, int a_minX, int a_minY, int a_maxX, int a_maxY)
+	{
+		const float* x = a_triangle.x;
+		const float* y = a_triangle.y;
+		const float* z = a_triangle.z;
+
+		// Edge functions E(p) = A * p.x + B * p.y + C, positive on the inside of each edge of a counter-clockwise triangle
+		float edgeA[3], edgeB[3], edgeC[3];
+
+		for (unsigned int i = 0; i < 3; ++i) {
+			unsigned int next = (i + 1) % 3;
+
+			edgeA[i] = y[i] - y[next];
+			edgeB[i] = x[next] - x[i];
+			edgeC[i] = -(edgeA[i] * x[i] + edgeB[i] * y[i]);
+		}
+
+		// Depth plane z(p) = dzdx * p.x + dzdy * p.y + c
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		float dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+		float dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+		float depthC = z[0] - dzdx * x[0] - dzdy * y[0];
+
+		// Offsets from a pixel's center to its corner furthest outside each edge, and to its furthest depth
+		__m128 edgeBias0 = _mm_set1_ps(0.5f * (std::abs(edgeA[0]) + std::abs(edgeB[0])));
+		__m128 edgeBias1 = _mm_set1_ps(0.5f * (std::abs(edgeA[1]) + std::abs(edgeB[1])));
+		__m128 edgeBias2 = _mm_set1_ps(0.5f * (std::abs(edgeA[2]) + std::abs(edgeB[2])));
+		__m128 depthBias = _mm_set1_ps(0.5f * (std::abs(dzdx) + std::abs(dzdy)));
+
+		__m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);		// Pixel centers
+		__m128 zero = _mm_setzero_ps();
+
+		for (int py = a_minY; py <= a_maxY; ++py) {
+			float centerY = py + 0.5f;
+
+			// Per row constant parts, edges at the pixels' outermost corners and depth at their furthest point
+			__m128 rowEdge0 = _mm_sub_ps(_mm_set1_ps(edgeB[0] * centerY + edgeC[0]), edgeBias0);
+			__m128 rowEdge1 = _mm_sub_ps(_mm_set1_ps(edgeB[1] * centerY + edgeC[1]), edgeBias1);
+			__m128 rowEdge2 = _mm_sub_ps(_mm_set1_ps(edgeB[2] * centerY + edgeC[2]), edgeBias2);
+			__m128 rowDepth = _mm_add_ps(_mm_set1_ps(dzdy * centerY + depthC), depthBias);
+
+			float* row = &m_depth[py * m_width];
+
+			for (int px = a_minX & ~3; px <= a_maxX; px += 4) {
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)px), laneOffsets);
+
+				__m128 edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[0]), centerX), rowEdge0);
+				__m128 edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[1]), centerX), rowEdge1);
+				__m128 edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[2]), centerX), rowEdge2);
+
+				// Every corner of the pixel is inside every edge
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+				if (!_mm_movemask_ps(inside)) { continue; }
+
+				__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), centerX), rowDepth);
+				__m128 current = _mm_loadu_ps(&row[px]);
+
+				// Keep the nearest depth in the covered pixels
+				__m128 nearest = _mm_min_ps(current, depth);
+				_mm_storeu_ps(&row[px], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+			}
+		}
+	}
+}
\ No newline at end of file
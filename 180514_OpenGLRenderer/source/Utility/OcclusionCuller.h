@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Vertex.h"
+#include "AABB.h"
+
+#include <vector>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	/**
+	*	@brief Low resolution depth buffer rasterized on the CPU from a few occluder meshes, used to skip objects hidden behind them before they are submitted.
+	*	The buffer is split into tiles that are rasterized as separate jobs, each tile tests 4 pixels per SSE instruction against every triangle overlapping it.
+	*	Each tile also keeps its furthest depth, so a box behind every tile it covers is rejected without reading its pixels.
+	*	NOTE: Runs entirely on the CPU and makes no openGL calls. Occluders only write the pixels they fully cover, with their furthest depth over the pixel,
+	*	and boxes test every pixel they touch, so visible geometry is never hidden. Occluders thinner than a pixel are dropped and hide nothing.
+	*/
+	class OcclusionCuller {
+	public:
+		OcclusionCuller(unsigned int a_width, unsigned int a_height);
+		~OcclusionCuller();
+
+		void Begin(const glm::mat4& a_projectionView);
+		bool AddOccluder(const std::vector<Vertex>& a_verts, const std::vector<unsigned int>& a_indices, const glm::mat4& a_world,
+			unsigned int a_firstIndex = 0, unsigned int a_indexCount = 0);
+		void Rasterize();
+
+		bool IsVisible(const AABB& a_bounds) const;
+
+		unsigned int GetWidth() const { return m_width; }
+		unsigned int GetHeight() const { return m_height; }
+		unsigned int GetTriangleCount() const { return (unsigned int)m_triangles.size(); }
+		const std::vector<float>& GetDepth() const { return m_depth; }
+	protected:
+	private:
+		// Triangle in buffer space, x and y in pixels and z as depth in [0, 1]
+		struct ScreenTriangle {
+			float	x[3];
+			float	y[3];
+			float	z[3];
+			int		minX, minY, maxX, maxY;		// Pixel bounds, clamped to the buffer
+		};
+
+		void RasterizeTile(unsigned int a_tile);
+		void RasterizeTriangle(const ScreenTriangle& a_triangle, int a_minX, int a_minY, int a_maxX, int a_maxY);
+
+		unsigned int	m_width;
+		unsigned int	m_height;
+		unsigned int	m_tileCountX;
+		unsigned int	m_tileCountY;
+
+		glm::mat4		m_projectionView;
+
+		std::vector<float>			m_depth;			// Nearest occluder depth of each pixel, 1 where nothing was rasterized
+		std::vector<float>			m_tileMaxDepth;		// Furthest depth of each tile's pixels
+		std::vector<ScreenTriangle>	m_triangles;		// Occluder triangles of the frame, kept between frames to avoid re-allocating
+	};
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "PVSBaker.h"
+#include "Renderer_Utility_Literals.h"
+#include "JobSystem.h"
+#include "../Wrappers/StaticBatch.h"
+#include "../Wrappers/Mesh.h"
+#include "../Wrappers/VertexFormat.h"
+
+#include <glm/geometric.hpp>
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+namespace SPRON {
+	/// Static initialisation
+	static const unsigned int NO_HIT = ~0u;
+	static const unsigned int MAX_LEAF_TRIANGLES = 4;
+	static const unsigned int MAX_TRAVERSAL_DEPTH = 64;
+
+	static const float MIN_TRIANGLE_AREA = 1e-10f;		// Squared length of the edges' cross product, smaller triangles can't block rays
+	static const float RAY_EPSILON = 1e-4f;				// Hits closer than this to the ray's origin are ignored
+	static const float SAMPLE_INSET = 0.9f;				// Corner samples are pulled towards the cell's center so they aren't shared with neighbours
+
+	// Deterministic random numbers, so the same scene always bakes the same sets
+	static unsigned int NextRandom(unsigned int& a_state)
+	{
+		a_state ^= a_state << 13;
+		a_state ^= a_state >> 17;
+		a_state ^= a_state << 5;
+		return a_state;
+	}
+
+	static float NextRandomFloat(unsigned int& a_state)
+	{
+		return (NextRandom(a_state) >> 8) * (1.f / 16777216.f);
+	}
+
+	/**
+	*	@brief Gather the world space triangles of every sub-range of the static batches and build the triangle hierarchy.
+	*	@param a_batches is the static batches, objects are numbered by batch then by sub-range.
+	*/
+	PVSBaker::PVSBaker(const std::vector<StaticBatch*>& a_batches)
+	{
+		for (unsigned int i = 0; i < a_batches.size(); ++i) {
+			const std::vector<Vertex>& verts = a_batches[i]->GetMesh()->GetVerticeData();
+			const std::vector<unsigned int>& indices = a_batches[i]->GetMesh()->GetVertexFormat()->GetIndices();
+			const std::vector<StaticBatch::SubRange>& subRanges = a_batches[i]->GetSubRanges();
+
+			for (unsigned int j = 0; j < subRanges.size(); ++j) {
+				unsigned int object = (unsigned int)m_objectBounds.size();
+				unsigned int end = std::min(subRanges[j].firstIndex + subRanges[j].indexCount, (unsigned int)indices.size());
+
+				AABB bounds(subRanges[j].boundsCenter, subRanges[j].boundsCenter);
+				m_objectFirst.push_back((unsigned int)m_triangles.size());
+
+				for (unsigned int k = subRanges[j].firstIndex; k + 2 < end; k += 3) {
+					glm::vec3 a = glm::vec3(verts[indices[k]].pos);
+					glm::vec3 b = glm::vec3(verts[indices[k + 1]].pos);
+					glm::vec3 c = glm::vec3(verts[indices[k + 2]].pos);
+
+					Triangle triangle;
+					triangle.corner = a;
+					triangle.edge1 = b - a;
+					triangle.edge2 = c - a;
+					triangle.object = object;
+
+					glm::vec3 normal = glm::cross(triangle.edge1, triangle.edge2);
+					if (glm::dot(normal, normal) < MIN_TRIANGLE_AREA) { continue; }
+
+					bounds = AABB::Merge(bounds, AABB(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))));
+					m_triangles.push_back(triangle);
+				}
+
+				m_objectCounts.push_back((unsigned int)m_triangles.size() - m_objectFirst.back());
+				m_objectBounds.push_back(bounds);
+				m_sceneBounds = (object == 0 ? bounds : AABB::Merge(m_sceneBounds, bounds));
+			}
+		}
+
+		if (m_triangles.empty()) { return; }
+
+		m_nodeTriangles.resize(m_triangles.size());
+		for (unsigned int i = 0; i < m_nodeTriangles.size(); ++i) {
+			m_nodeTriangles[i] = i;
+		}
+
+		m_nodes.reserve(m_triangles.size() / MAX_LEAF_TRIANGLES * 2 + 1);
+		m_nodes.push_back(Node());
+		BuildNode(0, 0, (unsigned int)m_nodeTriangles.size());
+	}
+
+	PVSBaker::~PVSBaker()
+	{
+	}
+
+	/**
+	*	@brief Lay a grid over the static scene and find the objects visible from each of its cells.
+	*	The cell size is grown until the grid has no more than PVS_MAX_CELLS cells.
+	*	NOTE: Blocks until every cell is baked, cells are spread over the job system's workers.
+	*	@param a_cellSize is the requested size of the cells, set to the size that was used.
+	*	@param a_origin is set to the minimum corner of the grid.
+	*	@param a_dimensions is set to the number of cells along each axis.
+	*	@param a_cellBits is set to the bitset of visible objects of each cell, x fastest then z then y.
+	*	@return void.
+	*/
+	void PVSBaker::Bake(float& a_cellSize, glm::vec3& a_origin, glm::ivec3& a_dimensions, std::vector<std::vector<uint32_t>>& a_cellBits)
+	{
+		assert(a_cellSize > 0.f && "ERROR::PVS_BAKER::CELL_SIZE_NOT_POSITIVE");
+
+		glm::vec3 size = m_sceneBounds.max - m_sceneBounds.min;
+		for (;;) {
+			a_dimensions = glm::max(glm::ivec3(glm::ceil(size / a_cellSize)), glm::ivec3(1));
+			if ((unsigned int)(a_dimensions.x * a_dimensions.y * a_dimensions.z) <= PVS_MAX_CELLS) { break; }
+			a_cellSize *= 1.25f;
+		}
+
+		a_origin = m_sceneBounds.min;
+
+		unsigned int cellCount = a_dimensions.x * a_dimensions.y * a_dimensions.z;
+		unsigned int wordCount = (GetObjectCount() + 31) / 32;
+
+		a_cellBits.assign(cellCount, std::vector<uint32_t>(wordCount, 0));
+
+		glm::ivec3 dimensions = a_dimensions;
+		glm::vec3 origin = a_origin;
+		float cellSize = a_cellSize;
+
+		JobSystem::ParallelFor(cellCount, 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				glm::ivec3 cell(i % dimensions.x, i / (dimensions.x * dimensions.z), (i / dimensions.x) % dimensions.z);
+				glm::vec3 cellMin = origin + glm::vec3(cell) * cellSize;
+
+				BakeCell(AABB(cellMin, cellMin + glm::vec3(cellSize)), i * 2654435761u + 1, a_cellBits[i]);
+			}
+		});
+	}
+
+	/**
+	*	@brief Fill a node with the bounds of its triangles and split it at the median of the triangles' centers along its longest axis.
+	*	@param a_node is the index of the node, already allocated.
+	*	@param a_first is the first entry of m_nodeTriangles under the node.
+	*	@param a_count is the number of triangles under the node.
+	*	@return void.
+	*/
+	void PVSBaker::BuildNode(unsigned int a_node, unsigned int a_first, unsigned int a_count)
+	{
+		AABB bounds(m_triangles[m_nodeTriangles[a_first]].corner, m_triangles[m_nodeTriangles[a_first]].corner);
+		AABB centers = bounds;
+
+		for (unsigned int i = a_first; i < a_first + a_count; ++i) {
+			const Triangle& triangle = m_triangles[m_nodeTriangles[i]];
+			glm::vec3 b = triangle.corner + triangle.edge1;
+			glm::vec3 c = triangle.corner + triangle.edge2;
+
+			bounds = AABB::Merge(bounds, AABB(glm::min(triangle.corner, glm::min(b, c)), glm::max(triangle.corner, glm::max(b, c))));
+
+			glm::vec3 center = (triangle.corner + b + c) * (1.f / 3.f);
+			centers = AABB::Merge(centers, AABB(center, center));
+		}
+
+		m_nodes[a_node].bounds = bounds;
+
+		if (a_count <= MAX_LEAF_TRIANGLES) {
+			m_nodes[a_node].first = a_first;
+			m_nodes[a_node].count = a_count;
+			return;
+		}
+
+		glm::vec3 extents = centers.GetExtents();
+		int axis = (extents.x > extents.y ? (extents.x > extents.z ? 0 : 2) : (extents.y > extents.z ? 1 : 2));
+		unsigned int half = a_count / 2;
+
+		std::nth_element(m_nodeTriangles.begin() + a_first, m_nodeTriangles.begin() + a_first + half, m_nodeTriangles.begin() + a_first + a_count,
+			[this, axis](unsigned int a_lhs, unsigned int a_rhs) {
+			const Triangle& lhs = m_triangles[a_lhs];
+			const Triangle& rhs = m_triangles[a_rhs];
+			return (lhs.corner[axis] * 3.f + lhs.edge1[axis] + lhs.edge2[axis]) < (rhs.corner[axis] * 3.f + rhs.edge1[axis] + rhs.edge2[axis]);
+		});
+
+		unsigned int children = (unsigned int)m_nodes.size();
+		m_nodes.push_back(Node());
+		m_nodes.push_back(Node());
+
+		m_nodes[a_node].first = children;
+		m_nodes[a_node].count = 0;
+
+		BuildNode(children, a_first, half);
+		BuildNode(children + 1, a_first + half, a_count - half);
+	}
+
+	/**
+	*	@brief Find the closest triangle a ray hits, from either side.
+	*	NOTE: Reads the hierarchy only, so it can be called from any number of jobs.
+	*	@param a_origin is the world space start of the ray.
+	*	@param a_direction is the normalized direction of the ray.
+	*	@param a_maxDistance is the length of the ray.
+	*	@return the object of the closest triangle hit, NO_HIT if the ray hits nothing.
+	*/
+	unsigned int PVSBaker::CastRay(const glm::vec3& a_origin, const glm::vec3& a_direction, float a_maxDistance) const
+	{
+		if (m_nodes.empty()) { return NO_HIT; }
+
+		glm::vec3 inverseDirection = 1.f / a_direction;
+		float closest = a_maxDistance;
+		unsigned int hitObject = NO_HIT;
+
+		unsigned int stack[MAX_TRAVERSAL_DEPTH];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const Node& node = m_nodes[stack[--stackSize]];
+
+			// Slab test against the node's box, clipped to the closest hit so far
+			glm::vec3 t0 = (node.bounds.min - a_origin) * inverseDirection;
+			glm::vec3 t1 = (node.bounds.max - a_origin) * inverseDirection;
+			glm::vec3 tMin = glm::min(t0, t1);
+			glm::vec3 tMax = glm::max(t0, t1);
+			float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+			float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, closest));
+			if (enter > exit) { continue; }
+
+			if (node.count == 0) {
+				assert(stackSize + 2 <= MAX_TRAVERSAL_DEPTH && "ERROR::PVS_BAKER::TRAVERSAL_STACK_OVERFLOW");
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+				continue;
+			}
+
+			// Moller-Trumbore, without culling back faces
+			for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+				const Triangle& triangle = m_triangles[m_nodeTriangles[i]];
+
+				glm::vec3 p = glm::cross(a_direction, triangle.edge2);
+				float determinant = glm::dot(triangle.edge1, p);
+				if (std::fabs(determinant) < 1e-12f) { continue; }
+
+				float inverseDeterminant = 1.f / determinant;
+				glm::vec3 toOrigin = a_origin - triangle.corner;
+
+				float u = glm::dot(toOrigin, p) * inverseDeterminant;
+				if (u < 0.f || u > 1.f) { continue; }
+
+				glm::vec3 q = glm::cross(toOrigin, triangle.edge1);
+				float v = glm::dot(a_direction, q) * inverseDeterminant;
+				if (v < 0.f || u + v > 1.f) { continue; }
+
+				float t = glm::dot(triangle.edge2, q) * inverseDeterminant;
+				if (t > RAY_EPSILON && t < closest) {
+					closest = t;
+					hitObject = triangle.object;
+				}
+			}
+		}
+
+		return hitObject;
+	}
+
+	/**
+	*	@brief Find the objects visible from anywhere inside a cell.
+	*	Rays are cast from the cell's center, its corners and random points inside it to random points on each object's triangles,
+	*	an object is visible once a ray reaches it, or the first thing a ray hits is the object.
+	*	@param a_cell is the world space box of the cell.
+	*	@param a_seed is the seed of the cell's random numbers, never 0.
+	*	@param a_bits is the bitset of the cell's visible objects, sized for every object and cleared.
+	*	@return void.
+	*/
+	void PVSBaker::BakeCell(const AABB& a_cell, unsigned int a_seed, std::vector<uint32_t>& a_bits) const
+	{
+		unsigned int random = (a_seed == 0 ? 1 : a_seed);
+
+		glm::vec3 center = a_cell.GetCenter();
+		glm::vec3 extents = a_cell.GetExtents() * SAMPLE_INSET;
+
+		glm::vec3 samples[PVS_SAMPLES_PER_CELL];
+		for (unsigned int i = 0; i < PVS_SAMPLES_PER_CELL; ++i) {
+			if (i == 0) {
+				samples[i] = center;
+			}
+			else if (i <= 8) {
+				unsigned int corner = i - 1;
+				samples[i] = center + glm::vec3((corner & 1) ? extents.x : -extents.x, (corner & 2) ? extents.y : -extents.y, (corner & 4) ? extents.z : -extents.z);
+			}
+			else {
+				glm::vec3 offset(NextRandomFloat(random), NextRandomFloat(random), NextRandomFloat(random));
+				samples[i] = center + (offset * 2.f - 1.f) * extents;
+			}
+		}
+
+		for (unsigned int i = 0; i < m_objectBounds.size(); ++i) {
+			const AABB& bounds = m_objectBounds[i];
+
+			// Objects the cell touches are always visible from it
+			if (bounds.min.x <= a_cell.max.x && bounds.max.x >= a_cell.min.x &&
+				bounds.min.y <= a_cell.max.y && bounds.max.y >= a_cell.min.y &&
+				bounds.min.z <= a_cell.max.z && bounds.max.z >= a_cell.min.z) {
+				a_bits[i >> 5] |= 1u << (i & 31);
+				continue;
+			}
+
+			if (m_objectCounts[i] == 0) { continue; }
+
+			for (unsigned int j = 0; j < PVS_RAYS_PER_OBJECT; ++j) {
+				const Triangle& triangle = m_triangles[m_objectFirst[i] + NextRandom(random) % m_objectCounts[i]];
+
+				// Uniform point on the triangle, folding points outside it back in
+				float u = NextRandomFloat(random);
+				float v = NextRandomFloat(random);
+				if (u + v > 1.f) { u = 1.f - u; v = 1.f - v; }
+
+				const glm::vec3& origin = samples[j % PVS_SAMPLES_PER_CELL];
+				glm::vec3 toTarget = triangle.corner + triangle.edge1 * u + triangle.edge2 * v - origin;
+				float distance = glm::length(toTarget);
+				if (distance <= RAY_EPSILON) { continue; }
+
+				// Rays that miss the target through precision loss count as reaching it
+				unsigned int hitObject = CastRay(origin, toTarget / distance, distance * (1.f + RAY_EPSILON));
+				if (hitObject == NO_HIT || hitObject == i) {
+					a_bits[i >> 5] |= 1u << (i & 31);
+					break;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
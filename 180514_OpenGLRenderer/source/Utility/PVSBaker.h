@@ -0,0 +1,60 @@
+#pragma once
+
+#include "AABB.h"
+
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+
+namespace SPRON {
+	class StaticBatch;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Bakes the potentially visible sets of a grid over the static scene by casting rays on the CPU.
+	*	From sample points spread through each cell, rays are aimed at random points on every object's triangles, an object is visible from the cell
+	*	if any ray reaches it before hitting another object. Objects whose bounds touch a cell are always visible from it.
+	*	Triangles are kept in a bounding volume hierarchy built once for the bake, and cells are baked in parallel on the job system.
+	*	NOTE: Sampling can miss objects seen only through gaps smaller than the spacing of the rays, raise the ray count if objects pop in.
+	*/
+	class PVSBaker {
+	public:
+		PVSBaker(const std::vector<StaticBatch*>& a_batches);
+		~PVSBaker();
+
+		void Bake(float& a_cellSize, glm::vec3& a_origin, glm::ivec3& a_dimensions, std::vector<std::vector<uint32_t>>& a_cellBits);
+
+		unsigned int GetObjectCount() const { return (unsigned int)m_objectBounds.size(); }
+		unsigned int GetTriangleCount() const { return (unsigned int)m_triangles.size(); }
+	protected:
+	private:
+		// World space triangle, stored as a corner and its two edges for the intersection test
+		struct Triangle {
+			glm::vec3		corner;
+			glm::vec3		edge1;
+			glm::vec3		edge2;
+			unsigned int	object;
+		};
+
+		// Node of the triangle hierarchy
+		struct Node {
+			AABB			bounds;
+			unsigned int	first;		// First child for inner nodes (the second follows it), first entry of m_nodeTriangles for leaves
+			unsigned int	count;		// Triangles in a leaf, 0 for inner nodes
+		};
+
+		void BuildNode(unsigned int a_node, unsigned int a_first, unsigned int a_count);
+		unsigned int CastRay(const glm::vec3& a_origin, const glm::vec3& a_direction, float a_maxDistance) const;
+		void BakeCell(const AABB& a_cell, unsigned int a_seed, std::vector<uint32_t>& a_bits) const;
+
+		std::vector<Triangle>		m_triangles;		// Grouped by object
+		std::vector<unsigned int>	m_objectFirst;		// First triangle of each object
+		std::vector<unsigned int>	m_objectCounts;
+		std::vector<AABB>			m_objectBounds;
+
+		std::vector<Node>			m_nodes;			// Root first
+		std::vector<unsigned int>	m_nodeTriangles;	// Triangle indices ordered so each leaf's triangles are consecutive
+		AABB						m_sceneBounds;
+	};
+}
\ No newline at end of file
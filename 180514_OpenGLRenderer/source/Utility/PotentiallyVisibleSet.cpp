@@ -0,0 +1,408 @@
+#include "PotentiallyVisibleSet.h"
+#include "PVSBaker.h"
+#include "Renderer_Utility_Literals.h"
+#include "../Wrappers/StaticBatch.h"
+
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+#include <assert.h>
+#include <string.h>
+#include <map>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace SPRON {
+	/// Static initialisation
+	static const uint32_t FILE_MAGIC = 0x31535650;		// "PVS1"
+	static const uint32_t FILE_VERSION = 1;
+
+	static const unsigned int MAX_RUN_LENGTH = 128;		// Words in one run of the encoded data
+	static const uint8_t LITERAL_RUN = 0x80;			// Set in a run's header if its words follow it, otherwise the words are all zero
+
+	// Start of a baked sets file, followed by the cells' set indices, the set offsets and the encoded sets
+	struct PVSFileHeader {
+		uint32_t	magic;
+		uint32_t	version;
+		uint64_t	sceneHash;
+		float		origin[3];
+		float		cellSize;
+		int32_t		dimensions[3];
+		uint32_t	objectCount;
+		uint32_t	setCount;
+		uint32_t	dataSize;
+	};
+
+	PotentiallyVisibleSet::PotentiallyVisibleSet() :
+		m_objectCount(0), m_sceneHash(0), m_origin(0.f), m_cellSize(0.f), m_dimensions(0),
+		m_selectedSet(NO_SET), m_selectedCount(0), m_bakeTime(0.f)
+	{
+	}
+
+	PotentiallyVisibleSet::~PotentiallyVisibleSet()
+	{
+	}
+
+	/**
+	*	@brief Bake the sets of the static batches, replacing any sets that were loaded or baked before.
+	*	NOTE: Casts rays on the job system's workers and blocks until they finish, which can take seconds, so sets should be saved once baked.
+	*	@param a_batches is the static batches the sets are for, their sub-ranges are the objects.
+	*	@param a_cellSize is the requested size of the grid's cells, grown if the grid would have more than PVS_MAX_CELLS cells.
+	*	@return void.
+	*/
+	void PotentiallyVisibleSet::Bake(const std::vector<StaticBatch*>& a_batches, float a_cellSize)
+	{
+		auto bakeStart = std::chrono::high_resolution_clock::now();
+
+		SetBatches(a_batches);
+		m_sceneHash = HashScene(a_batches);
+
+		glm::vec3 origin;
+		glm::ivec3 dimensions;
+		std::vector<std::vector<uint32_t>> cellBits;
+
+		PVSBaker baker(a_batches);
+		baker.Bake(a_cellSize, origin, dimensions, cellBits);
+
+		Build(origin, a_cellSize, dimensions, cellBits);
+
+		m_bakeTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - bakeStart).count();
+	}
+
+	/**
+	*	@brief Load sets saved by Save, if they were baked from the same static batches.
+	*	@param a_filePath is the path of the file.
+	*	@param a_batches is the static batches the sets should be for.
+	*	@return true if the sets were loaded, false if the file is missing, damaged or was baked from a different scene.
+	*/
+	bool PotentiallyVisibleSet::Load(const char* a_filePath, const std::vector<StaticBatch*>& a_batches)
+	{
+		std::ifstream file(a_filePath, std::ios::binary);
+		if (!file.is_open()) { return false; }
+
+		try {
+			char errorMsg[512];
+
+			PVSFileHeader header;
+			if (!file.read((char*)&header, sizeof(header)) || header.magic != FILE_MAGIC || header.version != FILE_VERSION) {
+				sprintf_s(errorMsg, "ERROR::PVS::UNKNOWN_FILE_FORMAT: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			// NOTE: Counted without SetBatches, nothing is changed until the whole file is validated
+			unsigned int objectCount = 0;
+			for (unsigned int i = 0; i < a_batches.size(); ++i) {
+				objectCount += (unsigned int)a_batches[i]->GetSubRanges().size();
+			}
+
+			if (header.sceneHash != HashScene(a_batches) || header.objectCount != objectCount) {
+				sprintf_s(errorMsg, "ERROR::PVS::STALE_FILE: %s \nDescription: The sets were baked from a different scene and will be baked again.", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			// Each dimension is checked before multiplying so the cell count can't overflow, the baker never makes more than PVS_MAX_CELLS cells
+			glm::ivec3 dimensions(header.dimensions[0], header.dimensions[1], header.dimensions[2]);
+			if (dimensions.x <= 0 || dimensions.y <= 0 || dimensions.z <= 0 ||
+				dimensions.x > PVS_MAX_CELLS || dimensions.y > PVS_MAX_CELLS || dimensions.z > PVS_MAX_CELLS || header.cellSize <= 0.f) {
+				sprintf_s(errorMsg, "ERROR::PVS::INVALID_GRID: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			uint64_t cellCount = (uint64_t)dimensions.x * (uint64_t)dimensions.y * (uint64_t)dimensions.z;		// NOTE: Up to 2^36, too big for a 32 bit size_t
+
+			// Every cell points at one set, so there are never more sets than cells
+			if (cellCount > PVS_MAX_CELLS || header.setCount == 0 || header.setCount > cellCount) {
+				sprintf_s(errorMsg, "ERROR::PVS::INVALID_GRID: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			// The arrays must fill the rest of the file exactly, checked before anything is allocated for them
+			std::streamoff headerEnd = file.tellg();
+			file.seekg(0, std::ios::end);
+			std::streamoff arraysSize = file.tellg() - headerEnd;
+			file.seekg(headerEnd);
+
+			if (arraysSize != (std::streamoff)(sizeof(uint32_t) * (cellCount + header.setCount + 1) + header.dataSize)) {
+				sprintf_s(errorMsg, "ERROR::PVS::DAMAGED_FILE: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			m_cellSets.resize((size_t)cellCount);
+			m_setOffsets.resize(header.setCount + 1);
+			m_setData.resize(header.dataSize);
+
+			file.read((char*)m_cellSets.data(), m_cellSets.size() * sizeof(uint32_t));
+			file.read((char*)m_setOffsets.data(), m_setOffsets.size() * sizeof(uint32_t));
+			file.read((char*)m_setData.data(), m_setData.size());
+
+			bool isValid = !file.fail() && m_setOffsets.front() == 0 && m_setOffsets.back() == header.dataSize &&
+				std::is_sorted(m_setOffsets.begin(), m_setOffsets.end()) &&
+				std::all_of(m_cellSets.begin(), m_cellSets.end(), [&header](uint32_t a_set) { return a_set < header.setCount; });
+
+			if (!isValid) {
+				sprintf_s(errorMsg, "ERROR::PVS::DAMAGED_FILE: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+
+			SetBatches(a_batches);
+
+			m_sceneHash = header.sceneHash;
+			m_origin = glm::vec3(header.origin[0], header.origin[1], header.origin[2]);
+			m_cellSize = header.cellSize;
+			m_dimensions = dimensions;
+			m_bakeTime = 0.f;
+
+			m_selected.assign((m_objectCount + 31) / 32, 0);
+			m_selectedSet = NO_SET;
+			m_selectedCount = 0;
+		}
+		catch (std::exception const& e) {
+			std::cout << "Exception: " << e.what() << std::endl;
+
+			m_cellSets.clear();
+			m_setOffsets.clear();
+			m_setData.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	/**
+	*	@brief Save the baked sets so later runs can load them instead of baking.
+	*	@param a_filePath is the path of the file, overwritten if it exists.
+	*	@return true if the file was written.
+	*/
+	bool PotentiallyVisibleSet::Save(const char* a_filePath) const
+	{
+		assert(IsBaked() && "ERROR::PVS::SAVED_BEFORE_BAKE");
+
+		try {
+			std::ofstream file(a_filePath, std::ios::binary | std::ios::trunc);
+
+			PVSFileHeader header;
+			header.magic = FILE_MAGIC;
+			header.version = FILE_VERSION;
+			header.sceneHash = m_sceneHash;
+			header.origin[0] = m_origin.x; header.origin[1] = m_origin.y; header.origin[2] = m_origin.z;
+			header.cellSize = m_cellSize;
+			header.dimensions[0] = m_dimensions.x; header.dimensions[1] = m_dimensions.y; header.dimensions[2] = m_dimensions.z;
+			header.objectCount = m_objectCount;
+			header.setCount = GetSetCount();
+			header.dataSize = (uint32_t)m_setData.size();
+
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)m_cellSets.data(), m_cellSets.size() * sizeof(uint32_t));
+			file.write((const char*)m_setOffsets.data(), m_setOffsets.size() * sizeof(uint32_t));
+			file.write((const char*)m_setData.data(), m_setData.size());
+
+			if (!file) {
+				char errorMsg[512];
+				sprintf_s(errorMsg, "ERROR::PVS::FAILED_TO_WRITE: %s", a_filePath);
+				throw std::runtime_error(errorMsg);
+			}
+		}
+		catch (std::exception const& e) {
+			std::cout << "Exception: " << e.what() << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	/**
+	*	@brief Decode the set of the cell a position is in, so IsVisible answers for that cell.
+	*	NOTE: Only decodes when the position moves into a cell with a different set.
+	*	@param a_position is the world space position of the viewer.
+	*	@return false if the position is outside the grid, no set is selected and nothing should be culled by it.
+	*/
+	bool PotentiallyVisibleSet::Select(const glm::vec3& a_position)
+	{
+		if (!IsBaked()) { return false; }
+
+		glm::vec3 cellPosition = glm::floor((a_position - m_origin) / m_cellSize);
+		if (glm::any(glm::lessThan(cellPosition, glm::vec3(0.f))) || glm::any(glm::greaterThanEqual(cellPosition, glm::vec3(m_dimensions)))) {
+			m_selectedSet = NO_SET;
+			return false;
+		}
+
+		glm::ivec3 cell(cellPosition);
+		uint32_t set = m_cellSets[cell.x + m_dimensions.x * (cell.z + m_dimensions.z * cell.y)];
+		if (set == m_selectedSet) { return true; }
+
+		Decode(m_setData.data() + m_setOffsets[set], m_setData.data() + m_setOffsets[set + 1], m_selected);
+
+		m_selectedSet = set;
+		m_selectedCount = 0;
+		for (unsigned int i = 0; i < m_selected.size(); ++i) {
+			for (uint32_t word = m_selected[i]; word != 0; word &= word - 1) {
+				++m_selectedCount;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	*	@brief Find a static batch's position among the batches the sets were baked or loaded for.
+	*	@param a_batch is the batch to find.
+	*	@return the index to pass to GetFirstObject, -1 if the sets don't cover the batch.
+	*/
+	int PotentiallyVisibleSet::FindBatch(const StaticBatch* a_batch) const
+	{
+		auto found = std::find(m_batches.begin(), m_batches.end(), a_batch);
+		return (found == m_batches.end() ? -1 : (int)(found - m_batches.begin()));
+	}
+
+	/**
+	*	@brief Hash the layout of the static batches, so sets baked from a different scene are not loaded.
+	*	@param a_batches is the static batches to hash.
+	*	@return FNV-1a hash of the batches' sub-ranges and their bounds.
+	*/
+	uint64_t PotentiallyVisibleSet::HashScene(const std::vector<StaticBatch*>& a_batches)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		auto hashValue = [&hash](uint32_t a_value) {
+			for (unsigned int i = 0; i < 4; ++i) {
+				hash = (hash ^ ((a_value >> (i * 8)) & 0xFF)) * 1099511628211ull;
+			}
+		};
+
+		hashValue((uint32_t)a_batches.size());
+		for (unsigned int i = 0; i < a_batches.size(); ++i) {
+			const std::vector<StaticBatch::SubRange>& subRanges = a_batches[i]->GetSubRanges();
+
+			hashValue((uint32_t)subRanges.size());
+			for (unsigned int j = 0; j < subRanges.size(); ++j) {
+				hashValue(subRanges[j].firstIndex);
+				hashValue(subRanges[j].indexCount);
+
+				// Bounds are quantized to centimetres so rounding differences between builds don't change the hash
+				hashValue((uint32_t)(int32_t)std::round(subRanges[j].boundsCenter.x * 100.f));
+				hashValue((uint32_t)(int32_t)std::round(subRanges[j].boundsCenter.y * 100.f));
+				hashValue((uint32_t)(int32_t)std::round(subRanges[j].boundsCenter.z * 100.f));
+				hashValue((uint32_t)(int32_t)std::round(subRanges[j].boundsRadius * 100.f));
+			}
+		}
+
+		return hash;
+	}
+
+	/**
+	*	@brief Number the objects of the static batches, by batch then by sub-range.
+	*	@param a_batches is the static batches.
+	*	@return void.
+	*/
+	void PotentiallyVisibleSet::SetBatches(const std::vector<StaticBatch*>& a_batches)
+	{
+		m_batches.assign(a_batches.begin(), a_batches.end());
+		m_batchOffsets.resize(a_batches.size());
+		m_objectCount = 0;
+
+		for (unsigned int i = 0; i < a_batches.size(); ++i) {
+			m_batchOffsets[i] = m_objectCount;
+			m_objectCount += (unsigned int)a_batches[i]->GetSubRanges().size();
+		}
+	}
+
+	/**
+	*	@brief Store each distinct bitset of the cells once, encoded, and point the cells at them.
+	*	@param a_origin is the minimum corner of the grid.
+	*	@param a_cellSize is the size of the cells.
+	*	@param a_dimensions is the number of cells along each axis.
+	*	@param a_cellBits is the bitset of visible objects of each cell, x fastest then z then y.
+	*	@return void.
+	*/
+	void PotentiallyVisibleSet::Build(const glm::vec3& a_origin, float a_cellSize, const glm::ivec3& a_dimensions, const std::vector<std::vector<uint32_t>>& a_cellBits)
+	{
+		m_origin = a_origin;
+		m_cellSize = a_cellSize;
+		m_dimensions = a_dimensions;
+
+		m_cellSets.resize(a_cellBits.size());
+		m_setOffsets.assign(1, 0);
+		m_setData.clear();
+
+		std::map<std::vector<uint32_t>, uint32_t> sets;
+		for (unsigned int i = 0; i < a_cellBits.size(); ++i) {
+			auto found = sets.find(a_cellBits[i]);
+			if (found != sets.end()) {
+				m_cellSets[i] = found->second;
+				continue;
+			}
+
+			uint32_t set = (uint32_t)sets.size();
+			sets.emplace(a_cellBits[i], set);
+
+			Encode(a_cellBits[i], m_setData);
+			m_setOffsets.push_back((uint32_t)m_setData.size());
+			m_cellSets[i] = set;
+		}
+
+		m_selected.assign((m_objectCount + 31) / 32, 0);
+		m_selectedSet = NO_SET;
+		m_selectedCount = 0;
+	}
+
+	/**
+	*	@brief Run length encode a bitset as runs of zero words and runs of literal words, each run starting with a header byte.
+	*	Objects hidden from a cell are usually grouped in batches, so long runs of zero words are common.
+	*	@param a_bits is the bitset to encode.
+	*	@param a_data is the encoded data, the bitset is appended to it.
+	*	@return void.
+	*/
+	void PotentiallyVisibleSet::Encode(const std::vector<uint32_t>& a_bits, std::vector<uint8_t>& a_data)
+	{
+		unsigned int i = 0;
+		while (i < a_bits.size()) {
+			unsigned int runEnd = i;
+			bool isZeroRun = (a_bits[i] == 0);
+
+			while (runEnd < a_bits.size() && runEnd - i < MAX_RUN_LENGTH && (a_bits[runEnd] == 0) == isZeroRun) {
+				++runEnd;
+			}
+
+			a_data.push_back((uint8_t)((runEnd - i - 1) | (isZeroRun ? 0 : LITERAL_RUN)));
+
+			if (!isZeroRun) {
+				const uint8_t* words = (const uint8_t*)(a_bits.data() + i);
+				a_data.insert(a_data.end(), words, words + (runEnd - i) * sizeof(uint32_t));
+			}
+
+			i = runEnd;
+		}
+	}
+
+	/**
+	*	@brief Decode a bitset written by Encode.
+	*	@param a_data is the start of the encoded bitset.
+	*	@param a_end is the end of the encoded bitset.
+	*	@param a_bits is the decoded bitset, already sized for every object.
+	*	@return void.
+	*/
+	void PotentiallyVisibleSet::Decode(const uint8_t* a_data, const uint8_t* a_end, std::vector<uint32_t>& a_bits)
+	{
+		unsigned int word = 0;
+		while (a_data < a_end && word < a_bits.size()) {
+			uint8_t runHeader = *a_data++;
+			unsigned int runLength = std::min((unsigned int)(runHeader & ~LITERAL_RUN) + 1, (unsigned int)a_bits.size() - word);
+
+			if (runHeader & LITERAL_RUN) {
+				runLength = std::min(runLength, (unsigned int)(a_end - a_data) / (unsigned int)sizeof(uint32_t));
+				memcpy(a_bits.data() + word, a_data, runLength * sizeof(uint32_t));
+				a_data += runLength * sizeof(uint32_t);
+			}
+			else {
+				std::fill(a_bits.begin() + word, a_bits.begin() + word + runLength, 0);
+			}
+
+			word += runLength;
+		}
+
+		assert(word == a_bits.size() && "ERROR::PVS::SET_SIZE_MISMATCH");
+		std::fill(a_bits.begin() + word, a_bits.end(), 0);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+
+namespace SPRON {
+	class StaticBatch;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Precomputed sets of the static geometry visible from each cell of a grid over the static scene, baked once by PVSBaker.
+	*	Every sub-range of every static batch is an object, each cell stores a bitset of the objects visible from anywhere inside it.
+	*	Neighbouring cells usually see the same objects, so each distinct bitset is stored once and run length encoded, cells only store its index.
+	*	NOTE: Sets are only valid for the static batches they were baked from, a scene hash is stored with them so stale files are rejected.
+	*/
+	class PotentiallyVisibleSet {
+	public:
+		PotentiallyVisibleSet();
+		~PotentiallyVisibleSet();
+
+		void Bake(const std::vector<StaticBatch*>& a_batches, float a_cellSize);
+		bool Load(const char* a_filePath, const std::vector<StaticBatch*>& a_batches);
+		bool Save(const char* a_filePath) const;
+
+		bool Select(const glm::vec3& a_position);
+
+		int FindBatch(const StaticBatch* a_batch) const;
+		unsigned int GetFirstObject(int a_batch) const { return m_batchOffsets[a_batch]; }
+		bool IsVisible(unsigned int a_object) const { return (m_selected[a_object >> 5] >> (a_object & 31)) & 1; }
+
+		bool IsSelected() const { return m_selectedSet != NO_SET; }
+		bool IsBaked() const { return !m_cellSets.empty(); }
+		unsigned int GetObjectCount() const { return m_objectCount; }
+		unsigned int GetCellCount() const { return (unsigned int)m_cellSets.size(); }
+		unsigned int GetSetCount() const { return (m_setOffsets.empty() ? 0 : (unsigned int)m_setOffsets.size() - 1); }
+		unsigned int GetCompressedSize() const { return (unsigned int)m_setData.size(); }
+		unsigned int GetSelectedCount() const { return m_selectedCount; }
+		float GetBakeTime() const { return m_bakeTime; }
+
+		static uint64_t HashScene(const std::vector<StaticBatch*>& a_batches);
+	protected:
+	private:
+		static const uint32_t NO_SET = ~0u;
+
+		void SetBatches(const std::vector<StaticBatch*>& a_batches);
+		void Build(const glm::vec3& a_origin, float a_cellSize, const glm::ivec3& a_dimensions, const std::vector<std::vector<uint32_t>>& a_cellBits);
+
+		static void Encode(const std::vector<uint32_t>& a_bits, std::vector<uint8_t>& a_data);
+		static void Decode(const uint8_t* a_data, const uint8_t* a_end, std::vector<uint32_t>& a_bits);
+
+		// Objects
+		std::vector<const StaticBatch*>	m_batches;
+		std::vector<unsigned int>		m_batchOffsets;		// Object index of each batch's first sub-range
+		unsigned int					m_objectCount;
+		uint64_t						m_sceneHash;
+
+		// Grid
+		glm::vec3		m_origin;			// Minimum corner of the first cell
+		float			m_cellSize;
+		glm::ivec3		m_dimensions;		// Cells along each axis
+
+		// Sets
+		std::vector<uint32_t>	m_cellSets;		// Index of each cell's set, x fastest then z then y
+		std::vector<uint32_t>	m_setOffsets;	// Start of each set in the encoded data, with the end of the last set appended
+		std::vector<uint8_t>	m_setData;		// Run length encoded bitsets
+
+		// Selection
+		uint32_t				m_selectedSet;		// Set decoded into the selected bits, NO_SET if the position is outside the grid
+		std::vector<uint32_t>	m_selected;
+		unsigned int			m_selectedCount;
+
+		float	m_bakeTime;		// Seconds the last bake took, 0 if the sets were loaded
+	};
+}
\ No newline at end of file
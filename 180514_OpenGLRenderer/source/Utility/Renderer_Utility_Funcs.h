@@ -4,6 +4,7 @@
 #include "Renderer_Utility_Literals.h"
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <assert.h>
 #include <iostream>
@@ -12,6 +13,9 @@
 #include <glm/vec4.hpp>
 #include <glm/mat2x2.hpp>
 #include <glm/mat4x2.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
 
 namespace RendererUtility {
 
@@ -129,4 +133,88 @@ namespace RendererUtility {
 		a_vert2.normalTangent = tangent;
 		a_vert3.normalTangent = tangent;
 	}
+	/**
+	*	@brief Find the smallest axis aligned box that encloses a set of vertices.
+	*	@param a_verts is the vertices to enclose.
+	*	@param a_min is the minimum corner of the box to output to, the origin if there are no vertices.
+	*	@param a_max is the maximum corner of the box to output to, the origin if there are no vertices.
+	*	@return void.
+	*/
+	inline void CalculateBoundingBox(const std::vector<SPRON::Vertex>& a_verts, glm::vec3& a_min, glm::vec3& a_max) {
+		a_min = glm::vec3(0.f);
+		a_max = glm::vec3(0.f);
+
+		if (a_verts.empty()) { return; }
+
+		a_min = glm::vec3(a_verts[0].pos);
+		a_max = a_min;
+
+		for (unsigned int i = 1; i < a_verts.size(); ++i) {
+			a_min = glm::min(a_min, glm::vec3(a_verts[i].pos));
+			a_max = glm::max(a_max, glm::vec3(a_verts[i].pos));
+		}
+	}
+
+	/**
+	*	@brief Fit a sphere around a set of vertices, centered on their bounding box.
+	*	@param a_verts is the vertices to enclose.
+	*	@param a_center is the center of the sphere to output to.
+	*	@param a_radius is the radius of the sphere to output to, 0 if there are no vertices.
+	*	@return void.
+	*/
+	inline void CalculateBoundingSphere(const std::vector<SPRON::Vertex>& a_verts, glm::vec3& a_center, float& a_radius) {
+		a_center = glm::vec3(0.f);
+		a_radius = 0.f;
+
+		if (a_verts.empty()) { return; }
+
+		glm::vec3 minPos, maxPos;
+		CalculateBoundingBox(a_verts, minPos, maxPos);
+
+		a_center = (minPos + maxPos) * 0.5f;
+
+		for (unsigned int i = 0; i < a_verts.size(); ++i) {
+			a_radius = glm::max(a_radius, glm::length(glm::vec3(a_verts[i].pos) - a_center));
+		}
+	}
+
+	/**
+	*	@brief Extract the six clipping planes of a projection view matrix, pointing inwards and normalized so distances are in world units.
+	*	@param a_projectionView is the projection matrix multiplied by the view matrix.
+	*	@param a_planes is the array of 6 planes to output to, xyz = normal and w = distance (left, right, bottom, top, near, far).
+	*	@return void.
+	*/
+	inline void ExtractFrustumPlanes(const glm::mat4& a_projectionView, glm::vec4 a_planes[6]) {
+		// Rows of the matrix (NOTE: glm is column major)
+		glm::vec4 row0 = glm::vec4(a_projectionView[0][0], a_projectionView[1][0], a_projectionView[2][0], a_projectionView[3][0]);
+		glm::vec4 row1 = glm::vec4(a_projectionView[0][1], a_projectionView[1][1], a_projectionView[2][1], a_projectionView[3][1]);
+		glm::vec4 row2 = glm::vec4(a_projectionView[0][2], a_projectionView[1][2], a_projectionView[2][2], a_projectionView[3][2]);
+		glm::vec4 row3 = glm::vec4(a_projectionView[0][3], a_projectionView[1][3], a_projectionView[2][3], a_projectionView[3][3]);
+
+		a_planes[0] = row3 + row0;
+		a_planes[1] = row3 - row0;
+		a_planes[2] = row3 + row1;
+		a_planes[3] = row3 - row1;
+		a_planes[4] = row3 + row2;
+		a_planes[5] = row3 - row2;
+
+		for (unsigned int i = 0; i < 6; ++i) {
+			a_planes[i] /= glm::length(glm::vec3(a_planes[i]));
+		}
+	}
+
+	/**
+	*	@brief Check whether a bounding sphere is at least partly inside a frustum.
+	*	@param a_planes is the 6 planes of the frustum, from ExtractFrustumPlanes.
+	*	@param a_center is the world space center of the sphere.
+	*	@param a_radius is the world space radius of the sphere.
+	*	@return false if the sphere is entirely outside any plane.
+	*/
+	inline bool IsSphereInFrustum(const glm::vec4 a_planes[6], const glm::vec3& a_center, float a_radius) {
+		for (unsigned int i = 0; i < 6; ++i) {
+			if (glm::dot(glm::vec3(a_planes[i]), a_center) + a_planes[i].w < -a_radius) { return false; }
+		}
+
+		return true;
+	}
 }
\ No newline at end of file
@@ -19,6 +19,51 @@
 
 #define BLEND_POST_PROCESSING true
 #define BLEND_RENDERING true
+#define USE_RENDER_QUEUE true
+#define USE_MULTI_DRAW_INDIRECT true
+#define USE_PARALLEL_RECORDING true
+#define OBJECT_UNIFORM_RING_SIZE (16 * 1024 * 1024)
+#define DYNAMIC_STREAM_SIZE (4 * 1024 * 1024)
+#define STREAM_BUFFER_FRAMES 3
+#define GEOMETRY_DEFRAG_BYTES_PER_FRAME (256 * 1024)
+#define JOB_WORKER_COUNT -1
+#define JOB_BATCH_SIZE 512
+#define USE_PIPELINED_SIMULATION false
+#define FRAME_ARENA_SIZE (256 * 1024)
+#define ASSERT_FRAME_ALLOCATIONS false
+#define ALLOCATION_WARMUP_FRAMES 120
+#define AABB_TREE_MARGIN 0.1f
+#define USE_OCCLUSION_CULLING true
+#define OCCLUSION_BUFFER_WIDTH 256
+#define OCCLUSION_BUFFER_HEIGHT 128
+#define OCCLUSION_MAX_OCCLUDERS 32
+#define OCCLUSION_MAX_OCCLUDER_TRIANGLES 4096
+#define OCCLUSION_MAX_TRIANGLES 16384
+#define USE_GPU_CULLING true
+#define USE_DEPTH_PREPASS true
+#define USE_PVS true
+#define PVS_FILE_PATH "./models/scene.pvs"
+#define PVS_CELL_SIZE 4.f
+#define PVS_MAX_CELLS 4096
+#define PVS_SAMPLES_PER_CELL 8
+#define PVS_RAYS_PER_OBJECT 32
+#define USE_VISIBILITY_BUFFER false
+#define VIS_MAX_LIGHTS 8
+#define USE_SHADOWS true
+#define SHADOW_ATLAS_SIZE 4096
+#define SHADOW_MAX_TILE_SIZE 1024
+#define SHADOW_MIN_TILE_SIZE 128
+#define SHADOW_LEVEL_HYSTERESIS 0.25f
+#define SHADOW_UPDATE_BUDGET (4 * 1024 * 1024)
+#define SHADOW_CASCADE_COUNT 3
+#define SHADOW_CASCADE_LAMBDA 0.75f
+#define SHADOW_CASCADE_SNAP 0.125f
+#define SHADOW_DISTANCE 60.f
+#define SHADOW_DIR_CASTER_EXTENT 50.f
+#define SHADOW_SPOT_RANGE 30.f
+#define SHADOW_NEAR_PLANE 0.1f
+#define SHADOW_SLOPE_BIAS 2.f
+#define SHADOW_CONSTANT_BIAS 4.f
 
 #define DEFAULT_CLEAR_COLOR 0.01f, 0.01f, 0.015f, 1
 #define DEFAULT_GLOBAL_AMBIENT glm::vec4(0.01f, 0.01f, 0.01f, 1)
@@ -35,6 +80,11 @@
 #define DEFAULT_LIGHT_POS2 glm::vec4(1.5f, 3.f, -4.f, 1.f)
 #define DEFAULT_LIGHT_DIR glm::vec4(0.f, -1.f, 1.f, 0.f)
 #define DEFAULT_CUBE_NUM 0
+#define DEFAULT_CROWD_NUM 0
+#define USE_INSTANCED_CUBES true
+#define BENCHMARK_MAX_CUBE_NUM 100000
+#define BENCHMARK_SCENE_LAYOUT false
+#define BENCHMARK_SCENE_LAYOUT_ITERATIONS 50
 #define DEFAULT_MIN_ILLUMINATION 0.001f
 #define SKY_COLOR glm::vec4(64.f / 255, 156.f / 255, 255.f / 255, 1.f)
 
@@ -48,6 +98,7 @@ namespace SPRON {
 	enum eShaderType {
 		FRAG_SHADER,
 		VERT_SHADER,
-		GEOMETRY_SHADER
+		GEOMETRY_SHADER,
+		COMPUTE_SHADER
 	};
 }
\ No newline at end of file
@@ -1,17 +1,18 @@
 #include "Transform.h"
-#include <glm/ext.hpp>
+#include "TransformHierarchy.h"
 
 namespace SPRON {
 
 	Transform::Transform(Transform* a_parentTransform, const glm::vec3& a_pos, const glm::vec3& a_scale, const glm::vec3& a_rot) :
-		m_position(a_pos), m_scale(a_scale), m_rotation(a_rot), m_parentTransform(a_parentTransform)
+		m_position(a_pos), m_scale(a_scale), m_rotation(a_rot)
 	{
 		/// Variable initialisation
-		ReconstructMatrix();
+		m_index = TransformHierarchy::Add(this, a_parentTransform ? a_parentTransform->m_index : TransformHierarchy::NO_PARENT);
 	}
 
 	Transform::~Transform()
 	{
+		TransformHierarchy::Remove(m_index);
 	}
 
 	const glm::vec3 & Transform::GetPosition()
@@ -23,7 +24,7 @@ namespace SPRON {
 	{
 		m_position = a_pos;				// Store value to avoid needing to decompose matrix
 
-		ReconstructMatrix();
+		TransformHierarchy::MarkDirty(m_index);
 	}
 
 	const glm::vec3 & Transform::GetScale()
@@ -35,7 +36,7 @@ namespace SPRON {
 	{
 		m_scale = a_scale;				// Store value to avoid needing to decompose matrix
 
-		ReconstructMatrix();
+		TransformHierarchy::MarkDirty(m_index);
 	}
 
 	const glm::vec3 & Transform::GetRotation()
@@ -47,79 +48,56 @@ namespace SPRON {
 	{
 		m_rotation = a_rotation;		// Store value to avoid needing to decompose matrix
 
-		ReconstructMatrix();
-	}
-
-	const glm::mat4 & Transform::GetMatrix()
-	{
-		return m_transformMatrix;
+		TransformHierarchy::MarkDirty(m_index);
 	}
 
 	/**
-	*	@brief Recursively travel through the current transform's parents to determine its global transform matrix.
-	*	@return Calculated global transform matrix.
+	*	@brief Get the transform's matrix relative to its parent.
+	*	@return Local transform matrix.
 	*/
-	glm::mat4 Transform::RecurCalculateGlobalMatrix()
+	const glm::mat4 & Transform::GetMatrix()
 	{
-		if (m_parentTransform == nullptr) {		// No parent found, return regular transform matrix
-			return m_transformMatrix;
-		}
-
-		return m_parentTransform->RecurCalculateGlobalMatrix() * m_transformMatrix;		// Calculate global matrix of current transform by timesing its parent's global matrix by its own local transform
+		return TransformHierarchy::GetLocalMatrix(m_index);
 	}
 
 	/**
-	*	@brief Calculate and return global transform matrix.
+	*	@brief Get the transform's matrix in world space, cached by the transform hierarchy until it or a parent changes.
 	*	@return Global transform matrix for this transform.
 	**/
-	glm::mat4 Transform::GetGlobalMatrix()
+	const glm::mat4 & Transform::GetGlobalMatrix()
 	{
-		if (m_parentTransform == nullptr) {		// No parent found, return local transform
-			return m_transformMatrix;
-		}
+		return TransformHierarchy::GetWorldMatrix(m_index);
+	}
 
-		return m_parentTransform->RecurCalculateGlobalMatrix() * m_transformMatrix;		// Global matrix = global matrix of parent * local matrix
+	/**
+	*	@brief Get the global matrix as of the last transform hierarchy publish, read by rendering so it never sees a transform the simulation is part way through changing.
+	*	@return published global matrix.
+	*/
+	const glm::mat4 & Transform::GetPublishedMatrix() const
+	{
+		return TransformHierarchy::GetPublishedMatrix(m_index);
 	}
 
+	/// Axis directions are read from the global matrix
 	glm::vec3 Transform::Forward()
 	{
-		return m_forward;
+		return glm::vec3(GetGlobalMatrix()[2]);
 	}
 
 	glm::vec3 Transform::Up()
 	{
-		return m_up;
+		return glm::vec3(GetGlobalMatrix()[1]);
 	}
 
 	glm::vec3 Transform::Left()
 	{
-		return m_left;
+		return glm::vec3(GetGlobalMatrix()[0]);
 	}
 
 	void Transform::Translate(const glm::vec3 & a_vec)
 	{
 		m_position += a_vec;
 
-		ReconstructMatrix();
-	}
-
-	/**
-	*	@brief Combine position, rotation and scale information to construct final matrix.
-	*	NOTE: Only needs to be called upon retrieving the Matrix because it is not able to be modified otherwise.
-	*	@return void.
-	*/
-	void Transform::ReconstructMatrix() {
-		// Reconstruct transform matrix in order of scale, rotate, translate to avoid skewing
-		m_transformMatrix = glm::translate(m_position) *
-			glm::mat4_cast(glm::quat(m_rotation)) *		// Convert from quat to mat in order to be compatable in composition operation
-			glm::scale(m_scale);
-
-		// Apply parent transformation if transform has parent
-		if (m_parentTransform) { m_transformMatrix = m_parentTransform->RecurCalculateGlobalMatrix() * m_transformMatrix; };
-
-		/// Store transform matrix axis directions
-		m_forward = glm::vec3(m_transformMatrix[2][0], m_transformMatrix[2][1], m_transformMatrix[2][2]);
-		m_up = glm::vec3(m_transformMatrix[1][0], m_transformMatrix[1][1], m_transformMatrix[1][2]);
-		m_left = glm::vec3(m_transformMatrix[0][0], m_transformMatrix[0][1], m_transformMatrix[0][2]);
+		TransformHierarchy::MarkDirty(m_index);
 	}
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include <glm/mat4x4.hpp>
 
 namespace SPRON {
+	/**
+	*	@brief Position, rotation and scale of an object relative to its parent.
+	*	Matrices are owned by the transform hierarchy, setters only flag the transform as dirty and matrices are recalculated once when next needed.
+	*/
 	class Transform {
 	public:
 		Transform(Transform* a_parentTransform = nullptr,
@@ -20,7 +24,8 @@ namespace SPRON {
 		void SetRotation(const glm::vec3& a_rotation);
 
 		const glm::mat4& GetMatrix();
-		glm::mat4 GetGlobalMatrix();
+		const glm::mat4& GetGlobalMatrix();
+		const glm::mat4& GetPublishedMatrix() const;
 
 		glm::vec3 Forward();
 		glm::vec3 Up();
@@ -29,20 +34,13 @@ namespace SPRON {
 		void Translate(const glm::vec3& a_vec);
 	protected:
 	private:
-		void ReconstructMatrix();
-		glm::mat4 RecurCalculateGlobalMatrix();
+		friend class TransformHierarchy;
 
 		// Cached values (avoids decomposition)
 		glm::vec3 m_position;
 		glm::vec3 m_scale;
 		glm::vec3 m_rotation;
 
-		glm::vec3 m_forward;
-		glm::vec3 m_up;
-		glm::vec3 m_left;
-
-		glm::mat4 m_transformMatrix;		// Final constructed matrix with position, rotation and scale information
-
-		Transform* m_parentTransform;		// Hold onto parent to ensure that all transformations applied to the parent are also applied to the children
+		unsigned int m_index;		// Slot in the transform hierarchy, after the parent's slot so all transformations applied to the parent are also applied to the children
 	};
 }
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "TransformHierarchy.h"
+#include "Transform.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "Renderer_Utility_Literals.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <imgui.h>
+#include <xmmintrin.h>
+#include <assert.h>
+
+namespace SPRON {
+	/// Static initialisation
+	TransformHierarchy* TransformHierarchy::m_stn = nullptr;
+	const unsigned int TransformHierarchy::NO_PARENT;
+
+	/**
+	*	@brief Multiply two column major matrices with SSE, each column of the result is a sum of the left matrix's columns weighted by a column of the right.
+	*	@param a_lhs is the left hand matrix e.g. the parent's world matrix.
+	*	@param a_rhs is the right hand matrix e.g. the child's local matrix.
+	*	@param a_out is the matrix to output to, must not be either input.
+	*	@return void.
+	*/
+	static void MultiplyMat4(const glm::mat4& a_lhs, const glm::mat4& a_rhs, glm::mat4& a_out)
+	{
+		// NOTE: Unaligned loads as std::vector only guarantees the alignment of the platform allocator
+		__m128 col0 = _mm_loadu_ps(&a_lhs[0][0]);
+		__m128 col1 = _mm_loadu_ps(&a_lhs[1][0]);
+		__m128 col2 = _mm_loadu_ps(&a_lhs[2][0]);
+		__m128 col3 = _mm_loadu_ps(&a_lhs[3][0]);
+
+		for (int i = 0; i < 4; ++i) {
+			__m128 result = _mm_mul_ps(col0, _mm_set1_ps(a_rhs[i][0]));
+			result = _mm_add_ps(result, _mm_mul_ps(col1, _mm_set1_ps(a_rhs[i][1])));
+			result = _mm_add_ps(result, _mm_mul_ps(col2, _mm_set1_ps(a_rhs[i][2])));
+			result = _mm_add_ps(result, _mm_mul_ps(col3, _mm_set1_ps(a_rhs[i][3])));
+
+			_mm_storeu_ps(&a_out[i][0], result);
+		}
+	}
+
+	TransformHierarchy::TransformHierarchy() :
+		m_pass(0), m_dirtyCount(0), m_freeCount(0), m_passCount(0), m_updatedCount(0)
+	{
+	}
+
+	TransformHierarchy::~TransformHierarchy()
+	{
+	}
+
+	/**
+	*	@brief Create singleton.
+	*	NOTE: Must be called before any transforms are created, any future calls will be ignored.
+	*	@return void.
+	*/
+	void TransformHierarchy::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new TransformHierarchy();
+		}
+	}
+
+	void TransformHierarchy::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	void TransformHierarchy::BeginFrame()
+	{
+		// Statistics are kept per frame
+		m_stn->m_passCount = 0;
+		m_stn->m_updatedCount = 0;
+	}
+
+	/**
+	*	@brief Rebuild dirty local matrices and recalculate the world matrices of every transform that changed, along with their descendants.
+	*	O(N) complexity where N = number of transforms, as parents come first a parent's world matrix is always final before its children read it.
+	*	NOTE: Must not be called from a job, read world matrices from jobs only after the pass has run.
+	*	@return void.
+	*/
+	void TransformHierarchy::Update()
+	{
+		if (m_stn->m_dirtyCount == 0) { return; }
+
+		m_stn->m_pass++;
+		m_stn->m_passCount++;
+
+		// Local matrices only read their own transform, so they are rebuilt in parallel before the ordered pass
+		JobSystem::ParallelFor((unsigned int)m_stn->m_owners.size(), JOB_BATCH_SIZE, [](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				if ((m_stn->m_flags[i] & LOCAL_DIRTY) && !(m_stn->m_flags[i] & FREE)) { RebuildLocalMatrix(i); }
+			}
+		});
+
+		for (unsigned int i = 0; i < m_stn->m_owners.size(); ++i) {
+			unsigned char& flags = m_stn->m_flags[i];
+
+			if (flags & FREE) { continue; }
+
+			unsigned int parent = m_stn->m_parents[i];
+			bool isParentUpdated = (parent != NO_PARENT) && (m_stn->m_updatePasses[parent] == m_stn->m_pass);
+
+			if (!(flags & WORLD_DIRTY) && !isParentUpdated) { continue; }
+
+			if (parent == NO_PARENT) { m_stn->m_worldMatrices[i] = m_stn->m_localMatrices[i]; }
+			else { MultiplyMat4(m_stn->m_worldMatrices[parent], m_stn->m_localMatrices[i], m_stn->m_worldMatrices[i]); }		// World = parent world * local
+
+			m_stn->m_updatePasses[i] = m_stn->m_pass;
+			flags &= ~WORLD_DIRTY;
+
+			m_stn->m_updatedCount++;
+		}
+
+		m_stn->m_dirtyCount = 0;
+	}
+
+	/**
+	*	@brief Copy every world matrix into the published array that rendering reads from, so the simulation can change transforms while the previous state is drawn.
+	*	Freed slots are only compacted here, as compacting moves the slots rendering looks matrices up by.
+	*	NOTE: Must be called while nothing else is changing or reading transforms, between the simulation finishing and rendering starting.
+	*	@return void.
+	*/
+	void TransformHierarchy::Publish()
+	{
+		if (m_stn->m_freeCount > m_stn->m_owners.size() / 4) { Compact(); }		// Keep deleted slots from bloating the pass
+
+		Update();		// Catch changes made since the simulation finished
+
+		m_stn->m_publishedMatrices = m_stn->m_worldMatrices;		// NOTE: Assigning keeps the capacity, so steady state frames do not re-allocate
+	}
+
+	/**
+	*	@brief Get a transform's world matrix as of the last publish.
+	*	@param a_index is the slot of the transform.
+	*	@return published world matrix of the transform.
+	*/
+	const glm::mat4 & TransformHierarchy::GetPublishedMatrix(unsigned int a_index)
+	{
+		assert(a_index < m_stn->m_publishedMatrices.size() && "ERROR::TRANSFORM_HIERARCHY::TRANSFORM_NOT_PUBLISHED");
+
+		return m_stn->m_publishedMatrices[a_index];
+	}
+
+	/**
+	*	@brief Give a transform a slot after every existing one, which keeps it after its parent.
+	*	@param a_owner is the transform the slot belongs to.
+	*	@param a_parent is the slot of the transform's parent, or NO_PARENT.
+	*	@return index of the slot.
+	*/
+	unsigned int TransformHierarchy::Add(Transform * a_owner, unsigned int a_parent)
+	{
+		m_stn->m_owners.push_back(a_owner);
+		m_stn->m_parents.push_back(a_parent);
+		m_stn->m_localMatrices.push_back(glm::mat4(1));
+		m_stn->m_worldMatrices.push_back(glm::mat4(1));
+		m_stn->m_updatePasses.push_back(0);
+		m_stn->m_flags.push_back(LOCAL_DIRTY | WORLD_DIRTY);
+
+		m_stn->m_dirtyCount++;
+
+		return (unsigned int)m_stn->m_owners.size() - 1;
+	}
+
+	/**
+	*	@brief Free a deleted transform's slot, the slot stays in place until the next compaction so no other indices change.
+	*	NOTE: Children of the deleted transform keep its last world matrix as their parent's and become roots on compaction.
+	*	@param a_index is the slot of the transform.
+	*	@return void.
+	*/
+	void TransformHierarchy::Remove(unsigned int a_index)
+	{
+		m_stn->m_owners[a_index] = nullptr;
+		m_stn->m_flags[a_index] = FREE;
+
+		m_stn->m_freeCount++;
+	}
+
+	/**
+	*	@brief Flag a transform's position, rotation or scale as changed.
+	*	@param a_index is the slot of the transform.
+	*	@return void.
+	*/
+	void TransformHierarchy::MarkDirty(unsigned int a_index)
+	{
+		unsigned char& flags = m_stn->m_flags[a_index];
+
+		if (!(flags & WORLD_DIRTY)) { m_stn->m_dirtyCount++; }		// Only count each slot once between passes
+
+		flags |= LOCAL_DIRTY | WORLD_DIRTY;
+	}
+
+	/**
+	*	@brief Get a transform's local matrix, rebuilding it first if it is out of date.
+	*	@param a_index is the slot of the transform.
+	*	@return local matrix of the transform.
+	*/
+	const glm::mat4 & TransformHierarchy::GetLocalMatrix(unsigned int a_index)
+	{
+		if (m_stn->m_flags[a_index] & LOCAL_DIRTY) { RebuildLocalMatrix(a_index); }		// NOTE: World stays flagged dirty for the next pass
+
+		return m_stn->m_localMatrices[a_index];
+	}
+
+	/**
+	*	@brief Get a transform's world matrix, running the update pass first if any transform has changed since the last one.
+	*	@param a_index is the slot of the transform.
+	*	@return world matrix of the transform.
+	*/
+	const glm::mat4 & TransformHierarchy::GetWorldMatrix(unsigned int a_index)
+	{
+		if (m_stn->m_dirtyCount > 0) { Update(); }
+
+		return m_stn->m_worldMatrices[a_index];
+	}
+
+	/**
+	*	@brief Combine a transform's position, rotation and scale into its local matrix.
+	*	@param a_index is the slot of the transform.
+	*	@return void.
+	*/
+	void TransformHierarchy::RebuildLocalMatrix(unsigned int a_index)
+	{
+		Transform* owner = m_stn->m_owners[a_index];
+		glm::mat4& local = m_stn->m_localMatrices[a_index];
+
+		// Translate * rotate * scale, written directly instead of multiplying the three matrices together
+		local = glm::mat4_cast(glm::quat(owner->m_rotation));
+
+		local[0] *= owner->m_scale.x;
+		local[1] *= owner->m_scale.y;
+		local[2] *= owner->m_scale.z;
+		local[3] = glm::vec4(owner->m_position, 1.f);
+
+		m_stn->m_flags[a_index] &= ~LOCAL_DIRTY;
+	}
+
+	/**
+	*	@brief Remove freed slots while keeping the remaining slots in order, so parents still come before their children.
+	*	@return void.
+	*/
+	void TransformHierarchy::Compact()
+	{
+		ArenaVector<unsigned int> remap(m_stn->m_owners.size(), NO_PARENT, FrameArena::GetThreadArena());		// New index of each old slot
+		unsigned int count = 0;
+
+		for (unsigned int i = 0; i < m_stn->m_owners.size(); ++i) {
+			if (m_stn->m_flags[i] & FREE) { continue; }
+
+			remap[i] = count;
+
+			m_stn->m_owners[count] = m_stn->m_owners[i];
+			m_stn->m_parents[count] = (m_stn->m_parents[i] == NO_PARENT) ? NO_PARENT : remap[m_stn->m_parents[i]];		// Freed parents map to NO_PARENT
+			m_stn->m_localMatrices[count] = m_stn->m_localMatrices[i];
+			m_stn->m_worldMatrices[count] = m_stn->m_worldMatrices[i];
+			m_stn->m_updatePasses[count] = m_stn->m_updatePasses[i];
+			m_stn->m_flags[count] = m_stn->m_flags[i];
+
+			m_stn->m_owners[count]->m_index = count;
+
+			count++;
+		}
+
+		m_stn->m_owners.resize(count);
+		m_stn->m_parents.resize(count);
+		m_stn->m_localMatrices.resize(count);
+		m_stn->m_worldMatrices.resize(count);
+		m_stn->m_updatePasses.resize(count);
+		m_stn->m_flags.resize(count);
+
+		m_stn->m_freeCount = 0;
+	}
+
+	/**
+	*	@brief Display the number of transforms and how much of the hierarchy was recalculated this frame.
+	*	@return void.
+	*/
+	void TransformHierarchy::ListenIMGUI()
+	{
+		ImGui::Begin("Transform Hierarchy");
+
+		ImGui::Text("Transforms: %u (%u free slots)", GetTransformCount(), m_stn->m_freeCount);
+		ImGui::Text("World matrices updated: %u in %u passes", m_stn->m_updatedCount, m_stn->m_passCount);
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class Transform;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Static singleton class that stores the matrices of every transform in flat arrays, ordered so parents always come before their children.
+	*	Setters only flag a transform as dirty, world matrices are recalculated in a single ordered pass that also re-calculates the children of anything that changed,
+	*	so a parent change propagates once no matter how many children it has or how often they are queried.
+	*	NOTE: The pass runs once per frame before rendering, and lazily whenever a world matrix is read while changes are pending.
+	*	Rendering reads the published copy of the world matrices, so a simulation thread can change transforms while the last published state is drawn.
+	*/
+	class TransformHierarchy {
+	public:
+		static const unsigned int NO_PARENT = ~0u;
+
+		static void Initialise();
+		static void Shutdown();
+
+		static void BeginFrame();
+		static void Update();
+		static void Publish();
+
+		static unsigned int GetTransformCount() { return (unsigned int)m_stn->m_owners.size() - m_stn->m_freeCount; }
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		friend class Transform;
+
+		static TransformHierarchy* m_stn;		// Singleton instance
+
+		static unsigned int Add(Transform* a_owner, unsigned int a_parent);
+		static void Remove(unsigned int a_index);
+		static void MarkDirty(unsigned int a_index);
+
+		static const glm::mat4& GetLocalMatrix(unsigned int a_index);
+		static const glm::mat4& GetWorldMatrix(unsigned int a_index);
+		static const glm::mat4& GetPublishedMatrix(unsigned int a_index);
+
+		static void RebuildLocalMatrix(unsigned int a_index);
+		static void Compact();
+
+		enum eTransformFlags : unsigned char {
+			LOCAL_DIRTY = 1 << 0,		// Position, rotation or scale changed
+			WORLD_DIRTY = 1 << 1,		// Local matrix changed since the world matrix was calculated
+			FREE = 1 << 2				// Transform was deleted, slot is removed on the next compaction
+		};
+
+		// Instance variables
+		// NOTE: Stored as separate arrays so the update pass streams through matrices without touching the transforms themselves
+		std::vector<Transform*>		m_owners;			// Transform that owns each slot, read for position, rotation and scale when rebuilding its local matrix
+		std::vector<unsigned int>	m_parents;			// Index of each slot's parent, always lower than the slot's own index
+		std::vector<glm::mat4>		m_localMatrices;
+		std::vector<glm::mat4>		m_worldMatrices;
+		std::vector<unsigned int>	m_updatePasses;		// Pass each world matrix was last recalculated in, children of slots updated this pass are updated too
+		std::vector<unsigned char>	m_flags;
+		std::vector<glm::mat4>		m_publishedMatrices;	// World matrices as of the last publish, read by rendering while the simulation changes the transforms
+
+		unsigned int	m_pass;
+		unsigned int	m_dirtyCount;		// Slots changed since the last pass
+		unsigned int	m_freeCount;
+
+		// Statistics
+		unsigned int	m_passCount;		// Passes run this frame
+		unsigned int	m_updatedCount;		// World matrices recalculated this frame
+
+		TransformHierarchy();
+		~TransformHierarchy();
+	};
+}
\ No newline at end of file
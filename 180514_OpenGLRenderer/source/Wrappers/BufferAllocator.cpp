@@ -0,0 +1,395 @@
+#include "BufferAllocator.h"
+
+#include <assert.h>
+#include <intrin.h>
+
+namespace SPRON {
+	/**
+	*	@brief Find the index of the most significant set bit.
+	*	@param a_value is the value to scan, must not be 0.
+	*	@return index of the bit.
+	*/
+	static inline unsigned int FindLastSet(unsigned int a_value) {
+		unsigned long index;
+		_BitScanReverse(&index, a_value);
+
+		return (unsigned int)index;
+	}
+
+	/**
+	*	@brief Find the index of the least significant set bit.
+	*	@param a_value is the value to scan, must not be 0.
+	*	@return index of the bit.
+	*/
+	static inline unsigned int FindFirstSet(unsigned int a_value) {
+		unsigned long index;
+		_BitScanForward(&index, a_value);
+
+		return (unsigned int)index;
+	}
+
+	BufferAllocator::BufferAllocator(unsigned int a_capacity) :
+		m_flBitmap(0), m_lastBlock(INVALID_BLOCK), m_capacity(0), m_used(0), m_freeBlockCount(0)
+	{
+		for (unsigned int fl = 0; fl < FL_INDEX_COUNT; ++fl) {
+			m_slBitmaps[fl] = 0;
+			for (unsigned int sl = 0; sl < SL_INDEX_COUNT; ++sl) { m_freeHeads[fl][sl] = INVALID_BLOCK; }
+		}
+
+		Grow(a_capacity);
+	}
+
+	/**
+	*	@brief Reserve a range of the buffer from the smallest size class that is guaranteed to fit.
+	*	@param a_size is the number of elements to reserve.
+	*	@return handle of the reserved block, INVALID_BLOCK if no free block is large enough and the buffer has to grow.
+	*/
+	unsigned int BufferAllocator::Allocate(unsigned int a_size)
+	{
+		if (a_size == 0) { return INVALID_BLOCK; }
+
+		unsigned int block = FindFreeBlock(a_size);
+		if (block == INVALID_BLOCK) { return INVALID_BLOCK; }
+
+		Claim(block, a_size);
+
+		return block;
+	}
+
+	/**
+	*	@brief Reserve a range that ends at or before an offset, used to move blocks towards the start of the buffer.
+	*	NOTE: Walks the free lists instead of using the bitmaps, so it is slower than Allocate and only meant for defragmentation.
+	*	@param a_size is the number of elements to reserve.
+	*	@param a_limit is the offset the range must end before.
+	*	@return handle of the reserved block, INVALID_BLOCK if no free block below the limit is large enough.
+	*/
+	unsigned int BufferAllocator::AllocateBelow(unsigned int a_size, unsigned int a_limit)
+	{
+		if (a_size == 0) { return INVALID_BLOCK; }
+
+		unsigned int startFL, startSL;
+		MapInsert(a_size, startFL, startSL);
+
+		for (unsigned int fl = startFL; fl < FL_INDEX_COUNT; ++fl) {
+			if (!(m_flBitmap & (1u << fl))) { continue; }
+
+			for (unsigned int sl = (fl == startFL) ? startSL : 0; sl < SL_INDEX_COUNT; ++sl) {
+				// Blocks in the first bin may still be too small, so sizes are checked as well as offsets
+				for (unsigned int block = m_freeHeads[fl][sl]; block != INVALID_BLOCK; block = m_blocks[block].nextFree) {
+					if (m_blocks[block].size >= a_size && m_blocks[block].offset + a_size <= a_limit) {
+						Claim(block, a_size);
+
+						return block;
+					}
+				}
+			}
+		}
+
+		return INVALID_BLOCK;
+	}
+
+	/**
+	*	@brief Release a block, merging it with any free neighbours.
+	*	@param a_block is the handle returned by Allocate.
+	*	@return void.
+	*/
+	void BufferAllocator::Free(unsigned int a_block)
+	{
+		assert(a_block < m_blocks.size() && !m_blocks[a_block].free && "ERROR::BUFFER_ALLOCATOR::INVALID_FREE");
+
+		m_used -= m_blocks[a_block].size;
+		m_blocks[a_block].free = true;
+		m_blocks[a_block].userData = INVALID_BLOCK;
+
+		// Coalesce with the previous block
+		unsigned int prev = m_blocks[a_block].prevPhysical;
+		if (prev != INVALID_BLOCK && m_blocks[prev].free) {
+			RemoveFreeBlock(prev);
+			Merge(prev, a_block);
+
+			a_block = prev;
+		}
+
+		// Coalesce with the next block
+		unsigned int next = m_blocks[a_block].nextPhysical;
+		if (next != INVALID_BLOCK && m_blocks[next].free) {
+			RemoveFreeBlock(next);
+			Merge(a_block, next);
+		}
+
+		InsertFreeBlock(a_block);
+	}
+
+	/**
+	*	@brief Extend the managed range after the buffer has been re-allocated, existing blocks keep their offsets.
+	*	@param a_capacity is the new number of elements in the buffer.
+	*	@return void.
+	*/
+	void BufferAllocator::Grow(unsigned int a_capacity)
+	{
+		if (a_capacity <= m_capacity) { return; }
+
+		unsigned int extra = a_capacity - m_capacity;
+
+		if (m_lastBlock != INVALID_BLOCK && m_blocks[m_lastBlock].free) {		// Extend the free space at the end
+			RemoveFreeBlock(m_lastBlock);
+			m_blocks[m_lastBlock].size += extra;
+			InsertFreeBlock(m_lastBlock);
+		}
+		else {
+			unsigned int block = CreateBlock();
+			m_blocks[block].offset = m_capacity;
+			m_blocks[block].size = extra;
+			m_blocks[block].prevPhysical = m_lastBlock;
+
+			if (m_lastBlock != INVALID_BLOCK) { m_blocks[m_lastBlock].nextPhysical = block; }
+			m_lastBlock = block;
+
+			InsertFreeBlock(block);
+		}
+
+		m_capacity = a_capacity;
+	}
+
+	/**
+	*	@brief Find the reserved block furthest into the buffer, the first candidate to move when defragmenting.
+	*	@return handle of the block, INVALID_BLOCK if nothing is reserved.
+	*/
+	unsigned int BufferAllocator::GetLastUsedBlock() const
+	{
+		if (m_lastBlock == INVALID_BLOCK) { return INVALID_BLOCK; }
+
+		// NOTE: Free blocks are always merged, so the block before a free block is in use
+		return (m_blocks[m_lastBlock].free) ? m_blocks[m_lastBlock].prevPhysical : m_lastBlock;
+	}
+
+	/**
+	*	@brief Find the largest range that could be allocated without growing.
+	*	@return size of the largest free block.
+	*/
+	unsigned int BufferAllocator::GetLargestFree() const
+	{
+		if (!m_flBitmap) { return 0; }
+
+		// Only the highest occupied bin needs to be searched
+		unsigned int fl = FindLastSet(m_flBitmap);
+		unsigned int sl = FindLastSet(m_slBitmaps[fl]);
+
+		unsigned int largest = 0;
+		for (unsigned int block = m_freeHeads[fl][sl]; block != INVALID_BLOCK; block = m_blocks[block].nextFree) {
+			if (m_blocks[block].size > largest) { largest = m_blocks[block].size; }
+		}
+
+		return largest;
+	}
+
+	/**
+	*	@brief How scattered the free space is.
+	*	@return 0 when all free space is in one block, approaching 1 as it is split into many small blocks.
+	*/
+	float BufferAllocator::GetFragmentation() const
+	{
+		unsigned int freeSpace = m_capacity - m_used;
+		if (freeSpace == 0) { return 0.f; }
+
+		return 1.f - (float)GetLargestFree() / freeSpace;
+	}
+
+	/**
+	*	@brief Get the bin a free block of a size is stored in.
+	*	Sizes below the second level count map linearly, larger sizes are split into power of two ranges subdivided linearly.
+	*	@param a_size is the size of the block.
+	*	@param a_fl is the first level index to output to.
+	*	@param a_sl is the second level index to output to.
+	*	@return void.
+	*/
+	void BufferAllocator::MapInsert(unsigned int a_size, unsigned int & a_fl, unsigned int & a_sl)
+	{
+		if (a_size < SL_INDEX_COUNT) {
+			a_fl = 0;
+			a_sl = a_size;
+		}
+		else {
+			unsigned int log2 = FindLastSet(a_size);
+
+			a_fl = log2 - SL_INDEX_LOG2 + 1;
+			a_sl = (a_size >> (log2 - SL_INDEX_LOG2)) - SL_INDEX_COUNT;
+		}
+	}
+
+	/**
+	*	@brief Get the first bin whose blocks are all at least a size, by rounding the size up to the next bin.
+	*	@param a_size is the size being allocated.
+	*	@param a_fl is the first level index to output to.
+	*	@param a_sl is the second level index to output to.
+	*	@return void.
+	*/
+	void BufferAllocator::MapSearch(unsigned int a_size, unsigned int & a_fl, unsigned int & a_sl)
+	{
+		if (a_size >= SL_INDEX_COUNT) {
+			unsigned int round = (1u << (FindLastSet(a_size) - SL_INDEX_LOG2)) - 1;
+			a_size = (a_size > ~0u - round) ? ~0u : a_size + round;		// Clamp instead of overflowing
+		}
+
+		MapInsert(a_size, a_fl, a_sl);
+	}
+
+	/**
+	*	@brief Find a free block of at least a size using the bin bitmaps.
+	*	@param a_size is the size being allocated.
+	*	@return handle of the first block in the bin, INVALID_BLOCK if there are no large enough free blocks.
+	*/
+	unsigned int BufferAllocator::FindFreeBlock(unsigned int a_size) const
+	{
+		unsigned int fl, sl;
+		MapSearch(a_size, fl, sl);
+
+		// Occupied bins in the same size range
+		unsigned int slMap = m_slBitmaps[fl] & (~0u << sl);
+
+		if (!slMap) {
+			// Occupied size ranges above
+			unsigned int flMap = (fl + 1 < FL_INDEX_COUNT) ? m_flBitmap & (~0u << (fl + 1)) : 0;
+			if (!flMap) { return INVALID_BLOCK; }
+
+			fl = FindFirstSet(flMap);
+			slMap = m_slBitmaps[fl];
+		}
+
+		sl = FindFirstSet(slMap);
+
+		return m_freeHeads[fl][sl];
+	}
+
+	/**
+	*	@brief Take a free block out of its bin and reserve the start of it, returning the remainder to the free bins.
+	*	@param a_block is the free block to reserve.
+	*	@param a_size is the number of elements to reserve.
+	*	@return void.
+	*/
+	void BufferAllocator::Claim(unsigned int a_block, unsigned int a_size)
+	{
+		RemoveFreeBlock(a_block);
+		Split(a_block, a_size);
+
+		m_blocks[a_block].free = false;
+		m_used += a_size;
+	}
+
+	void BufferAllocator::InsertFreeBlock(unsigned int a_block)
+	{
+		unsigned int fl, sl;
+		MapInsert(m_blocks[a_block].size, fl, sl);
+
+		unsigned int head = m_freeHeads[fl][sl];
+
+		m_blocks[a_block].free = true;
+		m_blocks[a_block].prevFree = INVALID_BLOCK;
+		m_blocks[a_block].nextFree = head;
+		if (head != INVALID_BLOCK) { m_blocks[head].prevFree = a_block; }
+
+		m_freeHeads[fl][sl] = a_block;
+		m_flBitmap |= 1u << fl;
+		m_slBitmaps[fl] |= 1u << sl;
+
+		m_freeBlockCount++;
+	}
+
+	void BufferAllocator::RemoveFreeBlock(unsigned int a_block)
+	{
+		unsigned int fl, sl;
+		MapInsert(m_blocks[a_block].size, fl, sl);
+
+		unsigned int prev = m_blocks[a_block].prevFree;
+		unsigned int next = m_blocks[a_block].nextFree;
+
+		if (prev != INVALID_BLOCK) { m_blocks[prev].nextFree = next; }
+		if (next != INVALID_BLOCK) { m_blocks[next].prevFree = prev; }
+
+		// Block was the head of its bin, clear the bitmaps if the bin is now empty
+		if (m_freeHeads[fl][sl] == a_block) {
+			m_freeHeads[fl][sl] = next;
+
+			if (next == INVALID_BLOCK) {
+				m_slBitmaps[fl] &= ~(1u << sl);
+				if (!m_slBitmaps[fl]) { m_flBitmap &= ~(1u << fl); }
+			}
+		}
+
+		m_freeBlockCount--;
+	}
+
+	/**
+	*	@brief Shrink a block to a size, turning the rest into a new free block placed directly after it.
+	*	@param a_block is the block to split, must not be in a free list.
+	*	@param a_size is the size to keep.
+	*	@return handle of the remainder, INVALID_BLOCK if the block was already the right size.
+	*/
+	unsigned int BufferAllocator::Split(unsigned int a_block, unsigned int a_size)
+	{
+		if (m_blocks[a_block].size == a_size) { return INVALID_BLOCK; }
+
+		unsigned int remainder = CreateBlock();		// NOTE: May re-allocate the block list, so blocks are accessed by index only
+
+		m_blocks[remainder].offset = m_blocks[a_block].offset + a_size;
+		m_blocks[remainder].size = m_blocks[a_block].size - a_size;
+		m_blocks[remainder].prevPhysical = a_block;
+		m_blocks[remainder].nextPhysical = m_blocks[a_block].nextPhysical;
+
+		if (m_blocks[a_block].nextPhysical != INVALID_BLOCK) { m_blocks[m_blocks[a_block].nextPhysical].prevPhysical = remainder; }
+		else { m_lastBlock = remainder; }
+
+		m_blocks[a_block].nextPhysical = remainder;
+		m_blocks[a_block].size = a_size;
+
+		InsertFreeBlock(remainder);
+
+		return remainder;
+	}
+
+	/**
+	*	@brief Absorb a block into the block before it.
+	*	@param a_block is the block to keep.
+	*	@param a_next is the block directly after it, destroyed.
+	*	@return void.
+	*/
+	void BufferAllocator::Merge(unsigned int a_block, unsigned int a_next)
+	{
+		m_blocks[a_block].size += m_blocks[a_next].size;
+		m_blocks[a_block].nextPhysical = m_blocks[a_next].nextPhysical;
+
+		if (m_blocks[a_next].nextPhysical != INVALID_BLOCK) { m_blocks[m_blocks[a_next].nextPhysical].prevPhysical = a_block; }
+		else { m_lastBlock = a_block; }
+
+		DestroyBlock(a_next);
+	}
+
+	unsigned int BufferAllocator::CreateBlock()
+	{
+		unsigned int block;
+
+		if (!m_unusedBlocks.empty()) {
+			block = m_unusedBlocks.back();
+			m_unusedBlocks.pop_back();
+		}
+		else {
+			block = (unsigned int)m_blocks.size();
+			m_blocks.push_back(Block());
+		}
+
+		Block& newBlock = m_blocks[block];
+		newBlock.offset = 0;
+		newBlock.size = 0;
+		newBlock.userData = INVALID_BLOCK;
+		newBlock.free = false;
+		newBlock.prevPhysical = newBlock.nextPhysical = INVALID_BLOCK;
+		newBlock.prevFree = newBlock.nextFree = INVALID_BLOCK;
+
+		return block;
+	}
+
+	void BufferAllocator::DestroyBlock(unsigned int a_block)
+	{
+		m_unusedBlocks.push_back(a_block);
+	}
+}
\ No newline at end of file
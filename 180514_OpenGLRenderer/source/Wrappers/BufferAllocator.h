@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+namespace SPRON {
+	/**
+	*	@brief Two level segregated fit (TLSF) allocator that hands out ranges of a buffer, without touching the buffer itself.
+	*	Free blocks are binned by size class so allocation and freeing are constant time, neighbouring free blocks are merged when freed.
+	*	NOTE: Offsets and sizes are counted in elements rather than bytes, so ranges can be passed straight to draw calls.
+	*/
+	class BufferAllocator {
+	public:
+		static const unsigned int INVALID_BLOCK = ~0u;
+
+		BufferAllocator(unsigned int a_capacity = 0);
+
+		unsigned int Allocate(unsigned int a_size);
+		unsigned int AllocateBelow(unsigned int a_size, unsigned int a_limit);
+		void Free(unsigned int a_block);
+		void Grow(unsigned int a_capacity);
+
+		unsigned int GetOffset(unsigned int a_block) const { return m_blocks[a_block].offset; }
+		unsigned int GetSize(unsigned int a_block) const { return m_blocks[a_block].size; }
+		unsigned int GetUserData(unsigned int a_block) const { return m_blocks[a_block].userData; }
+		void SetUserData(unsigned int a_block, unsigned int a_userData) { m_blocks[a_block].userData = a_userData; }
+
+		unsigned int GetLastUsedBlock() const;
+
+		// Statistics
+		unsigned int GetCapacity() const { return m_capacity; }
+		unsigned int GetUsed() const { return m_used; }
+		unsigned int GetFreeBlockCount() const { return m_freeBlockCount; }
+		unsigned int GetLargestFree() const;
+		float GetFragmentation() const;
+	protected:
+	private:
+		static const unsigned int SL_INDEX_LOG2 = 3;						// Second level bins per first level bin = 2 ^ SL_INDEX_LOG2
+		static const unsigned int SL_INDEX_COUNT = 1 << SL_INDEX_LOG2;
+		static const unsigned int FL_INDEX_COUNT = 32 - SL_INDEX_LOG2 + 1;
+
+		struct Block {
+			unsigned int	offset;
+			unsigned int	size;
+			unsigned int	userData;
+			bool			free;
+
+			// Neighbours in the buffer
+			unsigned int	prevPhysical;
+			unsigned int	nextPhysical;
+
+			// Neighbours in the free list of the block's bin, only valid while free
+			unsigned int	prevFree;
+			unsigned int	nextFree;
+		};
+
+		static void MapInsert(unsigned int a_size, unsigned int& a_fl, unsigned int& a_sl);
+		static void MapSearch(unsigned int a_size, unsigned int& a_fl, unsigned int& a_sl);
+
+		unsigned int FindFreeBlock(unsigned int a_size) const;
+		void Claim(unsigned int a_block, unsigned int a_size);
+		void InsertFreeBlock(unsigned int a_block);
+		void RemoveFreeBlock(unsigned int a_block);
+		unsigned int Split(unsigned int a_block, unsigned int a_size);
+		void Merge(unsigned int a_block, unsigned int a_next);
+
+		unsigned int CreateBlock();
+		void DestroyBlock(unsigned int a_block);
+
+		std::vector<Block>			m_blocks;				// Block nodes, indexed by block handle
+		std::vector<unsigned int>	m_unusedBlocks;			// Handles of destroyed blocks to re-use
+
+		unsigned int	m_flBitmap;							// Bit per first level bin with any free block
+		unsigned int	m_slBitmaps[FL_INDEX_COUNT];		// Bit per second level bin with any free block
+		unsigned int	m_freeHeads[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+		unsigned int	m_lastBlock;						// Block at the end of the buffer, extended when the buffer grows
+
+		unsigned int	m_capacity;
+		unsigned int	m_used;
+		unsigned int	m_freeBlockCount;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "CommandList.h"
+#include "RenderQueue.h"
+#include "Mesh.h"
+#include "ShaderWrapper.h"
+#include "GLStateCache.h"
+#include "GPUCuller.h"
+#include "PassQueries.h"
+#include "ShadowAtlas.h"
+#include "Renderer_Utility_Literals.h"
+#include "Light\PhongLight_Dir.h"
+#include "Light\PhongLight_Point.h"
+#include "Light\PhongLight_Spot.h"
+#include "Texture\Texture.h"
+
+#include <gl_core_4_4.h>
+#include <glm/vec4.hpp>
+
+namespace SPRON {
+
+	CommandList::CommandList()
+	{
+	}
+
+	CommandList::~CommandList()
+	{
+	}
+
+	void CommandList::SetPassState(unsigned int a_pass, bool a_isDepthPrepassed)
+	{
+		RenderCommand command = { RENDER_COMMAND_PASS_STATE, a_pass, nullptr, nullptr, nullptr, 0, 0, a_isDepthPrepassed };
+		m_commands.push_back(command);
+	}
+
+	void CommandList::BindProgram(ShaderWrapper * a_program)
+	{
+		RenderCommand command = { RENDER_COMMAND_BIND_PROGRAM, 0, a_program, nullptr, nullptr, 0, 0, false };
+		m_commands.push_back(command);
+	}
+
+	void CommandList::SetLight(ShaderWrapper * a_program, PhongLight * a_light)
+	{
+		RenderCommand command = { RENDER_COMMAND_SET_LIGHT, 0, a_program, a_light, nullptr, 0, 0, false };
+		m_commands.push_back(command);
+	}
+
+	void CommandList::SetMaterial(ShaderWrapper * a_program, unsigned int a_pass, Material * a_material)
+	{
+		RenderCommand command = { RENDER_COMMAND_SET_MATERIAL, a_pass, a_program, nullptr, a_material, 0, 0, false };
+		m_commands.push_back(command);
+	}
+
+	/**
+	*	@brief Record a range of draw commands to be issued together.
+	*	@param a_firstDraw is the index of the first draw command.
+	*	@param a_drawCount is the number of consecutive draw commands.
+	*	@return void.
+	*/
+	void CommandList::Draw(unsigned int a_firstDraw, unsigned int a_drawCount)
+	{
+		RenderCommand command = { RENDER_COMMAND_DRAW, 0, nullptr, nullptr, nullptr, a_firstDraw, a_drawCount, false };
+		m_commands.push_back(command);
+	}
+
+	/**
+	*	@brief Make the openGL calls of every recorded command in order, expects the geometry pool's vertex array to already be bound.
+	*	NOTE: Must be called on the thread that owns the context.
+	*	@param a_draws is the draw commands the list's draws index into, already uploaded to the bound indirect buffer when multi-draw is enabled.
+	*	@param a_isDrawCounted is whether each draw range's visible count was written to the bound parameter buffer by the GPU cull.
+	*	@param a_queries is the queries to measure each pass with, nullptr to not measure.
+	*	@return number of draw calls issued.
+	*/
+	unsigned int CommandList::Replay(const std::vector<IndirectDrawCommand>& a_draws, bool a_isDrawCounted, PassQueries* a_queries) const
+	{
+#if USE_MULTI_DRAW_INDIRECT
+		(void)a_draws;				// Draws are read from the bound indirect buffer instead
+#else
+		(void)a_isDrawCounted;		// Only multi-draw reads the GPU cull's counts
+#endif
+
+		unsigned int submitCount = 0;
+
+		for (unsigned int i = 0; i < m_commands.size(); ++i) {
+			const RenderCommand& command = m_commands[i];
+
+			switch (command.type) {
+				case RENDER_COMMAND_PASS_STATE:
+					ApplyPassState(command.pass, command.isDepthPrepassed);
+					if (a_queries) { a_queries->SwitchPass(command.pass); }
+					break;
+				case RENDER_COMMAND_BIND_PROGRAM:
+					GLStateCache::UseProgram(*command.program);
+					break;
+				case RENDER_COMMAND_SET_LIGHT:
+					ApplyLight(command.program, command.light);
+					break;
+				case RENDER_COMMAND_SET_MATERIAL:
+					ApplyMaterial(command.program, command.pass, *command.material);
+					break;
+				case RENDER_COMMAND_DRAW:
+#if USE_MULTI_DRAW_INDIRECT
+					if (a_isDrawCounted) {		// Only the range's visible commands, compacted to its front
+						GPUCuller::MultiDrawCounted(command.firstDraw, command.drawCount);
+					}
+					else {						// Whole range in one call
+						glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+							(void*)(sizeof(IndirectDrawCommand) * command.firstDraw),	// Offset of the range's first command in the indirect buffer
+							command.drawCount,
+							0);															// Commands are tightly packed
+					}
+
+					submitCount++;
+#else
+					for (unsigned int j = command.firstDraw; j < command.firstDraw + command.drawCount; ++j) {
+						const IndirectDrawCommand& draw = a_draws[j];
+
+						glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, draw.count, GL_UNSIGNED_INT,
+							(void*)(sizeof(unsigned int) * draw.firstIndex), draw.instanceCount, draw.baseVertex, draw.baseInstance);
+
+						submitCount++;
+					}
+#endif
+					break;
+			}
+		}
+
+		return submitCount;
+	}
+
+	/**
+	*	@brief Set blending, depth state and the vertex array for a render pass.
+	*	@param a_pass is the pass to set state for.
+	*	@param a_isDepthPrepassed is whether a depth prepass laid down the depth, so the ambient pass only shades the closest fragments.
+	*	@return void.
+	*/
+	void CommandList::ApplyPassState(unsigned int a_pass, bool a_isDepthPrepassed)
+	{
+		// Depth only draws read the tightly packed positions instead of whole vertices
+		if (a_pass == RENDER_PASS_DEPTH) { GeometryPool::BindPositions(); }
+		else { GeometryPool::Bind(); }
+
+		GLStateCache::SetColorMask(a_pass != RENDER_PASS_DEPTH);
+
+		switch (a_pass) {
+			case RENDER_PASS_AMBIENT:
+				GLStateCache::SetBlending(false);
+
+				if (a_isDepthPrepassed) {
+					GLStateCache::SetDepthMask(false);
+					GLStateCache::SetDepthFunc(GL_EQUAL);		// Only the fragment that laid down the depth is shaded
+				}
+				else {
+					GLStateCache::SetDepthFunc(GL_LESS);
+					GLStateCache::SetDepthMask(true);
+				}
+				break;
+			case RENDER_PASS_LIGHT:
+#if BLEND_RENDERING
+				GLStateCache::SetBlending(true);
+				GLStateCache::SetBlendFunc(GL_ONE, GL_ONE);	// Take existing frag color *1 and add it onto the new frag color *1
+
+				GLStateCache::SetDepthMask(false);				// Disable writing to depth buffer
+				GLStateCache::SetDepthFunc(GL_EQUAL);			// Only add on the lighting if the pixel has the same depth value as the one laid down by the ambient pass
+#endif
+				break;
+			case RENDER_PASS_DEPTH:
+			case RENDER_PASS_DEBUG:
+			default:
+				GLStateCache::SetDepthFunc(GL_LESS);
+				GLStateCache::SetDepthMask(true);
+				GLStateCache::SetBlending(false);
+				break;
+		}
+	}
+
+	/**
+	*	@brief Send a light's data to the program for its light type, and its shadow if it has one.
+	*	@return void.
+	*/
+	void CommandList::ApplyLight(ShaderWrapper * a_program, PhongLight * a_light)
+	{
+		switch (a_light->GetType()) {
+			case DIRECTIONAL_LIGHT:
+				a_program->SetDirectionalLight(Uniforms::LIGHT_DIR, (PhongLight_Dir*)a_light);
+				break;
+			case POINT_LIGHT:
+				a_program->SetPointLight(Uniforms::LIGHT_POINT, (PhongLight_Point*)a_light);
+				break;
+			case SPOT_LIGHT:
+				a_program->SetSpotLight(Uniforms::LIGHT_SPOT, (PhongLight_Spot*)a_light);
+				break;
+		}
+
+		ShadowAtlas::SetShadowUniforms(a_program, a_light);
+	}
+
+	/**
+	*	@brief Send a material's data to the program in the layout expected by the given pass.
+	*	@return void.
+	*/
+	void CommandList::ApplyMaterial(ShaderWrapper * a_program, unsigned int a_pass, Material & a_material)
+	{
+		switch (a_pass) {
+			case RENDER_PASS_AMBIENT:
+				a_program->SetTexture(Uniforms::TEX_SAMPLE, a_material.diffuseMap);
+				a_program->SetBool(Uniforms::USE_TEX, (a_material.diffuseMap ? true : false));
+				break;
+			case RENDER_PASS_LIGHT:
+				a_program->SetMaterialMaps(Uniforms::MATERIAL_MAPS, a_material);
+				break;
+			case RENDER_PASS_DEBUG:
+				a_program->SetFloat(Uniforms::DRAW_SCALE, 0.1f);
+				a_program->SetVec4(Uniforms::NORMAL_COLOR, glm::vec4(0, 0, 1, 1));
+				a_program->SetVec4(Uniforms::TANGENT_COLOR, glm::vec4(1, 0, 0, 1));
+				a_program->SetVec4(Uniforms::BITANGENT_COLOR, glm::vec4(0, 1, 0, 1));
+				break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "GeometryPool.h"
+
+namespace SPRON {
+	class ShaderWrapper;
+	class PassQueries;
+	class PhongLight;
+	struct Material;
+}
+
+namespace SPRON {
+	enum eRenderCommandType : unsigned char {
+		RENDER_COMMAND_PASS_STATE,		// Blending and depth state of a render pass
+		RENDER_COMMAND_BIND_PROGRAM,
+		RENDER_COMMAND_SET_LIGHT,		// Light uniforms of the bound program
+		RENDER_COMMAND_SET_MATERIAL,	// Texture maps of the bound program
+		RENDER_COMMAND_DRAW				// Range of draw commands, each draw finds its object block through its base instance
+	};
+
+	// Single state change or draw, plain data so that it can be recorded on any thread without touching openGL
+	struct RenderCommand {
+		eRenderCommandType	type;
+		unsigned int		pass;
+		ShaderWrapper*		program;
+		PhongLight*			light;			// Only used by RENDER_COMMAND_SET_LIGHT
+		Material*			material;		// Only used by RENDER_COMMAND_SET_MATERIAL
+		unsigned int		firstDraw;		// Only used by RENDER_COMMAND_DRAW, index into the draw commands given to Replay
+		unsigned int		drawCount;
+		bool				isDepthPrepassed;	// Only used by RENDER_COMMAND_PASS_STATE, a depth prepass already laid down the frame's depth
+	};
+
+	/**
+	*	@brief List of render commands recorded without making any openGL calls, then replayed in order on the thread that owns the context.
+	*	Several lists can be recorded in parallel by jobs, each covering part of a frame, and replayed one after the other.
+	*	NOTE: A list assumes nothing about the state it is replayed in, so the first commands of each list set the pass, program and material.
+	*/
+	class CommandList {
+	public:
+		CommandList();
+		~CommandList();
+
+		void Clear() { m_commands.clear(); }
+
+		void SetPassState(unsigned int a_pass, bool a_isDepthPrepassed = false);
+		void BindProgram(ShaderWrapper* a_program);
+		void SetLight(ShaderWrapper* a_program, PhongLight* a_light);
+		void SetMaterial(ShaderWrapper* a_program, unsigned int a_pass, Material* a_material);
+		void Draw(unsigned int a_firstDraw, unsigned int a_drawCount);
+
+		unsigned int Replay(const std::vector<IndirectDrawCommand>& a_draws, bool a_isDrawCounted = false, PassQueries* a_queries = nullptr) const;
+
+		unsigned int GetCommandCount() const { return (unsigned int)m_commands.size(); }
+
+		static void ApplyPassState(unsigned int a_pass, bool a_isDepthPrepassed = false);
+	protected:
+	private:
+		static void ApplyLight(ShaderWrapper* a_program, PhongLight* a_light);
+		static void ApplyMaterial(ShaderWrapper* a_program, unsigned int a_pass, Material& a_material);
+
+		std::vector<RenderCommand>	m_commands;		// Kept between frames to avoid re-allocating
+	};
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "GLStateCache.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+
+namespace SPRON {
+	/// Static initialisation
+	GLStateCache* GLStateCache::m_stn = nullptr;
+
+	static const unsigned int UNKNOWN_STATE = ~0u;		// Shadowed value that never matches, forces the next call through
+
+	GLStateCache::GLStateCache() :
+		m_issuedCalls(0), m_filteredCalls(0), m_lastIssuedCalls(0), m_lastFilteredCalls(0)
+	{
+	}
+
+	GLStateCache::~GLStateCache()
+	{
+	}
+
+	/**
+	*	@brief Create singleton and size the texture unit table from the actual limit of the context.
+	*	NOTE: Must be called after the openGL functions have been loaded, any future calls will be ignored.
+	*	@return void.
+	*/
+	void GLStateCache::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new GLStateCache();
+
+			int texUnitNum = 0; glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &texUnitNum);
+			m_stn->m_texUnits.resize(texUnitNum);
+
+			Invalidate();
+		}
+	}
+
+	void GLStateCache::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Store the previous frame's call counts and start counting again.
+	*	NOTE: Also invalidates the shadowed state since libraries like IMGUI change state without going through the cache.
+	*	@return void.
+	*/
+	void GLStateCache::BeginFrame()
+	{
+		m_stn->m_lastIssuedCalls = m_stn->m_issuedCalls;
+		m_stn->m_lastFilteredCalls = m_stn->m_filteredCalls;
+
+		m_stn->m_issuedCalls = 0;
+		m_stn->m_filteredCalls = 0;
+
+		Invalidate();
+	}
+
+	/**
+	*	@brief Mark all shadowed state as unknown so the next call for each state is always issued.
+	*	@return void.
+	*/
+	void GLStateCache::Invalidate()
+	{
+		m_stn->m_program = UNKNOWN_STATE;
+		m_stn->m_vertexArray = UNKNOWN_STATE;
+		m_stn->m_framebuffer = UNKNOWN_STATE;
+		m_stn->m_activeTexUnit = UNKNOWN_STATE;
+
+		for (int i = 0; i < m_stn->m_texUnits.size(); ++i) {
+			m_stn->m_texUnits[i].target = UNKNOWN_STATE;
+			m_stn->m_texUnits[i].texture = UNKNOWN_STATE;
+		}
+
+		m_stn->m_blendEnabled = -1;
+		m_stn->m_blendSrcFactor = UNKNOWN_STATE;
+		m_stn->m_blendDstFactor = UNKNOWN_STATE;
+		m_stn->m_depthTestEnabled = -1;
+		m_stn->m_depthMaskEnabled = -1;
+		m_stn->m_depthFunc = UNKNOWN_STATE;
+		m_stn->m_colorMaskEnabled = -1;
+	}
+
+	/**
+	*	@brief Count a state call as issued or filtered.
+	*	@param a_changed is whether the call would change the shadowed state.
+	*	@return whether the call needs to be issued.
+	*/
+	bool GLStateCache::Track(bool a_changed)
+	{
+		if (a_changed) { m_stn->m_issuedCalls++; }
+		else { m_stn->m_filteredCalls++; }
+
+		return a_changed;
+	}
+
+	void GLStateCache::UseProgram(unsigned int a_program)
+	{
+		if (Track(m_stn->m_program != a_program)) {
+			glUseProgram(a_program);
+			m_stn->m_program = a_program;
+		}
+	}
+
+	void GLStateCache::BindVertexArray(unsigned int a_vertexArray)
+	{
+		if (Track(m_stn->m_vertexArray != a_vertexArray)) {
+			glBindVertexArray(a_vertexArray);
+			m_stn->m_vertexArray = a_vertexArray;
+		}
+	}
+
+	/**
+	*	@brief Bind texture to a texture unit, only activating the unit if the binding actually changes.
+	*	@param a_unit is the texture unit number (not the GL_TEXTUREi enum).
+	*	@param a_target is the texture target e.g. GL_TEXTURE_2D.
+	*	@param a_texture is the texture object to bind.
+	*	@return void.
+	*/
+	void GLStateCache::BindTexture(unsigned int a_unit, unsigned int a_target, unsigned int a_texture)
+	{
+		if (a_unit >= m_stn->m_texUnits.size()) {		// Outside of the context's texture units, pass through untracked and let openGL report the error
+			Track(true);
+
+			glActiveTexture(GL_TEXTURE0 + a_unit);
+			glBindTexture(a_target, a_texture);
+			m_stn->m_activeTexUnit = UNKNOWN_STATE;
+			return;
+		}
+
+		TextureBinding& binding = m_stn->m_texUnits[a_unit];
+
+		if (!Track(binding.target != a_target || binding.texture != a_texture)) { return; }
+
+		SetActiveTexture(a_unit);
+
+		glBindTexture(a_target, a_texture);
+		binding.target = a_target;
+		binding.texture = a_texture;
+	}
+
+	/**
+	*	@brief Make a texture unit the target of texture calls like glTexSubImage, without changing what is bound to it.
+	*	NOTE: BindTexture only activates the unit when the binding changes, so call this before editing an already bound texture.
+	*	@param a_unit is the texture unit number (not the GL_TEXTUREi enum).
+	*	@return void.
+	*/
+	void GLStateCache::SetActiveTexture(unsigned int a_unit)
+	{
+		if (Track(m_stn->m_activeTexUnit != a_unit)) {
+			glActiveTexture(GL_TEXTURE0 + a_unit);
+			m_stn->m_activeTexUnit = a_unit;
+		}
+	}
+
+	void GLStateCache::BindFramebuffer(unsigned int a_framebuffer)
+	{
+		if (Track(m_stn->m_framebuffer != a_framebuffer)) {
+			glBindFramebuffer(GL_FRAMEBUFFER, a_framebuffer);
+			m_stn->m_framebuffer = a_framebuffer;
+		}
+	}
+
+	void GLStateCache::SetBlending(bool a_enabled)
+	{
+		if (Track(m_stn->m_blendEnabled != (int)a_enabled)) {
+			if (a_enabled) { glEnable(GL_BLEND); }
+			else { glDisable(GL_BLEND); }
+
+			m_stn->m_blendEnabled = (int)a_enabled;
+		}
+	}
+
+	void GLStateCache::SetBlendFunc(unsigned int a_srcFactor, unsigned int a_dstFactor)
+	{
+		if (Track(m_stn->m_blendSrcFactor != a_srcFactor || m_stn->m_blendDstFactor != a_dstFactor)) {
+			glBlendFunc(a_srcFactor, a_dstFactor);
+
+			m_stn->m_blendSrcFactor = a_srcFactor;
+			m_stn->m_blendDstFactor = a_dstFactor;
+		}
+	}
+
+	void GLStateCache::SetDepthTest(bool a_enabled)
+	{
+		if (Track(m_stn->m_depthTestEnabled != (int)a_enabled)) {
+			if (a_enabled) { glEnable(GL_DEPTH_TEST); }
+			else { glDisable(GL_DEPTH_TEST); }
+
+			m_stn->m_depthTestEnabled = (int)a_enabled;
+		}
+	}
+
+	void GLStateCache::SetDepthMask(bool a_enabled)
+	{
+		if (Track(m_stn->m_depthMaskEnabled != (int)a_enabled)) {
+			glDepthMask(a_enabled);
+			m_stn->m_depthMaskEnabled = (int)a_enabled;
+		}
+	}
+
+	void GLStateCache::SetDepthFunc(unsigned int a_func)
+	{
+		if (Track(m_stn->m_depthFunc != a_func)) {
+			glDepthFunc(a_func);
+			m_stn->m_depthFunc = a_func;
+		}
+	}
+
+	void GLStateCache::SetColorMask(bool a_enabled)
+	{
+		if (Track(m_stn->m_colorMaskEnabled != (int)a_enabled)) {
+			glColorMask(a_enabled, a_enabled, a_enabled, a_enabled);
+			m_stn->m_colorMaskEnabled = (int)a_enabled;
+		}
+	}
+
+	void GLStateCache::ForgetProgram(unsigned int a_program)
+	{
+		if (m_stn && m_stn->m_program == a_program) { m_stn->m_program = UNKNOWN_STATE; }
+	}
+
+	void GLStateCache::ForgetVertexArray(unsigned int a_vertexArray)
+	{
+		if (m_stn && m_stn->m_vertexArray == a_vertexArray) { m_stn->m_vertexArray = UNKNOWN_STATE; }
+	}
+
+	void GLStateCache::ForgetTexture(unsigned int a_texture)
+	{
+		if (!m_stn) { return; }
+
+		for (int i = 0; i < m_stn->m_texUnits.size(); ++i) {
+			if (m_stn->m_texUnits[i].texture == a_texture) {
+				m_stn->m_texUnits[i].target = UNKNOWN_STATE;
+				m_stn->m_texUnits[i].texture = UNKNOWN_STATE;
+			}
+		}
+	}
+
+	void GLStateCache::ForgetFramebuffer(unsigned int a_framebuffer)
+	{
+		if (m_stn && m_stn->m_framebuffer == a_framebuffer) { m_stn->m_framebuffer = UNKNOWN_STATE; }
+	}
+
+	/**
+	*	@brief Display the previous frame's call statistics.
+	*	@return void.
+	*/
+	void GLStateCache::ListenIMGUI()
+	{
+		ImGui::Begin("GL State");
+
+		unsigned int totalCalls = m_stn->m_lastIssuedCalls + m_stn->m_lastFilteredCalls;
+
+		ImGui::Text("State calls issued: %u", m_stn->m_lastIssuedCalls);
+		ImGui::Text("State calls filtered: %u", m_stn->m_lastFilteredCalls);
+		ImGui::Text("Filtered: %.1f%%", (totalCalls ? 100.f * m_stn->m_lastFilteredCalls / totalCalls : 0.f));
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+namespace SPRON {
+	/**
+	*	@brief Static singleton class that shadows bound openGL state and drops calls that would not change it.
+	*	Counts issued and filtered calls per frame so redundant state changes can be tracked.
+	*	NOTE: All state changes for tracked state must go through this class or the shadowed state will go stale, call Invalidate after untracked code changes state.
+	*/
+	class GLStateCache {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static void BeginFrame();
+		static void Invalidate();
+
+		/// Object binding
+		static void UseProgram(unsigned int a_program);
+		static void BindVertexArray(unsigned int a_vertexArray);
+		static void BindTexture(unsigned int a_unit, unsigned int a_target, unsigned int a_texture);
+		static void SetActiveTexture(unsigned int a_unit);
+		static void BindFramebuffer(unsigned int a_framebuffer);
+
+		/// Fixed function state
+		static void SetBlending(bool a_enabled);
+		static void SetBlendFunc(unsigned int a_srcFactor, unsigned int a_dstFactor);
+		static void SetDepthTest(bool a_enabled);
+		static void SetDepthMask(bool a_enabled);
+		static void SetDepthFunc(unsigned int a_func);
+		static void SetColorMask(bool a_enabled);		// Every color channel at once
+
+		/// Deleted objects must be forgotten so a re-used openGL name is not mistaken for an already bound object
+		static void ForgetProgram(unsigned int a_program);
+		static void ForgetVertexArray(unsigned int a_vertexArray);
+		static void ForgetTexture(unsigned int a_texture);
+		static void ForgetFramebuffer(unsigned int a_framebuffer);
+
+		static unsigned int GetIssuedCalls() { return m_stn->m_lastIssuedCalls; }
+		static unsigned int GetFilteredCalls() { return m_stn->m_lastFilteredCalls; }
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static GLStateCache* m_stn;		// Singleton instance
+
+		static bool Track(bool a_changed);
+
+		// Texture bound to a texture unit
+		struct TextureBinding {
+			unsigned int target;
+			unsigned int texture;
+		};
+
+		// Instance variables
+		unsigned int	m_program;
+		unsigned int	m_vertexArray;
+		unsigned int	m_framebuffer;
+		unsigned int	m_activeTexUnit;
+		std::vector<TextureBinding>	m_texUnits;
+
+		int				m_blendEnabled;		// -1 = unknown
+		unsigned int	m_blendSrcFactor;
+		unsigned int	m_blendDstFactor;
+		int				m_depthTestEnabled;
+		int				m_depthMaskEnabled;
+		unsigned int	m_depthFunc;
+		int				m_colorMaskEnabled;
+
+		// Call statistics
+		unsigned int	m_issuedCalls;
+		unsigned int	m_filteredCalls;
+		unsigned int	m_lastIssuedCalls;
+		unsigned int	m_lastFilteredCalls;
+
+		GLStateCache();
+		~GLStateCache();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,448 @@
+#include "GPUCuller.h"
+#include "ShaderWrapper.h"
+#include "Frustum.h"
+#include "AABB.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "Renderer_Utility_Literals.h"
+#include "Texture\TextureBinder.h"
+
+#include <gl_core_4_4.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <string.h>
+#include <assert.h>
+
+namespace SPRON {
+	/// ARB_indirect_parameters, not part of the 4.4 core loader so it is loaded by hand if the context supports it
+	static const GLenum PARAMETER_BUFFER_ARB = 0x80EE;
+
+	typedef void (APIENTRY *MultiDrawElementsIndirectCountFunc)(GLenum a_mode, GLenum a_type, const void* a_indirect, GLintptr a_drawCount,
+		GLsizei a_maxDrawCount, GLsizei a_stride);
+
+	static MultiDrawElementsIndirectCountFunc s_multiDrawElementsIndirectCount = nullptr;
+
+	static const unsigned int CULL_GROUP_SIZE = 64;			// Must match local_size_x of cull_draws.comp
+	static const unsigned int PYRAMID_GROUP_SIZE = 8;		// Must match local_size_x and local_size_y of the depth pyramid shaders
+
+	/**
+	*	@brief Order commands by every field, so batches compacted in a different order can be compared.
+	*/
+	static bool CommandLess(const IndirectDrawCommand& a_lhs, const IndirectDrawCommand& a_rhs)
+	{
+		if (a_lhs.baseInstance != a_rhs.baseInstance) { return a_lhs.baseInstance < a_rhs.baseInstance; }
+		if (a_lhs.firstIndex != a_rhs.firstIndex) { return a_lhs.firstIndex < a_rhs.firstIndex; }
+		if (a_lhs.baseVertex != a_rhs.baseVertex) { return a_lhs.baseVertex < a_rhs.baseVertex; }
+		if (a_lhs.count != a_rhs.count) { return a_lhs.count < a_rhs.count; }
+
+		return a_lhs.instanceCount < a_rhs.instanceCount;
+	}
+
+	GPUCuller::GPUCuller() : m_drawCapacity(0), m_commandCapacity(0), m_countCapacity(0),
+		m_pyramidID(0), m_pyramidWidth(0), m_pyramidHeight(0), m_pyramidLevels(0), m_hasPyramid(false),
+		m_isDrawCountSupported(false), m_validatedVisible(0)
+	{
+		m_cullProgram = new ShaderWrapper("gpu_cull");
+		m_cullProgram->LoadShader("./shaders/cull/cull_draws.comp", COMPUTE_SHADER);
+		m_cullProgram->LinkShaders();
+
+		m_depthCopyProgram = new ShaderWrapper("depth_pyramid_copy");
+		m_depthCopyProgram->LoadShader("./shaders/cull/depth_pyramid_copy.comp", COMPUTE_SHADER);
+		m_depthCopyProgram->LinkShaders();
+
+		m_depthReduceProgram = new ShaderWrapper("depth_pyramid_reduce");
+		m_depthReduceProgram->LoadShader("./shaders/cull/depth_pyramid_reduce.comp", COMPUTE_SHADER);
+		m_depthReduceProgram->LinkShaders();
+
+		glGenBuffers(1, &m_drawBufferID);
+		glGenBuffers(1, &m_inputBufferID);
+		glGenBuffers(1, &m_outputBufferID);
+		glGenBuffers(1, &m_countBufferID);
+
+		// Draw counts can only be read from a buffer with ARB_indirect_parameters
+		int extensionNum = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensionNum);
+
+		for (int i = 0; i < extensionNum; ++i) {
+			if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_indirect_parameters") == 0) {
+				s_multiDrawElementsIndirectCount = (MultiDrawElementsIndirectCountFunc)glfwGetProcAddress("glMultiDrawElementsIndirectCountARB");
+				break;
+			}
+		}
+
+		m_isDrawCountSupported = (s_multiDrawElementsIndirectCount != nullptr);
+	}
+
+	GPUCuller::~GPUCuller()
+	{
+		delete m_cullProgram;
+		delete m_depthCopyProgram;
+		delete m_depthReduceProgram;
+
+		glDeleteBuffers(1, &m_drawBufferID);
+		glDeleteBuffers(1, &m_inputBufferID);
+		glDeleteBuffers(1, &m_outputBufferID);
+		glDeleteBuffers(1, &m_countBufferID);
+
+		if (m_pyramidID) {
+			TextureBinder::Forget(m_pyramidID);
+			glDeleteTextures(1, &m_pyramidID);
+		}
+	}
+
+	/**
+	*	@brief Upload a frame's commands and their bounds, then cull and compact them on the GPU.
+	*	The compacted commands are left bound as the indirect buffer, and the batch counts as the parameter buffer if draw counts are supported.
+	*	NOTE: Batches are found through each draw's first command, so the commands of a batch must be consecutive.
+	*	@param a_commands is the draw commands of the frame, in the order they are drawn.
+	*	@param a_draws is the bounds and batch of each command.
+	*	@param a_frustum is the view frustum of the frame.
+	*	@return void.
+	*/
+	void GPUCuller::Cull(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum & a_frustum)
+	{
+		assert(a_commands.size() == a_draws.size() && "ERROR::GPU_CULLER::COMMAND_BOUNDS_MISMATCH");
+
+		unsigned int commandCount = (unsigned int)a_commands.size();
+		if (commandCount == 0) { return; }
+
+		unsigned int commandBytes = sizeof(IndirectDrawCommand) * commandCount;
+
+		//// Upload
+		// NOTE: Storage is orphaned every frame so the upload does not wait on last frame's cull still reading it
+		ReserveBuffer(m_drawBufferID, sizeof(CullDrawData) * commandCount, m_drawCapacity);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullDrawData) * commandCount, &a_draws[0]);
+
+		ReserveBuffer(m_inputBufferID, commandBytes, m_commandCapacity);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commandBytes, &a_commands[0]);
+
+		// Commands that are not written to stay as draws of 0 instances, counts start at 0
+		unsigned int outputCapacity = m_commandCapacity;		// Always the same size as the input
+		ReserveBuffer(m_outputBufferID, commandBytes, outputCapacity);
+		glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, commandBytes, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+		ReserveBuffer(m_countBufferID, sizeof(unsigned int) * commandCount, m_countCapacity);
+		glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(unsigned int) * commandCount, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_CULL_DRAWS, m_drawBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_CULL_INPUT_COMMANDS, m_inputBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_CULL_OUTPUT_COMMANDS, m_outputBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_CULL_COUNTS, m_countBufferID);
+
+		//// Cull
+		m_cullProgram->SetInt(Uniforms::CULL_DRAW_COUNT, (int)commandCount);
+		glProgramUniform4fv(*m_cullProgram, m_cullProgram->FindLocation("frustumPlanes"), 6, &a_frustum.GetPlanes()[0].x);
+
+		m_cullProgram->SetBool(Uniforms::CULL_USE_PYRAMID, m_hasPyramid);
+
+		if (m_hasPyramid) {
+			// NOTE: Sampled from the scratch unit, nothing else is bound before the dispatch
+			TextureBinder::BindForEdit(GL_TEXTURE_2D, m_pyramidID);
+
+			m_cullProgram->SetInt(Uniforms::CULL_DEPTH_PYRAMID, 0);
+			m_cullProgram->SetMat4(Uniforms::CULL_PYRAMID_PROJECTION_VIEW, m_pyramidProjectionView);
+		}
+
+		GLStateCache::UseProgram(*m_cullProgram);
+		glDispatchCompute((commandCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+		// Draws read the commands and counts written by the shader
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_outputBufferID);
+
+		if (m_isDrawCountSupported) {
+			glBindBuffer(PARAMETER_BUFFER_ARB, m_countBufferID);
+		}
+	}
+
+	/**
+	*	@brief Build the depth pyramid the next frame's cull tests against from the depth the scene was just rendered with.
+	*	@param a_depthTexture is the depth texture the scene was rendered to, 0 disables the occlusion test.
+	*	@param a_projectionView is the projection matrix multiplied by the view matrix the scene was rendered with.
+	*	@return void.
+	*/
+	void GPUCuller::BuildDepthPyramid(unsigned int a_depthTexture, const glm::mat4 & a_projectionView)
+	{
+		if (a_depthTexture == 0) {
+			m_hasPyramid = false;
+			return;
+		}
+
+		// Match the pyramid to the depth texture
+		int width = 0, height = 0;
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, a_depthTexture);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+		if (width <= 0 || height <= 0) { return; }
+
+		if ((unsigned int)width != m_pyramidWidth || (unsigned int)height != m_pyramidHeight) {
+			ResizeDepthPyramid(width, height);
+		}
+
+		//// First level, copied from the depth texture (NOTE: Depth textures can't be bound as images)
+		m_depthCopyProgram->SetInt(Uniforms::CULL_DEPTH_TEX, 0);		// Still bound to the scratch unit
+
+		glBindImageTexture(0, m_pyramidID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		GLStateCache::UseProgram(*m_depthCopyProgram);
+		glDispatchCompute((width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+
+		//// Each following level keeps the furthest depth of the level above it
+		GLStateCache::UseProgram(*m_depthReduceProgram);
+
+		for (unsigned int i = 1; i < m_pyramidLevels; ++i) {
+			unsigned int levelWidth = std::max(1u, m_pyramidWidth >> i);
+			unsigned int levelHeight = std::max(1u, m_pyramidHeight >> i);
+
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);		// Previous level must be written before it is read
+
+			glBindImageTexture(0, m_pyramidID, i - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+			glBindImageTexture(1, m_pyramidID, i, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+			glDispatchCompute((levelWidth + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (levelHeight + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+		}
+
+		// Cull reads the pyramid with texel fetches
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+		m_pyramidProjectionView = a_projectionView;
+		m_hasPyramid = true;
+	}
+
+	/**
+	*	@brief Cull and compact the commands on the CPU exactly as cull_draws.comp does, against the pyramid last read back.
+	*	NOTE: Visible commands keep their order within a batch, the shader's order depends on which invocation finishes first.
+	*	@param a_commands is the draw commands of the frame, in the order they are drawn.
+	*	@param a_draws is the bounds and batch of each command.
+	*	@param a_frustum is the view frustum of the frame.
+	*	@param a_culled is the list to write the compacted commands to, resized to the number of commands.
+	*	@param a_counts is the list to write each batch's visible count to, at the batch's first command.
+	*	@return void.
+	*/
+	void GPUCuller::CullReference(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum & a_frustum,
+		std::vector<IndirectDrawCommand>& a_culled, std::vector<unsigned int>& a_counts) const
+	{
+		assert(a_commands.size() == a_draws.size() && "ERROR::GPU_CULLER::COMMAND_BOUNDS_MISMATCH");
+
+		IndirectDrawCommand emptyCommand = { 0, 0, 0, 0, 0 };
+
+		a_culled.assign(a_commands.size(), emptyCommand);
+		a_counts.assign(a_commands.size(), 0);
+
+		for (unsigned int i = 0; i < a_commands.size(); ++i) {
+			if (!IsDrawVisible(a_draws[i], a_frustum)) { continue; }
+
+			unsigned int first = a_draws[i].firstCommand;
+			a_culled[first + a_counts[first]++] = a_commands[i];
+		}
+	}
+
+	/**
+	*	@brief Read back the last cull's results and depth pyramid and compare them against the CPU reference.
+	*	NOTE: Stalls until the GPU has finished the cull, only meant for debugging.
+	*	@param a_commands is the draw commands given to the last cull.
+	*	@param a_draws is the bounds given to the last cull.
+	*	@param a_frustum is the frustum given to the last cull.
+	*	@return number of batches whose visible commands differ between the GPU and the CPU.
+	*/
+	unsigned int GPUCuller::Validate(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum & a_frustum)
+	{
+		unsigned int commandCount = (unsigned int)a_commands.size();
+		if (commandCount == 0) { return 0; }
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+		std::vector<IndirectDrawCommand> gpuCommands(commandCount);
+		std::vector<unsigned int> gpuCounts(commandCount);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_outputBufferID);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(IndirectDrawCommand) * commandCount, &gpuCommands[0]);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBufferID);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned int) * commandCount, &gpuCounts[0]);
+
+		if (m_hasPyramid) { ReadDepthPyramid(); }
+
+		std::vector<IndirectDrawCommand> cpuCommands;
+		std::vector<unsigned int> cpuCounts;
+		CullReference(a_commands, a_draws, a_frustum, cpuCommands, cpuCounts);
+
+		// Compare each batch's visible commands, ignoring their order
+		unsigned int mismatchCount = 0;
+		m_validatedVisible = 0;
+
+		for (unsigned int i = 0; i < commandCount; ++i) {
+			if (a_draws[i].firstCommand != i) { continue; }		// Not the first command of a batch
+
+			m_validatedVisible += cpuCounts[i];
+
+			if (gpuCounts[i] != cpuCounts[i]) {
+				mismatchCount++;
+				continue;
+			}
+
+			std::sort(gpuCommands.begin() + i, gpuCommands.begin() + i + gpuCounts[i], CommandLess);
+			std::sort(cpuCommands.begin() + i, cpuCommands.begin() + i + cpuCounts[i], CommandLess);
+
+			if (memcmp(&gpuCommands[i], &cpuCommands[i], sizeof(IndirectDrawCommand) * cpuCounts[i]) != 0) { mismatchCount++; }
+		}
+
+		return mismatchCount;
+	}
+
+	/**
+	*	@brief Draw a batch of compacted commands with its visible count read from the parameter buffer.
+	*	NOTE: Only valid if IsDrawCountSupported, the indirect and parameter buffers bound by Cull must still be bound.
+	*	@param a_firstCommand is the batch's first command, its count is stored at the same index.
+	*	@param a_maxCount is the number of commands in the batch.
+	*	@return void.
+	*/
+	void GPUCuller::MultiDrawCounted(unsigned int a_firstCommand, unsigned int a_maxCount)
+	{
+		assert(s_multiDrawElementsIndirectCount && "ERROR::GPU_CULLER::DRAW_COUNT_NOT_SUPPORTED");
+
+		s_multiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(void*)(sizeof(IndirectDrawCommand) * a_firstCommand),		// Offset of the batch's first command in the indirect buffer
+			sizeof(unsigned int) * a_firstCommand,						// Offset of the batch's count in the parameter buffer
+			a_maxCount,
+			0);															// Commands are tightly packed
+	}
+
+	/**
+	*	@brief Test a command's box against the frustum and the depth pyramid, mirrors cull_draws.comp.
+	*	@param a_draw is the bounds of the command.
+	*	@param a_frustum is the view frustum of the frame.
+	*	@return false if the box is outside the frustum or behind the pyramid's depth.
+	*/
+	bool GPUCuller::IsDrawVisible(const CullDrawData & a_draw, const Frustum & a_frustum) const
+	{
+		if (a_frustum.TestAABB(AABB(a_draw.boundsMin, a_draw.boundsMax)) == FRUSTUM_OUTSIDE) { return false; }
+
+		if (!m_hasPyramid || m_pyramidReadback.size() != m_pyramidLevels) { return true; }
+
+		// Screen rectangle and nearest depth of the box as the pyramid's camera saw it
+		glm::vec2 rectMin = glm::vec2(1.f);
+		glm::vec2 rectMax = glm::vec2(0.f);
+		float nearestDepth = 1.f;
+
+		for (unsigned int i = 0; i < 8; ++i) {
+			glm::vec3 corner = glm::vec3((i & 1) ? a_draw.boundsMax.x : a_draw.boundsMin.x,
+				(i & 2) ? a_draw.boundsMax.y : a_draw.boundsMin.y,
+				(i & 4) ? a_draw.boundsMax.z : a_draw.boundsMin.z);
+
+			glm::vec4 clip = m_pyramidProjectionView * glm::vec4(corner, 1.f);
+			if (clip.w <= 0.f) { return true; }		// Box crosses the camera's plane, nothing can be said about it
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+			rectMin = glm::min(rectMin, glm::vec2(ndc) * 0.5f + 0.5f);
+			rectMax = glm::max(rectMax, glm::vec2(ndc) * 0.5f + 0.5f);
+			nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+		}
+
+		if (rectMax.x < 0.f || rectMax.y < 0.f || rectMin.x > 1.f || rectMin.y > 1.f) { return true; }		// Not on the pyramid's screen
+
+		// Texels of the first level covered by the rectangle
+		int pixelMinX = glm::clamp((int)glm::floor(rectMin.x * m_pyramidWidth), 0, (int)m_pyramidWidth - 1);
+		int pixelMinY = glm::clamp((int)glm::floor(rectMin.y * m_pyramidHeight), 0, (int)m_pyramidHeight - 1);
+		int pixelMaxX = glm::clamp((int)glm::floor(rectMax.x * m_pyramidWidth), 0, (int)m_pyramidWidth - 1);
+		int pixelMaxY = glm::clamp((int)glm::floor(rectMax.y * m_pyramidHeight), 0, (int)m_pyramidHeight - 1);
+
+		// First level where the rectangle covers at most 2x2 texels
+		int span = std::max(pixelMaxX - pixelMinX, pixelMaxY - pixelMinY);
+
+		unsigned int level = 0;
+		while ((span >> level) > 0) { level++; }
+		level = std::min(level, m_pyramidLevels - 1);
+
+		int levelWidth = std::max(1, (int)m_pyramidWidth >> level);
+		int levelHeight = std::max(1, (int)m_pyramidHeight >> level);
+
+		// NOTE: The last texel of a level also covers the odd texels left over from the level above, so coordinates are clamped rather than rescaled
+		int texelMinX = std::min(pixelMinX >> level, levelWidth - 1);
+		int texelMinY = std::min(pixelMinY >> level, levelHeight - 1);
+		int texelMaxX = std::min(pixelMaxX >> level, levelWidth - 1);
+		int texelMaxY = std::min(pixelMaxY >> level, levelHeight - 1);
+
+		const std::vector<float>& depth = m_pyramidReadback[level];
+		float furthestDepth = 0.f;
+
+		for (int y = texelMinY; y <= texelMaxY; ++y) {
+			for (int x = texelMinX; x <= texelMaxX; ++x) {
+				furthestDepth = std::max(furthestDepth, depth[y * levelWidth + x]);
+			}
+		}
+
+		return nearestDepth <= furthestDepth;
+	}
+
+	/**
+	*	@brief Re-create the pyramid texture with a full mip chain for a new depth texture size.
+	*	@param a_width is the width of the depth texture.
+	*	@param a_height is the height of the depth texture.
+	*	@return void.
+	*/
+	void GPUCuller::ResizeDepthPyramid(unsigned int a_width, unsigned int a_height)
+	{
+		if (m_pyramidID) {
+			TextureBinder::Forget(m_pyramidID);
+			glDeleteTextures(1, &m_pyramidID);
+		}
+
+		m_pyramidWidth = a_width;
+		m_pyramidHeight = a_height;
+
+		// Halve until a single texel remains
+		m_pyramidLevels = 1;
+		while ((std::max(a_width, a_height) >> m_pyramidLevels) > 0) { m_pyramidLevels++; }
+
+		glGenTextures(1, &m_pyramidID);
+
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, m_pyramidID);
+		glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, a_width, a_height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		m_pyramidReadback.clear();
+		m_hasPyramid = false;
+	}
+
+	/**
+	*	@brief Copy every level of the pyramid to the CPU for the reference cull.
+	*	@return void.
+	*/
+	void GPUCuller::ReadDepthPyramid()
+	{
+		m_pyramidReadback.resize(m_pyramidLevels);
+
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, m_pyramidID);
+
+		for (unsigned int i = 0; i < m_pyramidLevels; ++i) {
+			unsigned int levelWidth = std::max(1u, m_pyramidWidth >> i);
+			unsigned int levelHeight = std::max(1u, m_pyramidHeight >> i);
+
+			m_pyramidReadback[i].resize(levelWidth * levelHeight);
+			glGetTexImage(GL_TEXTURE_2D, i, GL_RED, GL_FLOAT, &m_pyramidReadback[i][0]);
+		}
+	}
+
+	/**
+	*	@brief Orphan a buffer's storage, growing it if it is too small.
+	*	NOTE: Leaves the buffer bound as the shader storage buffer.
+	*	@param a_bufferID is the buffer to reserve storage for.
+	*	@param a_size is the number of bytes needed.
+	*	@param a_capacity is the number of bytes the buffer has storage for, updated if it grows.
+	*	@return void.
+	*/
+	void GPUCuller::ReserveBuffer(unsigned int a_bufferID, unsigned int a_size, unsigned int & a_capacity)
+	{
+		if (a_size > a_capacity) {		// Out of storage, grow
+			a_capacity = std::max(a_size, a_capacity * 2);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, a_bufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, a_capacity, nullptr, GL_STREAM_DRAW);
+	}
+}
\ No newline at end of file
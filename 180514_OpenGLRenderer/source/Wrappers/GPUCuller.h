@@ -0,0 +1,88 @@
+#pragma once
+
+#include "GeometryPool.h"
+
+#include <vector>
+#include <stddef.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class ShaderWrapper;
+	class Frustum;
+}
+
+namespace SPRON {
+	// Mirror of the std430 "CullDraw" shader struct, the bounds of one indirect draw command and the batch it is drawn in
+	struct CullDrawData {
+		glm::vec3		boundsMin;			// World space box of everything the command draws
+		unsigned int	firstCommand;		// First command of the command's batch, its compacted commands are written from here
+		glm::vec3		boundsMax;
+		unsigned int	padding;
+	};
+
+	static_assert(offsetof(CullDrawData, firstCommand) == 12 && offsetof(CullDrawData, boundsMax) == 16, "ERROR::GPU_CULLER::CULL_DRAW_NOT_STD430");
+	static_assert(sizeof(CullDrawData) == 32, "ERROR::GPU_CULLER::CULL_DRAW_NOT_STD430");
+
+	/**
+	*	@brief Culls a frame's indirect draw commands in a compute shader, against the view frustum and a depth pyramid (Hi-Z) of the previous frame.
+	*	Visible commands are compacted to the front of their batch's range in the indirect buffer and counted per batch, the rest of the range is left
+	*	as draws of 0 instances. If the context supports ARB_indirect_parameters the batches are drawn with their counts, otherwise the whole range is drawn.
+	*	The depth pyramid halves in size each level and keeps the furthest depth of the texels below it, so a box is tested with at most 2x2 texels.
+	*	NOTE: Boxes are tested against the previous frame's depth from the previous frame's camera, so anything uncovered since then appears a frame late.
+	*	A CPU reference of the same tests can be run on read back results to validate the shaders.
+	*/
+	class GPUCuller {
+	public:
+		GPUCuller();
+		~GPUCuller();
+
+		void Cull(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum& a_frustum);
+		void BuildDepthPyramid(unsigned int a_depthTexture, const glm::mat4& a_projectionView);
+		void InvalidateDepthPyramid() { m_hasPyramid = false; }
+
+		void CullReference(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum& a_frustum,
+			std::vector<IndirectDrawCommand>& a_culled, std::vector<unsigned int>& a_counts) const;
+		unsigned int Validate(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<CullDrawData>& a_draws, const Frustum& a_frustum);
+
+		static void MultiDrawCounted(unsigned int a_firstCommand, unsigned int a_maxCount);
+
+		bool IsDrawCountSupported() const { return m_isDrawCountSupported; }
+		bool HasDepthPyramid() const { return m_hasPyramid; }
+		unsigned int GetPyramidWidth() const { return m_pyramidWidth; }
+		unsigned int GetPyramidHeight() const { return m_pyramidHeight; }
+		unsigned int GetPyramidLevels() const { return m_pyramidLevels; }
+		unsigned int GetValidatedVisible() const { return m_validatedVisible; }
+	protected:
+	private:
+		bool IsDrawVisible(const CullDrawData& a_draw, const Frustum& a_frustum) const;
+		void ResizeDepthPyramid(unsigned int a_width, unsigned int a_height);
+		void ReadDepthPyramid();
+		static void ReserveBuffer(unsigned int a_bufferID, unsigned int a_size, unsigned int& a_capacity);
+
+		ShaderWrapper*	m_cullProgram;
+		ShaderWrapper*	m_depthCopyProgram;		// Writes the depth texture into the pyramid's first level
+		ShaderWrapper*	m_depthReduceProgram;	// Writes each level from the level above it
+
+		unsigned int	m_drawBufferID;			// Bounds of each command
+		unsigned int	m_inputBufferID;		// Commands as recorded
+		unsigned int	m_outputBufferID;		// Compacted commands, bound as the indirect buffer for the queue's draws
+		unsigned int	m_countBufferID;		// Visible commands of each batch, at the batch's first command
+		unsigned int	m_drawCapacity;			// Bytes of storage in each buffer
+		unsigned int	m_commandCapacity;
+		unsigned int	m_countCapacity;
+
+		unsigned int	m_pyramidID;
+		unsigned int	m_pyramidWidth;
+		unsigned int	m_pyramidHeight;
+		unsigned int	m_pyramidLevels;
+		glm::mat4		m_pyramidProjectionView;	// Camera the pyramid's depth was rendered from
+		bool			m_hasPyramid;
+
+		bool			m_isDrawCountSupported;
+
+		std::vector<std::vector<float>>	m_pyramidReadback;		// Levels of the pyramid read back for the CPU reference
+		unsigned int					m_validatedVisible;		// Visible commands found by the last validation
+	};
+}
\ No newline at end of file
@@ -0,0 +1,493 @@
+#include "GeometryPool.h"
+#include "Vertex.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <assert.h>
+#include <stddef.h>
+
+namespace SPRON {
+	/// Static initialisation
+	GeometryPool* GeometryPool::m_stn = nullptr;
+
+	GeometryPool::GeometryPool() :
+		m_vertexArrayID(0), m_positionArrayID(0), m_vertexBufferID(0), m_positionBufferID(0), m_indexBufferID(0), m_drawIDBufferID(0),
+		m_allocatedThisFrame(false), m_allocationCount(0), m_growCount(0), m_movedBytes(0), m_movedBytesLastFrame(0)
+	{
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		// Clean up vertex array
+		GLStateCache::ForgetVertexArray(m_vertexArrayID);
+		GLStateCache::ForgetVertexArray(m_positionArrayID);
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		glDeleteVertexArrays(1, &m_positionArrayID);
+
+		// Clean up buffers
+		glDeleteBuffers(1, &m_vertexBufferID);
+		glDeleteBuffers(1, &m_positionBufferID);
+		glDeleteBuffers(1, &m_indexBufferID);
+		glDeleteBuffers(1, &m_drawIDBufferID);
+	}
+
+	/**
+	*	@brief Create singleton, allocate the shared buffers and describe the vertex layout once on the pool's vertex array.
+	*	NOTE: Must be called after UniformBlocks::Initialise, the draw ID buffer is sized to the number of object blocks.
+	*	@return void.
+	*/
+	void GeometryPool::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new GeometryPool();
+
+			glGenVertexArrays(1, &m_stn->m_vertexArrayID);
+			glGenVertexArrays(1, &m_stn->m_positionArrayID);
+
+			// Allocate initial storage
+			Grow(m_stn->m_vertexBufferID, m_stn->m_vertexAllocator, INITIAL_VERTEX_CAPACITY, sizeof(Vertex));
+			Grow(m_stn->m_indexBufferID, m_stn->m_indexAllocator, INITIAL_INDEX_CAPACITY, sizeof(unsigned int));
+
+			// Draw IDs, one per object block so any object index can be passed as a base instance
+			std::vector<unsigned int> drawIDs(UniformBlocks::GetObjectCapacity());
+			for (unsigned int i = 0; i < drawIDs.size(); ++i) { drawIDs[i] = i; }
+
+			CreateStorage(m_stn->m_drawIDBufferID, sizeof(unsigned int) * (unsigned int)drawIDs.size(), &drawIDs[0], 0);		// Never changes
+
+			/// Pre-defined memory layout attributes
+			// NOTE: Formats are separate from the buffers they read from, so growing a buffer only needs it to be re-attached
+			Bind();
+
+			//// Vertex Position
+			glVertexAttribFormat(VERTEX_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE, 0);
+
+			//// Vertex Texture Coords
+			glVertexAttribFormat(VERTEX_ATTRIBUTE_TEX_COORD, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, texCoord));	// Use offsetof macro to get the point in which the tex coordinates data starts
+
+			//// Vertex Normal
+			glVertexAttribFormat(VERTEX_ATTRIBUTE_NORMAL, 3, GL_FLOAT, GL_TRUE, offsetof(Vertex, normal));
+
+			//// Vertex Tangent Normal
+			glVertexAttribFormat(VERTEX_ATTRIBUTE_TANGENT, 4, GL_FLOAT, GL_TRUE, offsetof(Vertex, normalTangent));
+
+			for (unsigned int i = VERTEX_ATTRIBUTE_POSITION; i <= VERTEX_ATTRIBUTE_TANGENT; ++i) {
+				glVertexAttribBinding(i, 0);		// All per vertex attributes read from vertex buffer binding 0
+				glEnableVertexAttribArray(i);
+			}
+
+			//// Draw ID (integer, advances once per instance)
+			glVertexAttribIFormat(VERTEX_ATTRIBUTE_DRAW_ID, 1, GL_UNSIGNED_INT, 0);
+			glVertexAttribBinding(VERTEX_ATTRIBUTE_DRAW_ID, 1);
+			glVertexBindingDivisor(1, 1);
+			glEnableVertexAttribArray(VERTEX_ATTRIBUTE_DRAW_ID);
+
+			/// Position only layout, read by depth only draws
+			// NOTE: Positions are stored as vec3s, shaders reading them as vec4s are given a w component of 1
+			BindPositions();
+
+			glVertexAttribFormat(VERTEX_ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, 0);
+			glVertexAttribBinding(VERTEX_ATTRIBUTE_POSITION, 0);
+			glEnableVertexAttribArray(VERTEX_ATTRIBUTE_POSITION);
+
+			glVertexAttribIFormat(VERTEX_ATTRIBUTE_DRAW_ID, 1, GL_UNSIGNED_INT, 0);
+			glVertexAttribBinding(VERTEX_ATTRIBUTE_DRAW_ID, 1);
+			glVertexBindingDivisor(1, 1);
+			glEnableVertexAttribArray(VERTEX_ATTRIBUTE_DRAW_ID);
+
+			AttachBuffers();
+		}
+	}
+
+	void GeometryPool::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Copy a mesh's vertices and indices into free ranges of the shared buffers, growing them if no range is large enough.
+	*	NOTE: Meshes without indices are given a sequential index list so every mesh can be drawn the same way.
+	*	@param a_verts is the vertex data of the mesh.
+	*	@param a_indices is the draw order of the vertices, an empty or single element list draws the vertices in order.
+	*	@return handle to the mesh's geometry, to be passed to GetRange and MakeCommand.
+	*/
+	unsigned int GeometryPool::Allocate(const std::vector<Vertex>& a_verts, const std::vector<unsigned int>& a_indices)
+	{
+		if (a_verts.empty()) { return INVALID_GEOMETRY; }
+
+		// Determine draw order
+		std::vector<unsigned int> sequentialIndices;
+		const std::vector<unsigned int>* indices = &a_indices;
+
+		if (a_indices.size() <= 1) {		// Mesh has no preset draw format
+			sequentialIndices.resize(a_verts.size());
+			for (unsigned int i = 0; i < sequentialIndices.size(); ++i) { sequentialIndices[i] = i; }
+
+			indices = &sequentialIndices;
+		}
+
+		// Make room
+		Allocation allocation;
+		allocation.vertexBlock = Reserve(m_stn->m_vertexBufferID, m_stn->m_vertexAllocator, (unsigned int)a_verts.size(), sizeof(Vertex));
+		allocation.indexBlock = Reserve(m_stn->m_indexBufferID, m_stn->m_indexAllocator, (unsigned int)indices->size(), sizeof(unsigned int));
+
+		// Upload, indices stay local to the mesh and are offset by the base vertex when drawn
+		// NOTE: Copy target so the bound vertex array's element buffer is not modified
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_stn->m_vertexBufferID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * m_stn->m_vertexAllocator.GetOffset(allocation.vertexBlock), sizeof(Vertex) * a_verts.size(), &a_verts[0]);
+
+		std::vector<glm::vec3> positions(a_verts.size());
+		for (unsigned int i = 0; i < positions.size(); ++i) { positions[i] = glm::vec3(a_verts[i].pos); }
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_stn->m_positionBufferID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(glm::vec3) * m_stn->m_vertexAllocator.GetOffset(allocation.vertexBlock), sizeof(glm::vec3) * positions.size(), &positions[0]);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_stn->m_indexBufferID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * m_stn->m_indexAllocator.GetOffset(allocation.indexBlock), sizeof(unsigned int) * indices->size(), &(*indices)[0]);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// Hand out a handle, blocks remember it so defragmentation can find the allocation they belong to
+		unsigned int handle;
+
+		if (!m_stn->m_unusedAllocations.empty()) {
+			handle = m_stn->m_unusedAllocations.back();
+			m_stn->m_unusedAllocations.pop_back();
+
+			m_stn->m_allocations[handle] = allocation;
+		}
+		else {
+			handle = (unsigned int)m_stn->m_allocations.size();
+			m_stn->m_allocations.push_back(allocation);
+		}
+
+		m_stn->m_vertexAllocator.SetUserData(allocation.vertexBlock, handle);
+		m_stn->m_indexAllocator.SetUserData(allocation.indexBlock, handle);
+
+		m_stn->m_allocatedThisFrame = true;
+		m_stn->m_allocationCount++;
+
+		return handle;
+	}
+
+	/**
+	*	@brief Release a mesh's ranges of the shared buffers so they can be re-used.
+	*	@param a_geometry is the handle returned by Allocate.
+	*	@return void.
+	*/
+	void GeometryPool::Free(unsigned int a_geometry)
+	{
+		if (!m_stn || a_geometry == INVALID_GEOMETRY) { return; }		// Pool already shut down or mesh had no geometry
+
+		Allocation& allocation = m_stn->m_allocations[a_geometry];
+
+		m_stn->m_vertexAllocator.Free(allocation.vertexBlock);
+		m_stn->m_indexAllocator.Free(allocation.indexBlock);
+
+		allocation.vertexBlock = allocation.indexBlock = BufferAllocator::INVALID_BLOCK;
+		m_stn->m_unusedAllocations.push_back(a_geometry);
+
+		m_stn->m_allocationCount--;
+	}
+
+	/**
+	*	@brief Close gaps left by freed meshes by moving the geometry furthest into each buffer down into a free range, copied on the GPU.
+	*	Skipped on frames that allocated geometry, so moves only happen while nothing is being loaded.
+	*	NOTE: Must be called before draws are recorded for the frame, commands made earlier would point at the old ranges.
+	*	@param a_byteBudget is the maximum number of bytes to copy this call.
+	*	@return void.
+	*/
+	void GeometryPool::Defragment(unsigned int a_byteBudget)
+	{
+		m_stn->m_movedBytesLastFrame = 0;
+
+		if (m_stn->m_allocatedThisFrame) {
+			m_stn->m_allocatedThisFrame = false;
+			return;
+		}
+
+		// Alternate between buffers so neither starves the other of budget
+		bool moveVertices = true, moveIndices = true;
+
+		while ((moveVertices || moveIndices) && m_stn->m_movedBytesLastFrame < a_byteBudget) {
+			if (moveVertices) {
+				unsigned int moved = MoveDown(m_stn->m_vertexBufferID, m_stn->m_vertexAllocator, sizeof(Vertex));
+
+				moveVertices = (moved != 0);
+				m_stn->m_movedBytesLastFrame += moved;
+			}
+
+			if (moveIndices) {
+				unsigned int moved = MoveDown(m_stn->m_indexBufferID, m_stn->m_indexAllocator, sizeof(unsigned int));
+
+				moveIndices = (moved != 0);
+				m_stn->m_movedBytesLastFrame += moved;
+			}
+		}
+
+		m_stn->m_movedBytes += m_stn->m_movedBytesLastFrame;
+	}
+
+	/**
+	*	@brief Bind the pool's vertex array, the only one any mesh needs.
+	*	@return void.
+	*/
+	void GeometryPool::Bind()
+	{
+		GLStateCache::BindVertexArray(m_stn->m_vertexArrayID);
+	}
+
+	/**
+	*	@brief Bind the pool's position only vertex array, drawn with the same indices and draw commands as the full vertex array.
+	*	NOTE: Only the position and draw ID attributes are enabled, so it can only be used by shaders that read nothing else.
+	*	@return void.
+	*/
+	void GeometryPool::BindPositions()
+	{
+		GLStateCache::BindVertexArray(m_stn->m_positionArrayID);
+	}
+
+	/**
+	*	@brief Look up where a mesh's geometry currently is in the shared buffers.
+	*	@param a_geometry is the handle returned by Allocate.
+	*	@return offsets and counts of the mesh's vertices and indices, empty for an invalid handle.
+	*/
+	GeometryRange GeometryPool::GetRange(unsigned int a_geometry)
+	{
+		GeometryRange range;
+		if (a_geometry == INVALID_GEOMETRY) { return range; }
+
+		const Allocation& allocation = m_stn->m_allocations[a_geometry];
+
+		range.firstIndex = m_stn->m_indexAllocator.GetOffset(allocation.indexBlock);
+		range.indexCount = m_stn->m_indexAllocator.GetSize(allocation.indexBlock);
+		range.baseVertex = (int)m_stn->m_vertexAllocator.GetOffset(allocation.vertexBlock);
+		range.vertexCount = m_stn->m_vertexAllocator.GetSize(allocation.vertexBlock);
+
+		return range;
+	}
+
+	/**
+	*	@brief Create the indirect draw command for one or more instances of a mesh.
+	*	@param a_geometry is the handle of the mesh's geometry.
+	*	@param a_objectIndex is the index of the object block to draw with, returned by UniformBlocks::PushObject.
+	*	@param a_instanceCount is the number of instances, each reads the object block after the previous one.
+	*	@return command to be written into an indirect buffer.
+	*/
+	IndirectDrawCommand GeometryPool::MakeCommand(unsigned int a_geometry, unsigned int a_objectIndex, unsigned int a_instanceCount)
+	{
+		GeometryRange range = GetRange(a_geometry);
+
+		IndirectDrawCommand command;
+		command.count = range.indexCount;
+		command.instanceCount = a_instanceCount;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = a_objectIndex;
+
+		return command;
+	}
+
+	/**
+	*	@brief Display how full and how fragmented the shared buffers are.
+	*	@return void.
+	*/
+	void GeometryPool::ListenIMGUI()
+	{
+		ImGui::Begin("Geometry Pool");
+
+		ImGui::Text("Meshes allocated: %u", m_stn->m_allocationCount);
+
+		const BufferAllocator& vertices = m_stn->m_vertexAllocator;
+		ImGui::Text("Vertex bytes: %u / %u reserved", vertices.GetUsed() * (unsigned int)sizeof(Vertex), vertices.GetCapacity() * (unsigned int)sizeof(Vertex));
+		ImGui::Text("Vertex fragmentation: %.1f%% (%u free blocks)", vertices.GetFragmentation() * 100.f, vertices.GetFreeBlockCount());
+		ImGui::Text("Position bytes: %u / %u reserved", vertices.GetUsed() * (unsigned int)sizeof(glm::vec3), vertices.GetCapacity() * (unsigned int)sizeof(glm::vec3));
+
+		const BufferAllocator& indices = m_stn->m_indexAllocator;
+		ImGui::Text("Index bytes: %u / %u reserved", indices.GetUsed() * (unsigned int)sizeof(unsigned int), indices.GetCapacity() * (unsigned int)sizeof(unsigned int));
+		ImGui::Text("Index fragmentation: %.1f%% (%u free blocks)", indices.GetFragmentation() * 100.f, indices.GetFreeBlockCount());
+
+		ImGui::Text("Buffer re-allocations: %u", m_stn->m_growCount);
+		ImGui::Text("Defragmentation: %u bytes moved (%u last frame)", m_stn->m_movedBytes, m_stn->m_movedBytesLastFrame);
+
+		ImGui::End();
+	}
+
+	/**
+	*	@brief Reserve a range of a shared buffer, re-allocating the buffer if no free range is large enough.
+	*	@param a_bufferID is the buffer to reserve from, replaced if the buffer is re-allocated.
+	*	@param a_allocator is the allocator managing the buffer.
+	*	@param a_size is the number of elements to reserve.
+	*	@param a_elementSize is the size of an element in bytes.
+	*	@return handle of the reserved block in the allocator.
+	*/
+	unsigned int GeometryPool::Reserve(unsigned int & a_bufferID, BufferAllocator & a_allocator, unsigned int a_size, unsigned int a_elementSize)
+	{
+		unsigned int block = a_allocator.Allocate(a_size);
+
+		// NOTE: Growing extends the free space at the end of the buffer, repeated because allocation only searches size classes that are sure to fit
+		while (block == BufferAllocator::INVALID_BLOCK) {
+			Grow(a_bufferID, a_allocator, a_allocator.GetCapacity() + a_size, a_elementSize);
+			AttachBuffers();
+
+			block = a_allocator.Allocate(a_size);
+		}
+
+		assert(block != BufferAllocator::INVALID_BLOCK && "ERROR::GEOMETRY_POOL::FAILED_TO_RESERVE");
+
+		return block;
+	}
+
+	/**
+	*	@brief Re-allocate a buffer so it can hold at least the required number of elements, keeping the ranges already in use at the same offsets.
+	*	NOTE: The position buffer is re-allocated along with the vertex buffer, as it shares the vertex allocator.
+	*	@param a_bufferID is the buffer to grow, replaced with the new buffer.
+	*	@param a_allocator is the allocator managing the buffer, extended to the new capacity.
+	*	@param a_required is the minimum number of elements the buffer must hold.
+	*	@param a_elementSize is the size of an element in bytes.
+	*	@return void.
+	*/
+	void GeometryPool::Grow(unsigned int & a_bufferID, BufferAllocator & a_allocator, unsigned int a_required, unsigned int a_elementSize)
+	{
+		unsigned int oldCapacity = a_allocator.GetCapacity();
+		if (a_required <= oldCapacity) { return; }
+
+		unsigned int newCapacity = std::max(a_required, oldCapacity * 2);
+
+		if (a_bufferID != 0) { m_stn->m_growCount++; }
+
+		ReplaceStorage(a_bufferID, oldCapacity * a_elementSize, newCapacity * a_elementSize);
+
+		if (&a_allocator == &m_stn->m_vertexAllocator) {
+			ReplaceStorage(m_stn->m_positionBufferID, oldCapacity * sizeof(glm::vec3), newCapacity * sizeof(glm::vec3));
+		}
+
+		a_allocator.Grow(newCapacity);
+	}
+
+	/**
+	*	@brief Move the block furthest into a buffer to the first free range before it that fits, updating the allocation it belongs to.
+	*	@param a_bufferID is the buffer the block is stored in.
+	*	@param a_allocator is the allocator managing the buffer.
+	*	@param a_elementSize is the size of an element in bytes.
+	*	@return number of bytes copied, 0 if there was nothing to move.
+	*/
+	unsigned int GeometryPool::MoveDown(unsigned int a_bufferID, BufferAllocator & a_allocator, unsigned int a_elementSize)
+	{
+		unsigned int oldBlock = a_allocator.GetLastUsedBlock();
+		if (oldBlock == BufferAllocator::INVALID_BLOCK) { return 0; }
+
+		unsigned int size = a_allocator.GetSize(oldBlock);
+		unsigned int newBlock = a_allocator.AllocateBelow(size, a_allocator.GetOffset(oldBlock));
+		if (newBlock == BufferAllocator::INVALID_BLOCK) { return 0; }
+
+		unsigned int oldOffset = a_allocator.GetOffset(oldBlock);
+		unsigned int newOffset = a_allocator.GetOffset(newBlock);
+		unsigned int movedBytes = size * a_elementSize;
+
+		CopyRange(a_bufferID, oldOffset * a_elementSize, newOffset * a_elementSize, size * a_elementSize);
+
+		// Point the owning allocation at the new block, positions follow their vertices
+		unsigned int handle = a_allocator.GetUserData(oldBlock);
+		Allocation& allocation = m_stn->m_allocations[handle];
+
+		if (&a_allocator == &m_stn->m_vertexAllocator) {
+			allocation.vertexBlock = newBlock;
+
+			CopyRange(m_stn->m_positionBufferID, oldOffset * sizeof(glm::vec3), newOffset * sizeof(glm::vec3), size * sizeof(glm::vec3));
+			movedBytes += size * sizeof(glm::vec3);
+		}
+		else { allocation.indexBlock = newBlock; }
+
+		a_allocator.SetUserData(newBlock, handle);
+		a_allocator.Free(oldBlock);
+
+		return movedBytes;
+	}
+
+	/**
+	*	@brief Create a buffer with immutable storage.
+	*	@param a_bufferID is the buffer name to output to.
+	*	@param a_size is the size of the storage in bytes.
+	*	@param a_data is the initial contents, nullptr to leave uninitialised.
+	*	@param a_flags is how the storage may be accessed after creation e.g. GL_DYNAMIC_STORAGE_BIT.
+	*	@return void.
+	*/
+	void GeometryPool::CreateStorage(unsigned int & a_bufferID, unsigned int a_size, const void * a_data, unsigned int a_flags)
+	{
+		glGenBuffers(1, &a_bufferID);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, a_bufferID);		// NOTE: Copy target so the bound vertex array is not modified
+		glBufferStorage(GL_COPY_WRITE_BUFFER, a_size, a_data, a_flags);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	/**
+	*	@brief Create a buffer with room for a new size and copy an old buffer's contents into it, then delete the old buffer.
+	*	NOTE: Used ranges can be anywhere, so the whole old buffer is copied, without a round trip to the CPU.
+	*	@param a_bufferID is the buffer to replace, 0 if there is no old buffer, set to the new buffer.
+	*	@param a_oldSize is the size of the old buffer in bytes.
+	*	@param a_newSize is the size of the new buffer in bytes.
+	*	@return void.
+	*/
+	void GeometryPool::ReplaceStorage(unsigned int & a_bufferID, unsigned int a_oldSize, unsigned int a_newSize)
+	{
+		unsigned int newBufferID = 0;
+		CreateStorage(newBufferID, a_newSize, nullptr, GL_DYNAMIC_STORAGE_BIT);		// Sub data uploads need dynamic storage
+
+		if (a_bufferID != 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, a_bufferID);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (size_t)a_oldSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+			glDeleteBuffers(1, &a_bufferID);
+		}
+
+		a_bufferID = newBufferID;
+	}
+
+	/**
+	*	@brief Copy a range of a buffer to another range of the same buffer on the GPU.
+	*	NOTE: Ranges are in the same buffer but never overlap, so it can be bound as both source and destination.
+	*	@param a_bufferID is the buffer to copy within.
+	*	@param a_from is the byte offset of the range to copy.
+	*	@param a_to is the byte offset to copy the range to.
+	*	@param a_size is the size of the range in bytes.
+	*	@return void.
+	*/
+	void GeometryPool::CopyRange(unsigned int a_bufferID, unsigned int a_from, unsigned int a_to, unsigned int a_size)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, a_bufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, a_bufferID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (size_t)a_from, (size_t)a_to, (size_t)a_size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	/**
+	*	@brief Point the pool's vertex arrays at the current buffers, after they have been created or re-allocated.
+	*	@return void.
+	*/
+	void GeometryPool::AttachBuffers()
+	{
+		Bind();
+
+		glBindVertexBuffer(0, m_stn->m_vertexBufferID, 0, sizeof(Vertex));
+		glBindVertexBuffer(1, m_stn->m_drawIDBufferID, 0, sizeof(unsigned int));
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_stn->m_indexBufferID);		// NOTE: Stored in the bound vertex array
+
+		BindPositions();
+
+		glBindVertexBuffer(0, m_stn->m_positionBufferID, 0, sizeof(glm::vec3));
+		glBindVertexBuffer(1, m_stn->m_drawIDBufferID, 0, sizeof(unsigned int));
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_stn->m_indexBufferID);
+
+		Bind();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include "BufferAllocator.h"
+
+namespace SPRON {
+	struct Vertex;
+}
+
+namespace SPRON {
+	// Fixed vertex attribute locations, must match the location layout qualifiers of the vertex shaders
+	enum eVertexAttribute {
+		VERTEX_ATTRIBUTE_POSITION = 0,
+		VERTEX_ATTRIBUTE_TEX_COORD = 1,
+		VERTEX_ATTRIBUTE_NORMAL = 2,
+		VERTEX_ATTRIBUTE_TANGENT = 3,
+		VERTEX_ATTRIBUTE_DRAW_ID = 4		// Per instance, equals the base instance of the draw
+	};
+
+	// Where a mesh's vertices and indices currently are in the pool's buffers, changes when the pool is defragmented
+	struct GeometryRange {
+		unsigned int	firstIndex = 0;
+		unsigned int	indexCount = 0;
+		int				baseVertex = 0;
+		unsigned int	vertexCount = 0;
+	};
+
+	// Layout expected by glMultiDrawElementsIndirect
+	struct IndirectDrawCommand {
+		unsigned int	count;
+		unsigned int	instanceCount;
+		unsigned int	firstIndex;
+		int				baseVertex;
+		unsigned int	baseInstance;		// Index of the first object block, read back through the draw ID attribute
+	};
+
+	static_assert(sizeof(IndirectDrawCommand) == 20, "ERROR::GEOMETRY_POOL::INDIRECT_COMMAND_NOT_TIGHTLY_PACKED");
+
+	/**
+	*	@brief Static singleton class that sub-allocates every mesh's vertices and indices from a few large buffers behind a single vertex array.
+	*	Meshes never need a vertex array change between them, so any run of draws with the same shader state can be submitted as one multi-draw.
+	*	Ranges are sub-allocated with a TLSF allocator so space released by deleted meshes is re-used, and on frames without new allocations
+	*	meshes are moved towards the start of the buffers to close gaps. Meshes hold a handle instead of offsets so they follow their geometry when it is moved.
+	*	Vertex positions are also kept tightly packed in a buffer of their own, at the same offsets as their vertices, behind a second vertex array
+	*	for depth only draws that would otherwise fetch whole vertices for their positions.
+	*	NOTE: Storage is immutable, when a buffer is full it is re-allocated at double the size and the old contents are copied across on the GPU.
+	*/
+	class GeometryPool {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static const unsigned int INVALID_GEOMETRY = ~0u;
+
+		static unsigned int Allocate(const std::vector<Vertex>& a_verts, const std::vector<unsigned int>& a_indices);
+		static void Free(unsigned int a_geometry);
+		static void Defragment(unsigned int a_byteBudget);
+
+		static void Bind();
+		static void BindPositions();
+		static unsigned int GetVertexArray() { return m_stn->m_vertexArrayID; }
+		static unsigned int GetVertexBuffer() { return m_stn->m_vertexBufferID; }		// NOTE: Changes when the pool grows, fetch it every frame
+		static unsigned int GetIndexBuffer() { return m_stn->m_indexBufferID; }
+
+		static GeometryRange GetRange(unsigned int a_geometry);
+		static IndirectDrawCommand MakeCommand(unsigned int a_geometry, unsigned int a_objectIndex, unsigned int a_instanceCount = 1);
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static GeometryPool* m_stn;		// Singleton instance
+
+		static const unsigned int INITIAL_VERTEX_CAPACITY = 64 * 1024;
+		static const unsigned int INITIAL_INDEX_CAPACITY = 256 * 1024;
+
+		// Vertex and index blocks of a mesh
+		struct Allocation {
+			unsigned int vertexBlock;
+			unsigned int indexBlock;
+		};
+
+		static unsigned int Reserve(unsigned int& a_bufferID, BufferAllocator& a_allocator, unsigned int a_size, unsigned int a_elementSize);
+		static void Grow(unsigned int& a_bufferID, BufferAllocator& a_allocator, unsigned int a_required, unsigned int a_elementSize);
+		static unsigned int MoveDown(unsigned int a_bufferID, BufferAllocator& a_allocator, unsigned int a_elementSize);
+		static void CreateStorage(unsigned int& a_bufferID, unsigned int a_size, const void* a_data, unsigned int a_flags);
+		static void ReplaceStorage(unsigned int& a_bufferID, unsigned int a_oldSize, unsigned int a_newSize);
+		static void CopyRange(unsigned int a_bufferID, unsigned int a_from, unsigned int a_to, unsigned int a_size);
+		static void AttachBuffers();
+
+		// Instance variables
+		unsigned int	m_vertexArrayID;
+		unsigned int	m_positionArrayID;		// Reads only the position stream, for depth only draws
+		unsigned int	m_vertexBufferID;
+		unsigned int	m_positionBufferID;		// Vertex positions as tightly packed vec3s, offset like the vertex buffer
+		unsigned int	m_indexBufferID;
+		unsigned int	m_drawIDBufferID;		// 0, 1, 2... sampled per instance, so a draw's base instance becomes its draw ID
+
+		BufferAllocator	m_vertexAllocator;		// Counted in vertices
+		BufferAllocator	m_indexAllocator;		// Counted in indices
+
+		std::vector<Allocation>		m_allocations;			// Indexed by the handle given to meshes
+		std::vector<unsigned int>	m_unusedAllocations;	// Handles of freed meshes to re-use
+
+		bool			m_allocatedThisFrame;	// Defragmentation waits for a frame without loading so it does not compete with uploads
+
+		// Statistics
+		unsigned int	m_allocationCount;
+		unsigned int	m_growCount;
+		unsigned int	m_movedBytes;			// Copied by defragmentation in total
+		unsigned int	m_movedBytesLastFrame;
+
+		GeometryPool();
+		~GeometryPool();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "InstancedMesh.h"
+#include "Transform.h"
+#include "MaterialTable.h"
+#include "Renderer_Utility_Funcs.h"
+#include "Renderer_Utility_Literals.h"
+#include "JobSystem.h"
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+
+#include <gl_core_4_4.h>
+#include <glm/geometric.hpp>
+#include <algorithm>
+
+namespace SPRON {
+	// Result of culling an instance
+	enum eInstanceVisibility : unsigned char {
+		INSTANCE_CULLED,		// Outside the frustum
+		INSTANCE_OCCLUDED,		// In the frustum but hidden behind occluders
+		INSTANCE_VISIBLE
+	};
+
+	InstancedMesh::InstancedMesh(const std::vector<Vertex>& a_verts, VertexFormat * a_format, const Material & a_material) :
+		m_visibleCount(0), m_occludedCount(0), m_transformVersion(1), m_boundsVersion(0), m_transformBufferID(0), m_transformCapacity(0), m_bufferVersion(0)
+	{
+		// Geometry is uploaded once no matter how many instances there are
+		m_mesh = new Mesh(a_verts, a_format, new Transform(), a_material);
+	}
+
+	InstancedMesh::~InstancedMesh()
+	{
+		ClearInstances();
+
+		delete m_mesh;
+
+		glDeleteBuffers(1, &m_transformBufferID);
+	}
+
+	/**
+	*	@brief Add an instance that uses the shared material.
+	*	@param a_transform is the global matrix of the instance.
+	*	@return index of the instance.
+	*/
+	unsigned int InstancedMesh::AddInstance(const glm::mat4 & a_transform)
+	{
+		m_transforms.push_back(a_transform);
+		m_materialIndices.push_back(SHARED_MATERIAL);
+		m_transformVersion++;
+
+		return (unsigned int)m_transforms.size() - 1;
+	}
+
+	/**
+	*	@brief Add an instance with its own material parameters.
+	*	@param a_transform is the global matrix of the instance.
+	*	@param a_material is the material of the instance, its texture maps must be in the same texture arrays as the shared material's.
+	*	@return index of the instance.
+	*/
+	unsigned int InstancedMesh::AddInstance(const glm::mat4 & a_transform, const Material & a_material)
+	{
+		m_transforms.push_back(a_transform);
+		m_materialIndices.push_back(MaterialTable::Register(a_material));		// Identical materials share a table entry
+		m_transformVersion++;
+
+		return (unsigned int)m_transforms.size() - 1;
+	}
+
+	/**
+	*	@brief Move an instance.
+	*	NOTE: Setting the transform an instance already has leaves the transform version unchanged, so instances copied every frame only count as moved when they did.
+	*	@param a_instance is the index of the instance.
+	*	@param a_transform is the global matrix of the instance.
+	*	@return void.
+	*/
+	void InstancedMesh::SetInstanceTransform(unsigned int a_instance, const glm::mat4 & a_transform)
+	{
+		if (m_transforms[a_instance] == a_transform) { return; }
+
+		m_transforms[a_instance] = a_transform;
+		m_transformVersion++;
+	}
+
+	/**
+	*	@brief Give an instance its own material parameters, replacing any it already had.
+	*	@param a_instance is the index of the instance.
+	*	@param a_material is the material of the instance, its texture maps must be in the same texture arrays as the shared material's.
+	*	@return void.
+	*/
+	void InstancedMesh::SetInstanceMaterial(unsigned int a_instance, const Material & a_material)
+	{
+		unsigned int materialIndex = MaterialTable::Register(a_material);		// NOTE: Registered before releasing so an unchanged material keeps its entry
+
+		ResetInstanceMaterial(a_instance);
+		m_materialIndices[a_instance] = materialIndex;
+	}
+
+	/**
+	*	@brief Make an instance use the shared material again.
+	*	@param a_instance is the index of the instance.
+	*	@return void.
+	*/
+	void InstancedMesh::ResetInstanceMaterial(unsigned int a_instance)
+	{
+		if (m_materialIndices[a_instance] != SHARED_MATERIAL) { MaterialTable::Release(m_materialIndices[a_instance]); }
+
+		m_materialIndices[a_instance] = SHARED_MATERIAL;
+	}
+
+	/**
+	*	@brief Remove an instance by moving the last instance into its place.
+	*	NOTE: The index of the last instance changes to the removed index.
+	*	@param a_instance is the index of the instance to remove.
+	*	@return void.
+	*/
+	void InstancedMesh::RemoveInstance(unsigned int a_instance)
+	{
+		ResetInstanceMaterial(a_instance);
+
+		m_transforms[a_instance] = m_transforms.back();
+		m_materialIndices[a_instance] = m_materialIndices.back();
+
+		m_transforms.pop_back();
+		m_materialIndices.pop_back();
+		m_transformVersion++;
+	}
+
+	void InstancedMesh::ClearInstances()
+	{
+		for (unsigned int i = 0; i < m_materialIndices.size(); ++i) {
+			ResetInstanceMaterial(i);
+		}
+
+		m_transforms.clear();
+		m_materialIndices.clear();
+		m_transformVersion++;
+	}
+
+	/**
+	*	@brief Get the bounds of every instance, recalculated only when an instance was added, moved or removed since the last call.
+	*	O(N) complexity where N = number of instances, when recalculated
+	*	@return global space bounds of every instance, empty at the origin when there are no instances.
+	*/
+	const AABB& InstancedMesh::GetInstanceBounds()
+	{
+		if (m_boundsVersion == m_transformVersion) { return m_instanceBounds; }
+
+		const AABB& localBounds = m_mesh->GetLocalBounds();
+
+		m_instanceBounds = (m_transforms.empty() ? AABB() : localBounds.Transform(m_transforms[0]));
+		for (unsigned int i = 1; i < m_transforms.size(); ++i) {
+			m_instanceBounds = AABB::Merge(m_instanceBounds, localBounds.Transform(m_transforms[i]));
+		}
+
+		m_boundsVersion = m_transformVersion;
+
+		return m_instanceBounds;
+	}
+
+	/**
+	*	@brief Upload every instance's object block to the transform buffer if any instance was added, moved or removed since the last upload.
+	*	Draws that bind it in place of the object table read an instance's block with its instance ID.
+	*	NOTE: Material indices are not kept up to date, only the transforms are meant to be read.
+	*	@return ID of the transform buffer, 0 if there are no instances.
+	*/
+	unsigned int InstancedMesh::UpdateTransformBuffer()
+	{
+		if (m_transforms.empty()) { return 0; }
+		if (m_bufferVersion == m_transformVersion) { return m_transformBufferID; }
+
+		if (!m_transformBufferID) { glGenBuffers(1, &m_transformBufferID); }
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_transformBufferID);
+
+		if (m_transforms.size() > m_transformCapacity) {		// Out of storage, grow
+			m_transformCapacity = std::max((unsigned int)m_transforms.size(), m_transformCapacity * 2);
+		}
+
+		// Orphaned every upload so draws still reading the previous transforms don't stall it
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ObjectUniformBlock) * m_transformCapacity, nullptr, GL_DYNAMIC_DRAW);
+
+		ObjectUniformBlock* objects = (ObjectUniformBlock*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+			sizeof(ObjectUniformBlock) * m_transforms.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		for (unsigned int i = 0; i < m_transforms.size(); ++i) {
+			objects[i].modelTransform = m_transforms[i];
+			objects[i].materialIndex = 0;
+		}
+
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+
+		m_bufferVersion = m_transformVersion;
+
+		return m_transformBufferID;
+	}
+
+	/**
+	*	@brief Test every instance's bounding box against a frustum and the occluders, and write the object blocks of the visible ones next to each other.
+	*	O(N) complexity where N = number of instances
+	*	@param a_frustum is the camera frustum.
+	*	@param a_visibleObjects is the list to append the object blocks of visible instances to.
+	*	@param a_occlusion is the rasterized occluders to also test instances in the frustum against, nullptr to only frustum cull.
+	*	@return number of visible instances appended.
+	*/
+	unsigned int InstancedMesh::Cull(const Frustum & a_frustum, std::vector<ObjectUniformBlock>& a_visibleObjects, const OcclusionCuller* a_occlusion)
+	{
+		unsigned int sharedMaterial = m_mesh->GetMaterialIndex();		// NOTE: Looked up per frame as editing the material can move it to another entry
+		const AABB& localBounds = m_mesh->GetLocalBounds();
+
+		m_visibleCount = 0;
+		m_occludedCount = 0;
+		m_instanceVisibility.resize(m_transforms.size());
+
+		// Test in parallel, each job only writes the flags of its own instances
+		JobSystem::ParallelFor((unsigned int)m_transforms.size(), JOB_BATCH_SIZE, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				AABB bounds = localBounds.Transform(m_transforms[i]);
+
+				if (a_frustum.TestAABB(bounds) == FRUSTUM_OUTSIDE) { m_instanceVisibility[i] = INSTANCE_CULLED; }
+				else if (a_occlusion && !a_occlusion->IsVisible(bounds)) { m_instanceVisibility[i] = INSTANCE_OCCLUDED; }
+				else { m_instanceVisibility[i] = INSTANCE_VISIBLE; }
+			}
+		});
+
+		// Append in order so the visible instances' blocks stay consecutive
+		for (unsigned int i = 0; i < m_transforms.size(); ++i) {
+			if (m_instanceVisibility[i] == INSTANCE_OCCLUDED) { m_occludedCount++; }
+			if (m_instanceVisibility[i] != INSTANCE_VISIBLE) { continue; }
+
+			ObjectUniformBlock object;
+			object.modelTransform = m_transforms[i];
+			object.materialIndex = (m_materialIndices[i] == SHARED_MATERIAL) ? sharedMaterial : m_materialIndices[i];
+
+			a_visibleObjects.push_back(object);
+			m_visibleCount++;
+		}
+
+		return m_visibleCount;
+	}
+
+	/**
+	*	@brief Cull the instances and render the visible ones with one draw per pass.
+	*	NOTE: If a light shader is set to nullptr then that pass will not be performed.
+	*	@param a_camera is the camera to render to.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_ambientPass is the shader program to use during the ambient lighting pass.
+	*	@param a_directionalPass is the shader program to use during the directional lighting pass.
+	*	@param a_pointPass is the shader program to use during the point lighting pass.
+	*	@param a_debugPass is the shader program to use to draw debug information for the mesh.
+	*	@return void.
+	*/
+	void InstancedMesh::Draw(RenderCamera * a_camera, const std::vector<PhongLight*>& a_lights, ShaderWrapper * a_ambientPass,
+		ShaderWrapper * a_directionalPass, ShaderWrapper * a_pointPass, ShaderWrapper * a_spotPass, ShaderWrapper * a_debugPass)
+	{
+		assert(a_camera && "ERROR::INSTANCED_MESH::NULL_CAMERA");
+
+		// Camera data is in the frame uniform block
+		const FrameUniformBlock& frame = UniformBlocks::GetFrameData();
+
+		Frustum frustum;
+		frustum.Set(frame.projectionTransform * frame.viewTransform);
+
+		m_visibleObjects.clear();
+		if (Cull(frustum, m_visibleObjects) == 0) { return; }
+
+		// Keep the visible instances' blocks consecutive in the ring
+		UniformBlocks::Reserve(m_visibleCount);
+
+		unsigned int firstObject = UniformBlocks::PushObject(m_visibleObjects[0]);
+		for (unsigned int i = 1; i < m_visibleCount; ++i) {
+			UniformBlocks::PushObject(m_visibleObjects[i]);
+		}
+
+		UniformBlocks::Flush();
+
+		m_mesh->DrawObjects(a_lights, a_ambientPass, a_directionalPass, a_pointPass, a_spotPass, a_debugPass, firstObject, m_visibleCount);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Vertex.h"
+#include "Mesh.h"
+#include "UniformBlocks.h"
+
+#include <vector>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class RenderCamera;
+
+	class VertexFormat;
+	class ShaderWrapper;
+	class PhongLight;
+	class Frustum;
+	class OcclusionCuller;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Many copies of the same mesh that share one geometry allocation and are drawn together as instances of a single draw.
+	*	Each instance only stores a transform and a material index, visible instances are compacted into consecutive object blocks every frame
+	*	so the draw ID attribute (which advances once per instance) reads each instance's block.
+	*	NOTE: Instances are drawn with the texture maps of the shared material, per instance materials may only differ in parameters or texture array layer.
+	*/
+	class InstancedMesh {
+	public:
+		InstancedMesh(const std::vector<Vertex>& a_verts, VertexFormat* a_format, const Material& a_material = Material());
+		~InstancedMesh();
+
+		unsigned int AddInstance(const glm::mat4& a_transform);
+		unsigned int AddInstance(const glm::mat4& a_transform, const Material& a_material);
+		void SetInstanceTransform(unsigned int a_instance, const glm::mat4& a_transform);
+		void SetInstanceMaterial(unsigned int a_instance, const Material& a_material);
+		void ResetInstanceMaterial(unsigned int a_instance);
+		void RemoveInstance(unsigned int a_instance);
+		void ClearInstances();
+
+		unsigned int Cull(const Frustum& a_frustum, std::vector<ObjectUniformBlock>& a_visibleObjects, const OcclusionCuller* a_occlusion = nullptr);
+
+		void Draw(RenderCamera* a_camera,
+			const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
+			ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass);
+
+		Mesh* GetMesh() { return m_mesh; }
+		unsigned int GetInstanceCount() const { return (unsigned int)m_transforms.size(); }
+		const glm::mat4& GetInstanceTransform(unsigned int a_instance) const { return m_transforms[a_instance]; }
+		unsigned int GetVisibleCount() const { return m_visibleCount; }
+		unsigned int GetOccludedCount() const { return m_occludedCount; }
+
+		const AABB& GetInstanceBounds();
+		uint64_t GetTransformVersion() const { return m_transformVersion; }
+		unsigned int UpdateTransformBuffer();
+	protected:
+	private:
+		static const unsigned int SHARED_MATERIAL = ~0u;		// Instance uses the mesh's material
+
+		Mesh*		m_mesh;				// Geometry and material shared by every instance, its own transform is unused, its bounds are every instance's model space bounds
+
+		// Per instance data, stored in separate arrays so culling only reads the transforms
+		std::vector<glm::mat4>		m_transforms;
+		std::vector<unsigned int>	m_materialIndices;		// Entry in the material table, or SHARED_MATERIAL
+
+		std::vector<ObjectUniformBlock>	m_visibleObjects;		// Scratch list for Draw, kept between frames to avoid re-allocating
+		unsigned int					m_visibleCount;			// Instances that passed the last cull
+		unsigned int					m_occludedCount;		// Instances in the frustum but hidden behind occluders in the last cull
+		std::vector<unsigned char>		m_instanceVisibility;	// Result of the last cull per instance, written by the cull jobs
+
+		// Every instance at once, for passes that draw all of the instances without culling them (e.g. shadow casters)
+		uint64_t		m_transformVersion;		// Changed whenever an instance is added, moved or removed
+		AABB			m_instanceBounds;		// Global space bounds of every instance
+		uint64_t		m_boundsVersion;		// Transform version the bounds were calculated from
+		unsigned int	m_transformBufferID;	// Object blocks of every instance in order, indexed by instance ID
+		unsigned int	m_transformCapacity;	// Instances the transform buffer has storage for
+		uint64_t		m_bufferVersion;		// Transform version last uploaded to the transform buffer
+	};
+}
\ No newline at end of file
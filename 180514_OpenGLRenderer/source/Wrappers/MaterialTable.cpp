@@ -0,0 +1,231 @@
+#include "MaterialTable.h"
+#include "Mesh.h"
+#include "Texture\Texture.h"
+#include "UniformBlocks.h"
+#include "FrameArena.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <algorithm>
+
+namespace SPRON {
+	/// Static initialisation
+	MaterialTable* MaterialTable::m_stn = nullptr;
+
+	static const unsigned int INVALID_INDEX = ~0u;
+
+	MaterialTable::MaterialTable() :
+		m_bufferID(0), m_bufferCapacity(0), m_dirtyStart(INVALID_INDEX), m_dirtyEnd(0),
+		m_registerCount(0), m_patchCount(0), m_liveEntryCount(0)
+	{
+	}
+
+	MaterialTable::~MaterialTable()
+	{
+		glDeleteBuffers(1, &m_bufferID);
+	}
+
+	/**
+	*	@brief Create singleton and the shader storage buffer, storage is allocated on the first upload once the number of materials is known.
+	*	NOTE: Must be called after the openGL functions have been loaded and before any meshes are created, any future calls will be ignored.
+	*	@return void.
+	*/
+	void MaterialTable::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new MaterialTable();
+
+			glGenBuffers(1, &m_stn->m_bufferID);
+		}
+	}
+
+	void MaterialTable::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Add a material to the table, re-using an existing entry if an identical material has already been registered.
+	*	O(M) complexity where M = number of entries, materials are only registered on load and when edited.
+	*	@param a_material is the material to register.
+	*	@return index of the material's entry, to be passed to shaders through the object uniform block.
+	*/
+	unsigned int MaterialTable::Register(const Material & a_material)
+	{
+		m_stn->m_registerCount++;
+
+		Entry entry = MakeEntry(a_material);
+		unsigned int freeIndex = INVALID_INDEX;
+
+		for (unsigned int i = 0; i < m_stn->m_entries.size(); ++i) {
+			Entry& currEntry = m_stn->m_entries[i];
+
+			if (currEntry.refCount == 0) {		// Remember first unused entry in case there is no identical one
+				if (freeIndex == INVALID_INDEX) { freeIndex = i; }
+				continue;
+			}
+
+			if (IsSameEntry(currEntry, entry)) {
+				currEntry.refCount++;
+				return i;
+			}
+		}
+
+		// No identical entry, fill an unused one or add a new one
+		if (freeIndex == INVALID_INDEX) {
+			freeIndex = (unsigned int)m_stn->m_entries.size();
+			m_stn->m_entries.push_back(entry);
+		}
+		else {
+			m_stn->m_entries[freeIndex] = entry;
+		}
+
+		m_stn->m_entries[freeIndex].refCount = 1;
+		m_stn->m_liveEntryCount++;
+
+		MarkDirty(freeIndex);
+
+		return freeIndex;
+	}
+
+	/**
+	*	@brief Change the material used by a single owner of an entry.
+	*	NOTE: If the entry is only used by this owner it gets patched in place, otherwise the owner is moved to another entry so the other owners are not affected.
+	*	@param a_index is the entry currently used by the owner.
+	*	@param a_material is the edited material.
+	*	@return index of the entry the owner should use from now on.
+	*/
+	unsigned int MaterialTable::Update(unsigned int a_index, const Material & a_material)
+	{
+		assert(a_index < m_stn->m_entries.size() && "ERROR::MATERIAL_TABLE::INVALID_INDEX");
+
+		if (IsSameEntry(m_stn->m_entries[a_index], MakeEntry(a_material))) { return a_index; }		// Nothing that the table stores changed
+
+		// Releasing first lets a sole owner's entry be re-used as the first unused entry if no identical one exists
+		Release(a_index);
+
+		m_stn->m_patchCount++;
+
+		return Register(a_material);
+	}
+
+	/**
+	*	@brief Remove an owner from an entry, the entry can be re-used once it has no owners.
+	*	@param a_index is the entry to release.
+	*	@return void.
+	*/
+	void MaterialTable::Release(unsigned int a_index)
+	{
+		if (!m_stn || a_index >= m_stn->m_entries.size()) { return; }		// Table already shut down or mesh never registered a material
+
+		Entry& entry = m_stn->m_entries[a_index];
+
+		if (entry.refCount > 0 && --entry.refCount == 0) { m_stn->m_liveEntryCount--; }
+	}
+
+	/**
+	*	@brief Upload the entries changed since the last upload, re-allocating the buffer if it has run out of storage.
+	*	@return void.
+	*/
+	void MaterialTable::Upload()
+	{
+		if (m_stn->m_dirtyStart == INVALID_INDEX) { return; }		// Nothing changed
+
+		const unsigned int entryNum = (unsigned int)m_stn->m_entries.size();
+
+		// Gather GPU data of the entries, texture pointers and reference counts stay on the CPU
+		ArenaVector<GPUMaterial> gpuData(m_stn->m_dirtyEnd - m_stn->m_dirtyStart, GPUMaterial(), FrameArena::GetThreadArena());
+		for (unsigned int i = m_stn->m_dirtyStart; i < m_stn->m_dirtyEnd; ++i) {
+			gpuData[i - m_stn->m_dirtyStart] = m_stn->m_entries[i].data;
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_stn->m_bufferID);
+
+		if (entryNum > m_stn->m_bufferCapacity) {		// Out of storage, grow and re-upload everything
+			m_stn->m_bufferCapacity = std::max(entryNum, m_stn->m_bufferCapacity * 2);
+
+			gpuData.resize(entryNum);
+			for (unsigned int i = 0; i < entryNum; ++i) {
+				gpuData[i] = m_stn->m_entries[i].data;
+			}
+
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUMaterial) * m_stn->m_bufferCapacity, nullptr, GL_STATIC_DRAW);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GPUMaterial) * entryNum, &gpuData[0]);
+
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_MATERIALS, m_stn->m_bufferID);
+		}
+		else {											// Patch just the changed entries
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUMaterial) * m_stn->m_dirtyStart, sizeof(GPUMaterial) * gpuData.size(), &gpuData[0]);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		m_stn->m_dirtyStart = INVALID_INDEX;
+		m_stn->m_dirtyEnd = 0;
+	}
+
+	/**
+	*	@brief Display the table's deduplication and patch statistics.
+	*	@return void.
+	*/
+	void MaterialTable::ListenIMGUI()
+	{
+		ImGui::Begin("Material Table");
+
+		ImGui::Text("Materials registered: %u", m_stn->m_registerCount);
+		ImGui::Text("Unique entries: %u (%u allocated)", m_stn->m_liveEntryCount, (unsigned int)m_stn->m_entries.size());
+		ImGui::Text("Entries patched: %u", m_stn->m_patchCount);
+
+		ImGui::End();
+	}
+
+	/**
+	*	@brief Convert a material into the data the table stores for it.
+	*	@param a_material is the material to convert.
+	*	@return table entry with a reference count of 0.
+	*/
+	MaterialTable::Entry MaterialTable::MakeEntry(const Material & a_material)
+	{
+		Entry entry = {};
+
+		entry.data.ambientColor = a_material.ambientColor;
+		entry.data.diffuseColor = a_material.diffuseColor;
+		entry.data.specular = a_material.specular;
+		entry.data.shininessCoefficient = a_material.shininessCoefficient;
+
+		// Inform GPU whether diffuse, specular maps and normal maps are valid
+		entry.data.useDiffuseMap = (!a_material.disableDiffuseMap && a_material.diffuseMap && a_material.diffuseMap->IsNotNull() ? 1 : 0);
+		entry.data.useSpecularMap = (!a_material.disableSpecularMap && a_material.specularMap && a_material.specularMap->IsNotNull() ? 1 : 0);
+		entry.data.useNormalMap = (!a_material.disableNormalMap && a_material.normalMap && a_material.normalMap->IsNotNull() ? 1 : 0);
+
+		// Layer of the texture array each map is packed into, sampled with the array the map is bound to
+		entry.data.diffuseLayer = (a_material.diffuseMap ? a_material.diffuseMap->GetLayer() : 0);
+		entry.data.specularLayer = (a_material.specularMap ? a_material.specularMap->GetLayer() : 0);
+		entry.data.normalLayer = (a_material.normalMap ? a_material.normalMap->GetLayer() : 0);
+
+		entry.diffuseMap = a_material.diffuseMap;
+		entry.specularMap = a_material.specularMap;
+		entry.normalMap = a_material.normalMap;
+
+		return entry;
+	}
+
+	bool MaterialTable::IsSameEntry(const Entry & a_lhs, const Entry & a_rhs)
+	{
+		const GPUMaterial& lhs = a_lhs.data;
+		const GPUMaterial& rhs = a_rhs.data;
+
+		return (lhs.ambientColor == rhs.ambientColor && lhs.diffuseColor == rhs.diffuseColor && lhs.specular == rhs.specular &&
+			lhs.shininessCoefficient == rhs.shininessCoefficient &&
+			lhs.useDiffuseMap == rhs.useDiffuseMap && lhs.useSpecularMap == rhs.useSpecularMap && lhs.useNormalMap == rhs.useNormalMap &&
+			lhs.diffuseLayer == rhs.diffuseLayer && lhs.specularLayer == rhs.specularLayer && lhs.normalLayer == rhs.normalLayer &&
+			a_lhs.diffuseMap == a_rhs.diffuseMap && a_lhs.specularMap == a_rhs.specularMap && a_lhs.normalMap == a_rhs.normalMap);
+	}
+
+	void MaterialTable::MarkDirty(unsigned int a_index)
+	{
+		m_stn->m_dirtyStart = std::min(m_stn->m_dirtyStart, a_index);
+		m_stn->m_dirtyEnd = std::max(m_stn->m_dirtyEnd, a_index + 1);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <glm/vec4.hpp>
+
+namespace SPRON {
+	class Texture;
+
+	struct Material;
+}
+
+namespace SPRON {
+	// Mirror of the std430 "GPU_MaterialData" shader struct, one entry of the material table
+	struct GPUMaterial {
+		glm::vec4	ambientColor;
+		glm::vec4	diffuseColor;
+		glm::vec4	specular;
+		float		shininessCoefficient;
+
+		// NOTE: Bools are 4 bytes in shader buffers, use ints so the sizes match
+		int			useDiffuseMap;
+		int			useSpecularMap;
+		int			useNormalMap;
+
+		// Layer of each map in its texture array
+		int			diffuseLayer;
+		int			specularLayer;
+		int			normalLayer;
+		int			padding;
+	};
+
+	/// Validate C++ layout against std430 at compile time
+	static_assert(offsetof(GPUMaterial, ambientColor) == 0, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, diffuseColor) == 16, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, specular) == 32, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, shininessCoefficient) == 48, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, useDiffuseMap) == 52, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, useNormalMap) == 60, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, diffuseLayer) == 64, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(offsetof(GPUMaterial, normalLayer) == 72, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");
+	static_assert(sizeof(GPUMaterial) == 80, "ERROR::MATERIAL_TABLE::MATERIAL_NOT_STD430");		// Array stride, struct is aligned to its largest member (vec4)
+
+	/**
+	*	@brief Static singleton class that keeps every material's parameters in a shader storage buffer, indexed per draw.
+	*	Identical materials share an entry, entries are reference counted and edited copy-on-write so changing one mesh's material never affects another mesh.
+	*	NOTE: Texture maps can not be stored in the buffer, they are still bound as sampler uniforms but only when the material index changes. Only the layer of each map's texture array is stored.
+	*/
+	class MaterialTable {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static unsigned int Register(const Material& a_material);
+		static unsigned int Update(unsigned int a_index, const Material& a_material);
+		static void Release(unsigned int a_index);
+
+		static void Upload();
+
+		static unsigned int GetEntryCount() { return (unsigned int)m_stn->m_entries.size(); }
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static MaterialTable* m_stn;		// Singleton instance
+
+		// CPU side of an entry, textures are part of the key so materials that only differ by texture are not merged
+		struct Entry {
+			GPUMaterial		data;
+			Texture*		diffuseMap;
+			Texture*		specularMap;
+			Texture*		normalMap;
+			unsigned int	refCount;
+		};
+
+		static Entry MakeEntry(const Material& a_material);
+		static bool IsSameEntry(const Entry& a_lhs, const Entry& a_rhs);
+		static void MarkDirty(unsigned int a_index);
+
+		// Instance variables
+		unsigned int		m_bufferID;
+		unsigned int		m_bufferCapacity;		// Number of entries the GPU buffer has storage for
+
+		std::vector<Entry>	m_entries;
+
+		unsigned int		m_dirtyStart;			// Range of entries changed since the last upload
+		unsigned int		m_dirtyEnd;
+
+		// Statistics
+		unsigned int		m_registerCount;		// Materials registered, including ones merged into an existing entry
+		unsigned int		m_patchCount;			// Entries uploaded after load
+		unsigned int		m_liveEntryCount;
+
+		MaterialTable();
+		~MaterialTable();
+	};
+}
\ No newline at end of file
@@ -4,10 +4,15 @@
 #include "RenderCamera.h"
 #include "Transform.h"
 #include "Renderer_Utility_Literals.h"
+#include "Renderer_Utility_Funcs.h"
 #include "Light\PhongLight_Dir.h"
 #include "Light\PhongLight_Point.h"
 #include "Light\PhongLight_Spot.h"
 #include "Texture\Texture.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "MaterialTable.h"
+#include "GeometryPool.h"
 
 #include <gl_core_4_4.h>
 #include <imgui.h>
@@ -15,40 +20,31 @@
 
 namespace SPRON {
 
-	Mesh::Mesh(const std::vector<Vertex>& a_verts, VertexFormat* a_format, Transform* a_transform, Material a_material)
+	Mesh::Mesh(const std::vector<Vertex>& a_verts, VertexFormat* a_format, Transform* a_transform, const Material& a_material)
 	{
 		m_rawVerticeData = a_verts;		// Copy temporary contents into permanent class variable
 		m_material = a_material;
+		m_materialIndex = MaterialTable::Register(m_material);		// Identical materials share a table entry
 		m_vertFormat = a_format;
 		m_transform = a_transform;
 
-		// Create vertex buffer and bind to set vertex data
-		glGenBuffers(1, &m_vertBufferID);
+		glm::vec3 boundsCenter;
+		float boundsRadius;
+		RendererUtility::CalculateBoundingBox(m_rawVerticeData, m_localBounds.min, m_localBounds.max);
+		RendererUtility::CalculateBoundingSphere(m_rawVerticeData, boundsCenter, boundsRadius);
+		m_boundingSphere = glm::vec4(boundsCenter, boundsRadius);
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_vertBufferID);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * m_rawVerticeData.size(), &m_rawVerticeData[0], GL_STATIC_DRAW);
-
-		/// Pre-defined memory layout attributes
-		// NOTE: Stride is based on the overall size of the vertex, e.g. stride of 32 for a vertex containing 8 floats.
-
-		//// Vertex Position
-		m_vertFormat->AddAttribute(*this, 0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-
-		//// Vertex Texture Coords
-		m_vertFormat->AddAttribute(*this, 1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));	// Use offsetof macro to get the point in which the tex coordinates data starts
-
-		//// Vertex Normal
-		m_vertFormat->AddAttribute(*this, 2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-
-		//// Vertex Tangent Normal
-		m_vertFormat->AddAttribute(*this, 3, 4, GL_FLOAT, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, normalTangent));
+		// Copy vertex data and draw order into the shared buffers (NOTE: Vertex layout is described once by the geometry pool)
+		m_geometry = GeometryPool::Allocate(m_rawVerticeData, m_vertFormat->GetIndices());
 	}
 
 	Mesh::~Mesh()
 	{
 		/// NOTE: Only delete things unique to the mesh, not things that can be shared like materials and formats
-		// Delete vertex buffer
-		glDeleteBuffers(1, &m_vertBufferID);
+		// Release space in the geometry pool
+		GeometryPool::Free(m_geometry);
+
+		MaterialTable::Release(m_materialIndex);
 
 		// Clean up dynamically allocated memory
 		delete m_transform;
@@ -64,97 +60,100 @@ namespace SPRON {
 		return m_transform;
 	}
 
+	unsigned int Mesh::GetTriangleCount() const
+	{
+		if (!m_vertFormat || m_vertFormat->GetIndices().size() <= 1) { return (unsigned int)m_rawVerticeData.size() / 3; }		// No preset draw format, vertices are drawn in order
+
+		return (unsigned int)m_vertFormat->GetIndices().size() / 3;
+	}
+
 	/**
 	*	@brief Visually render mesh based on its vertices, transform, and render camera and lights.
 	*	NOTE: If a light shader is set to nullptr then that pass will not be performed.
 	*	O(L) complexity where L = number of lights
 	*	@param a_camera is the camera to render to.
 	*	@param a_lights is the vector of lights to take lighting information from.
-	*	@param a_globalAmbient is the global ambience to take into account when performing the ambient lighting pass.
 	*	@param a_ambientPass is the shader program to use during the ambient lighting pass.
 	*	@param a_directionalPass is the shader program to use during the directional lighting pass.
 	*	@param a_pointPass is the shader program to use during the point lighting pass.
 	*	@param a_debugPass is the shader program to use to draw debug information for the mesh.
 	*/
-	void Mesh::Draw(RenderCamera* a_camera, std::vector<PhongLight*> a_lights,
-		const glm::vec4& a_globalAmbient, ShaderWrapper* a_ambientPass,
+	void Mesh::Draw(RenderCamera* a_camera, const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
 		ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass)
 	{
 		assert(a_camera && "ERROR::MESH::NULL_CAMERA");
 
 		/// Set global rendering data
-		glm::mat4 modelTransform = m_transform->GetGlobalMatrix();
+		// NOTE: Camera data and global ambience are in the frame uniform block, only the object block needs to be written per mesh
+		ObjectUniformBlock object;
+		object.modelTransform = m_transform->GetPublishedMatrix();		// Ensure vertices are drawn in world coordinates not its local coordinates
+		object.materialIndex = m_materialIndex;
+
+		unsigned int objectIndex = UniformBlocks::PushObject(object);
+		UniformBlocks::Flush();
+
+		DrawObjects(a_lights, a_ambientPass, a_directionalPass, a_pointPass, a_spotPass, a_debugPass, objectIndex, 1);
+	}
+
+	/**
+	*	@brief Render every pass of the mesh for a run of consecutive object blocks that have already been pushed, as instances of a single draw.
+	*	NOTE: If a light shader is set to nullptr then that pass will not be performed.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_ambientPass is the shader program to use during the ambient lighting pass.
+	*	@param a_directionalPass is the shader program to use during the directional lighting pass.
+	*	@param a_pointPass is the shader program to use during the point lighting pass.
+	*	@param a_debugPass is the shader program to use to draw debug information for the mesh.
+	*	@param a_firstObject is the index of the first object block, returned by UniformBlocks::PushObject.
+	*	@param a_objectCount is the number of object blocks, one instance is drawn per block.
+	*	@return void.
+	*/
+	void Mesh::DrawObjects(const std::vector<PhongLight*>& a_lights, ShaderWrapper * a_ambientPass,
+		ShaderWrapper * a_directionalPass, ShaderWrapper * a_pointPass, ShaderWrapper * a_spotPass, ShaderWrapper * a_debugPass,
+		unsigned int a_firstObject, unsigned int a_objectCount)
+	{
+		unsigned int objectIndex = a_firstObject;
 
 #pragma region Ambient Pass
 		if (a_ambientPass) {
 			//// Ambient pass (only performed once)
-			a_ambientPass->SetMat4("modelTransform", modelTransform);		// Ensure vertices are drawn in world coordinates not its local coordinates
-			a_ambientPass->SetMat4("viewTransform", a_camera->CalculateView());
-			a_ambientPass->SetMat4("projectionTransform", a_camera->GetProjection());
-
 			// Set lighting data
-			a_ambientPass->SetVec4("ambient", a_globalAmbient * m_material.ambientColor);	// Combine global ambience with material ambience
-			a_ambientPass->SetTexture("texSample", m_material.diffuseMap);
-			a_ambientPass->SetBool("useTex", (m_material.diffuseMap ? true : false));
+			a_ambientPass->SetTexture(Uniforms::TEX_SAMPLE, m_material.diffuseMap);
+			a_ambientPass->SetBool(Uniforms::USE_TEX, (m_material.diffuseMap ? true : false));
 
 			// Perform render pass
-			Render(a_ambientPass);
+			Render(a_ambientPass, objectIndex, a_objectCount);
 		}
 #pragma endregion
 
 #pragma region Directional Pass Data Assignment
 		if (a_directionalPass) {
-			// Set render transforms
-			a_directionalPass->SetMat4("modelTransform", modelTransform);
-			a_directionalPass->SetMat4("viewTransform", a_camera->CalculateView());
-			a_directionalPass->SetMat4("projectionTransform", a_camera->GetProjection());
-
-			// Set material data
-			a_directionalPass->SetMaterial("material", m_material);
-
-			// Set additional data
-			a_directionalPass->SetVec3("worldViewerPos", a_camera->GetTransform()->GetPosition());
+			// Set material texture maps
+			a_directionalPass->SetMaterialMaps(Uniforms::MATERIAL_MAPS, m_material);
 		}
 #pragma endregion
 
 #pragma region Point Pass Data Assignment
 		if (a_pointPass) {
-			// Set render transforms
-			a_pointPass->SetMat4("modelTransform", modelTransform);
-			a_pointPass->SetMat4("viewTransform", a_camera->CalculateView());
-			a_pointPass->SetMat4("projectionTransform", a_camera->GetProjection());
-
-			// Set material data
-			a_pointPass->SetMaterial("material", m_material);
-
-			// Set additional data
-			a_pointPass->SetVec3("worldViewerPos", a_camera->GetTransform()->GetPosition());
+			// Set material texture maps
+			a_pointPass->SetMaterialMaps(Uniforms::MATERIAL_MAPS, m_material);
 		}
 #pragma endregion
 
 #pragma region Spot Pass Data Assignment
 		if (a_spotPass) {
-			// Set render transforms
-			a_spotPass->SetMat4("modelTransform", modelTransform);
-			a_spotPass->SetMat4("viewTransform", a_camera->CalculateView());
-			a_spotPass->SetMat4("projectionTransform", a_camera->GetProjection());
-
-			// Set material data
-			a_spotPass->SetMaterial("material", m_material);
-
-			// Set additional data
-			a_spotPass->SetVec3("worldViewerPos", a_camera->GetTransform()->GetPosition());
+			// Set material texture maps
+			a_spotPass->SetMaterialMaps(Uniforms::MATERIAL_MAPS, m_material);
 		}
 #pragma endregion
 
 		/// Forward rendering
 		// Activate blending
 #if BLEND_RENDERING
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_ONE, GL_ONE);	// Take existing frag color *1 and add it onto the new frag color *1
+		GLStateCache::SetBlending(true);
+		GLStateCache::SetBlendFunc(GL_ONE, GL_ONE);	// Take existing frag color *1 and add it onto the new frag color *1
 
-		glDepthMask(false);				// Disable writing to depth buffer
-		glDepthFunc(GL_EQUAL);			// Only tries to adds on the new pixel with the lighting if it has the same depth value as the pixel nearest to the screen
+		GLStateCache::SetDepthMask(false);				// Disable writing to depth buffer
+		GLStateCache::SetDepthFunc(GL_EQUAL);			// Only tries to adds on the new pixel with the lighting if it has the same depth value as the pixel nearest to the screen
 #endif
 		// Loop through each light and apply appropriate lighting passes
 		for (int i = 0; i < a_lights.size(); ++i) {
@@ -165,10 +164,10 @@ namespace SPRON {
 				PhongLight_Dir* dirLight = (PhongLight_Dir*)a_lights[i];
 
 				// Set lighting data
-				a_directionalPass->SetDirectionalLight("dirLight", dirLight);
+				a_directionalPass->SetDirectionalLight(Uniforms::LIGHT_DIR, dirLight);
 
 				// Perform render pass
-				Render(a_directionalPass);
+				Render(a_directionalPass, objectIndex, a_objectCount);
 			}
 
 			//// Point pass
@@ -177,10 +176,10 @@ namespace SPRON {
 				PhongLight_Point* ptLight = (PhongLight_Point*)a_lights[i];
 
 				// Set lighting data
-				a_pointPass->SetPointLight("ptLight", ptLight);
+				a_pointPass->SetPointLight(Uniforms::LIGHT_POINT, ptLight);
 
 				// Perform render pass
-				Render(a_pointPass);
+				Render(a_pointPass, objectIndex, a_objectCount);
 			}
 
 			//// Spot pass
@@ -189,67 +188,87 @@ namespace SPRON {
 				PhongLight_Spot* spotLight = (PhongLight_Spot*)a_lights[i];
 
 				// Set lighting data
-				a_spotPass->SetSpotLight("spotLight", spotLight);
+				a_spotPass->SetSpotLight(Uniforms::LIGHT_SPOT, spotLight);
 
 				// Perform render pass
-				Render(a_spotPass);
+				Render(a_spotPass, objectIndex, a_objectCount);
 			}
 		}
 
 #if BLEND_RENDERING
-		glDepthFunc(GL_LESS);			// Set back to default depth function
-		glDepthMask(true);				// Re-enable writing to depth buffer
+		GLStateCache::SetDepthFunc(GL_LESS);			// Set back to default depth function
+		GLStateCache::SetDepthMask(true);				// Re-enable writing to depth buffer
 
 		// De-activate blending
-		glDisable(GL_BLEND);
+		GLStateCache::SetBlending(false);
 #endif
 #pragma region Debug Pass
 		if (a_debugPass) {
 			//// Debug pass (only performed once)
-			a_debugPass->SetMat4("modelTransform", modelTransform);		// Ensure vertices are drawn in world coordinates not its local coordinates
-			a_debugPass->SetMat4("viewTransform", a_camera->CalculateView());
-			a_debugPass->SetMat4("projectionTransform", a_camera->GetProjection());
-
-			a_debugPass->SetFloat("drawScale", 0.1f);
-			a_debugPass->SetVec4("normalColor", glm::vec4(0, 0, 1, 1));
-			a_debugPass->SetVec4("tangentColor", glm::vec4(1, 0, 0, 1));
-			a_debugPass->SetVec4("bitangentColor", glm::vec4(0, 1, 0, 1));
+			a_debugPass->SetFloat(Uniforms::DRAW_SCALE, 0.1f);
+			a_debugPass->SetVec4(Uniforms::NORMAL_COLOR, glm::vec4(0, 0, 1, 1));
+			a_debugPass->SetVec4(Uniforms::TANGENT_COLOR, glm::vec4(1, 0, 0, 1));
+			a_debugPass->SetVec4(Uniforms::BITANGENT_COLOR, glm::vec4(0, 1, 0, 1));
 
 			// Perform render pass
-			Render(a_debugPass);
+			Render(a_debugPass, objectIndex, a_objectCount);
 		}
 #pragma endregion
 
 	}
 
-	void Mesh::SetMaterial(Material a_material)
+	void Mesh::SetMaterial(const Material& a_material)
 	{
 		m_material = a_material;
+
+		UpdateMaterial();
+	}
+
+	/**
+	*	@brief Patch the material table after the mesh's material has been modified through GetMaterial.
+	*	@return void.
+	*/
+	void Mesh::UpdateMaterial()
+	{
+		m_materialIndex = MaterialTable::Update(m_materialIndex, m_material);
 	}
 
 	/**
 	*	@brief Draw vertices with bound shader program.
 	*	NOTE: This can be used multiple times with forward rendering light shaders to create an overall blend with multiple render passes.
 	*	@param a_shaderProgram is the shader program to use to render the mesh with.
+	*	@param a_objectIndex is the object block to draw with, returned by UniformBlocks::PushObject.
+	*	@param a_instanceCount is the number of instances to draw, each reads the object block after the previous one.
 	**/
-	void Mesh::Render(ShaderWrapper * a_shaderProgram)
+	void Mesh::Render(ShaderWrapper * a_shaderProgram, unsigned int a_objectIndex, unsigned int a_instanceCount)
 	{
 		// Bind shader program
-		glUseProgram(*a_shaderProgram);
-
-		// Bind vertex formatting
-		m_vertFormat->SetAsContext();
+		GLStateCache::UseProgram(*a_shaderProgram);
 
-		// Determine render method from vertex format
-		unsigned int indiceNum = m_vertFormat->GetElementNum();
+		// Bind shared vertex array
+		GeometryPool::Bind();
 
-		if (indiceNum > 1) {	// Mesh has preset draw format
-			glDrawElements(GL_TRIANGLES, m_vertFormat->GetElementNum(), GL_UNSIGNED_INT, 0);		// Renderer shape hint, number of indices, offset in indice buffer
-		}
-		else {					// Mesh has no preset draw format
-			unsigned int vertNum = sizeof(Vertex) * m_rawVerticeData.size() / (sizeof(Vertex));		// Divide array size by vertex stride to get number of vertices
-			glDrawArrays(GL_TRIANGLES, 0, vertNum);
-		}
+		IssueDrawCall(a_objectIndex, a_instanceCount);
+	}
 
+	/**
+	*	@brief Issue the draw call for the mesh's vertices without binding a shader program or vertex array.
+	*	NOTE: Expects the shader program and the geometry pool's vertex array to already be bound, e.g. by the render queue.
+	*	@param a_objectIndex is the object block to draw with, passed as the base instance so the draw ID attribute reads it back.
+	*	@param a_instanceCount is the number of instances to draw, each reads the object block after the previous one.
+	*	@return void.
+	*/
+	void Mesh::IssueDrawCall(unsigned int a_objectIndex, unsigned int a_instanceCount)
+	{
+		GeometryRange range = GeometryPool::GetRange(m_geometry);
+
+		glDrawElementsInstancedBaseVertexBaseInstance(
+			GL_TRIANGLES,											// Renderer shape hint
+			range.indexCount,										// Number of indices
+			GL_UNSIGNED_INT,
+			(void*)(sizeof(unsigned int) * range.firstIndex),		// Offset in the shared indice buffer
+			a_instanceCount,										// Draw ID advances once per instance
+			range.baseVertex,										// Indices are local to the mesh
+			a_objectIndex);
 	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Vertex.h"
+#include "GeometryPool.h"
+#include "AABB.h"
 
 #include <vector>
 #include <glm/vec4.hpp>
@@ -45,15 +47,22 @@ namespace SPRON {
 		}
 		~Material() {}
 
+		int GetID() const { return m_id; }
+
 		/// IMGUI
-		void ListenIMGUI() {
-			if (!diffuseMap && !specularMap && !normalMap) { return; }		// No properties to modify, return
+		// Returns whether any property was modified
+		bool ListenIMGUI() {
+			if (!diffuseMap && !specularMap && !normalMap) { return false; }		// No properties to modify, return
+
+			bool modified = false;
 
 			ImGui::LabelText("", name.c_str());
-			if (diffuseMap) { ImGui::Checkbox("Disable Diffuse Mapping", &disableDiffuseMap); }
-			if (specularMap) { ImGui::Checkbox("Disable Specular Mapping", &disableSpecularMap); }
-			if (normalMap) { ImGui::Checkbox("Disable Normal Mapping", &disableNormalMap); }
+			if (diffuseMap) { modified |= ImGui::Checkbox("Disable Diffuse Mapping", &disableDiffuseMap); }
+			if (specularMap) { modified |= ImGui::Checkbox("Disable Specular Mapping", &disableSpecularMap); }
+			if (normalMap) { modified |= ImGui::Checkbox("Disable Normal Mapping", &disableNormalMap); }
 			ImGui::NewLine();
+
+			return modified;
 		}
 
 		std::string name;
@@ -81,35 +90,49 @@ namespace SPRON {
 
 	class Mesh {
 	public:
-		Mesh() {}
+		Mesh() : m_geometry(GeometryPool::INVALID_GEOMETRY), m_materialIndex(~0u), m_boundingSphere(0.f) {}
 		Mesh(const std::vector<Vertex>& a_verts, VertexFormat* a_format, Transform* a_transform,
-			Material a_material = Material());		// Set default material values if not defined in constructor
+			const Material& a_material = Material());		// Set default material values if not defined in constructor
 		~Mesh();
 
 		Material& GetMaterial();
+		unsigned int GetMaterialIndex() const { return m_materialIndex; }
 		Transform* GetTransform();
-		std::vector<Vertex> GetVerticeData() { return m_rawVerticeData; }
-
-		operator unsigned int() { return m_vertBufferID; }
+		VertexFormat* GetVertexFormat() { return m_vertFormat; }
+		unsigned int GetGeometry() const { return m_geometry; }
+		const std::vector<Vertex>& GetVerticeData() const { return m_rawVerticeData; }
+		const AABB& GetLocalBounds() const { return m_localBounds; }
+		const glm::vec4& GetBoundingSphere() const { return m_boundingSphere; }
+		unsigned int GetTriangleCount() const;
 
 		void Draw(RenderCamera* a_camera,
-			std::vector<PhongLight*> a_lights,
-			const glm::vec4& a_globalAmbient, ShaderWrapper* a_ambientPass,
+			const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
 			ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass);
 
-		void SetMaterial(Material a_material);
+		void DrawObjects(const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
+			ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass,
+			unsigned int a_firstObject, unsigned int a_objectCount);
+
+		void SetMaterial(const Material& a_material);
+		void UpdateMaterial();
 
-		void Render(ShaderWrapper* a_shaderProgram);
+		void Render(ShaderWrapper* a_shaderProgram, unsigned int a_objectIndex = 0, unsigned int a_instanceCount = 1);
+		void IssueDrawCall(unsigned int a_objectIndex, unsigned int a_instanceCount = 1);
 	protected:
 	private:
-		unsigned int m_vertBufferID;	// Hold onto vertex buffer identifier
+		unsigned int m_geometry;		// Handle to the vertices and indices in the geometry pool, offsets are looked up as they can move
 
 		Material m_material;
+		unsigned int m_materialIndex;	// Entry of the material in the material table
 
 		VertexFormat* m_vertFormat;			// How vertex data is interpreted
 
 		std::vector<Vertex> m_rawVerticeData;	// Keep track of vertex data so memory isn't freed until Mesh is deleted
 
+		// Bounds of the vertices in model space, calculated once when the mesh is created so culling never reads the vertices
+		AABB		m_localBounds;
+		glm::vec4	m_boundingSphere;		// xyz = center and w = radius
+
 		Transform* m_parentTransform;	// Hold onto parent transform so that changes made to it will apply to all of its child meshes
 		Transform* m_transform;			// Transform information in global space
 	};
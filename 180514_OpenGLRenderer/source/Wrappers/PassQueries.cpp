@@ -0,0 +1,108 @@
+#include "PassQueries.h"
+
+#include <gl_core_4_4.h>
+#include <assert.h>
+
+namespace SPRON {
+
+	PassQueries::PassQueries(unsigned int a_passCount) :
+		m_passCount(a_passCount), m_frame(0), m_currentPass(NO_PASS)
+	{
+		m_queries.resize(FRAME_LATENCY * m_passCount);
+
+		for (unsigned int i = 0; i < m_queries.size(); ++i) {
+			glGenQueries(1, &m_queries[i].samplesID);
+			glGenQueries(1, &m_queries[i].timeID);
+			m_queries[i].isIssued = false;
+		}
+
+		m_samples.resize(m_passCount, 0);
+		m_times.resize(m_passCount, 0.f);
+	}
+
+	PassQueries::~PassQueries()
+	{
+		for (unsigned int i = 0; i < m_queries.size(); ++i) {
+			glDeleteQueries(1, &m_queries[i].samplesID);
+			glDeleteQueries(1, &m_queries[i].timeID);
+		}
+	}
+
+	/**
+	*	@brief Move on to the next frame's queries, reading the results they held from FRAME_LATENCY frames ago first.
+	*	@return void.
+	*/
+	void PassQueries::Begin()
+	{
+		assert(m_currentPass == NO_PASS && "ERROR::PASS_QUERIES::BEGIN_WITHOUT_END");
+
+		m_frame = (m_frame + 1) % FRAME_LATENCY;
+		ReadResults(m_frame);
+	}
+
+	/**
+	*	@brief End the active pass's queries and start measuring another pass, does nothing if the pass is already being measured.
+	*	@param a_pass is the pass whose draws follow.
+	*	@return void.
+	*/
+	void PassQueries::SwitchPass(unsigned int a_pass)
+	{
+		if (a_pass == m_currentPass) { return; }
+
+		End();
+
+		assert(a_pass < m_passCount && "ERROR::PASS_QUERIES::PASS_OUT_OF_RANGE");
+
+		PassQuery& query = m_queries[m_frame * m_passCount + a_pass];
+		glBeginQuery(GL_SAMPLES_PASSED, query.samplesID);
+		glBeginQuery(GL_TIME_ELAPSED, query.timeID);
+		query.isIssued = true;
+
+		m_currentPass = a_pass;
+	}
+
+	/**
+	*	@brief End the active pass's queries, if any.
+	*	@return void.
+	*/
+	void PassQueries::End()
+	{
+		if (m_currentPass == NO_PASS) { return; }
+
+		glEndQuery(GL_SAMPLES_PASSED);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		m_currentPass = NO_PASS;
+	}
+
+	/**
+	*	@brief Read the results of a frame slot's queries that the GPU has finished, passes not drawn that frame read as 0.
+	*	@param a_frame is the frame slot to read.
+	*	@return void.
+	*/
+	void PassQueries::ReadResults(unsigned int a_frame)
+	{
+		for (unsigned int i = 0; i < m_passCount; ++i) {
+			PassQuery& query = m_queries[a_frame * m_passCount + i];
+
+			if (!query.isIssued) {
+				m_samples[i] = 0;
+				m_times[i] = 0.f;
+				continue;
+			}
+
+			// NOTE: The time query ends after the samples query, so its result is available last
+			GLint isAvailable = GL_FALSE;
+			glGetQueryObjectiv(query.timeID, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+			if (!isAvailable) { continue; }
+
+			GLuint64 samples = 0, time = 0;
+			glGetQueryObjectui64v(query.samplesID, GL_QUERY_RESULT, &samples);
+			glGetQueryObjectui64v(query.timeID, GL_QUERY_RESULT, &time);
+
+			m_samples[i] = samples;
+			m_times[i] = time / 1000000.f;
+			query.isIssued = false;
+		}
+	}
+}
\ No newline at end of file
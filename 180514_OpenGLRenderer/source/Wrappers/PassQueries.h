@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+namespace SPRON {
+	/**
+	*	@brief Measures the samples that pass the depth test and the GPU time of each render pass, with occlusion and timer queries.
+	*	Samples passed in a shading pass are the fragments it shaded, so divided by the pixels of the viewport they give its overdraw.
+	*	Results are read a few frames after they were issued so reading them never waits on the GPU, queries that are still pending are skipped.
+	*	NOTE: Passes must be contiguous, a pass can only be measured once per frame.
+	*/
+	class PassQueries {
+	public:
+		PassQueries(unsigned int a_passCount);
+		~PassQueries();
+
+		void Begin();
+		void SwitchPass(unsigned int a_pass);
+		void End();
+
+		uint64_t GetSamples(unsigned int a_pass) const { return m_samples[a_pass]; }
+		float GetTime(unsigned int a_pass) const { return m_times[a_pass]; }
+	protected:
+	private:
+		static const unsigned int FRAME_LATENCY = 3;		// Frames between issuing a query and reading its result
+		static const unsigned int NO_PASS = ~0u;
+
+		// Queries of one pass in one frame
+		struct PassQuery {
+			unsigned int	samplesID;
+			unsigned int	timeID;
+			bool			isIssued;
+		};
+
+		void ReadResults(unsigned int a_frame);
+
+		unsigned int			m_passCount;
+		std::vector<PassQuery>	m_queries;		// Frame major, FRAME_LATENCY * m_passCount
+		unsigned int			m_frame;		// Frame slot queries are currently issued into
+		unsigned int			m_currentPass;	// Pass whose queries are active, NO_PASS between passes
+
+		std::vector<uint64_t>	m_samples;		// Latest results of each pass
+		std::vector<float>		m_times;		// Milliseconds
+	};
+}
\ No newline at end of file
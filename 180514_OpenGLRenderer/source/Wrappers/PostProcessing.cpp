@@ -6,6 +6,8 @@
 #include "Transform.h"
 #include "Renderer_Utility_Literals.h"
 #include "ShaderWrapper.h"
+#include "GLStateCache.h"
+#include "Texture/TextureBinder.h"
 
 #include <gl_core_4_4.h>
 #include <iostream>
@@ -28,7 +30,7 @@ namespace SPRON {
 			// Create and bind frame buffer
 			glGenFramebuffers(1, &m_stn->m_frameBufferID);
 
-			glBindFramebuffer(GL_FRAMEBUFFER, m_stn->m_frameBufferID);	// Allow future read and write frame buffer operations to affect this buffer
+			GLStateCache::BindFramebuffer(m_stn->m_frameBufferID);	// Allow future read and write frame buffer operations to affect this buffer
 			
 			/// Create and attach render texture to frame buffer [SCREEN TEXTURE]
 			GLint viewport[4]; glGetIntegerv(GL_VIEWPORT, viewport); int screenWidth = viewport[2], screenHeight = viewport[3];
@@ -42,14 +44,16 @@ namespace SPRON {
 				*m_stn->m_screenTex,		// Texture ID
 				0);							// Mipmap level (kept at 0 because not being used) 
 
-			/// Create and attach render buffer to frame buffer
-			glGenRenderbuffers(1, &m_stn->m_renderBufferID);
+			/// Create and attach depth texture to frame buffer
+			// NOTE: A texture instead of a render buffer so the scene's depth can be sampled after it is rendered (GPU culling's depth pyramid)
+			glGenTextures(1, &m_stn->m_depthTextureID);
 
-			glBindRenderbuffer(GL_RENDERBUFFER, m_stn->m_renderBufferID);
-			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, screenWidth, screenHeight);	// Track depth with render buffer in order to perform depth testing so only the closest pixels render, avoiding overlap
-			glBindRenderbuffer(GL_RENDERBUFFER, 0);													// No need for render buffer to be bound after setting storage
+			TextureBinder::BindForEdit(GL_TEXTURE_2D, m_stn->m_depthTextureID);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, screenWidth, screenHeight);	// Track depth in order to perform depth testing so only the closest pixels render, avoiding overlap
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_stn->m_renderBufferID);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_stn->m_depthTextureID, 0);
 
 			// Check if frame buffer is 'complete' (at least one buffer attached, at least one color attachment, same number of samples - complete attachments)
 			try {
@@ -83,10 +87,8 @@ namespace SPRON {
 			m_stn->m_baseEffect->LoadShader("./shaders/post/post_hdr_bloom.frag", FRAG_SHADER);
 			m_stn->m_baseEffect->LinkShaders();
 
-			m_stn->m_baseEffect->SetTexture("screenRenderTex", m_stn->m_screenTex);
-
 			// Unbind custom frame buffer
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			GLStateCache::BindFramebuffer(0);
 		}
 	}
 
@@ -107,8 +109,8 @@ namespace SPRON {
 	*/
 	void PostProcessing::BeginListening()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, m_stn->m_frameBufferID);
-		glEnable(GL_DEPTH_TEST);			// Enable depth testing to accurately replace the default frame buffer
+		GLStateCache::BindFramebuffer(m_stn->m_frameBufferID);
+		GLStateCache::SetDepthTest(true);			// Enable depth testing to accurately replace the default frame buffer
 
 		// Refresh previous frame buffer content
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -122,27 +124,28 @@ namespace SPRON {
 	void PostProcessing::Draw()
 	{
 		// Bind back to default frame buffer to enable rendering to the window instead of off-screen rendering in the custom frame buffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glDisable(GL_DEPTH_TEST);		// Disable depth test or the screen quad will be discarded
+		GLStateCache::BindFramebuffer(0);
+		GLStateCache::SetDepthTest(false);		// Disable depth test or the screen quad will be discarded
 		glClear(GL_COLOR_BUFFER_BIT);	// No depth-testing, only need to refresh color
 
 		// Optional HDR
 		ImGui::Begin("HDR");
 		
-		static bool in_enableHDR = true; ImGui::Checkbox("Enable HDR", &in_enableHDR); m_stn->m_baseEffect->SetBool("enableHDR", in_enableHDR);
+		static bool in_enableHDR = true; ImGui::Checkbox("Enable HDR", &in_enableHDR); m_stn->m_baseEffect->SetBool(Uniforms::HDR_ENABLED, in_enableHDR);
 		if (in_enableHDR) {
-			static float in_exposure = 1; ImGui::DragFloat("Exposure", &in_exposure, 0.01f, 0.f, 10.f); m_stn->m_baseEffect->SetFloat("exposure", in_exposure);
+			static float in_exposure = 1; ImGui::DragFloat("Exposure", &in_exposure, 0.01f, 0.f, 10.f); m_stn->m_baseEffect->SetFloat(Uniforms::EXPOSURE, in_exposure);
 		}
 
 		ImGui::End();
 
-		// Draw screen render texture
+		// Draw screen render texture (NOTE: Units are assigned on bind, so the sampler is set every frame in case the texture's unit was re-used)
+		m_stn->m_baseEffect->SetTexture(Uniforms::SCREEN_RENDER_TEX, m_stn->m_screenTex);
 		m_stn->m_screenMesh->Render(m_stn->m_baseEffect);
 
 #if BLEND_POST_PROCESSING
 		// Activate blending
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_ONE, GL_ONE);	// Take existing frag color *1 and add it onto the new frag color *1
+		GLStateCache::SetBlending(true);
+		GLStateCache::SetBlendFunc(GL_ONE, GL_ONE);	// Take existing frag color *1 and add it onto the new frag color *1
 
 		/// Post-processing effect passes
 		ImGui::Begin("Post Processing Effects");
@@ -167,13 +170,13 @@ namespace SPRON {
 			ShaderWrapper* currentEffect = m_stn->m_effects[i];
 
 			// Set render texture parameter
-			currentEffect->SetTexture("screenRenderTex", m_stn->m_screenTex);
+			currentEffect->SetTexture(Uniforms::SCREEN_RENDER_TEX, m_stn->m_screenTex);
 
 			/// Sharpen
 #if ENABLE_SHARPEN
 			if (in_enableSharpen && currentEffect->GetName() == "post_sharpen") { 
 				
-				currentEffect->SetFloat("clarityFactor", in_sharpenClarity);
+				currentEffect->SetFloat(Uniforms::CLARITY_FACTOR, in_sharpenClarity);
 				m_stn->m_screenMesh->Render(currentEffect);
 			}
 #endif
@@ -182,7 +185,7 @@ namespace SPRON {
 #if ENABLE_BLUR
 			if (in_enableBlur && currentEffect->GetName() == "post_blur") {
 				
-				currentEffect->SetFloat("clarityFactor", in_blurClarity);
+				currentEffect->SetFloat(Uniforms::CLARITY_FACTOR, in_blurClarity);
 				m_stn->m_screenMesh->Render(currentEffect);
 			}
 #endif
@@ -190,14 +193,14 @@ namespace SPRON {
 #if ENABLE_EDGE_DETECT
 			if (in_enableEdge && currentEffect->GetName() == "post_edge") {
 
-				currentEffect->SetFloat("clarityFactor", in_edgeClarity);
+				currentEffect->SetFloat(Uniforms::CLARITY_FACTOR, in_edgeClarity);
 				m_stn->m_screenMesh->Render(currentEffect);
 			}
 #endif
 		}
 
 		// De-activate blending
-		glDisable(GL_BLEND);
+		GLStateCache::SetBlending(false);
 #endif
 	}
 
@@ -214,6 +217,7 @@ namespace SPRON {
 		delete m_stn->m_baseEffect;
 
 		// Clean up openGL frame buffer object
+		GLStateCache::ForgetFramebuffer(m_stn->m_frameBufferID);
 		glDeleteFramebuffers(1, &m_stn->m_frameBufferID);
 
 		// Clean up openGL render buffer object
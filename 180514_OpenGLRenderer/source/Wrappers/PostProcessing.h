@@ -19,6 +19,7 @@ namespace SPRON {
 		static void Draw();
 
 		static unsigned int GetFrameBufferID() { return m_stn->m_frameBufferID; }
+		static unsigned int GetDepthTextureID() { return m_stn->m_depthTextureID; }
 	protected:
 	private:
 		static PostProcessing* m_stn;		// Singleton instance
@@ -26,7 +27,7 @@ namespace SPRON {
 		// Instance variables
 		unsigned int	m_frameBufferID;
 
-		unsigned int	m_renderBufferID;
+		unsigned int	m_depthTextureID;			// Depth attachment of the frame buffer
 		RenderTexture*	m_screenTex;
 
 		VertexFormat*	m_quadFormat;				// Hold onto quad format so memory can be cleaned up
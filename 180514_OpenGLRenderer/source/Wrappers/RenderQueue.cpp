@@ -0,0 +1,1101 @@
+#include "RenderQueue.h"
+#include "Mesh.h"
+#include "InstancedMesh.h"
+#include "StaticBatch.h"
+#include "SceneStore.h"
+#include "ShaderWrapper.h"
+#include "RenderCamera.h"
+#include "Transform.h"
+#include "Renderer_Utility_Literals.h"
+#include "Renderer_Utility_Funcs.h"
+#include "Light\PhongLight_Dir.h"
+#include "Light\PhongLight_Point.h"
+#include "Light\PhongLight_Spot.h"
+#include "Texture\Texture.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "GeometryPool.h"
+#include "VertexFormat.h"
+#include "OcclusionCuller.h"
+#include "PotentiallyVisibleSet.h"
+#include "PassQueries.h"
+#include "JobSystem.h"
+#include "CommandList.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace SPRON {
+
+	/// Sort key layout
+	static const unsigned int KEY_PASS_SHIFT = 60;
+	static const unsigned int KEY_LIGHT_SHIFT = 52;
+	static const unsigned int KEY_PROGRAM_SHIFT = 44;
+	static const unsigned int KEY_MATERIAL_SHIFT = 24;
+
+	static const uint64_t KEY_PASS_MASK = 0xF;
+	static const uint64_t KEY_LIGHT_MASK = 0xFF;
+	static const uint64_t KEY_PROGRAM_MASK = 0xFF;
+	static const uint64_t KEY_MATERIAL_MASK = 0xFFFFF;
+	static const uint64_t KEY_DEPTH_MASK = 0xFFFFFF;
+
+	/**
+	*	@brief Count the texture maps a material sends to a pass, used for the texture bind statistics.
+	*	NOTE: An estimate, the state cache skips maps already bound to a unit and the binder may re-use units, so fewer binds can actually be issued.
+	*/
+	static unsigned int CountMaterialTextures(const Material& a_material, unsigned int a_pass)
+	{
+		if (a_pass == RENDER_PASS_DEPTH) {			// Depth prepass samples nothing
+			return 0;
+		}
+
+		if (a_pass == RENDER_PASS_AMBIENT) {		// Ambient pass only samples the diffuse map
+			return (a_material.diffuseMap ? 1 : 0);
+		}
+
+		return (a_material.diffuseMap ? 1 : 0) + (a_material.specularMap ? 1 : 0) + (a_material.normalMap ? 1 : 0);
+	}
+
+	/**
+	*	@brief Get the texture object a material map samples from, textures packed into the same texture array share an ID.
+	*/
+	static unsigned int GetMapID(Texture* a_map)
+	{
+		return (a_map ? (unsigned int)*a_map : ~0u);		// Distinguish no map from a map that failed to load
+	}
+
+	/**
+	*	@brief Check whether two materials set the same sampler uniforms for a pass, so draws using them can share a batch.
+	*	NOTE: Everything else about a material is read from the material table per draw.
+	*/
+	static bool HasSameMaps(const Material& a_lhs, const Material& a_rhs, unsigned int a_pass)
+	{
+		switch (a_pass) {
+			case RENDER_PASS_AMBIENT:
+				return GetMapID(a_lhs.diffuseMap) == GetMapID(a_rhs.diffuseMap);
+			case RENDER_PASS_LIGHT:
+				return GetMapID(a_lhs.diffuseMap) == GetMapID(a_rhs.diffuseMap) &&
+					GetMapID(a_lhs.specularMap) == GetMapID(a_rhs.specularMap) &&
+					GetMapID(a_lhs.normalMap) == GetMapID(a_rhs.normalMap);
+			default:		// Depth and debug passes do not sample the material
+				return true;
+		}
+	}
+
+	RenderQueue::RenderQueue() : m_camera(nullptr), m_isOcclusionCulling(USE_OCCLUSION_CULLING), m_isOcclusionReady(false),
+		m_visibleSet(nullptr), m_isPVSCulling(USE_PVS), m_isPVSSelected(false), m_rangeCount(0), m_indirectBufferID(0), m_indirectCapacity(0),
+		m_isGPUCulling(USE_GPU_CULLING && USE_MULTI_DRAW_INDIRECT), m_isCullValidationRequested(false), m_isDepthPrepass(USE_DEPTH_PREPASS),
+		m_isVisibilityBuffer(USE_VISIBILITY_BUFFER), m_viewportPixels(0), m_isParallelRecording(USE_PARALLEL_RECORDING),
+		m_recordTime(0.f), m_replayTime(0.f), m_occlusionTime(0.f)
+	{
+		glGenBuffers(1, &m_indirectBufferID);
+
+		m_depthProgram = new ShaderWrapper("depth_prepass");
+		m_depthProgram->LoadShader("./shaders/depth/depth_prepass.vert", VERT_SHADER);
+		m_depthProgram->LoadShader("./shaders/depth/depth_prepass.frag", FRAG_SHADER);
+		m_depthProgram->LinkShaders();
+
+		m_passQueries = new PassQueries(RENDER_PASS_COUNT);
+		m_visibilityBuffer = new VisibilityBuffer();
+
+		m_occlusion = new OcclusionCuller(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+		m_gpuCuller = new GPUCuller();
+	}
+
+	RenderQueue::~RenderQueue()
+	{
+		glDeleteBuffers(1, &m_indirectBufferID);
+
+		delete m_occlusion;
+		delete m_gpuCuller;
+		delete m_depthProgram;
+		delete m_passQueries;
+		delete m_visibilityBuffer;
+	}
+
+	/**
+	*	@brief Combine draw state into a single key so that sorting the keys groups draws by pass, light, program and material, then front to back.
+	*	NOTE: Each field is masked to its bit range, so collisions only cost an extra state change and never an incorrect draw.
+	*	@return 64 bit sort key.
+	*/
+	uint64_t RenderQueue::MakeKey(unsigned int a_pass, unsigned int a_light, unsigned int a_program, unsigned int a_material, unsigned int a_depth)
+	{
+		return ((a_pass & KEY_PASS_MASK) << KEY_PASS_SHIFT) |
+			((a_light & KEY_LIGHT_MASK) << KEY_LIGHT_SHIFT) |
+			((a_program & KEY_PROGRAM_MASK) << KEY_PROGRAM_SHIFT) |
+			((a_material & KEY_MATERIAL_MASK) << KEY_MATERIAL_SHIFT) |
+			(a_depth & KEY_DEPTH_MASK);
+	}
+
+	/**
+	*	@brief Clear the previous frame's draws and cache the camera data for this frame.
+	*	@param a_camera is the camera to render to.
+	*	@return void.
+	*/
+	void RenderQueue::Begin(RenderCamera * a_camera)
+	{
+		assert(a_camera && "ERROR::RENDER_QUEUE::NULL_CAMERA");
+
+		m_camera = a_camera;
+		m_viewTransform = UniformBlocks::GetFrameData().viewTransform;
+		m_viewerPos = UniformBlocks::GetFrameData().worldViewerPos;
+
+		m_frustum.Set(UniformBlocks::GetFrameData().projectionTransform * m_viewTransform);
+
+		// NOTE: Only decodes a set when the viewer moves into a cell with a different set
+		m_isPVSSelected = m_isPVSCulling && m_visibleSet && m_visibleSet->Select(m_viewerPos);
+
+		// NOTE: Clearing keeps the capacity so steady state frames do not re-allocate
+		m_items.clear();
+		m_objects.clear();
+		m_bounds.clear();
+		m_occluders.clear();
+
+		m_isOcclusionReady = false;
+
+		m_stats = Stats();
+	}
+
+	/**
+	*	@brief Offer every entity of a scene store with few enough triangles as an occluder.
+	*	NOTE: World bounds come from the store's last UpdateBounds.
+	*	@param a_scene is the scene store to take occluders from.
+	*	@return void.
+	*/
+	void RenderQueue::AddOccluders(SceneStore * a_scene)
+	{
+		if (!m_isOcclusionCulling) { return; }
+
+		for (unsigned int i = 0; i < a_scene->GetEntityCount(); ++i) {
+			Mesh* mesh = a_scene->GetMesh(i);
+
+			AddOccluder(mesh, a_scene->GetWorldMatrix(i), a_scene->GetWorldBox(i), mesh->GetTriangleCount());
+		}
+	}
+
+	/**
+	*	@brief Offer every instance of an instanced mesh as an occluder, if the mesh has few enough triangles.
+	*	@param a_instancedMesh is the instanced mesh to take occluders from.
+	*	@return void.
+	*/
+	void RenderQueue::AddOccluders(InstancedMesh * a_instancedMesh)
+	{
+		Mesh* mesh = a_instancedMesh->GetMesh();
+		unsigned int triangleCount = mesh->GetTriangleCount();
+
+		if (!m_isOcclusionCulling || triangleCount > OCCLUSION_MAX_OCCLUDER_TRIANGLES) { return; }
+
+		for (unsigned int i = 0; i < a_instancedMesh->GetInstanceCount(); ++i) {
+			const glm::mat4& world = a_instancedMesh->GetInstanceTransform(i);
+
+			AddOccluder(mesh, world, mesh->GetLocalBounds().Transform(world), triangleCount);
+		}
+	}
+
+	/**
+	*	@brief Offer every sub-range of a static batch with few enough triangles as an occluder.
+	*	NOTE: Sub-ranges outside the viewer cell's potentially visible set can't hide anything visible, so they are not offered.
+	*	@param a_staticBatch is the static batch to take occluders from.
+	*	@return void.
+	*/
+	void RenderQueue::AddOccluders(StaticBatch * a_staticBatch)
+	{
+		if (!m_isOcclusionCulling) { return; }
+
+		const std::vector<StaticBatch::SubRange>& subRanges = a_staticBatch->GetSubRanges();
+		int pvsBatch = (m_isPVSSelected ? m_visibleSet->FindBatch(a_staticBatch) : -1);
+
+		for (unsigned int i = 0; i < subRanges.size(); ++i) {
+			if (pvsBatch >= 0 && !m_visibleSet->IsVisible(m_visibleSet->GetFirstObject(pvsBatch) + i)) { continue; }
+
+			glm::vec3 radius = glm::vec3(subRanges[i].boundsRadius);
+			AABB bounds = AABB(subRanges[i].boundsCenter - radius, subRanges[i].boundsCenter + radius);
+
+			// Vertices are already in world space
+			AddOccluder(a_staticBatch->GetMesh(), glm::mat4(1), bounds, subRanges[i].indexCount / 3, subRanges[i].firstIndex, subRanges[i].indexCount);
+		}
+	}
+
+	/**
+	*	@brief Rasterize the occluders closest to the viewer relative to their size into the occlusion buffer.
+	*	NOTE: Submits made after this are tested against the occluders, call it after every occluder was added and before submitting.
+	*	@return void.
+	*/
+	void RenderQueue::RenderOccluders()
+	{
+		if (!m_isOcclusionCulling) { return; }
+
+		auto occlusionStart = std::chrono::high_resolution_clock::now();
+
+		unsigned int occluderCount = std::min((unsigned int)m_occluders.size(), (unsigned int)OCCLUSION_MAX_OCCLUDERS);
+
+		std::partial_sort(m_occluders.begin(), m_occluders.begin() + occluderCount, m_occluders.end(), [](const OccluderCandidate& a_lhs, const OccluderCandidate& a_rhs) {
+			return a_lhs.priority < a_rhs.priority;
+		});
+
+		m_occlusion->Begin(UniformBlocks::GetFrameData().projectionTransform * m_viewTransform);
+
+		for (unsigned int i = 0; i < occluderCount; ++i) {
+			const OccluderCandidate& occluder = m_occluders[i];
+			m_stats.occluderCount++;
+
+			if (!m_occlusion->AddOccluder(occluder.mesh->GetVerticeData(), occluder.mesh->GetVertexFormat()->GetIndices(), occluder.world,
+				occluder.firstIndex, occluder.indexCount)) { break; }		// Triangle budget is spent
+		}
+
+		m_occlusion->Rasterize();
+
+		m_stats.occluderTriangles = m_occlusion->GetTriangleCount();
+		m_isOcclusionReady = true;
+
+		m_occlusionTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - occlusionStart).count();
+	}
+
+	/**
+	*	@brief Add the draws needed to forward render a mesh with the given lights.
+	*	NOTE: If a pass program is set to nullptr then that pass will not be performed.
+	*	@param a_mesh is the mesh to draw.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void RenderQueue::Submit(Mesh * a_mesh, const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes)
+	{
+		// Calculate global matrix once and share it between all of the mesh's passes
+		ObjectUniformBlock object;
+		object.modelTransform = a_mesh->GetTransform()->GetPublishedMatrix();
+		object.materialIndex = a_mesh->GetMaterialIndex();
+
+		unsigned int objectIndex = (unsigned int)m_objects.size();
+		m_objects.push_back(object);
+
+		AddPassItems(a_mesh, objectIndex, 1, a_mesh->GetLocalBounds().Transform(object.modelTransform), CalculateDepthKey(object.modelTransform[3]),
+			a_lights, a_passes);
+	}
+
+	/**
+	*	@brief Cull the entities of a scene store and add the draws needed to forward render the visible ones with the store's published lights.
+	*	NOTE: World matrices come from the store's last UpdateBounds, only the visible entities' meshes are read.
+	*	@param a_scene is the scene store to draw.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void RenderQueue::Submit(SceneStore * a_scene, const ForwardPassSet & a_passes)
+	{
+		unsigned int visibleCount = a_scene->Cull(m_frustum);
+		m_stats.culledEntities += a_scene->GetEntityCount() - visibleCount;
+
+		if (m_isOcclusionReady) {
+			unsigned int unoccludedCount = a_scene->CullOccluded(*m_occlusion);
+
+			m_stats.occludedEntities += visibleCount - unoccludedCount;
+			visibleCount = unoccludedCount;
+		}
+
+		const std::vector<unsigned int>& visible = a_scene->GetVisible();
+
+		// Every entity is drawn in the same passes, so lights are assigned once and each entity's items are written to a fixed slot in parallel
+		BuildPassList(a_scene->GetPublishedLights(), a_passes);
+
+		unsigned int passCount = (unsigned int)m_passList.size();
+		if (visibleCount == 0 || passCount == 0) { return; }
+
+		unsigned int firstObject = (unsigned int)m_objects.size();
+		unsigned int firstBounds = (unsigned int)m_bounds.size();
+		unsigned int firstItem = (unsigned int)m_items.size();
+
+		m_objects.resize(firstObject + visibleCount);
+		m_bounds.resize(firstBounds + visibleCount);
+		m_items.resize(firstItem + visibleCount * passCount);
+
+		JobSystem::ParallelFor(visibleCount, JOB_BATCH_SIZE, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				Mesh* mesh = a_scene->GetMesh(visible[i]);
+
+				ObjectUniformBlock& object = m_objects[firstObject + i];
+				object.modelTransform = a_scene->GetWorldMatrix(visible[i]);
+				object.materialIndex = mesh->GetMaterialIndex();
+
+				m_bounds[firstBounds + i] = a_scene->GetWorldBox(visible[i]);
+
+				unsigned int depth = CalculateDepthKey(glm::vec4(glm::vec3(a_scene->GetWorldBounds(visible[i])), 1.f));
+
+				WritePassItems(&m_items[firstItem + i * passCount], mesh, firstObject + i, 1, firstBounds + i, depth, 0, 0);
+			}
+		});
+	}
+
+	/**
+	*	@brief Cull the instances of an instanced mesh and add the draws needed to forward render the visible ones, one draw per pass for all of them.
+	*	NOTE: Visible instances are written to consecutive object blocks, so the draw's instances step through them.
+	*	@param a_instancedMesh is the instanced mesh to draw.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void RenderQueue::Submit(InstancedMesh * a_instancedMesh, const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes)
+	{
+		unsigned int firstObject = (unsigned int)m_objects.size();
+		unsigned int visibleCount = a_instancedMesh->Cull(m_frustum, m_objects, m_isOcclusionReady ? m_occlusion : nullptr);
+
+		m_stats.occludedInstances += a_instancedMesh->GetOccludedCount();
+		m_stats.culledInstances += a_instancedMesh->GetInstanceCount() - visibleCount - a_instancedMesh->GetOccludedCount();
+		if (visibleCount == 0) { return; }
+
+		// Sort the whole group by its closest instance, and cull it on the GPU as a single box around every visible instance
+		const AABB& localBounds = a_instancedMesh->GetMesh()->GetLocalBounds();
+
+		unsigned int depth = KEY_DEPTH_MASK;
+		AABB bounds = localBounds.Transform(m_objects[firstObject].modelTransform);
+
+		for (unsigned int i = firstObject; i < firstObject + visibleCount; ++i) {
+			depth = std::min(depth, CalculateDepthKey(m_objects[i].modelTransform[3]));
+			bounds = AABB::Merge(bounds, localBounds.Transform(m_objects[i].modelTransform));
+		}
+
+		AddPassItems(a_instancedMesh->GetMesh(), firstObject, visibleCount, bounds, depth, a_lights, a_passes);
+	}
+
+	/**
+	*	@brief Cull the sub-ranges of a static batch and add the draws needed to forward render the visible ones.
+	*	NOTE: Consecutive visible sub-ranges are merged into a single draw, so a fully visible batch is one draw per pass.
+	*	Batches covered by the viewer cell's potentially visible set are culled by the set instead of the CPU occluders.
+	*	@param a_staticBatch is the static batch to draw.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void RenderQueue::Submit(StaticBatch * a_staticBatch, const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes)
+	{
+		Mesh* mesh = a_staticBatch->GetMesh();
+		const std::vector<StaticBatch::SubRange>& subRanges = a_staticBatch->GetSubRanges();
+
+		// Vertices are already in world space
+		ObjectUniformBlock object;
+		object.modelTransform = glm::mat4(1);
+		object.materialIndex = mesh->GetMaterialIndex();
+
+		unsigned int objectIndex = (unsigned int)m_objects.size();
+		m_objects.push_back(object);
+
+		// Run of visible sub-ranges
+		unsigned int runFirstIndex = 0;
+		unsigned int runIndexCount = 0;
+		unsigned int runDepth = KEY_DEPTH_MASK;		// Sorted by the run's closest sub-range
+		AABB runBounds;
+
+		int pvsBatch = (m_isPVSSelected ? m_visibleSet->FindBatch(a_staticBatch) : -1);
+
+		for (unsigned int i = 0; i <= subRanges.size(); ++i) {
+			bool isPotentiallyVisible = (i < subRanges.size()) &&
+				(pvsBatch < 0 || m_visibleSet->IsVisible(m_visibleSet->GetFirstObject(pvsBatch) + i));
+			bool isInFrustum = isPotentiallyVisible &&
+				m_frustum.IsSphereVisible(subRanges[i].boundsCenter, subRanges[i].boundsRadius);
+			bool isOccluded = false;
+
+			if (isInFrustum && m_isOcclusionReady && pvsBatch < 0) {
+				glm::vec3 radius = glm::vec3(subRanges[i].boundsRadius);
+				isOccluded = !m_occlusion->IsVisible(AABB(subRanges[i].boundsCenter - radius, subRanges[i].boundsCenter + radius));
+			}
+
+			bool isVisible = isInFrustum && !isOccluded;
+
+			if (isVisible) {
+				glm::vec3 radius = glm::vec3(subRanges[i].boundsRadius);
+				AABB subRangeBounds = AABB(subRanges[i].boundsCenter - radius, subRanges[i].boundsCenter + radius);
+
+				if (runIndexCount == 0) { runFirstIndex = subRanges[i].firstIndex; }
+
+				runBounds = (runIndexCount == 0 ? subRangeBounds : AABB::Merge(runBounds, subRangeBounds));
+
+				runIndexCount += subRanges[i].indexCount;		// NOTE: Sub-ranges are stored back to back, so a run is always contiguous
+				runDepth = std::min(runDepth, CalculateDepthKey(glm::vec4(subRanges[i].boundsCenter, 1.f)));
+
+				continue;
+			}
+
+			if (isOccluded) { m_stats.occludedSubRanges++; }
+			else if (i < subRanges.size() && !isPotentiallyVisible) { m_stats.pvsCulledSubRanges++; }
+			else if (i < subRanges.size()) { m_stats.culledSubRanges++; }
+
+			// Run ended, draw it
+			if (runIndexCount > 0) {
+				AddPassItems(mesh, objectIndex, 1, runBounds, runDepth, a_lights, a_passes, runFirstIndex, runIndexCount);
+
+				runIndexCount = 0;
+				runDepth = KEY_DEPTH_MASK;
+			}
+		}
+	}
+
+	/**
+	*	@brief Keep a mesh as an occluder candidate if it is in the frustum and simple enough to rasterize on the CPU.
+	*	@param a_mesh is the mesh whose triangles are rasterized.
+	*	@param a_world is the world matrix of the mesh.
+	*	@param a_worldBounds is the world space box of the triangles.
+	*	@param a_triangleCount is the number of triangles that would be rasterized.
+	*	@param a_firstIndex is the first index of the sub-range to rasterize, relative to the mesh's first index.
+	*	@param a_indexCount is the number of indices in the sub-range, 0 rasterizes the whole mesh.
+	*	@return void.
+	*/
+	void RenderQueue::AddOccluder(Mesh * a_mesh, const glm::mat4 & a_world, const AABB & a_worldBounds, unsigned int a_triangleCount,
+		unsigned int a_firstIndex, unsigned int a_indexCount)
+	{
+		if (a_triangleCount == 0 || a_triangleCount > OCCLUSION_MAX_OCCLUDER_TRIANGLES) { return; }
+		if (m_frustum.TestAABB(a_worldBounds) == FRUSTUM_OUTSIDE) { return; }
+
+		// Close and large meshes hide the most, distance is 0 when the viewer is inside the box
+		glm::vec3 offset = glm::max(glm::max(a_worldBounds.min - m_viewerPos, m_viewerPos - a_worldBounds.max), glm::vec3(0.f));
+		float size = glm::length(a_worldBounds.GetExtents());
+
+		OccluderCandidate candidate;
+		candidate.mesh = a_mesh;
+		candidate.world = a_world;
+		candidate.firstIndex = a_firstIndex;
+		candidate.indexCount = a_indexCount;
+		candidate.priority = glm::length(offset) / std::max(size, 0.001f);
+
+		m_occluders.push_back(candidate);
+	}
+
+	/**
+	*	@brief Add a draw item for each pass a mesh is rendered in.
+	*	@param a_mesh is the mesh to draw.
+	*	@param a_objectIndex is the index of the mesh's first object block in the queue.
+	*	@param a_instanceCount is the number of consecutive object blocks to draw as instances.
+	*	@param a_bounds is the world space box of everything the draws cover.
+	*	@param a_depth is the depth field of the sort key.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@param a_firstIndex is the first index of the sub-range to draw, relative to the mesh's first index.
+	*	@param a_indexCount is the number of indices in the sub-range, 0 draws the whole mesh.
+	*	@return void.
+	*/
+	void RenderQueue::AddPassItems(Mesh * a_mesh, unsigned int a_objectIndex, unsigned int a_instanceCount, const AABB & a_bounds, unsigned int a_depth,
+		const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes, unsigned int a_firstIndex, unsigned int a_indexCount)
+	{
+		BuildPassList(a_lights, a_passes);
+		if (m_passList.empty()) { return; }
+
+		unsigned int boundsIndex = (unsigned int)m_bounds.size();
+		m_bounds.push_back(a_bounds);
+
+		unsigned int firstItem = (unsigned int)m_items.size();
+		m_items.resize(firstItem + m_passList.size());
+
+		WritePassItems(&m_items[firstItem], a_mesh, a_objectIndex, a_instanceCount, boundsIndex, a_depth, a_firstIndex, a_indexCount);
+	}
+
+	/**
+	*	@brief Assign each light to the program of its pass, listing every pass a mesh is rendered in.
+	*	NOTE: If a pass program is set to nullptr then that pass will not be performed.
+	*	@param a_lights is the vector of lights to take lighting information from.
+	*	@param a_passes is the shader programs to use for each pass.
+	*	@return void.
+	*/
+	void RenderQueue::BuildPassList(const std::vector<PhongLight*>& a_lights, const ForwardPassSet & a_passes)
+	{
+		m_passList.clear();
+
+		//// Depth prepass, everything the ambient pass draws is drawn depth only first
+		if (a_passes.ambientPass && m_isDepthPrepass) { m_passList.push_back({ RENDER_PASS_DEPTH, 0, m_depthProgram, nullptr }); }
+
+		//// Ambient pass
+		if (a_passes.ambientPass) { m_passList.push_back({ RENDER_PASS_AMBIENT, 0, a_passes.ambientPass, nullptr }); }
+
+		//// Light passes
+		for (unsigned int i = 0; i < a_lights.size(); ++i) {
+			ShaderWrapper* lightPass = nullptr;
+
+			switch (a_lights[i]->GetType()) {
+				case DIRECTIONAL_LIGHT:	lightPass = a_passes.directionalPass; break;
+				case POINT_LIGHT:		lightPass = a_passes.pointPass; break;
+				case SPOT_LIGHT:		lightPass = a_passes.spotPass; break;
+			}
+
+			if (!lightPass) { continue; }	// No program provided for this light type, skip pass
+
+			m_passList.push_back({ RENDER_PASS_LIGHT, i, lightPass, a_lights[i] });
+		}
+
+		//// Debug pass
+		if (a_passes.debugPass) { m_passList.push_back({ RENDER_PASS_DEBUG, 0, a_passes.debugPass, nullptr }); }
+	}
+
+	/**
+	*	@brief Write a draw item for each pass in the pass list.
+	*	NOTE: Only reads shared state, so it is safe to call from jobs writing to separate items.
+	*	@param a_items is the first of the pass list's size of items to write to.
+	*	@param a_mesh is the mesh to draw.
+	*	@param a_objectIndex is the index of the mesh's first object block in the queue.
+	*	@param a_instanceCount is the number of consecutive object blocks to draw as instances.
+	*	@param a_boundsIndex is the index of the draws' world box in the queue.
+	*	@param a_depth is the depth field of the sort key.
+	*	@param a_firstIndex is the first index of the sub-range to draw, relative to the mesh's first index.
+	*	@param a_indexCount is the number of indices in the sub-range, 0 draws the whole mesh.
+	*	@return void.
+	*/
+	void RenderQueue::WritePassItems(DrawItem * a_items, Mesh * a_mesh, unsigned int a_objectIndex, unsigned int a_instanceCount, unsigned int a_boundsIndex,
+		unsigned int a_depth, unsigned int a_firstIndex, unsigned int a_indexCount) const
+	{
+		unsigned int material = a_mesh->GetMaterialIndex();		// Identical materials share an index, so meshes using them are grouped
+
+		for (unsigned int i = 0; i < m_passList.size(); ++i) {
+			const PassEntry& pass = m_passList[i];
+
+			DrawItem& item = a_items[i];
+			item.mesh = a_mesh;
+			item.program = pass.program;
+			item.light = pass.light;
+			item.objectIndex = a_objectIndex;
+			item.instanceCount = a_instanceCount;
+			item.firstIndex = a_firstIndex;
+			item.indexCount = a_indexCount;
+			item.boundsIndex = a_boundsIndex;
+
+			// Depth draws ignore the material, so they are sorted only front to back
+			item.key = MakeKey(pass.pass, pass.lightIndex, *item.program, (pass.pass == RENDER_PASS_DEPTH ? 0 : material), a_depth);
+		}
+	}
+
+	/**
+	*	@brief Sort all submitted draws by their keys.
+	*	@return void.
+	*/
+	void RenderQueue::Sort()
+	{
+		RadixSort();
+	}
+
+	/**
+	*	@brief Least significant digit radix sort on the draw keys, 8 bits per pass.
+	*	NOTE: Digits that are the same for every key are skipped, so the cost scales with how much of the key actually varies.
+	*	O(N) complexity where N = number of draws
+	*	@return void.
+	*/
+	void RenderQueue::RadixSort()
+	{
+		const unsigned int itemNum = (unsigned int)m_items.size();
+		if (itemNum < 2) { return; }
+
+		m_sortBuffer.resize(itemNum);
+
+		// Build histograms for all 8 digits in a single read of the keys
+		unsigned int histograms[8][256] = {};
+
+		for (unsigned int i = 0; i < itemNum; ++i) {
+			uint64_t key = m_items[i].key;
+
+			for (unsigned int digit = 0; digit < 8; ++digit) {
+				histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+			}
+		}
+
+		DrawItem* src = &m_items[0];
+		DrawItem* dst = &m_sortBuffer[0];
+
+		for (unsigned int digit = 0; digit < 8; ++digit) {
+			unsigned int* histogram = histograms[digit];
+
+			// Skip digit if all keys fall into the same bucket
+			if (histogram[(src[0].key >> (digit * 8)) & 0xFF] == itemNum) { continue; }
+
+			// Convert counts to starting offsets
+			unsigned int offset = 0;
+			for (unsigned int bucket = 0; bucket < 256; ++bucket) {
+				unsigned int count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += count;
+			}
+
+			// Scatter (stable, preserves the order of the previous digits)
+			for (unsigned int i = 0; i < itemNum; ++i) {
+				dst[histogram[(src[i].key >> (digit * 8)) & 0xFF]++] = src[i];
+			}
+
+			std::swap(src, dst);
+		}
+
+		// Ensure the sorted result ends up in the item vector
+		if (src != &m_items[0]) {
+			std::copy(src, src + itemNum, m_items.begin());
+		}
+	}
+
+	/**
+	*	@brief Record the sorted items into command lists on the job system, then replay the lists in order.
+	*	With GPU culling the recorded commands are culled and compacted on the GPU between recording and replaying.
+	*	With the visibility buffer the ambient items are drawn into it and resolved instead, nothing is recorded.
+	*	NOTE: Only the upload and the replay make openGL calls, everything between them runs in jobs when parallel recording is enabled.
+	*	@return void.
+	*/
+	void RenderQueue::Execute()
+	{
+		// Upload every object block for the frame with a single call
+		UniformBlocks::Reserve((unsigned int)m_objects.size());
+
+		m_objectIndices.resize(m_objects.size());
+		for (unsigned int i = 0; i < m_objects.size(); ++i) {
+			m_objectIndices[i] = UniformBlocks::PushObject(m_objects[i]);
+		}
+
+		UniformBlocks::Flush();
+
+		if (m_isVisibilityBuffer) {
+			auto visibilityStart = std::chrono::high_resolution_clock::now();
+
+			ExecuteVisibility();
+
+			// Restore default state for anything rendered after the queue
+			CommandList::ApplyPassState(RENDER_PASS_AMBIENT);
+
+			m_rangeCount = 0;
+			m_recordTime = 0.f;
+			m_replayTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - visibilityStart).count();
+			return;
+		}
+
+		//// Record
+		auto recordStart = std::chrono::high_resolution_clock::now();
+
+		// Split the sorted items into one range per thread, each large enough to be worth a job
+		unsigned int itemCount = (unsigned int)m_items.size();
+		unsigned int rangeCount = (m_isParallelRecording ? JobSystem::GetWorkerCount() + 1 : 1);
+		rangeCount = std::max(1u, std::min(rangeCount, (itemCount + JOB_BATCH_SIZE - 1) / JOB_BATCH_SIZE));
+
+		unsigned int rangeSize = (itemCount + rangeCount - 1) / rangeCount;
+
+		if (m_ranges.size() < rangeCount) { m_ranges.resize(rangeCount); }
+		m_rangeCount = rangeCount;
+
+		m_commands.resize(itemCount);		// One draw command per item, so each range writes its commands in place
+		if (m_isGPUCulling) { m_cullDraws.resize(itemCount); }
+
+		JobSystem::ParallelFor(rangeCount, 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				RecordRange(m_ranges[i], std::min(itemCount, i * rangeSize), std::min(itemCount, (i + 1) * rangeSize));
+			}
+		});
+
+		// Gather each range's statistics
+		for (unsigned int i = 0; i < rangeCount; ++i) {
+			const Stats& rangeStats = m_ranges[i].stats;
+
+			m_stats.drawCount += rangeStats.drawCount;
+			m_stats.batchCount += rangeStats.batchCount;
+			m_stats.programBinds += rangeStats.programBinds;
+			m_stats.materialBinds += rangeStats.materialBinds;
+			m_stats.textureBinds += rangeStats.textureBinds;
+			m_stats.naiveProgramBinds += rangeStats.naiveProgramBinds;
+			m_stats.naiveTextureBinds += rangeStats.naiveTextureBinds;
+			m_stats.depthInversions += rangeStats.depthInversions;
+			m_stats.instanceCount += rangeStats.instanceCount;
+			m_stats.commandCount += m_ranges[i].commands.GetCommandCount();
+		}
+
+		m_recordTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
+
+		//// Replay
+		auto replayStart = std::chrono::high_resolution_clock::now();
+
+		bool isDrawCounted = false;		// Batches draw only the visible commands counted by the GPU cull
+
+#if USE_MULTI_DRAW_INDIRECT
+		if (m_isGPUCulling) {
+			// Upload every draw command and its bounds, the compute shader's compacted commands are left bound as the indirect buffer
+			m_gpuCuller->Cull(m_commands, m_cullDraws, m_frustum);
+			isDrawCounted = m_gpuCuller->IsDrawCountSupported();
+
+			if (m_isCullValidationRequested) {
+				m_cullValidation.mismatchedBatches = m_gpuCuller->Validate(m_commands, m_cullDraws, m_frustum);
+				m_cullValidation.visibleCommands = m_gpuCuller->GetValidatedVisible();
+				m_cullValidation.commandCount = (unsigned int)m_commands.size();
+				m_cullValidation.isValid = true;
+
+				m_isCullValidationRequested = false;
+			}
+		}
+		else if (!m_commands.empty()) {		// Upload every draw command for the frame with a single call
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBufferID);
+
+			if (m_commands.size() > m_indirectCapacity) {		// Out of storage, grow
+				m_indirectCapacity = std::max((unsigned int)m_commands.size(), m_indirectCapacity * 2);
+			}
+
+			// NOTE: Orphan the storage so the upload does not wait on last frame's draws still reading it
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(IndirectDrawCommand) * m_indirectCapacity, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(IndirectDrawCommand) * m_commands.size(), &m_commands[0]);
+		}
+#endif
+
+		// Every mesh is stored in the geometry pool, so its vertex arrays are the only ones the queue binds
+		GeometryPool::Bind();
+
+		// Samples passed are compared against the pixels they cover to give each pass's overdraw
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		m_viewportPixels = (unsigned int)(viewport[2] * viewport[3]);
+
+		m_passQueries->Begin();
+
+		for (unsigned int i = 0; i < rangeCount; ++i) {
+			m_stats.submitCount += m_ranges[i].commands.Replay(m_commands, isDrawCounted, m_passQueries);
+		}
+
+		m_passQueries->End();
+
+#if USE_MULTI_DRAW_INDIRECT
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+
+		// Restore default state for anything rendered after the queue
+		CommandList::ApplyPassState(RENDER_PASS_AMBIENT);
+
+		m_replayTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - replayStart).count();
+	}
+
+	/**
+	*	@brief Build the depth pyramid next frame's GPU cull tests against, from the depth this frame's draws were rendered to.
+	*	NOTE: Must be called after Execute, before anything else is drawn to the depth texture.
+	*	@param a_depthTexture is the depth texture the queue's draws were rendered to.
+	*	@return void.
+	*/
+	void RenderQueue::BuildDepthPyramid(unsigned int a_depthTexture)
+	{
+		if (!m_isGPUCulling) {		// Pyramid would be stale by the time culling is enabled again
+			m_gpuCuller->InvalidateDepthPyramid();
+			return;
+		}
+
+		m_gpuCuller->BuildDepthPyramid(a_depthTexture, UniformBlocks::GetFrameData().projectionTransform * m_viewTransform);
+	}
+
+	/**
+	*	@brief Display the statistics of the last executed frame.
+	*	@return void.
+	*/
+	void RenderQueue::ListenIMGUI()
+	{
+		ImGui::Begin("Render Queue");
+
+		ImGui::Text("Draws: %u (%u draw calls)", m_stats.drawCount, m_stats.submitCount);
+		ImGui::Text("Batches: %u (%u commands in %u lists)", m_stats.batchCount, m_stats.commandCount, m_rangeCount);
+		ImGui::Text("Program binds: %u (unsorted: %u)", m_stats.programBinds, m_stats.naiveProgramBinds);
+		ImGui::Text("Material changes: %u", m_stats.materialBinds);
+		ImGui::Text("Texture binds (estimated): %u (unsorted: %u)", m_stats.textureBinds, m_stats.naiveTextureBinds);
+		ImGui::Text("Ambient depth inversions: %u", m_stats.depthInversions);
+		ImGui::Text("Instances: %u drawn (%u culled)", m_stats.instanceCount, m_stats.culledInstances);
+		ImGui::Text("Static sub-ranges culled: %u", m_stats.culledSubRanges);
+		ImGui::Text("Scene entities culled: %u", m_stats.culledEntities);
+
+		ImGui::Separator();
+		ImGui::Checkbox("Occlusion culling", &m_isOcclusionCulling);
+		ImGui::Text("Occluders: %u (%u triangles)", m_stats.occluderCount, m_stats.occluderTriangles);
+		ImGui::Text("Occluded: %u instances, %u sub-ranges, %u entities", m_stats.occludedInstances, m_stats.occludedSubRanges, m_stats.occludedEntities);
+		ImGui::Text("Rasterize: %.3f ms", m_occlusionTime);
+
+		ImGui::Separator();
+		ImGui::Checkbox("PVS culling", &m_isPVSCulling);
+
+		if (m_visibleSet && m_visibleSet->IsBaked()) {
+			ImGui::Text("Cells: %u (%u distinct sets, %u bytes)", m_visibleSet->GetCellCount(), m_visibleSet->GetSetCount(), m_visibleSet->GetCompressedSize());
+
+			if (m_isPVSSelected) {
+				ImGui::Text("Potentially visible: %u of %u objects", m_visibleSet->GetSelectedCount(), m_visibleSet->GetObjectCount());
+			}
+			else {
+				ImGui::Text("Potentially visible: viewer outside the grid");
+			}
+
+			ImGui::Text("PVS culled: %u sub-ranges", m_stats.pvsCulledSubRanges);
+			if (m_visibleSet->GetBakeTime() > 0.f) { ImGui::Text("Baked in %.2f s", m_visibleSet->GetBakeTime()); }
+		}
+		else {
+			ImGui::Text("No potentially visible sets");
+		}
+
+#if USE_MULTI_DRAW_INDIRECT
+		ImGui::Separator();
+		ImGui::Checkbox("GPU culling", &m_isGPUCulling);
+
+		if (m_gpuCuller->HasDepthPyramid()) {
+			ImGui::Text("Depth pyramid: %ux%u (%u levels)", m_gpuCuller->GetPyramidWidth(), m_gpuCuller->GetPyramidHeight(), m_gpuCuller->GetPyramidLevels());
+		}
+		else {
+			ImGui::Text("Depth pyramid: none, frustum only");
+		}
+
+		ImGui::Text("Draw counts: %s", m_gpuCuller->IsDrawCountSupported() ? "read by the GPU" : "unsupported, culled commands draw 0 instances");
+
+		if (ImGui::Button("Validate against CPU")) { m_isCullValidationRequested = true; }
+
+		if (m_cullValidation.isValid) {
+			ImGui::Text("Visible: %u of %u commands, %u batches differ", m_cullValidation.visibleCommands, m_cullValidation.commandCount, m_cullValidation.mismatchedBatches);
+		}
+#endif
+
+		ImGui::Separator();
+		ImGui::Checkbox("Depth prepass", &m_isDepthPrepass);
+		ImGui::Checkbox("Visibility buffer", &m_isVisibilityBuffer);
+
+		// Samples that passed the depth test are the fragments each pass shaded
+		float pixels = (float)std::max(m_viewportPixels, 1u);
+
+		if (m_isVisibilityBuffer) {
+			ImGui::Text("Visibility: %.3f ms GPU, %.2f fragments per pixel", m_visibilityBuffer->GetTime(VIS_PASS_VISIBILITY),
+				m_visibilityBuffer->GetSamples(VIS_PASS_VISIBILITY) / pixels);
+			ImGui::Text("Resolve: %.3f ms GPU, %.2f shaded per pixel", m_visibilityBuffer->GetTime(VIS_PASS_RESOLVE),
+				m_visibilityBuffer->GetSamples(VIS_PASS_RESOLVE) / pixels);
+			ImGui::Text("Map sets: %u, lights: %u (%u dropped)", (unsigned int)m_visMapSets.size(), (unsigned int)m_visLights.size(),
+				m_visibilityBuffer->GetDroppedLights());
+		}
+		else {
+			static const char* passNames[RENDER_PASS_COUNT] = { "Depth", "Ambient", "Light", "Debug" };
+
+			for (unsigned int i = 0; i < RENDER_PASS_COUNT; ++i) {
+				ImGui::Text("%s: %.3f ms GPU, %.2f fragments per pixel", passNames[i], m_passQueries->GetTime(i), m_passQueries->GetSamples(i) / pixels);
+			}
+		}
+
+		ImGui::Separator();
+		ImGui::Checkbox("Parallel recording", &m_isParallelRecording);
+		ImGui::Text("Record: %.3f ms", m_recordTime);
+		ImGui::Text("Replay: %.3f ms", m_replayTime);
+
+		ImGui::End();
+	}
+
+	/**
+	*	@brief Quantize the view space depth of a point, usually a mesh's origin, to the 24 bit depth field of the sort key.
+	*	@param a_worldPos is the world space position of the point (w = 1).
+	*	@return depth key, 0 at the near plane and 0xFFFFFF at the far plane.
+	*/
+	unsigned int RenderQueue::CalculateDepthKey(const glm::vec4 & a_worldPos) const
+	{
+		glm::vec4 viewPos = m_viewTransform * a_worldPos;
+
+		float nearPlane = m_camera->GetNearPlane();
+		float farPlane = m_camera->GetFarPlane();
+
+		float depth = (-viewPos.z - nearPlane) / (farPlane - nearPlane);	// View space looks down -z
+		depth = glm::clamp(depth, 0.f, 1.f);
+
+		return (unsigned int)(depth * KEY_DEPTH_MASK);
+	}
+
+	/**
+	*	@brief Write the draw commands of a range of sorted items and group consecutive items that need no state change between them into batches.
+	*	NOTE: Materials are read from the material table per draw, so draws only need splitting when the sampled texture objects change.
+	*	O(N) complexity where N = number of draws in the range
+	*	@param a_begin is the index of the first item in the range.
+	*	@param a_end is one past the index of the last item in the range.
+	*	@param a_batches is the list to append the range's batches to.
+	*	@param a_stats is the statistics to add the range's draws to.
+	*	@return void.
+	*/
+	void RenderQueue::BuildBatches(unsigned int a_begin, unsigned int a_end, std::vector<DrawBatch>& a_batches, Stats& a_stats)
+	{
+		unsigned int prevPass = ~0u;
+		unsigned int prevDepth = 0;
+
+		for (unsigned int i = a_begin; i < a_end; ++i) {
+			DrawItem& item = m_items[i];
+			unsigned int pass = (unsigned int)(item.key >> KEY_PASS_SHIFT);
+
+			// Continue the current batch if nothing that is set between draws differs
+			DrawBatch* batch = (a_batches.empty() ? nullptr : &a_batches.back());
+
+			if (!batch || batch->pass != pass || batch->program != item.program || batch->light != item.light ||
+				!HasSameMaps(batch->materialMesh->GetMaterial(), item.mesh->GetMaterial(), pass)) {
+
+				DrawBatch newBatch;
+				newBatch.pass = pass;
+				newBatch.program = item.program;
+				newBatch.light = item.light;
+				newBatch.materialMesh = item.mesh;
+				newBatch.firstCommand = i;
+				newBatch.commandCount = 0;
+
+				a_batches.push_back(newBatch);
+				batch = &a_batches.back();
+			}
+
+			// NOTE: Object blocks were pushed in order after a single reserve, so an instanced item's blocks are still consecutive in the ring
+			IndirectDrawCommand& command = m_commands[i];
+			command = GeometryPool::MakeCommand(item.mesh->GetGeometry(), m_objectIndices[item.objectIndex], item.instanceCount);
+
+			if (item.indexCount > 0) {		// Only part of the mesh is drawn
+				command.firstIndex += item.firstIndex;
+				command.count = item.indexCount;
+			}
+
+			batch->commandCount++;
+
+			// Bounds the GPU cull tests the command with, compacted into the front of its batch's commands
+			if (m_isGPUCulling) {
+				const AABB& bounds = m_bounds[item.boundsIndex];
+
+				CullDrawData& draw = m_cullDraws[i];
+				draw.boundsMin = bounds.min;
+				draw.firstCommand = batch->firstCommand;
+				draw.boundsMax = bounds.max;
+				draw.padding = 0;
+			}
+
+			// Track how well ambient draws are ordered front to back
+			unsigned int depth = (unsigned int)(item.key & KEY_DEPTH_MASK);
+			if ((pass == RENDER_PASS_AMBIENT || pass == RENDER_PASS_DEPTH) && pass == prevPass && depth < prevDepth) { a_stats.depthInversions++; }
+			prevPass = pass;
+			prevDepth = depth;
+
+			// What the per-mesh draw path would have issued for this draw
+			a_stats.drawCount++;
+			if (item.instanceCount > 1) { a_stats.instanceCount += item.instanceCount; }
+			a_stats.naiveProgramBinds++;
+			a_stats.naiveTextureBinds += CountMaterialTextures(item.mesh->GetMaterial(), pass);
+		}
+
+		a_stats.batchCount += (unsigned int)a_batches.size();
+	}
+
+	/**
+	*	@brief Batch a range of sorted items and record the state changes and draws of the batches into the range's command list.
+	*	NOTE: Makes no openGL calls so ranges can be recorded in parallel, state is tracked from scratch as the range does not know what the previous range left bound.
+	*	@param a_range is the range to record into.
+	*	@param a_begin is the index of the first item in the range.
+	*	@param a_end is one past the index of the last item in the range.
+	*	@return void.
+	*/
+	void RenderQueue::RecordRange(RecordedRange & a_range, unsigned int a_begin, unsigned int a_end)
+	{
+		a_range.batches.clear();
+		a_range.commands.Clear();
+		a_range.stats = Stats();
+
+		BuildBatches(a_begin, a_end, a_range.batches, a_range.stats);
+
+		unsigned int	currPass = ~0u;
+		ShaderWrapper*	currProgram = nullptr;
+		PhongLight*		currLight = nullptr;
+		Mesh*			currMaterialMesh = nullptr;
+
+		for (unsigned int i = 0; i < a_range.batches.size(); ++i) {
+			DrawBatch& batch = a_range.batches[i];
+			Material& material = batch.materialMesh->GetMaterial();
+
+			// Pass changed, set blending and depth state
+			if (batch.pass != currPass) {
+				a_range.commands.SetPassState(batch.pass, m_isDepthPrepass);
+
+				currPass = batch.pass;
+				currProgram = nullptr;
+			}
+
+			// Program changed
+			if (batch.program != currProgram) {
+				a_range.commands.BindProgram(batch.program);
+
+				currProgram = batch.program;
+				currLight = nullptr;		// Light and material uniforms are per program, force them to be re-sent
+				currMaterialMesh = nullptr;
+
+				a_range.stats.programBinds++;
+			}
+
+			// Light changed
+			if (batch.light && batch.light != currLight) {
+				a_range.commands.SetLight(batch.program, batch.light);
+
+				currLight = batch.light;
+			}
+
+			// Material maps changed, the depth prepass has none
+			if (batch.pass != RENDER_PASS_DEPTH && (!currMaterialMesh || !HasSameMaps(currMaterialMesh->GetMaterial(), material, batch.pass))) {
+				a_range.commands.SetMaterial(batch.program, batch.pass, &material);
+
+				currMaterialMesh = batch.materialMesh;
+
+				a_range.stats.materialBinds++;
+				a_range.stats.textureBinds += CountMaterialTextures(material, batch.pass);
+			}
+
+			a_range.commands.Draw(batch.firstCommand, batch.commandCount);
+		}
+	}
+
+	/**
+	*	@brief Draw the sorted ambient items into the visibility buffer and resolve them with the lights of the light items.
+	*	Each instance gets a draw table entry of its own, its draw ID, with the object block and triangles the resolve reads back.
+	*	NOTE: The light items are only read for their lights and the debug pass is skipped, the commands are not GPU culled.
+	*	@return void.
+	*/
+	void RenderQueue::ExecuteVisibility()
+	{
+		m_commands.clear();
+		m_visDraws.clear();
+		m_visMapSets.clear();
+		m_visLights.clear();
+
+		unsigned int mapSet = 0;
+		PhongLight* prevLight = nullptr;
+
+		for (unsigned int i = 0; i < m_items.size(); ++i) {
+			const DrawItem& item = m_items[i];
+			unsigned int pass = (unsigned int)(item.key >> KEY_PASS_SHIFT);
+
+			// Light items are sorted by light, so each light is only searched for once
+			if (pass == RENDER_PASS_LIGHT && item.light && item.light != prevLight) {
+				if (std::find(m_visLights.begin(), m_visLights.end(), item.light) == m_visLights.end()) { m_visLights.push_back(item.light); }
+				prevLight = item.light;
+			}
+
+			if (pass != RENDER_PASS_AMBIENT) { continue; }
+
+			// Ambient items are sorted by material, so the previous item's map set usually matches
+			Material& material = item.mesh->GetMaterial();
+
+			if (m_visMapSets.empty() || !HasSameMaps(*m_visMapSets[mapSet], material, RENDER_PASS_LIGHT)) {
+				for (mapSet = 0; mapSet < m_visMapSets.size(); ++mapSet) {
+					if (HasSameMaps(*m_visMapSets[mapSet], material, RENDER_PASS_LIGHT)) { break; }
+				}
+
+				if (mapSet == m_visMapSets.size()) { m_visMapSets.push_back(&material); }
+			}
+
+			// Base instance is the first draw table entry of the item instead of its object block
+			IndirectDrawCommand command = GeometryPool::MakeCommand(item.mesh->GetGeometry(), (unsigned int)m_visDraws.size(), item.instanceCount);
+
+			if (item.indexCount > 0) {		// Only part of the mesh is drawn
+				command.firstIndex += item.firstIndex;
+				command.count = item.indexCount;
+			}
+
+			m_commands.push_back(command);
+
+			// NOTE: An instanced item's object blocks are consecutive in the ring
+			for (unsigned int j = 0; j < item.instanceCount; ++j) {
+				VisDrawData draw = { m_objectIndices[item.objectIndex] + j, command.firstIndex, command.baseVertex, mapSet };
+				m_visDraws.push_back(draw);
+			}
+
+			m_stats.drawCount++;
+			if (item.instanceCount > 1) { m_stats.instanceCount += item.instanceCount; }
+		}
+
+		m_visibilityBuffer->Render(m_commands, m_visDraws, m_visMapSets, m_visLights);
+
+		m_viewportPixels = m_visibilityBuffer->GetWidth() * m_visibilityBuffer->GetHeight();
+
+		// One call for the visibility pass and one full screen triangle per map set
+#if USE_MULTI_DRAW_INDIRECT
+		m_stats.submitCount += (m_commands.empty() ? 0 : 1) + (unsigned int)m_visMapSets.size();
+#else
+		m_stats.submitCount += (unsigned int)m_commands.size() + (unsigned int)m_visMapSets.size();
+#endif
+		m_stats.programBinds += 2;
+		m_stats.materialBinds += (unsigned int)m_visMapSets.size();
+	}
+}
\ No newline at end of file
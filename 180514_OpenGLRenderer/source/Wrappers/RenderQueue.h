@@ -0,0 +1,236 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "UniformBlocks.h"
+#include "GeometryPool.h"
+#include "CommandList.h"
+#include "Frustum.h"
+#include "AABB.h"
+#include "GPUCuller.h"
+#include "VisibilityBuffer.h"
+
+namespace SPRON {
+	class Mesh;
+	class InstancedMesh;
+	class StaticBatch;
+	class SceneStore;
+	class RenderCamera;
+	class ShaderWrapper;
+	class PhongLight;
+	struct Material;
+	class OcclusionCuller;
+	class PotentiallyVisibleSet;
+	class PassQueries;
+}
+
+namespace SPRON {
+	enum eRenderPass {
+		RENDER_PASS_DEPTH,			// Depth only prepass, from the position stream front to back
+		RENDER_PASS_AMBIENT,		// Shades and writes depth, or only tests it when the depth prepass laid it down
+		RENDER_PASS_LIGHT,			// Additive light passes tested against the ambient pass depth
+		RENDER_PASS_DEBUG,
+		RENDER_PASS_COUNT
+	};
+
+	// Shader programs for each forward rendering pass, a pass is skipped if its program is nullptr
+	struct ForwardPassSet {
+		ShaderWrapper* ambientPass = nullptr;
+		ShaderWrapper* directionalPass = nullptr;
+		ShaderWrapper* pointPass = nullptr;
+		ShaderWrapper* spotPass = nullptr;
+		ShaderWrapper* debugPass = nullptr;
+	};
+
+	// Single draw of a mesh with a shader program, ordered by its sort key
+	struct DrawItem {
+		uint64_t		key;
+		Mesh*			mesh;
+		ShaderWrapper*	program;
+		PhongLight*		light;				// Light to shade with, nullptr for the ambient and debug passes
+		unsigned int	objectIndex;		// Index into the queue's object blocks so the global matrix is only calculated once per mesh per frame
+		unsigned int	instanceCount;		// Consecutive object blocks drawn as instances, 1 for a regular mesh
+		unsigned int	firstIndex;			// Sub-range of the mesh's indices to draw, relative to the mesh's first index
+		unsigned int	indexCount;			// 0 draws every index of the mesh
+		unsigned int	boundsIndex;		// Index into the queue's world boxes, tested by the GPU cull
+	};
+
+	/**
+	*	@brief Collects the draws of a frame, sorts them by state and executes them so that programs and materials are only changed when needed.
+	*	Consecutive draws that need no state change between them are written to an indirect buffer and submitted with a single multi-draw.
+	*	The sorted draws are split into ranges recorded into command lists by jobs, only replaying the lists makes openGL calls.
+	*	With the depth prepass every ambient draw is first drawn depth only, so the shading passes only shade the closest fragment of each pixel.
+	*	Static batch sub-ranges outside the potentially visible set of the viewer's cell are skipped, and the rest are not tested against the CPU occluders.
+	*	With GPU culling the commands are culled and compacted by a compute shader before the lists are replayed, against the world box of each draw.
+	*	With the visibility buffer the ambient draws are drawn into it instead, and every light pass is folded into its resolve (see VisibilityBuffer.h).
+	*	NOTE: Camera data comes from the frame uniform block, so UniformBlocks::SetFrameData must be called before Begin.
+	*	Sort key layout (most significant first):
+	*	[63-60] pass | [59-52] light | [51-44] program | [43-24] material | [23-0] depth (front to back)
+	*	Every mesh shares the geometry pool's vertex array, so it is not part of the key.
+	*/
+	class RenderQueue {
+	public:
+		RenderQueue();
+		~RenderQueue();
+
+		void Begin(RenderCamera* a_camera);
+		void AddOccluders(SceneStore* a_scene);
+		void AddOccluders(InstancedMesh* a_instancedMesh);
+		void AddOccluders(StaticBatch* a_staticBatch);
+		void RenderOccluders();
+		void Submit(Mesh* a_mesh, const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes);
+		void Submit(InstancedMesh* a_instancedMesh, const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes);
+		void Submit(StaticBatch* a_staticBatch, const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes);
+		void Submit(SceneStore* a_scene, const ForwardPassSet& a_passes);
+		void Sort();
+		void Execute();
+		void BuildDepthPyramid(unsigned int a_depthTexture);
+		void SetVisibleSet(PotentiallyVisibleSet* a_visibleSet) { m_visibleSet = a_visibleSet; }
+
+		void ListenIMGUI();
+
+		static uint64_t MakeKey(unsigned int a_pass, unsigned int a_light, unsigned int a_program, unsigned int a_material, unsigned int a_depth);
+
+		const std::vector<DrawItem>& GetItems() const { return m_items; }
+	protected:
+	private:
+		// Run of consecutive draws with the same state, submitted together
+		struct DrawBatch {
+			unsigned int	pass;
+			ShaderWrapper*	program;
+			PhongLight*		light;
+			Mesh*			materialMesh;		// First mesh of the batch, its material's texture maps are bound for the whole batch
+			unsigned int	firstCommand;
+			unsigned int	commandCount;
+		};
+
+		// Per-frame draw statistics
+		struct Stats {
+			unsigned int drawCount = 0;
+			unsigned int batchCount = 0;
+			unsigned int commandCount = 0;		// Render commands recorded into the command lists
+			unsigned int submitCount = 0;		// Draw calls issued, one per batch when multi-draw is enabled
+			unsigned int programBinds = 0;
+			unsigned int materialBinds = 0;
+			unsigned int textureBinds = 0;		// Estimated from the maps of each material change, not counted at the bind calls
+
+			// What the unsorted per-mesh path would have issued for the same draws
+			unsigned int naiveProgramBinds = 0;
+			unsigned int naiveTextureBinds = 0;
+
+			unsigned int depthInversions = 0;	// Consecutive ambient or depth draws that go back to front, lower means better early-Z rejection
+
+			unsigned int instanceCount = 0;		// Instances drawn by instanced meshes, counted once per pass
+			unsigned int culledInstances = 0;	// Instances outside the view frustum
+			unsigned int culledSubRanges = 0;	// Static batch sub-ranges outside the view frustum
+			unsigned int culledEntities = 0;	// Scene store entities outside the view frustum
+			unsigned int pvsCulledSubRanges = 0;	// Static batch sub-ranges outside the viewer cell's potentially visible set
+
+			unsigned int occluderCount = 0;		// Occluders rasterized, nearest first
+			unsigned int occluderTriangles = 0;
+			unsigned int occludedInstances = 0;	// Instances in the view frustum but hidden behind occluders
+			unsigned int occludedSubRanges = 0;
+			unsigned int occludedEntities = 0;
+		};
+
+		// Result of the last comparison of the GPU cull against its CPU reference
+		struct CullValidation {
+			unsigned int mismatchedBatches = 0;
+			unsigned int visibleCommands = 0;
+			unsigned int commandCount = 0;
+			bool isValid = false;
+		};
+
+		// Mesh that could be rasterized as an occluder this frame
+		struct OccluderCandidate {
+			Mesh*			mesh;
+			glm::mat4		world;
+			unsigned int	firstIndex;
+			unsigned int	indexCount;		// 0 for every index of the mesh
+			float			priority;		// Distance to the viewer relative to the size of the mesh, lowest are rasterized
+		};
+
+		// Pass a mesh is rendered in, with the light it is shaded by
+		struct PassEntry {
+			unsigned int	pass;
+			unsigned int	lightIndex;
+			ShaderWrapper*	program;
+			PhongLight*		light;
+		};
+
+		// Sorted items recorded by one job, with the batches and commands recorded from them
+		struct RecordedRange {
+			std::vector<DrawBatch>	batches;
+			CommandList				commands;
+			Stats					stats;
+		};
+
+		void AddOccluder(Mesh* a_mesh, const glm::mat4& a_world, const AABB& a_worldBounds, unsigned int a_triangleCount,
+			unsigned int a_firstIndex = 0, unsigned int a_indexCount = 0);
+		void AddPassItems(Mesh* a_mesh, unsigned int a_objectIndex, unsigned int a_instanceCount, const AABB& a_bounds, unsigned int a_depth,
+			const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes, unsigned int a_firstIndex = 0, unsigned int a_indexCount = 0);
+		void BuildPassList(const std::vector<PhongLight*>& a_lights, const ForwardPassSet& a_passes);
+		void WritePassItems(DrawItem* a_items, Mesh* a_mesh, unsigned int a_objectIndex, unsigned int a_instanceCount, unsigned int a_boundsIndex,
+			unsigned int a_depth, unsigned int a_firstIndex, unsigned int a_indexCount) const;
+		unsigned int CalculateDepthKey(const glm::vec4& a_worldPos) const;
+		void RadixSort();
+		void BuildBatches(unsigned int a_begin, unsigned int a_end, std::vector<DrawBatch>& a_batches, Stats& a_stats);
+		void RecordRange(RecordedRange& a_range, unsigned int a_begin, unsigned int a_end);
+		void ExecuteVisibility();
+
+		RenderCamera*	m_camera;
+		glm::mat4		m_viewTransform;		// Taken from the frame uniform block instead of recalculated per mesh
+		Frustum			m_frustum;				// Entities, instances and sub-ranges outside it are culled
+		glm::vec3		m_viewerPos;
+
+		OcclusionCuller*				m_occlusion;			// Occluders rasterized on the CPU, everything submitted after RenderOccluders is tested against them
+		std::vector<OccluderCandidate>	m_occluders;
+		bool							m_isOcclusionCulling;
+		bool							m_isOcclusionReady;		// Occluders were rasterized for this frame
+
+		PotentiallyVisibleSet*	m_visibleSet;			// Baked sets of the static batches, not owned by the queue
+		bool					m_isPVSCulling;
+		bool					m_isPVSSelected;		// Viewer is inside the sets' grid this frame
+
+		std::vector<DrawItem>	m_items;
+		std::vector<PassEntry>	m_passList;			// Passes of the mesh being submitted, kept between submits to avoid re-allocating
+		std::vector<DrawItem>	m_sortBuffer;		// Scratch buffer for the radix sort, kept between frames to avoid re-allocating
+		std::vector<ObjectUniformBlock>	m_objects;
+		std::vector<unsigned int>		m_objectIndices;	// Index of each object block in the object ring buffer
+		std::vector<AABB>				m_bounds;			// World box of each submitted mesh, instance group or sub-range run
+
+		std::vector<RecordedRange>			m_ranges;			// Kept between frames to avoid re-allocating, only the first m_rangeCount are used
+		unsigned int						m_rangeCount;
+		std::vector<IndirectDrawCommand>	m_commands;			// One per draw, ordered like the sorted items
+		unsigned int						m_indirectBufferID;
+		unsigned int						m_indirectCapacity;	// Number of commands the indirect buffer has storage for
+
+		GPUCuller*					m_gpuCuller;
+		std::vector<CullDrawData>	m_cullDraws;			// Bounds and batch of each draw command, written while batching
+		bool						m_isGPUCulling;
+		bool						m_isCullValidationRequested;
+		CullValidation				m_cullValidation;
+
+		ShaderWrapper*	m_depthProgram;			// Writes nothing but depth
+		bool			m_isDepthPrepass;
+
+		VisibilityBuffer*			m_visibilityBuffer;
+		std::vector<VisDrawData>	m_visDraws;			// One per drawn instance, the draw IDs of the visibility pass
+		std::vector<Material*>		m_visMapSets;		// First material of each distinct set of texture maps
+		std::vector<PhongLight*>	m_visLights;		// Every light of the frame's light passes
+		bool						m_isVisibilityBuffer;
+
+		PassQueries*	m_passQueries;			// Samples passed and GPU time of each pass, read a few frames late
+		unsigned int	m_viewportPixels;		// Pixels the samples of the passes are spread over
+
+		bool	m_isParallelRecording;		// Record ranges on the job system, otherwise the whole queue is recorded as one list on the calling thread
+
+		Stats m_stats;
+		float m_recordTime;		// Milliseconds spent batching and recording the last frame
+		float m_replayTime;		// Milliseconds spent making the openGL calls of the last frame
+		float m_occlusionTime;	// Milliseconds spent rasterizing the last frame's occluders
+	};
+}
\ No newline at end of file
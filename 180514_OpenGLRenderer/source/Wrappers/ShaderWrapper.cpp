@@ -2,10 +2,12 @@
 #include "Renderer_Utility_Literals.h"
 #include "Renderer_Utility_Funcs.h"
 #include "Texture\Texture.h"
+#include "Texture\TextureBinder.h"
 #include "Light\PhongLight_Dir.h"
 #include "Light\PhongLight_Spot.h"
 #include "Light\PhongLight_Point.h"
 #include "Mesh.h"
+#include "GLStateCache.h"
 
 #include <gl_core_4_4.h>
 #include <glm/ext.hpp>
@@ -23,6 +25,7 @@ namespace SPRON {
 
 	ShaderWrapper::~ShaderWrapper()
 	{
+		GLStateCache::ForgetProgram(*this);
 		glDeleteProgram(*this);
 	}
 
@@ -54,6 +57,9 @@ namespace SPRON {
 			case GEOMETRY_SHADER:
 				newShaderID = glCreateShader(GL_GEOMETRY_SHADER);
 				break;
+			case COMPUTE_SHADER:
+				newShaderID = glCreateShader(GL_COMPUTE_SHADER);
+				break;
 			default:
 				assert(false && "ERROR::SHADER_PROGRAM::UNRECOGNISED_SHADER_TYPE");
 		}
@@ -89,6 +95,64 @@ namespace SPRON {
 		}
 
 		m_shaderIDs.clear();
+
+		// Cache all uniform locations now so setting uniforms never has to query openGL
+		ReflectUniforms();
+	}
+
+	/**
+	*	@brief Query every active uniform in the linked program and store its location by name hash.
+	*	NOTE: Array uniforms are stored under both "name[0]" and "name" so either can be used to find them.
+	*	@return void.
+	*/
+	void ShaderWrapper::ReflectUniforms()
+	{
+		m_uniformLocations.clear();
+
+		int uniformNum = 0;
+		glGetProgramInterfaceiv(*this, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformNum);
+
+		std::unordered_map<uint32_t, std::string> reflectedNames;		// Only kept during reflection to catch hash collisions
+
+		const GLenum properties[2] = { GL_NAME_LENGTH, GL_LOCATION };
+
+		for (int i = 0; i < uniformNum; ++i) {
+			int values[2];
+			glGetProgramResourceiv(*this, GL_UNIFORM, i, 2, properties, 2, nullptr, values);
+
+			if (values[1] == -1) { continue; }		// Uniform block member, has no location
+
+			std::string uniformName(values[0], '\0');
+			glGetProgramResourceName(*this, GL_UNIFORM, i, values[0], nullptr, &uniformName[0]);
+			uniformName.resize(values[0] - 1);		// Remove null terminator included in the name length
+
+			// Store location, also under the base name for arrays
+			std::string names[2] = { uniformName, "" };
+			size_t arrayPos = uniformName.rfind("[0]");
+			if (arrayPos != std::string::npos && arrayPos == uniformName.size() - 3) { names[1] = uniformName.substr(0, arrayPos); }
+
+			for (int j = 0; j < 2; ++j) {
+				if (names[j].empty()) { continue; }
+
+				uint32_t nameHash = HashUniformName(names[j].c_str());
+
+				// Error handling
+				try {
+					auto foundName = reflectedNames.find(nameHash);
+
+					if (foundName != reflectedNames.end() && foundName->second != names[j]) {	// Two different names produced the same hash
+						char errorMsg[256];
+						sprintf_s(errorMsg, "ERROR::SHADER_PROGRAM::UNIFORM_HASH_COLLISION: %s and %s in %i", foundName->second.c_str(), names[j].c_str(), m_ID);
+
+						throw std::runtime_error(errorMsg);
+					}
+				}
+				catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+
+				reflectedNames[nameHash] = names[j];
+				m_uniformLocations[nameHash] = values[1];
+			}
+		}
 	}
 
 	/**
@@ -99,132 +163,156 @@ namespace SPRON {
 	*/
 	void ShaderWrapper::SetBool(const char * a_name, bool a_val)
 	{
-		// Bind shader program
-		glUseProgram(*this);
-
-		glUniform1i(FindLocation(a_name), int(a_val));
+		SetBool(UniformHandle<bool>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetInt(const char * a_name, int a_val)
 	{
-		// Bind shader program
-		glUseProgram(*this);
-
-		glUniform1i(FindLocation(a_name), a_val);
+		SetInt(UniformHandle<int>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetFloat(const char * a_name, float a_val)
 	{
-		// Bind shader program
-		glUseProgram(*this);
-
-		glUniform1f(FindLocation(a_name), a_val);
+		SetFloat(UniformHandle<float>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetVec3(const char * a_name, const glm::vec3 & a_val)
 	{
-		// Bind shader program
-		glUseProgram(*this);
-
-		glUniform3f(FindLocation(a_name), a_val.x, a_val.y, a_val.z);
+		SetVec3(UniformHandle<glm::vec3>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetVec4(const char * a_name, const glm::vec4 & a_val)
 	{
-		// Bind shader program
-		glUseProgram(*this);
-
-		glUniform4f(FindLocation(a_name), a_val.x, a_val.y, a_val.z, a_val.w);
+		SetVec4(UniformHandle<glm::vec4>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetTexture(const char * a_name, TextureWrapperBase * a_tex)
 	{
-		if (a_tex == nullptr) { return; }	// Texture is null, do not assign
-
-		glUseProgram(*this);
-
-		// Set specified sampler2D to texture unit
-		SetInt(a_name, a_tex->GetTexUnit());
+		SetTexture(UniformHandle<TextureWrapperBase*>(a_name), a_tex);
 	}
 
 	void ShaderWrapper::SetMat3(const char * a_name, const glm::mat3 & a_val)
 	{
-		glUseProgram(*this);
-
-		glUniformMatrix3fv(FindLocation(a_name), 1, GL_FALSE, glm::value_ptr(a_val));	// Convert GLM matrix 4 to float pointer to be compatable with openGL
+		SetMat3(UniformHandle<glm::mat3>(a_name), a_val);
 	}
 
 	void ShaderWrapper::SetMat4(const char * a_name, const glm::mat4 & a_val)
 	{
-		glUseProgram(*this);
+		SetMat4(UniformHandle<glm::mat4>(a_name), a_val);
+	}
+
+	// NOTE: Struct member names are hashed on from the instance name, so no strings are concatenated
+	void ShaderWrapper::SetMaterialMaps(const char * a_name, const Material& a_mat)
+	{
+		SetMaterialMaps(MaterialMapUniforms(a_name), a_mat);
+	}
+
+	void ShaderWrapper::SetBaseLight(const char * a_name, PhongLight * a_light)
+	{
+		SetBaseLight(BaseLightUniforms(a_name), a_light);
+	}
 
-		glUniformMatrix4fv(FindLocation(a_name), 1, GL_FALSE, glm::value_ptr(a_val));	// Convert GLM matrix 4 to float pointer to be compatable with openGL
+	void ShaderWrapper::SetDirectionalLight(const char * a_name, PhongLight_Dir * a_light)
+	{
+		SetDirectionalLight(DirLightUniforms(a_name), a_light);
 	}
 
-	void ShaderWrapper::SetMaterial(const char * a_name, Material a_mat)
+	void ShaderWrapper::SetSpotLight(const char * a_name, PhongLight_Spot * a_light)
 	{
-		glUseProgram(*this);
+		SetSpotLight(SpotLightUniforms(a_name), a_light);
+	}
 
-		std::string nameStr = a_name;
+	void ShaderWrapper::SetPointLight(const char * a_name, PhongLight_Point * a_light)
+	{
+		SetPointLight(PointLightUniforms(a_name), a_light);
+	}
 
-		SetVec4((nameStr + ".ambientColor").c_str(), a_mat.ambientColor);
-		SetVec4((nameStr + ".diffuseColor").c_str(), a_mat.diffuseColor);
-		SetVec4((nameStr + ".specular").c_str(), a_mat.specular);
-		SetFloat((nameStr + ".shininessCoefficient").c_str(), a_mat.shininessCoefficient);
-		SetTexture((nameStr + ".diffuseMap").c_str(), a_mat.diffuseMap);
-		SetTexture((nameStr + ".specularMap").c_str(), a_mat.specularMap);
-		SetTexture((nameStr + ".normalMap").c_str(), a_mat.normalMap);
+	/**
+	*	@brief Set uniform variable found by a pre-hashed handle to given value.
+	*	NOTE: Uses glProgramUniform so the program does not need to be bound.
+	*	@param a_handle is the handle of the uniform variable.
+	*	@param a_val is the value to apply to the found uniform variable.
+	*	@return void.
+	*/
+	void ShaderWrapper::SetBool(const UniformHandle<bool>& a_handle, bool a_val)
+	{
+		glProgramUniform1i(m_ID, FindLocation(a_handle.hash, a_handle.name), int(a_val));
+	}
 
-		// Inform GPU whether diffuse, specular maps and normal maps are valid
-		SetBool((nameStr + ".useDiffuseMap").c_str(), (!a_mat.disableDiffuseMap && a_mat.diffuseMap && a_mat.diffuseMap->IsNotNull() ? true : false));
-		SetBool((nameStr + ".useSpecularMap").c_str(), (!a_mat.disableSpecularMap && a_mat.specularMap && a_mat.specularMap->IsNotNull() ? true : false));
-		SetBool((nameStr + ".useNormalMap").c_str(), (!a_mat.disableNormalMap && a_mat.normalMap && a_mat.normalMap->IsNotNull() ? true : false));
+	void ShaderWrapper::SetInt(const UniformHandle<int>& a_handle, int a_val)
+	{
+		glProgramUniform1i(m_ID, FindLocation(a_handle.hash, a_handle.name), a_val);
 	}
 
-	void ShaderWrapper::SetBaseLight(const char * a_name, PhongLight * a_light)
+	void ShaderWrapper::SetFloat(const UniformHandle<float>& a_handle, float a_val)
 	{
-		glUseProgram(*this);
+		glProgramUniform1f(m_ID, FindLocation(a_handle.hash, a_handle.name), a_val);
+	}
 
-		std::string nameStr = a_name;		// Convert to string in order to easily concatenate with variable nmaes
+	void ShaderWrapper::SetVec3(const UniformHandle<glm::vec3>& a_handle, const glm::vec3 & a_val)
+	{
+		glProgramUniform3f(m_ID, FindLocation(a_handle.hash, a_handle.name), a_val.x, a_val.y, a_val.z);
+	}
 
-		SetVec4((nameStr + ".base.ambient").c_str(), a_light->GetAmbient());
-		SetVec4((nameStr + ".base.diffuse").c_str(), a_light->GetDiffuse());
-		SetVec4((nameStr + ".base.specular").c_str(), a_light->GetSpecular());
+	void ShaderWrapper::SetVec4(const UniformHandle<glm::vec4>& a_handle, const glm::vec4 & a_val)
+	{
+		glProgramUniform4f(m_ID, FindLocation(a_handle.hash, a_handle.name), a_val.x, a_val.y, a_val.z, a_val.w);
 	}
 
-	void ShaderWrapper::SetDirectionalLight(const char * a_name, PhongLight_Dir * a_light)
+	void ShaderWrapper::SetTexture(const UniformHandle<TextureWrapperBase*>& a_handle, TextureWrapperBase * a_tex)
 	{
-		glUseProgram(*this);
+		if (a_tex == nullptr) { return; }	// Texture is null, do not assign
 
-		std::string nameStr = a_name;		// Convert to string in order to easily concatenate with variable nmaes
+		// Bind texture to a unit and set specified sampler to it
+		glProgramUniform1i(m_ID, FindLocation(a_handle.hash, a_handle.name), TextureBinder::Bind(a_tex));
+	}
 
-		SetBaseLight(a_name, a_light);
-		SetVec3((nameStr + ".castDir").c_str(), a_light->GetCastDir());
+	void ShaderWrapper::SetMat3(const UniformHandle<glm::mat3>& a_handle, const glm::mat3 & a_val)
+	{
+		glProgramUniformMatrix3fv(m_ID, FindLocation(a_handle.hash, a_handle.name), 1, GL_FALSE, glm::value_ptr(a_val));	// Convert GLM matrix 4 to float pointer to be compatable with openGL
 	}
 
-	void ShaderWrapper::SetSpotLight(const char * a_name, PhongLight_Spot * a_light)
+	void ShaderWrapper::SetMat4(const UniformHandle<glm::mat4>& a_handle, const glm::mat4 & a_val)
 	{
-		glUseProgram(*this);
+		glProgramUniformMatrix4fv(m_ID, FindLocation(a_handle.hash, a_handle.name), 1, GL_FALSE, glm::value_ptr(a_val));	// Convert GLM matrix 4 to float pointer to be compatable with openGL
+	}
 
-		std::string nameStr = a_name;		// Convert to string in order to easily concatenate with variable nmaes
+	// NOTE: Material parameters and whether each map is valid are read from the material table, only the samplers are uniforms
+	void ShaderWrapper::SetMaterialMaps(const MaterialMapUniforms& a_handles, const Material& a_mat)
+	{
+		SetTexture(a_handles.diffuseMap, a_mat.diffuseMap);
+		SetTexture(a_handles.specularMap, a_mat.specularMap);
+		SetTexture(a_handles.normalMap, a_mat.normalMap);
+	}
 
-		SetBaseLight(a_name, a_light);
-		SetVec4((nameStr + ".position").c_str(), a_light->GetPos());
-		SetVec3((nameStr + ".spotDir").c_str(), a_light->GetSpotDir());
-		SetFloat((nameStr + ".spotInnerCosine").c_str(), a_light->GetSpotInnerCosine());
-		SetFloat((nameStr + ".spotOuterCosine").c_str(), a_light->GetSpotOuterCosine());
+	void ShaderWrapper::SetBaseLight(const BaseLightUniforms& a_handles, PhongLight * a_light)
+	{
+		SetVec4(a_handles.ambient, a_light->GetAmbient());
+		SetVec4(a_handles.diffuse, a_light->GetDiffuse());
+		SetVec4(a_handles.specular, a_light->GetSpecular());
 	}
 
-	void ShaderWrapper::SetPointLight(const char * a_name, PhongLight_Point * a_light)
+	void ShaderWrapper::SetDirectionalLight(const DirLightUniforms& a_handles, PhongLight_Dir * a_light)
 	{
-		glUseProgram(*this);
+		SetBaseLight(a_handles.base, a_light);
+		SetVec3(a_handles.castDir, a_light->GetCastDir());
+	}
 
-		std::string nameStr = a_name;		// Convert to string in order to easily concatenate with variable nmaes
+	void ShaderWrapper::SetSpotLight(const SpotLightUniforms& a_handles, PhongLight_Spot * a_light)
+	{
+		SetBaseLight(a_handles.base, a_light);
+		SetVec4(a_handles.position, a_light->GetPos());
+		SetVec3(a_handles.spotDir, a_light->GetSpotDir());
+		SetFloat(a_handles.spotInnerCosine, a_light->GetSpotInnerCosine());
+		SetFloat(a_handles.spotOuterCosine, a_light->GetSpotOuterCosine());
+	}
 
-		SetBaseLight(a_name, a_light);
-		SetVec4((nameStr + ".position").c_str(), a_light->GetPos());
-		SetFloat((nameStr + ".attenuation.illuminationRadius").c_str(), a_light->GetIlluminationRadius());
-		SetFloat((nameStr + ".attenuation.minIllumination").c_str(), a_light->GetMinIllumination());
+	void ShaderWrapper::SetPointLight(const PointLightUniforms& a_handles, PhongLight_Point * a_light)
+	{
+		SetBaseLight(a_handles.base, a_light);
+		SetVec4(a_handles.position, a_light->GetPos());
+		SetFloat(a_handles.illuminationRadius, a_light->GetIlluminationRadius());
+		SetFloat(a_handles.minIllumination, a_light->GetMinIllumination());
 	}
 
 	/**
@@ -234,20 +322,28 @@ namespace SPRON {
 	*/
 	int ShaderWrapper::FindLocation(const char * a_name)
 	{
-		// Bind as current shader program in order to search for the kernel
-		glUseProgram(*this);
+		return FindLocation(HashUniformName(a_name), a_name);
+	}
+
+	/**
+	*	@brief Look up the location of a uniform variable by its name hash in the locations cached when the program was linked.
+	*	@param a_hash is the hash of the uniform variable name.
+	*	@param a_name is the name of the uniform variable, only used for error messages.
+	*	@return integer ID of the uniform variable location, or -1 if unable to find it.
+	*/
+	int ShaderWrapper::FindLocation(uint32_t a_hash, const char * a_name)
+	{
+		auto foundLocation = m_uniformLocations.find(a_hash);
 
-		int foundKernel = glGetUniformLocation(*this, a_name);
+		int foundKernel = (foundLocation != m_uniformLocations.end() ? foundLocation->second : -1);
 
 		// Error handling
 #if ERROR_CHECK_UNIFORM_FIND
 		try {
 			if (foundKernel == -1) {		// Unable to find kernel
-				int boundProgramID; glGetIntegerv(GL_CURRENT_PROGRAM, &boundProgramID);
-
 				char errorMsg[256];
-				sprintf_s(errorMsg, "ERROR::MATERIAL::FAILED_TO_FIND: %s in %i with %i bound \nDescription: Uniform name not found in bound material, it was either misspelled or optimized away for not being used in the shader.",
-					a_name, m_ID, boundProgramID);
+				sprintf_s(errorMsg, "ERROR::MATERIAL::FAILED_TO_FIND: %s (hash %u) in %i \nDescription: Uniform name not found in shader program, it was either misspelled or optimized away for not being used in the shader.",
+					(a_name ? a_name : "unknown"), a_hash, m_ID);
 
 				throw std::runtime_error(errorMsg);
 			}
@@ -256,6 +352,8 @@ namespace SPRON {
 			std::cout << "Exception: " << e.what() << std::endl; 
 			__debugbreak();
 		}
+#else
+		(void)a_name;
 #endif 
 
 		return foundKernel;
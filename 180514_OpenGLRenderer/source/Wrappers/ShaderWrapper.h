@@ -1,6 +1,9 @@
 #pragma once
 
+#include "UniformHandle.h"
+
 #include <vector>
+#include <unordered_map>
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -34,22 +37,42 @@ namespace SPRON {
 		void SetTexture(const char* a_name, TextureWrapperBase* a_tex);
 		void SetMat3(const char* a_name, const glm::mat3& a_val);
 		void SetMat4(const char* a_name, const glm::mat4& a_val);
-		void SetMaterial(const char* a_name, Material a_mat);
+		void SetMaterialMaps(const char* a_name, const Material& a_mat);
 		void SetBaseLight(const char* a_name, PhongLight* a_light);
 		void SetDirectionalLight(const char* a_name, PhongLight_Dir* a_light);
 		void SetSpotLight(const char* a_name, PhongLight_Spot* a_light);
 		void SetPointLight(const char* a_name, PhongLight_Point* a_light);
 
+		// Pre-hashed handle variants for the per-frame draw loop (no string building or location queries)
+		void SetBool(const UniformHandle<bool>& a_handle, bool a_val);
+		void SetInt(const UniformHandle<int>& a_handle, int a_val);
+		void SetFloat(const UniformHandle<float>& a_handle, float a_val);
+		void SetVec3(const UniformHandle<glm::vec3>& a_handle, const glm::vec3& a_val);
+		void SetVec4(const UniformHandle<glm::vec4>& a_handle, const glm::vec4& a_val);
+		void SetTexture(const UniformHandle<TextureWrapperBase*>& a_handle, TextureWrapperBase* a_tex);
+		void SetMat3(const UniformHandle<glm::mat3>& a_handle, const glm::mat3& a_val);
+		void SetMat4(const UniformHandle<glm::mat4>& a_handle, const glm::mat4& a_val);
+		void SetMaterialMaps(const MaterialMapUniforms& a_handles, const Material& a_mat);
+		void SetBaseLight(const BaseLightUniforms& a_handles, PhongLight* a_light);
+		void SetDirectionalLight(const DirLightUniforms& a_handles, PhongLight_Dir* a_light);
+		void SetSpotLight(const SpotLightUniforms& a_handles, PhongLight_Spot* a_light);
+		void SetPointLight(const PointLightUniforms& a_handles, PhongLight_Point* a_light);
+
 		std::string GetName() { return m_name; }
 
 		int FindLocation(const char* a_name);
+		int FindLocation(uint32_t a_hash, const char* a_name = nullptr);
 
 		operator unsigned int() { return m_ID; }	// Allow class to be used in parameters of openGL functions
 	protected:
 	private:
+		void ReflectUniforms();
+
 		unsigned int m_ID;							// OpenGL identifier
 		std::string m_name;
 
 		std::vector<unsigned int>	m_shaderIDs;	// List of attached shader IDs
+
+		std::unordered_map<uint32_t, int> m_uniformLocations;	// Uniform name hash -> location, filled once when the program is linked
 	};
 }
\ No newline at end of file
@@ -0,0 +1,1054 @@
+#include "ShadowAtlas.h"
+#include "ShaderWrapper.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "InstancedMesh.h"
+#include "StaticBatch.h"
+#include "Mesh.h"
+#include "SceneStore.h"
+#include "RenderCamera.h"
+#include "JobSystem.h"
+#include "Light\PhongLight_Dir.h"
+#include "Light\PhongLight_Point.h"
+#include "Light\PhongLight_Spot.h"
+#include "Texture\DepthTexture.h"
+
+#include <gl_core_4_4.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+#include <imgui.h>
+#include <assert.h>
+
+namespace SPRON {
+	/// Static initialisation
+	ShadowAtlas* ShadowAtlas::m_stn = nullptr;
+
+	/**
+	*	@brief Distance at which a point light's illumination reaches its minimum and is cut off, capped at the shadow distance.
+	*	@param a_light is the point light.
+	*	@return range of the light's shadow.
+	*/
+	static float CalculatePointRange(PhongLight_Point* a_light)
+	{
+		// Solves the forward shaders' attenuation 1 / (d / r + 1)^2 for the minimum illumination
+		float range = a_light->GetIlluminationRadius() * (1.f / std::sqrt(a_light->GetMinIllumination()) - 1.f);
+
+		return std::min(range, SHADOW_DISTANCE);
+	}
+
+	/**
+	*	@brief Continue a 64 bit FNV-1a hash with the geometry and placement of a caster.
+	*	@param a_data is the start of the bytes to hash.
+	*	@param a_size is the number of bytes.
+	*	@param a_hash is the hash to continue from.
+	*	@return hash including the bytes.
+	*/
+	static uint64_t HashBytes(const void* a_data, size_t a_size, uint64_t a_hash)
+	{
+		const unsigned char* bytes = (const unsigned char*)a_data;
+
+		for (size_t i = 0; i < a_size; ++i) {
+			a_hash = (a_hash ^ bytes[i]) * 1099511628211ull;
+		}
+
+		return a_hash;
+	}
+
+	ShadowAtlas::ShadowAtlas() : m_liveAtlas(nullptr), m_staticAtlas(nullptr), m_liveFrameBufferID(0), m_staticFrameBufferID(0), m_casterProgram(nullptr),
+		m_maxTileLevel(0), m_minTileLevel(0), m_usedTexels(0), m_viewerPos(0.f), m_updateBudget(SHADOW_UPDATE_BUDGET),
+		m_shadowedLights(0), m_updatedLights(0), m_deferredLights(0), m_staticViews(0), m_dynamicViews(0), m_updatedTexels(0), m_evictions(0)
+	{
+	}
+
+	ShadowAtlas::~ShadowAtlas()
+	{
+		delete m_casterProgram;
+		delete m_liveAtlas;
+		delete m_staticAtlas;
+
+		GLStateCache::ForgetFramebuffer(m_liveFrameBufferID);
+		GLStateCache::ForgetFramebuffer(m_staticFrameBufferID);
+		glDeleteFramebuffers(1, &m_liveFrameBufferID);
+		glDeleteFramebuffers(1, &m_staticFrameBufferID);
+	}
+
+	/**
+	*	@brief Create singleton, the atlases and their frame buffers, and load the caster program.
+	*	NOTE: Must be called after the geometry pool and uniform blocks are initialised, any future calls will be ignored.
+	*	@return void.
+	*/
+	void ShadowAtlas::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new ShadowAtlas();
+
+			m_stn->m_liveAtlas = new DepthTexture(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, true);
+			m_stn->m_staticAtlas = new DepthTexture(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+
+			glGenFramebuffers(1, &m_stn->m_liveFrameBufferID);
+			glGenFramebuffers(1, &m_stn->m_staticFrameBufferID);
+
+			unsigned int frameBuffers[2] = { m_stn->m_liveFrameBufferID, m_stn->m_staticFrameBufferID };
+			DepthTexture* atlases[2] = { m_stn->m_liveAtlas, m_stn->m_staticAtlas };
+
+			GLStateCache::SetDepthMask(true);		// Clears are masked too
+
+			for (unsigned int i = 0; i < 2; ++i) {
+				GLStateCache::BindFramebuffer(frameBuffers[i]);
+
+				// Depth only
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, *atlases[i], 0);
+				glDrawBuffer(GL_NONE);
+				glReadBuffer(GL_NONE);
+
+				// Error handling
+				try {
+					GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+					if (status != GL_FRAMEBUFFER_COMPLETE) {
+						char errorMsg[256];
+						sprintf_s(errorMsg, "ERROR::SHADOW_ATLAS::FRAME_BUFFER_INCOMPLETE: %#x", status);
+
+						throw std::runtime_error(errorMsg);
+					}
+				}
+				catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+
+				glClear(GL_DEPTH_BUFFER_BIT);		// Tiles that were never rendered read as lit
+			}
+
+			GLStateCache::BindFramebuffer(0);
+
+			/// Quadtree, from the whole atlas down to the smallest tiles
+			while ((SHADOW_ATLAS_SIZE >> m_stn->m_maxTileLevel) > SHADOW_MAX_TILE_SIZE) { m_stn->m_maxTileLevel++; }
+			while ((SHADOW_ATLAS_SIZE >> m_stn->m_minTileLevel) > SHADOW_MIN_TILE_SIZE) { m_stn->m_minTileLevel++; }
+
+			m_stn->m_nodes.resize(m_stn->m_minTileLevel + 1);
+			for (unsigned int i = 0; i < m_stn->m_nodes.size(); ++i) {
+				m_stn->m_nodes[i].assign((size_t)1 << (2 * i), NODE_FREE);
+			}
+
+			m_stn->m_casterProgram = new ShaderWrapper("shadow_caster");
+			m_stn->m_casterProgram->LoadShader("./shaders/shadow/shadow_caster.vert", VERT_SHADER);
+			m_stn->m_casterProgram->LoadShader("./shaders/shadow/shadow_caster.geom", GEOMETRY_SHADER);
+			m_stn->m_casterProgram->LoadShader("./shaders/shadow/shadow_caster.frag", FRAG_SHADER);
+			m_stn->m_casterProgram->LinkShaders();
+		}
+	}
+
+	void ShadowAtlas::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Start a frame's shadows: match the lights to their entries, calculate each view for this frame and re-allocate tiles of lights
+	*	whose importance changed. Casters are cleared, so they must be added again every frame.
+	*	NOTE: Must be called after the frame data is set, cascades are fitted to the camera's view.
+	*	@param a_camera is the camera being rendered to.
+	*	@param a_lights is every light to shadow, entries are kept by pointer so the lights must stay at the same address between frames.
+	*	@return void.
+	*/
+	void ShadowAtlas::Begin(RenderCamera * a_camera, const std::vector<PhongLight*>& a_lights)
+	{
+		const FrameUniformBlock& frame = UniformBlocks::GetFrameData();
+
+		m_stn->m_viewerPos = frame.worldViewerPos;
+		m_stn->m_cameraFrustum.Set(frame.projectionTransform * frame.viewTransform);
+
+		m_stn->m_staticCasters.clear();
+		m_stn->m_dynamicCasters.clear();
+		m_stn->m_evictions = 0;
+
+		std::vector<ShadowLight>& lights = m_stn->m_lights;
+
+		for (unsigned int i = 0; i < lights.size(); ++i) { lights[i].isSeen = false; }
+
+		for (unsigned int i = 0; i < a_lights.size(); ++i) {
+			std::unordered_map<PhongLight*, unsigned int>::iterator entry = m_stn->m_lightLookup.find(a_lights[i]);
+
+			if (entry == m_stn->m_lightLookup.end()) {		// New light, has no tiles until it is allocated
+				ShadowLight light = ShadowLight();
+				light.light = a_lights[i];
+				light.level = -1;
+
+				switch (a_lights[i]->GetType()) {
+					case DIRECTIONAL_LIGHT:	light.viewCount = SHADOW_CASCADE_COUNT;	break;
+					case POINT_LIGHT:		light.viewCount = 6;					break;		// One per cube face
+					case SPOT_LIGHT:		light.viewCount = 1;					break;
+				}
+
+				lights.push_back(light);
+				entry = m_stn->m_lightLookup.insert(std::make_pair(a_lights[i], (unsigned int)lights.size() - 1)).first;
+			}
+
+			ShadowLight& light = lights[entry->second];
+			light.isSeen = true;
+			light.importance = m_stn->CalculateImportance(light.light);
+
+			m_stn->UpdateViews(light, a_camera);
+		}
+
+		// Lights removed from the scene give their tiles back
+		for (unsigned int i = 0; i < lights.size();) {
+			if (lights[i].isSeen) { ++i; continue; }
+
+			m_stn->FreeLight(lights[i]);
+
+			lights[i] = lights.back();
+			lights.pop_back();
+		}
+
+		m_stn->m_lightLookup.clear();
+		for (unsigned int i = 0; i < lights.size(); ++i) { m_stn->m_lightLookup[lights[i].light] = i; }
+
+		m_stn->AllocateTiles();
+	}
+
+	/**
+	*	@brief Add every entity of the scene as a dynamic caster.
+	*	NOTE: Must be called after the scene's bounds are updated for the frame.
+	*	@param a_scene is the scene to take casters from.
+	*	@return void.
+	*/
+	void ShadowAtlas::AddCasters(SceneStore * a_scene)
+	{
+		for (unsigned int i = 0; i < a_scene->GetEntityCount(); ++i) {
+			unsigned int geometry = a_scene->GetMesh(i)->GetGeometry();
+			if (geometry == GeometryPool::INVALID_GEOMETRY) { continue; }
+
+			ShadowCaster caster;
+			caster.geometry = geometry;
+			caster.firstIndex = 0;
+			caster.indexCount = 0;
+			caster.world = a_scene->GetWorldMatrix(i);
+			caster.bounds = a_scene->GetWorldBox(i);
+			caster.instances = nullptr;
+			caster.version = 0;
+
+			m_stn->m_dynamicCasters.push_back(caster);
+		}
+	}
+
+	/**
+	*	@brief Add an instanced mesh as a single dynamic caster, bounded by every instance and drawn as one instanced draw.
+	*	NOTE: Views only re-render it when its transform version changes, so instances that don't move cost nothing per frame.
+	*	@param a_instancedMesh is the instanced mesh to add.
+	*	@return void.
+	*/
+	void ShadowAtlas::AddCasters(InstancedMesh * a_instancedMesh)
+	{
+		Mesh* mesh = a_instancedMesh->GetMesh();
+		if (mesh->GetGeometry() == GeometryPool::INVALID_GEOMETRY || a_instancedMesh->GetInstanceCount() == 0) { return; }
+
+		ShadowCaster caster;
+		caster.geometry = mesh->GetGeometry();
+		caster.firstIndex = 0;
+		caster.indexCount = 0;
+		caster.world = glm::mat4(1);		// Each instance's transform is in its transform buffer
+		caster.bounds = a_instancedMesh->GetInstanceBounds();
+		caster.instances = a_instancedMesh;
+		caster.version = a_instancedMesh->GetTransformVersion();
+
+		m_stn->m_dynamicCasters.push_back(caster);
+	}
+
+	/**
+	*	@brief Add every sub-range of a static batch as a static caster, they are only drawn into the static atlas.
+	*	@param a_staticBatch is the static batch to take casters from.
+	*	@return void.
+	*/
+	void ShadowAtlas::AddCasters(StaticBatch * a_staticBatch)
+	{
+		Mesh* mesh = a_staticBatch->GetMesh();
+		const std::vector<StaticBatch::SubRange>& subRanges = a_staticBatch->GetSubRanges();
+
+		for (unsigned int i = 0; i < subRanges.size(); ++i) {
+			glm::vec3 radius = glm::vec3(subRanges[i].boundsRadius);
+
+			ShadowCaster caster;
+			caster.geometry = mesh->GetGeometry();
+			caster.firstIndex = subRanges[i].firstIndex;
+			caster.indexCount = subRanges[i].indexCount;
+			caster.world = glm::mat4(1);		// Vertices are already in world space
+			caster.bounds = AABB(subRanges[i].boundsCenter - radius, subRanges[i].boundsCenter + radius);
+			caster.instances = nullptr;
+			caster.version = 0;
+
+			m_stn->m_staticCasters.push_back(caster);
+		}
+	}
+
+	/**
+	*	@brief Find the views whose casters or projection changed and re-render them, most urgent lights first until the update budget is spent.
+	*	NOTE: Must be called after every caster is added and before the light passes are executed, changes the bound vertex array and program.
+	*	@return void.
+	*/
+	void ShadowAtlas::Render()
+	{
+		std::vector<ShadowLight>& lights = m_stn->m_lights;
+
+		m_stn->m_updatedLights = 0;
+		m_stn->m_deferredLights = 0;
+		m_stn->m_staticViews = 0;
+		m_stn->m_dynamicViews = 0;
+		m_stn->m_updatedTexels = 0;
+
+		// Hash the dynamic casters in each view, every caster is tested against every view so lights are hashed in parallel
+		JobSystem::ParallelFor((unsigned int)lights.size(), 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; ++i) {
+				ShadowLight& light = lights[i];
+				if (light.level < 0) { continue; }
+
+				for (unsigned int v = 0; v < light.viewCount; ++v) {
+					ShadowView& view = light.views[v];
+					uint64_t hash = 14695981039346656037ull;
+
+					for (unsigned int c = 0; c < m_stn->m_dynamicCasters.size(); ++c) {
+						const ShadowCaster& caster = m_stn->m_dynamicCasters[c];
+						if (view.frustum.TestAABB(caster.bounds) == FRUSTUM_OUTSIDE) { continue; }
+
+						hash = HashBytes(&caster.geometry, sizeof(unsigned int) * 3, hash);		// Geometry and index range
+
+						if (caster.instances) {		// Instances moved since the last render, without reading every transform
+							hash = HashBytes(&caster.instances, sizeof(InstancedMesh*), hash);
+							hash = HashBytes(&caster.version, sizeof(uint64_t), hash);
+						}
+						else { hash = HashBytes(glm::value_ptr(caster.world), sizeof(glm::mat4), hash); }
+					}
+
+					view.dynamicHash = hash;
+				}
+			}
+		});
+
+		// Lights with views to update, lights out of view are left as they are until they come back into view
+		std::vector<unsigned int>& order = m_stn->m_order;
+		order.clear();
+
+		for (unsigned int i = 0; i < lights.size(); ++i) {
+			ShadowLight& light = lights[i];
+			bool isPending = false;
+
+			for (unsigned int v = 0; v < light.viewCount; ++v) { isPending |= IsPending(light.views[v]); }
+
+			if (light.level < 0 || light.importance <= 0.f || !isPending) { light.framesPending = 0; continue; }
+
+			order.push_back(i);
+		}
+
+		// Most important first, lights that have been waiting are boosted so they are not starved by more important ones
+		std::sort(order.begin(), order.end(), [&](unsigned int a_lhs, unsigned int a_rhs) {
+			float lhsPriority = lights[a_lhs].importance * (lights[a_lhs].framesPending + 1);
+			float rhsPriority = lights[a_rhs].importance * (lights[a_rhs].framesPending + 1);
+
+			return (lhsPriority != rhsPriority ? lhsPriority > rhsPriority : a_lhs < a_rhs);
+		});
+
+		if (!order.empty()) {
+			int previousFrameBuffer = 0;
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+
+			int viewport[4];
+			glGetIntegerv(GL_VIEWPORT, viewport);
+
+			GLStateCache::SetDepthTest(true);
+			GLStateCache::SetDepthMask(true);
+			GLStateCache::SetDepthFunc(GL_LESS);
+			GLStateCache::SetBlending(false);
+
+			// Slope scaled bias, so surfaces at a grazing angle to the light don't shadow themselves
+			glEnable(GL_POLYGON_OFFSET_FILL);
+			glPolygonOffset(SHADOW_SLOPE_BIAS, SHADOW_CONSTANT_BIAS);
+
+			// Only positions are needed for depth
+			GeometryPool::BindPositions();
+			GLStateCache::UseProgram(*m_stn->m_casterProgram);
+
+			for (unsigned int i = 0; i < order.size(); ++i) {
+				ShadowLight& light = lights[order[i]];
+
+				unsigned int cost = 0;
+				for (unsigned int v = 0; v < light.viewCount; ++v) {
+					if (!IsPending(light.views[v])) { continue; }
+
+					unsigned int size = m_stn->GetTileRect(light.views[v].tile).z;
+					cost += size * size;
+				}
+
+				// NOTE: The most urgent light is always updated, so a light larger than the budget is never starved
+				if (m_stn->m_updatedLights > 0 && m_stn->m_updatedTexels + cost > (unsigned int)m_stn->m_updateBudget) {
+					light.framesPending++;
+					m_stn->m_deferredLights++;
+					continue;
+				}
+
+				m_stn->UpdateLight(light);
+
+				light.framesPending = 0;
+				m_stn->m_updatedLights++;
+				m_stn->m_updatedTexels += cost;
+			}
+
+			glDisable(GL_POLYGON_OFFSET_FILL);
+
+			glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);		// Resets every indexed viewport
+			GLStateCache::BindFramebuffer(previousFrameBuffer);
+		}
+
+		m_stn->m_shadowedLights = 0;
+		for (unsigned int i = 0; i < lights.size(); ++i) {
+			m_stn->UpdateShadingData(lights[i]);
+
+			if (lights[i].isReady) { m_stn->m_shadowedLights++; }
+		}
+	}
+
+	/**
+	*	@brief Send a light's shadow to a light pass, lights without a ready shadow are sent a view count of 0 and are shaded unshadowed.
+	*	NOTE: Does nothing if the atlas was never initialised, the view count uniform then keeps its default of 0.
+	*	@param a_program is the light pass about to draw with the light.
+	*	@param a_light is the light.
+	*	@return void.
+	*/
+	void ShadowAtlas::SetShadowUniforms(ShaderWrapper * a_program, PhongLight * a_light)
+	{
+		if (!m_stn) { return; }
+
+		a_program->SetTexture(Uniforms::SHADOW_ATLAS, m_stn->m_liveAtlas);
+
+		std::unordered_map<PhongLight*, unsigned int>::const_iterator entry = m_stn->m_lightLookup.find(a_light);
+
+		if (entry == m_stn->m_lightLookup.end() || !m_stn->m_lights[entry->second].isReady) {
+			a_program->SetInt(Uniforms::SHADOW_VIEW_COUNT, 0);
+			return;
+		}
+
+		const ShadowLight& light = m_stn->m_lights[entry->second];
+
+		a_program->SetInt(Uniforms::SHADOW_VIEW_COUNT, (int)light.viewCount);
+		a_program->SetVec4(Uniforms::SHADOW_CASCADE_ENDS, light.cascadeEnds);
+
+		glProgramUniformMatrix4fv(*a_program, a_program->FindLocation(Uniforms::SHADOW_MATRICES.hash, Uniforms::SHADOW_MATRICES.name),
+			light.viewCount, GL_FALSE, glm::value_ptr(light.shadowMatrices[0]));
+		glProgramUniform4fv(*a_program, a_program->FindLocation(Uniforms::SHADOW_TILES.hash, Uniforms::SHADOW_TILES.name),
+			light.viewCount, glm::value_ptr(light.shadowTiles[0]));
+	}
+
+	/**
+	*	@brief Display the atlas' usage and how many views were updated last frame, and edit the update budget.
+	*	@return void.
+	*/
+	void ShadowAtlas::ListenIMGUI()
+	{
+		ImGui::Begin("Shadows");
+
+		const float atlasTexels = (float)SHADOW_ATLAS_SIZE * SHADOW_ATLAS_SIZE;
+
+		ImGui::Text("Atlas: %ux%u (%.1f%% allocated)", SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, 100.f * m_stn->m_usedTexels / atlasTexels);
+		ImGui::Text("Shadowed lights: %u of %u (%u evicted)", m_stn->m_shadowedLights, (unsigned int)m_stn->m_lights.size(), m_stn->m_evictions);
+		ImGui::Text("Updated lights: %u (%u deferred)", m_stn->m_updatedLights, m_stn->m_deferredLights);
+		ImGui::Text("Views rendered: %u static, %u dynamic", m_stn->m_staticViews, m_stn->m_dynamicViews);
+		ImGui::Text("Texels rendered: %.2f M", m_stn->m_updatedTexels / (1024.f * 1024.f));
+		ImGui::Text("Casters: %u static, %u dynamic", (unsigned int)m_stn->m_staticCasters.size(), (unsigned int)m_stn->m_dynamicCasters.size());
+		ImGui::SliderInt("Update budget", &m_stn->m_updateBudget, SHADOW_MIN_TILE_SIZE * SHADOW_MIN_TILE_SIZE, SHADOW_ATLAS_SIZE * SHADOW_ATLAS_SIZE);
+
+		ImGui::Separator();
+		for (unsigned int i = 0; i < m_stn->m_lights.size(); ++i) {
+			const ShadowLight& light = m_stn->m_lights[i];
+			unsigned int tileSize = (light.level < 0 ? 0 : SHADOW_ATLAS_SIZE >> light.level);
+
+			ImGui::Text("Light %u: %u views of %ux%u, importance %.2f%s", i, light.viewCount, tileSize, tileSize, light.importance,
+				(light.isReady ? "" : " (unshadowed)"));
+		}
+
+		ImGui::End();
+	}
+
+	/**
+	*	@brief Calculate this frame's view projection and frustum of each of a light's views.
+	*	@param a_light is the light to update.
+	*	@param a_camera is the camera cascades are fitted to.
+	*	@return void.
+	*/
+	void ShadowAtlas::UpdateViews(ShadowLight & a_light, RenderCamera * a_camera)
+	{
+		switch (a_light.light->GetType()) {
+			case DIRECTIONAL_LIGHT:
+				UpdateCascades(a_light, a_camera);
+				break;
+			case POINT_LIGHT: {
+				PhongLight_Point* light = (PhongLight_Point*)a_light.light;
+				glm::vec3 pos = glm::vec3(light->GetPos());
+
+				// Faces in the order the forward header picks them, +X, -X, +Y, -Y, +Z, -Z
+				static const glm::vec3 faceDirs[6] = {
+					glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+				static const glm::vec3 faceUps[6] = {
+					glm::vec3(0, -1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1), glm::vec3(0, -1, 0), glm::vec3(0, -1, 0) };
+
+				glm::mat4 projection = glm::perspective(glm::radians(90.f), 1.f, SHADOW_NEAR_PLANE, CalculatePointRange(light));
+
+				for (unsigned int i = 0; i < 6; ++i) {
+					a_light.views[i].viewProjection = projection * glm::lookAt(pos, pos + faceDirs[i], faceUps[i]);
+				}
+				break;
+			}
+			case SPOT_LIGHT: {
+				PhongLight_Spot* light = (PhongLight_Spot*)a_light.light;
+				glm::vec3 pos = glm::vec3(light->GetPos());
+				glm::vec3 dir = glm::normalize(light->GetSpotDir());
+				glm::vec3 up = (std::abs(dir.y) > 0.99f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0));
+
+				// Widened a little past the outer cone so the filter kernel at the cone's edge stays in the map
+				float fov = std::min(2.f * std::acos(light->GetSpotOuterCosine()) + glm::radians(2.f), glm::radians(170.f));
+
+				a_light.views[0].viewProjection = glm::perspective(fov, 1.f, SHADOW_NEAR_PLANE, SHADOW_SPOT_RANGE) * glm::lookAt(pos, pos + dir, up);
+				break;
+			}
+		}
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			a_light.views[i].frustum.Set(a_light.views[i].viewProjection);
+		}
+	}
+
+	/**
+	*	@brief Fit each cascade of a directional light around a slice of the camera's view, split between the near plane and the shadow distance.
+	*	Cascades are bounding spheres snapped to steps in light space, so turning the camera or moving within a step leaves the projection unchanged
+	*	and the cached tiles stay valid.
+	*	@param a_light is the directional light to update.
+	*	@param a_camera is the camera to fit the cascades to.
+	*	@return void.
+	*/
+	void ShadowAtlas::UpdateCascades(ShadowLight & a_light, RenderCamera * a_camera)
+	{
+		const FrameUniformBlock& frame = UniformBlocks::GetFrameData();
+		glm::mat4 inverseProjectionView = glm::inverse(frame.projectionTransform * frame.viewTransform);
+
+		float nearPlane = a_camera->GetNearPlane();
+		float farPlane = a_camera->GetFarPlane();
+		float shadowFar = std::min(farPlane, SHADOW_DISTANCE);
+
+		// Corners of the camera's near and far planes in global space
+		glm::vec3 nearCorners[4];
+		glm::vec3 farCorners[4];
+
+		for (unsigned int i = 0; i < 4; ++i) {
+			glm::vec2 ndc = glm::vec2((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f);
+			glm::vec4 nearCorner = inverseProjectionView * glm::vec4(ndc, -1.f, 1.f);
+			glm::vec4 farCorner = inverseProjectionView * glm::vec4(ndc, 1.f, 1.f);
+
+			nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+			farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+		}
+
+		glm::vec3 castDir = glm::normalize(((PhongLight_Dir*)a_light.light)->GetCastDir());
+		glm::vec3 up = (std::abs(castDir.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0));
+		glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.f), castDir, up);
+
+		float sliceStart = nearPlane;
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			// Practical split scheme, a blend of logarithmic and uniform splits
+			float t = (i + 1) / (float)a_light.viewCount;
+			float logSplit = nearPlane * std::pow(shadowFar / nearPlane, t);
+			float uniformSplit = nearPlane + (shadowFar - nearPlane) * t;
+			float sliceEnd = SHADOW_CASCADE_LAMBDA * logSplit + (1.f - SHADOW_CASCADE_LAMBDA) * uniformSplit;
+
+			// Corners move linearly with view distance along the edges of the frustum
+			glm::vec3 corners[8];
+			glm::vec3 center = glm::vec3(0.f);
+
+			for (unsigned int j = 0; j < 4; ++j) {
+				corners[j] = glm::mix(nearCorners[j], farCorners[j], (sliceStart - nearPlane) / (farPlane - nearPlane));
+				corners[j + 4] = glm::mix(nearCorners[j], farCorners[j], (sliceEnd - nearPlane) / (farPlane - nearPlane));
+
+				center += corners[j] + corners[j + 4];
+			}
+
+			center /= 8.f;
+
+			float radius = 0.f;
+			for (unsigned int j = 0; j < 8; ++j) { radius = std::max(radius, glm::length(corners[j] - center)); }
+
+			radius = std::ceil(radius * 16.f) / 16.f;		// Rounding error as the camera turns would otherwise change the projection
+
+			// Snapped in light space, the extent covers the slice wherever in its step the center was snapped from
+			float step = radius * SHADOW_CASCADE_SNAP;
+			float extent = radius + step;
+
+			glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.f));
+			lightCenter = glm::floor(lightCenter / step + 0.5f) * step;
+
+			glm::mat4 view = glm::translate(glm::mat4(1), -lightCenter) * lightRotation;
+			glm::mat4 projection = glm::ortho(-extent, extent, -extent, extent, -(extent + SHADOW_DIR_CASTER_EXTENT), extent);		// Casters behind the slice
+
+			a_light.views[i].viewProjection = projection * view;
+			a_light.views[i].cascadeEnd = sliceEnd;
+
+			sliceStart = sliceEnd;
+		}
+	}
+
+	/**
+	*	@brief Estimate how much of the view a light's shadow covers, from its range and distance to the viewer.
+	*	@param a_light is the light.
+	*	@return 1 for directional lights and lights the viewer is in range of, down to 0 for lights whose range is out of view.
+	*/
+	float ShadowAtlas::CalculateImportance(PhongLight * a_light) const
+	{
+		glm::vec3 center;
+		float range;
+
+		switch (a_light->GetType()) {
+			case POINT_LIGHT:
+				center = glm::vec3(((PhongLight_Point*)a_light)->GetPos());
+				range = CalculatePointRange((PhongLight_Point*)a_light);
+				break;
+			case SPOT_LIGHT:
+				center = glm::vec3(((PhongLight_Spot*)a_light)->GetPos());
+				range = SHADOW_SPOT_RANGE;
+				break;
+			default:
+				return 1.f;		// Covers everything in view
+		}
+
+		if (!m_cameraFrustum.IsSphereVisible(center, range)) { return 0.f; }
+
+		return std::min(range / std::max(glm::length(center - m_viewerPos), 0.001f), 1.f);
+	}
+
+	/**
+	*	@brief Choose the quadtree level of a light's tiles, each halving of importance halves the tile size.
+	*	NOTE: A light keeps its level until its importance is SHADOW_LEVEL_HYSTERESIS levels past it, so lights near a boundary don't keep being re-allocated.
+	*	@param a_importance is the light's importance.
+	*	@param a_currentLevel is the level of the light's tiles, -1 if it has none.
+	*	@return level to allocate, the current level if it should not change.
+	*/
+	int ShadowAtlas::ChooseLevel(float a_importance, int a_currentLevel) const
+	{
+		if (a_importance <= 0.f) { return a_currentLevel; }		// Out of view, keeps whatever it has
+
+		float levelOffset = -std::log2(std::min(a_importance, 1.f));
+
+		if (a_currentLevel >= 0) {
+			float currentOffset = (float)(a_currentLevel - (int)m_maxTileLevel);
+
+			if (levelOffset > currentOffset - SHADOW_LEVEL_HYSTERESIS && levelOffset < currentOffset + 1.f + SHADOW_LEVEL_HYSTERESIS) { return a_currentLevel; }
+		}
+
+		return std::min((int)m_maxTileLevel + (int)levelOffset, (int)m_minTileLevel);
+	}
+
+	/**
+	*	@brief Give lights whose level changed new tiles, the most important lights first.
+	*	Lights that don't fit fall back to smaller tiles, then take the tiles of the least important lights, and are unshadowed if neither works.
+	*	@return void.
+	*/
+	void ShadowAtlas::AllocateTiles()
+	{
+		m_order.clear();
+		for (unsigned int i = 0; i < m_lights.size(); ++i) { m_order.push_back(i); }
+
+		std::sort(m_order.begin(), m_order.end(), [&](unsigned int a_lhs, unsigned int a_rhs) {
+			return (m_lights[a_lhs].importance != m_lights[a_rhs].importance ? m_lights[a_lhs].importance > m_lights[a_rhs].importance : a_lhs < a_rhs);
+		});
+
+		for (unsigned int i = 0; i < m_order.size(); ++i) {
+			ShadowLight& light = m_lights[m_order[i]];
+
+			int level = ChooseLevel(light.importance, light.level);
+			if (level == light.level) { continue; }		// Keeps its tiles, or is out of view without any
+
+			FreeLight(light);
+
+			unsigned int lastLight = (unsigned int)m_order.size();
+			bool isAllocated = false;
+
+			while (true) {
+				for (int j = level; j <= (int)m_minTileLevel && !isAllocated; ++j) { isAllocated = AllocateLight(light, j); }
+				if (isAllocated) { break; }
+
+				// Evict the least important light that still has tiles, they are re-allocated later in the order if anything is left
+				while (lastLight > i + 1 && m_lights[m_order[lastLight - 1]].level < 0) { lastLight--; }
+				if (lastLight <= i + 1) { break; }
+
+				FreeLight(m_lights[m_order[--lastLight]]);
+				m_evictions++;
+			}
+		}
+	}
+
+	/**
+	*	@brief Allocate a tile for each of a light's views.
+	*	@param a_light is the light, must have no tiles.
+	*	@param a_level is the quadtree level of the tiles.
+	*	@return true if every view got a tile, otherwise none of the tiles are kept.
+	*/
+	bool ShadowAtlas::AllocateLight(ShadowLight & a_light, int a_level)
+	{
+		assert(a_light.level < 0 && "ERROR::SHADOW_ATLAS::LIGHT_ALREADY_ALLOCATED");
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			int index = AllocateNode(0, 0, 0, a_level);
+
+			if (index < 0) {		// Out of space, give back the tiles taken so far
+				for (unsigned int j = 0; j < i; ++j) { FreeNode(a_level, a_light.views[j].tile.index); }
+				return false;
+			}
+
+			ShadowView& view = a_light.views[i];
+			view.tile.level = a_level;
+			view.tile.index = index;
+			view.isStaticValid = false;
+			view.hasContent = false;
+		}
+
+		unsigned int tileSize = SHADOW_ATLAS_SIZE >> a_level;
+
+		a_light.level = a_level;
+		m_usedTexels += a_light.viewCount * tileSize * tileSize;
+
+		return true;
+	}
+
+	/**
+	*	@brief Give a light's tiles back to the quadtree, the light is unshadowed until it is allocated again.
+	*	@param a_light is the light.
+	*	@return void.
+	*/
+	void ShadowAtlas::FreeLight(ShadowLight & a_light)
+	{
+		if (a_light.level < 0) { return; }
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			FreeNode(a_light.level, a_light.views[i].tile.index);
+
+			a_light.views[i].isStaticValid = false;
+			a_light.views[i].hasContent = false;
+		}
+
+		unsigned int tileSize = SHADOW_ATLAS_SIZE >> a_light.level;
+
+		m_usedTexels -= a_light.viewCount * tileSize * tileSize;
+		a_light.level = -1;
+		a_light.isReady = false;
+	}
+
+	/**
+	*	@brief Find a free node at the target level below a node, splitting free nodes on the way down.
+	*	@param a_level is the level of the node to search from.
+	*	@param a_x is the node's column.
+	*	@param a_y is the node's row.
+	*	@param a_targetLevel is the level to allocate at.
+	*	@return index of the allocated node within the target level, -1 if there was no space.
+	*/
+	int ShadowAtlas::AllocateNode(unsigned int a_level, unsigned int a_x, unsigned int a_y, unsigned int a_targetLevel)
+	{
+		unsigned int index = a_y * (1u << a_level) + a_x;
+		unsigned char& state = m_nodes[a_level][index];
+
+		if (state == NODE_USED) { return -1; }
+
+		if (a_level == a_targetLevel) {
+			if (state != NODE_FREE) { return -1; }		// Part of it is used by smaller tiles
+
+			state = NODE_USED;
+			return (int)index;
+		}
+
+		bool wasFree = (state == NODE_FREE);
+		state = NODE_SPLIT;
+
+		for (unsigned int i = 0; i < 4; ++i) {
+			int childIndex = AllocateNode(a_level + 1, a_x * 2 + (i & 1), a_y * 2 + (i >> 1), a_targetLevel);
+			if (childIndex >= 0) { return childIndex; }
+		}
+
+		if (wasFree) { state = NODE_FREE; }		// Nothing fitted, undo the split
+
+		return -1;
+	}
+
+	/**
+	*	@brief Free a node and merge its parents back together while all four of their children are free.
+	*	@param a_level is the node's level.
+	*	@param a_index is the node's index within the level.
+	*	@return void.
+	*/
+	void ShadowAtlas::FreeNode(unsigned int a_level, unsigned int a_index)
+	{
+		unsigned int x = a_index % (1u << a_level);
+		unsigned int y = a_index / (1u << a_level);
+
+		m_nodes[a_level][a_index] = NODE_FREE;
+
+		while (a_level > 0) {
+			const std::vector<unsigned char>& nodes = m_nodes[a_level];
+			unsigned int rowSize = 1u << a_level;
+			unsigned int firstChild = (y & ~1u) * rowSize + (x & ~1u);
+
+			bool isSiblingsFree = nodes[firstChild] == NODE_FREE && nodes[firstChild + 1] == NODE_FREE &&
+				nodes[firstChild + rowSize] == NODE_FREE && nodes[firstChild + rowSize + 1] == NODE_FREE;
+			if (!isSiblingsFree) { break; }
+
+			a_level--;
+			x /= 2;
+			y /= 2;
+
+			m_nodes[a_level][y * (1u << a_level) + x] = NODE_FREE;
+		}
+	}
+
+	/**
+	*	@brief Get where a tile is in the atlas.
+	*	@param a_tile is the tile.
+	*	@return x and y of the tile's corner, and its size, in texels.
+	*/
+	glm::uvec3 ShadowAtlas::GetTileRect(const ShadowTile & a_tile) const
+	{
+		unsigned int rowSize = 1u << a_tile.level;
+		unsigned int size = SHADOW_ATLAS_SIZE >> a_tile.level;
+
+		return glm::uvec3((a_tile.index % rowSize) * size, (a_tile.index / rowSize) * size, size);
+	}
+
+	/**
+	*	@brief Whether a view's live tile is out of date, because it was never rendered, its projection changed or a dynamic caster in it moved.
+	*	@param a_view is the view.
+	*	@return true if the view needs rendering.
+	*/
+	bool ShadowAtlas::IsPending(const ShadowView & a_view)
+	{
+		return !a_view.hasContent || a_view.renderedMatrix != a_view.viewProjection || a_view.renderedHash != a_view.dynamicHash;
+	}
+
+	/**
+	*	@brief Whether a view's static tile is out of date, static casters never move so only a new tile or projection invalidates it.
+	*	NOTE: A stale static tile always has a pending live tile, both are rendered with the same projection.
+	*	@param a_view is the view.
+	*	@return true if the static casters need rendering.
+	*/
+	bool ShadowAtlas::IsStaticStale(const ShadowView & a_view)
+	{
+		return !a_view.isStaticValid || a_view.staticMatrix != a_view.viewProjection;
+	}
+
+	/**
+	*	@brief Re-render a light's pending views: the static casters into the static atlas where stale, then a copy of each static tile plus
+	*	the dynamic casters into the live atlas.
+	*	@param a_light is the light to update.
+	*	@return void.
+	*/
+	void ShadowAtlas::UpdateLight(ShadowLight & a_light)
+	{
+		unsigned int staticViews[SHADOW_MAX_VIEWS];
+		unsigned int pendingViews[SHADOW_MAX_VIEWS];
+		unsigned int staticCount = 0;
+		unsigned int pendingCount = 0;
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			if (!IsPending(a_light.views[i])) { continue; }
+
+			pendingViews[pendingCount++] = i;
+			if (IsStaticStale(a_light.views[i])) { staticViews[staticCount++] = i; }
+		}
+
+		/// Static casters
+		if (staticCount > 0) {
+			GLStateCache::BindFramebuffer(m_staticFrameBufferID);
+
+			// Cleared a tile at a time, the rest of the atlas belongs to other views
+			glEnable(GL_SCISSOR_TEST);
+
+			for (unsigned int i = 0; i < staticCount; ++i) {
+				glm::uvec3 rect = GetTileRect(a_light.views[staticViews[i]].tile);
+
+				glScissor(rect.x, rect.y, rect.z, rect.z);
+				glClear(GL_DEPTH_BUFFER_BIT);
+			}
+
+			glDisable(GL_SCISSOR_TEST);
+
+			DrawViews(a_light, staticViews, staticCount, m_staticCasters);
+
+			for (unsigned int i = 0; i < staticCount; ++i) {
+				ShadowView& view = a_light.views[staticViews[i]];
+
+				view.staticMatrix = view.viewProjection;
+				view.isStaticValid = true;
+			}
+
+			m_staticViews += staticCount;
+		}
+
+		/// Dynamic casters, drawn over a copy of the static casters
+		for (unsigned int i = 0; i < pendingCount; ++i) {
+			glm::uvec3 rect = GetTileRect(a_light.views[pendingViews[i]].tile);
+
+			glCopyImageSubData(*m_staticAtlas, GL_TEXTURE_2D, 0, rect.x, rect.y, 0,
+				*m_liveAtlas, GL_TEXTURE_2D, 0, rect.x, rect.y, 0,
+				rect.z, rect.z, 1);
+		}
+
+		GLStateCache::BindFramebuffer(m_liveFrameBufferID);
+
+		DrawViews(a_light, pendingViews, pendingCount, m_dynamicCasters);
+
+		for (unsigned int i = 0; i < pendingCount; ++i) {
+			ShadowView& view = a_light.views[pendingViews[i]];
+
+			view.renderedMatrix = view.viewProjection;
+			view.renderedCascadeEnd = view.cascadeEnd;
+			view.renderedHash = view.dynamicHash;
+			view.hasContent = true;
+		}
+
+		m_dynamicViews += pendingCount;
+	}
+
+	/**
+	*	@brief Draw the casters in any of the given views into the bound atlas, in a single draw for all of the views.
+	*	The geometry shader runs once per view and sends each triangle to the viewport of that view's tile.
+	*	@param a_light is the light the views belong to.
+	*	@param a_views is the indices of the views to draw.
+	*	@param a_viewCount is the number of views to draw.
+	*	@param a_casters is the casters to draw.
+	*	@return void.
+	*/
+	void ShadowAtlas::DrawViews(ShadowLight & a_light, const unsigned int * a_views, unsigned int a_viewCount, const std::vector<ShadowCaster>& a_casters)
+	{
+		glm::mat4 viewProjections[SHADOW_MAX_VIEWS];
+
+		for (unsigned int i = 0; i < a_viewCount; ++i) {
+			const ShadowView& view = a_light.views[a_views[i]];
+			glm::uvec3 rect = GetTileRect(view.tile);
+
+			viewProjections[i] = view.viewProjection;
+			glViewportIndexedf(i, (float)rect.x, (float)rect.y, (float)rect.z, (float)rect.z);
+		}
+
+		glProgramUniformMatrix4fv(*m_casterProgram, m_casterProgram->FindLocation(Uniforms::SHADOW_VIEW_PROJECTIONS.hash, Uniforms::SHADOW_VIEW_PROJECTIONS.name),
+			a_viewCount, GL_FALSE, glm::value_ptr(viewProjections[0]));
+		m_casterProgram->SetInt(Uniforms::SHADOW_CASTER_VIEW_COUNT, (int)a_viewCount);
+
+		// Casters in at least one of the views, triangles outside a view are culled per view by the geometry shader
+		m_drawList.clear();
+		m_instancedDrawList.clear();
+
+		for (unsigned int i = 0; i < a_casters.size(); ++i) {
+			for (unsigned int j = 0; j < a_viewCount; ++j) {
+				if (a_light.views[a_views[j]].frustum.TestAABB(a_casters[i].bounds) != FRUSTUM_OUTSIDE) {
+					(a_casters[i].instances ? m_instancedDrawList : m_drawList).push_back(i);
+					break;
+				}
+			}
+		}
+
+		/// Instanced meshes, a draw each that reads the mesh's own transform buffer in place of the object table
+		if (!m_instancedDrawList.empty()) {
+			m_casterProgram->SetBool(Uniforms::SHADOW_CASTER_INSTANCED, true);
+
+			for (unsigned int i = 0; i < m_instancedDrawList.size(); ++i) {
+				const ShadowCaster& caster = a_casters[m_instancedDrawList[i]];
+				unsigned int instanceCount = caster.instances->GetInstanceCount();
+
+				// NOTE: The draw ID attribute is still fetched per instance, so the same limit applies as drawing the instances through the object table
+				assert(instanceCount <= UniformBlocks::GetObjectCapacity() && "ERROR::SHADOW_ATLAS::TOO_MANY_INSTANCES");
+
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_OBJECTS, caster.instances->UpdateTransformBuffer());
+
+				IndirectDrawCommand draw = GeometryPool::MakeCommand(caster.geometry, 0);
+
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, draw.count, GL_UNSIGNED_INT,
+					(void*)(sizeof(unsigned int) * draw.firstIndex), instanceCount, draw.baseVertex);
+			}
+
+			m_casterProgram->SetBool(Uniforms::SHADOW_CASTER_INSTANCED, false);
+			UniformBlocks::BindObjectTable();
+		}
+
+		if (m_drawList.empty()) { return; }
+
+		/// Single objects, drawn together through the object table
+		m_commands.clear();
+
+		UniformBlocks::Reserve((unsigned int)m_drawList.size());		// The draw's object blocks must not wrap part way through
+
+		for (unsigned int i = 0; i < m_drawList.size(); ++i) {
+			const ShadowCaster& caster = a_casters[m_drawList[i]];
+
+			ObjectUniformBlock object;
+			object.modelTransform = caster.world;
+			object.materialIndex = 0;		// Not read
+
+			IndirectDrawCommand command = GeometryPool::MakeCommand(caster.geometry, UniformBlocks::PushObject(object));
+
+			if (caster.indexCount > 0) {		// Sub-range of the geometry
+				command.firstIndex += caster.firstIndex;
+				command.count = caster.indexCount;
+			}
+
+			m_commands.push_back(command);
+		}
+
+		UniformBlocks::Flush();
+
+#if USE_MULTI_DRAW_INDIRECT
+		StreamAllocation commands = UniformBlocks::AllocateDynamic(sizeof(IndirectDrawCommand) * (unsigned int)m_commands.size(), 4);
+		memcpy(commands.data, &m_commands[0], sizeof(IndirectDrawCommand) * m_commands.size());
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, UniformBlocks::GetDynamicBufferID());
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(uintptr_t)commands.offset, (GLsizei)m_commands.size(), 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#else
+		for (unsigned int i = 0; i < m_commands.size(); ++i) {
+			const IndirectDrawCommand& draw = m_commands[i];
+
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, draw.count, GL_UNSIGNED_INT,
+				(void*)(sizeof(unsigned int) * draw.firstIndex), draw.instanceCount, draw.baseVertex, draw.baseInstance);
+		}
+#endif
+	}
+
+	/**
+	*	@brief Build the shading uniforms of a light from the projections its live tiles were rendered with.
+	*	@param a_light is the light.
+	*	@return void.
+	*/
+	void ShadowAtlas::UpdateShadingData(ShadowLight & a_light)
+	{
+		a_light.isReady = (a_light.level >= 0);
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			if (!a_light.views[i].hasContent) { a_light.isReady = false; }
+		}
+
+		if (!a_light.isReady) { return; }
+
+		const float texelSize = 1.f / SHADOW_ATLAS_SIZE;
+
+		for (unsigned int i = 0; i < a_light.viewCount; ++i) {
+			const ShadowView& view = a_light.views[i];
+			glm::uvec3 rect = GetTileRect(view.tile);
+
+			glm::vec2 offset = glm::vec2(rect.x, rect.y) * texelSize;
+			float scale = rect.z * texelSize;
+
+			// Clip space to the tile's uvs, and depth from -1 to 1 to 0 to 1
+			glm::mat4 tileTransform = glm::translate(glm::mat4(1), glm::vec3(offset + scale * 0.5f, 0.5f)) *
+				glm::scale(glm::mat4(1), glm::vec3(scale * 0.5f, scale * 0.5f, 0.5f));
+
+			a_light.shadowMatrices[i] = tileTransform * view.renderedMatrix;
+
+			// Inset by half a texel so filtering never reads across the tile's edge
+			a_light.shadowTiles[i] = glm::vec4(offset + texelSize * 0.5f, offset + scale - texelSize * 0.5f);
+
+			if (i < 4) { a_light.cascadeEnds[i] = view.renderedCascadeEnd; }
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "GeometryPool.h"
+#include "Frustum.h"
+#include "Renderer_Utility_Literals.h"
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class ShaderWrapper;
+	class DepthTexture;
+	class RenderCamera;
+	class PhongLight;
+	class SceneStore;
+	class InstancedMesh;
+	class StaticBatch;
+}
+
+namespace SPRON {
+	// Must match SHADOW_MAX_VIEWS in the forward header and the caster geometry shader's invocations
+	static const unsigned int SHADOW_MAX_VIEWS = 6;
+
+	static_assert(SHADOW_CASCADE_COUNT <= 4, "ERROR::SHADOW_ATLAS::CASCADE_ENDS_ARE_A_VEC4");
+
+	/**
+	*	@brief Static singleton class that renders every light's shadow maps into tiles of a single depth atlas, so any light is shaded with one sampler.
+	*	Tiles are allocated from a quadtree over the atlas and sized by how important each light is to the viewer: directional lights render
+	*	SHADOW_CASCADE_COUNT cascades, point lights a view per cube face and spot lights a single perspective view.
+	*	Static casters are rendered into a second atlas that is only refreshed when a view's matrix changes, the live atlas is then updated by copying
+	*	a view's static tile and drawing just the dynamic casters over it whenever a dynamic caster in the view moves.
+	*	Views that need updating are refreshed a light at a time within a per-frame texel budget, lights waiting longer are picked first.
+	*	NOTE: A light is only shadowed once all of its views have been rendered, until then it is shaded without shadows.
+	*/
+	class ShadowAtlas {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static void Begin(RenderCamera* a_camera, const std::vector<PhongLight*>& a_lights);
+		static void AddCasters(SceneStore* a_scene);
+		static void AddCasters(InstancedMesh* a_instancedMesh);
+		static void AddCasters(StaticBatch* a_staticBatch);
+		static void Render();
+
+		static void SetShadowUniforms(ShaderWrapper* a_program, PhongLight* a_light);
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static ShadowAtlas* m_stn;		// Singleton instance
+
+		// State of a quadtree node, one per tile of every size
+		enum eNodeState : unsigned char {
+			NODE_FREE,
+			NODE_SPLIT,		// Some of its children are used
+			NODE_USED
+		};
+
+		// Tile of the atlas, a node of the quadtree
+		struct ShadowTile {
+			unsigned int level;		// Depth in the quadtree, the tile is the atlas size >> level texels wide
+			unsigned int index;		// y * tiles per row + x
+		};
+
+		// Geometry rendered into shadow maps
+		struct ShadowCaster {
+			unsigned int	geometry;
+			unsigned int	firstIndex;		// Relative to the geometry's first index
+			unsigned int	indexCount;		// 0 draws the whole geometry
+			glm::mat4		world;
+			AABB			bounds;			// World space
+			InstancedMesh*	instances;		// Every instance is drawn by one instanced draw, nullptr for a single object
+			uint64_t		version;		// Transform version of the instances, stands in for the world matrix when hashing
+		};
+
+		// One shadow map of a light, a cascade, cube face or spot light
+		struct ShadowView {
+			glm::mat4	viewProjection;		// This frame's
+			Frustum		frustum;
+			float		cascadeEnd;			// View space distance the cascade ends at, directional lights only
+			ShadowTile	tile;
+
+			// Static atlas
+			glm::mat4	staticMatrix;		// View projection the static tile was rendered with
+			bool		isStaticValid;		// False until rendered into the current tile
+
+			// Live atlas
+			glm::mat4	renderedMatrix;		// View projection the live tile was rendered with, shading uses this one
+			float		renderedCascadeEnd;
+			uint64_t	renderedHash;		// Dynamic casters in the live tile
+			uint64_t	dynamicHash;		// Dynamic casters in the view this frame
+			bool		hasContent;
+		};
+
+		struct ShadowLight {
+			PhongLight*		light;
+			float			importance;			// 0 when none of the light's range is in view, up to 1
+			int				level;				// Quadtree level of each of its tiles, -1 when it has none
+			unsigned int	viewCount;
+			unsigned int	framesPending;		// Frames its pending views have waited for an update
+			bool			isSeen;				// Still in the scene's lights this frame
+			ShadowView		views[SHADOW_MAX_VIEWS];
+
+			// Shading data, in the layout of the forward header's shadow uniforms
+			bool			isReady;
+			glm::mat4		shadowMatrices[SHADOW_MAX_VIEWS];
+			glm::vec4		shadowTiles[SHADOW_MAX_VIEWS];
+			glm::vec4		cascadeEnds;
+		};
+
+		/// Light views
+		void UpdateViews(ShadowLight& a_light, RenderCamera* a_camera);
+		void UpdateCascades(ShadowLight& a_light, RenderCamera* a_camera);
+		float CalculateImportance(PhongLight* a_light) const;
+		int ChooseLevel(float a_importance, int a_currentLevel) const;
+		void AllocateTiles();
+
+		/// Quadtree
+		bool AllocateLight(ShadowLight& a_light, int a_level);
+		void FreeLight(ShadowLight& a_light);
+		int AllocateNode(unsigned int a_level, unsigned int a_x, unsigned int a_y, unsigned int a_targetLevel);
+		void FreeNode(unsigned int a_level, unsigned int a_index);
+		glm::uvec3 GetTileRect(const ShadowTile& a_tile) const;
+
+		/// Rendering
+		static bool IsPending(const ShadowView& a_view);
+		static bool IsStaticStale(const ShadowView& a_view);
+		void UpdateLight(ShadowLight& a_light);
+		void DrawViews(ShadowLight& a_light, const unsigned int* a_views, unsigned int a_viewCount, const std::vector<ShadowCaster>& a_casters);
+		void UpdateShadingData(ShadowLight& a_light);
+
+		// Instance variables
+		DepthTexture*	m_liveAtlas;		// Compared, sampled by the light passes
+		DepthTexture*	m_staticAtlas;		// Static casters only, copied into the live atlas
+		unsigned int	m_liveFrameBufferID;
+		unsigned int	m_staticFrameBufferID;
+
+		ShaderWrapper*	m_casterProgram;
+
+		std::vector<std::vector<unsigned char>>	m_nodes;		// Node states per quadtree level, level L is 2^L by 2^L tiles
+		unsigned int	m_maxTileLevel;		// Level of SHADOW_MAX_TILE_SIZE tiles
+		unsigned int	m_minTileLevel;		// Level of SHADOW_MIN_TILE_SIZE tiles
+		unsigned int	m_usedTexels;
+
+		std::vector<ShadowLight>					m_lights;
+		std::unordered_map<PhongLight*, unsigned int>	m_lightLookup;	// Light -> entry in m_lights, rebuilt every Begin
+		std::vector<unsigned int>					m_order;		// Light entries by priority, re-used between frames
+
+		glm::vec3		m_viewerPos;
+		Frustum			m_cameraFrustum;
+
+		std::vector<ShadowCaster>	m_staticCasters;		// Never move, cached in the static atlas
+		std::vector<ShadowCaster>	m_dynamicCasters;		// Redrawn into a view whenever one of them in it moves
+
+		std::vector<unsigned int>			m_drawList;				// Single object casters drawn by the current draw
+		std::vector<unsigned int>			m_instancedDrawList;	// Instanced mesh casters drawn by the current draw
+		std::vector<IndirectDrawCommand>	m_commands;
+
+		int				m_updateBudget;		// Texels rendered per frame before updates are deferred to later frames
+
+		// Statistics
+		unsigned int m_shadowedLights;		// Lights with every view rendered
+		unsigned int m_updatedLights;		// Lights updated in the last Render
+		unsigned int m_deferredLights;		// Lights with pending views left for a later frame
+		unsigned int m_staticViews;			// Views re-rendered into the static atlas
+		unsigned int m_dynamicViews;		// Views refreshed in the live atlas
+		unsigned int m_updatedTexels;
+		unsigned int m_evictions;			// Lights that lost their tiles to more important lights
+
+		ShadowAtlas();
+		~ShadowAtlas();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "StaticBatch.h"
+#include "Mesh.h"
+#include "InstancedMesh.h"
+#include "VertexFormat.h"
+#include "Transform.h"
+#include "ModelAsset.h"
+#include "ModelInstance.h"
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+#include <algorithm>
+
+namespace SPRON {
+
+	StaticBatch::StaticBatch() : m_mesh(nullptr), m_format(nullptr)
+	{
+	}
+
+	StaticBatch::~StaticBatch()
+	{
+		delete m_mesh;
+		delete m_format;
+	}
+
+	/**
+	*	@brief Merge the meshes of every static instance into one batch per material.
+	*	Vertices are transformed into world space and indices are offset into the merged vertex list, each source mesh becomes a sub-range.
+	*	O(V) complexity where V = number of vertices in the static instances
+	*	@param a_instances is the scene's model instances, only the static ones are merged.
+	*	@return the built batches, to be deleted by the caller.
+	*/
+	std::vector<StaticBatch*> StaticBatch::Build(const std::vector<ModelInstance*>& a_instances)
+	{
+		// Geometry collected for one material
+		struct BatchData {
+			unsigned int				materialIndex;		// Identical materials share an index, so it is used as the grouping key
+			const Material*				material;
+			std::vector<Vertex>			vertices;
+			std::vector<unsigned int>	indices;
+			std::vector<SubRange>		subRanges;
+		};
+
+		std::vector<BatchData> batchData;
+
+		for (unsigned int i = 0; i < a_instances.size(); ++i) {
+			if (!a_instances[i]->IsStatic()) { continue; }
+
+			glm::mat4 modelTransform = a_instances[i]->GetTransform()->GetGlobalMatrix();
+			glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(modelTransform)));		// Keeps normals perpendicular under non-uniform scale
+
+			const std::vector<InstancedMesh*>& meshes = a_instances[i]->GetAsset()->GetModelMeshes();
+
+			for (unsigned int j = 0; j < meshes.size(); ++j) {
+				Mesh* mesh = meshes[j]->GetMesh();
+
+				// Find the batch for the mesh's material
+				unsigned int batchIndex = 0;
+				while (batchIndex < batchData.size() && batchData[batchIndex].materialIndex != mesh->GetMaterialIndex()) { ++batchIndex; }
+
+				if (batchIndex == batchData.size()) {
+					batchData.push_back(BatchData());
+					batchData.back().materialIndex = mesh->GetMaterialIndex();
+					batchData.back().material = &mesh->GetMaterial();
+				}
+
+				BatchData& batch = batchData[batchIndex];
+
+				unsigned int baseVertex = (unsigned int)batch.vertices.size();
+
+				SubRange subRange;
+				subRange.firstIndex = (unsigned int)batch.indices.size();
+
+				/// Pre-transform vertices
+				std::vector<Vertex> vertices = mesh->GetVerticeData();
+				if (vertices.empty()) { continue; }
+
+				glm::vec3 minPos = glm::vec3(modelTransform * vertices[0].pos);
+				glm::vec3 maxPos = minPos;
+
+				for (unsigned int k = 0; k < vertices.size(); ++k) {
+					Vertex vert = vertices[k];
+
+					vert.pos = modelTransform * vert.pos;
+					vert.normal = glm::normalize(normalTransform * vert.normal);
+
+					glm::vec3 tangent = glm::normalize(glm::mat3(modelTransform) * glm::vec3(vert.normalTangent));
+					vert.normalTangent = glm::vec4(tangent, vert.normalTangent.w);		// Keep handedness
+
+					minPos = glm::min(minPos, glm::vec3(vert.pos));
+					maxPos = glm::max(maxPos, glm::vec3(vert.pos));
+
+					batch.vertices.push_back(vert);
+				}
+
+				/// Offset indices into the merged vertex list
+				const std::vector<unsigned int>& indices = mesh->GetVertexFormat()->GetIndices();
+
+				if (indices.size() <= 1) {		// Mesh has no preset draw format, draw vertices in order
+					for (unsigned int k = 0; k < vertices.size(); ++k) { batch.indices.push_back(baseVertex + k); }
+				}
+				else {
+					for (unsigned int k = 0; k < indices.size(); ++k) { batch.indices.push_back(baseVertex + indices[k]); }
+				}
+
+				subRange.indexCount = (unsigned int)batch.indices.size() - subRange.firstIndex;
+
+				// Fit a sphere around the transformed vertices, centered on their bounding box
+				subRange.boundsCenter = (minPos + maxPos) * 0.5f;
+				subRange.boundsRadius = 0.f;
+
+				for (unsigned int k = baseVertex; k < batch.vertices.size(); ++k) {
+					subRange.boundsRadius = std::max(subRange.boundsRadius, glm::length(glm::vec3(batch.vertices[k].pos) - subRange.boundsCenter));
+				}
+
+				batch.subRanges.push_back(subRange);
+			}
+		}
+
+		/// Upload merged geometry
+		std::vector<StaticBatch*> batches;
+
+		for (unsigned int i = 0; i < batchData.size(); ++i) {
+			if (batchData[i].vertices.empty()) { continue; }
+
+			StaticBatch* batch = new StaticBatch();
+			batch->m_format = new VertexFormat(batchData[i].indices);
+			batch->m_mesh = new Mesh(batchData[i].vertices, batch->m_format, new Transform(), *batchData[i].material);
+			batch->m_subRanges = batchData[i].subRanges;
+
+			batches.push_back(batch);
+		}
+
+		return batches;
+	}
+
+	/**
+	*	@brief Draw the whole batch without culling its sub-ranges.
+	*	@return void.
+	*/
+	void StaticBatch::Draw(RenderCamera * a_camera, const std::vector<PhongLight*>& a_lights, ShaderWrapper * a_ambientPass,
+		ShaderWrapper * a_directionalPass, ShaderWrapper * a_pointPass, ShaderWrapper * a_spotPass, ShaderWrapper * a_debugPass)
+	{
+		m_mesh->Draw(a_camera, a_lights, a_ambientPass, a_directionalPass, a_pointPass, a_spotPass, a_debugPass);
+	}
+}
\ No newline at end of file
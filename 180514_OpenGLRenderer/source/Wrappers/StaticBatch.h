@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec3.hpp>
+
+namespace SPRON {
+	class Mesh;
+	class VertexFormat;
+	class ModelInstance;
+	class RenderCamera;
+	class PhongLight;
+	class ShaderWrapper;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Meshes of static model instances that share a material, pre-transformed into world space and merged into a single mesh when the scene is built.
+	*	The indices of each source mesh stay a separate sub-range with its own bounding sphere, so the render queue can still cull them individually
+	*	and only draws the runs of visible sub-ranges.
+	*	NOTE: Static instances must not be moved after the batches are built, their transforms are baked into the vertices.
+	*/
+	class StaticBatch {
+	public:
+		// Indices of one source mesh within the batch
+		struct SubRange {
+			unsigned int	firstIndex;			// Relative to the batch mesh's first index
+			unsigned int	indexCount;
+			glm::vec3		boundsCenter;		// World space bounding sphere
+			float			boundsRadius;
+		};
+
+		static std::vector<StaticBatch*> Build(const std::vector<ModelInstance*>& a_instances);
+
+		~StaticBatch();
+
+		void Draw(RenderCamera* a_camera,
+			const std::vector<PhongLight*>& a_lights, ShaderWrapper* a_ambientPass,
+			ShaderWrapper* a_directionalPass, ShaderWrapper* a_pointPass, ShaderWrapper* a_spotPass, ShaderWrapper* a_debugPass);
+
+		Mesh* GetMesh() { return m_mesh; }
+		const std::vector<SubRange>& GetSubRanges() const { return m_subRanges; }
+	protected:
+	private:
+		StaticBatch();
+
+		Mesh*					m_mesh;			// Merged world space geometry, drawn with an identity transform
+		VertexFormat*			m_format;		// Merged indices, owned by the batch unlike regular meshes' formats
+		std::vector<SubRange>	m_subRanges;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "StreamBuffer.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <assert.h>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace SPRON {
+
+	/**
+	*	@brief Create the buffer's immutable storage and map it for the lifetime of the stream.
+	*	NOTE: Must be called after the openGL functions have been loaded.
+	*	@param a_regionSize is the number of bytes that can be allocated each frame.
+	*/
+	StreamBuffer::StreamBuffer(unsigned int a_regionSize) :
+		m_bufferID(0), m_mappedData(nullptr), m_regionSize(0), m_region(0), m_head(0),
+		m_waitCount(0), m_totalWaitCount(0), m_waitTime(0.f), m_wrapCount(0)
+	{
+		for (unsigned int i = 0; i < STREAM_BUFFER_FRAMES; ++i) { m_fences[i] = nullptr; }
+
+		// Regions are bound as uniform and shader storage ranges, so their starts must meet both offset alignments
+		int uniformAlignment = 0, storageAlignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+
+		unsigned int regionAlignment = (unsigned int)std::max(1, std::max(uniformAlignment, storageAlignment));
+		m_regionSize = (a_regionSize + regionAlignment - 1) / regionAlignment * regionAlignment;
+
+		unsigned int bufferSize = m_regionSize * STREAM_BUFFER_FRAMES;
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;		// NOTE: Coherent so writes are visible to the GPU without flushing
+
+		glGenBuffers(1, &m_bufferID);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);		// NOTE: Copy target so no other binding is modified
+		glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, flags);
+		m_mappedData = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, flags);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// Error handling
+		try {
+			if (!m_mappedData) {
+				char errorMsg[256];
+				sprintf_s(errorMsg, "ERROR::STREAM_BUFFER::MAP_FAILED: %u bytes", bufferSize);
+
+				throw std::runtime_error(errorMsg);
+			}
+		}
+		catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		for (unsigned int i = 0; i < STREAM_BUFFER_FRAMES; ++i) {
+			if (m_fences[i]) { glDeleteSync((GLsync)m_fences[i]); }
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufferID);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &m_bufferID);
+	}
+
+	/**
+	*	@brief Move on to the next region, blocking until the GPU has finished the frame that last used it.
+	*	@return void.
+	*/
+	void StreamBuffer::BeginFrame()
+	{
+		// Statistics are kept per frame
+		m_waitCount = 0;
+		m_waitTime = 0.f;
+		m_wrapCount = 0;
+
+		m_region = (m_region + 1) % STREAM_BUFFER_FRAMES;
+		m_head = 0;
+
+		WaitForFence(m_region);
+	}
+
+	/**
+	*	@brief Fence the current region after every command that reads from it has been issued.
+	*	@return void.
+	*/
+	void StreamBuffer::EndFrame()
+	{
+		if (m_fences[m_region]) { glDeleteSync((GLsync)m_fences[m_region]); }		// Region wrapped this frame, the new fence covers everything
+
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	/**
+	*	@brief Bump allocate a range of the current region.
+	*	NOTE: If the region is full it is wrapped, which stalls until the GPU has finished every command issued so far.
+	*	@param a_size is the number of bytes to allocate.
+	*	@param a_alignment is the alignment of the range relative to the start of the region, does not need to be a power of 2.
+	*	@return mapped pointer and buffer offset of the range, data is nullptr if the range can never fit in a region.
+	*/
+	StreamAllocation StreamBuffer::Allocate(unsigned int a_size, unsigned int a_alignment)
+	{
+		StreamAllocation allocation = { nullptr, 0 };
+
+		// Error handling
+		try {
+			if (a_size > m_regionSize) {
+				char errorMsg[256];
+				sprintf_s(errorMsg, "ERROR::STREAM_BUFFER::REGION_TOO_SMALL: %u bytes requested, %u fit", a_size, m_regionSize);
+
+				throw std::runtime_error(errorMsg);
+			}
+		}
+		catch (std::exception const& e) {
+			std::cout << "Exception: " << e.what() << std::endl;
+			return allocation;
+		}
+
+		if (!Fits(a_size, a_alignment)) { Wrap(); }
+
+		unsigned int alignedHead = (m_head + a_alignment - 1) / a_alignment * a_alignment;
+
+		allocation.offset = GetRegionOffset() + alignedHead;
+		allocation.data = m_mappedData + allocation.offset;
+
+		m_head = alignedHead + a_size;
+
+		return allocation;
+	}
+
+	/**
+	*	@brief Check whether a range can be allocated from the current region without wrapping.
+	*	@param a_size is the number of bytes to allocate.
+	*	@param a_alignment is the alignment of the range relative to the start of the region.
+	*	@return true if the range fits.
+	*/
+	bool StreamBuffer::Fits(unsigned int a_size, unsigned int a_alignment) const
+	{
+		unsigned int alignedHead = (m_head + a_alignment - 1) / a_alignment * a_alignment;
+
+		return alignedHead + a_size <= m_regionSize;
+	}
+
+	/**
+	*	@brief Start writing from the beginning of the current region again, once the GPU has caught up with the commands that read from it.
+	*	NOTE: This is a full pipeline stall, the region size should be large enough that it never happens in a normal frame.
+	*	@return void.
+	*/
+	void StreamBuffer::Wrap()
+	{
+		if (m_fences[m_region]) { glDeleteSync((GLsync)m_fences[m_region]); }
+
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		WaitForFence(m_region);
+
+		m_head = 0;
+		m_wrapCount++;
+	}
+
+	/**
+	*	@brief Block until a region's fence has been signalled, then delete it.
+	*	@param a_region is the region to wait for.
+	*	@return void.
+	*/
+	void StreamBuffer::WaitForFence(unsigned int a_region)
+	{
+		GLsync fence = (GLsync)m_fences[a_region];
+		if (!fence) { return; }
+
+		GLenum result = glClientWaitSync(fence, 0, 0);		// Poll first so the common case is not counted as a wait
+
+		if (result == GL_TIMEOUT_EXPIRED) {
+			auto waitStart = std::chrono::high_resolution_clock::now();
+
+			// NOTE: Flush bit so the fence is guaranteed to reach the GPU, otherwise waiting on it could never return
+			do { result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); } while (result == GL_TIMEOUT_EXPIRED);
+
+			m_waitTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+			m_waitCount++;
+			m_totalWaitCount++;
+		}
+
+		assert(result != GL_WAIT_FAILED && "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED");
+
+		glDeleteSync(fence);
+		m_fences[a_region] = nullptr;
+	}
+
+	/**
+	*	@brief Display the current frame's usage and fence statistics.
+	*	@param a_label is the name of the stream.
+	*	@return void.
+	*/
+	void StreamBuffer::ListenIMGUI(const char * a_label)
+	{
+		ImGui::Text("%s: %u / %u bytes (region %u)", a_label, m_head, m_regionSize, m_region);
+		ImGui::Text("%s fence waits: %u (%.3f ms), %u total", a_label, m_waitCount, m_waitTime, m_totalWaitCount);
+		ImGui::Text("%s wraps: %u", a_label, m_wrapCount);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Renderer_Utility_Literals.h"
+
+namespace SPRON {
+	// Part of a stream buffer written by the CPU during the current frame
+	struct StreamAllocation {
+		void*			data;			// Persistently mapped memory to write to
+		unsigned int	offset;			// Bytes from the start of the buffer, used to bind or point attributes at the data
+	};
+
+	/**
+	*	@brief Buffer that is mapped once for its whole lifetime and split into one region per frame in flight, so the CPU writes straight into memory the GPU reads from.
+	*	A fence is inserted after each frame's commands and a region is only written again once the GPU has signalled the fence of the last frame that used it.
+	*	NOTE: Allocations are bump allocated from the current region and are only valid for the frame they were made in.
+	*/
+	class StreamBuffer {
+	public:
+		StreamBuffer(unsigned int a_regionSize);
+		~StreamBuffer();
+
+		void BeginFrame();
+		void EndFrame();
+
+		StreamAllocation Allocate(unsigned int a_size, unsigned int a_alignment = 1);
+		bool Fits(unsigned int a_size, unsigned int a_alignment = 1) const;
+		void Wrap();
+
+		unsigned int GetBufferID() const { return m_bufferID; }
+		unsigned int GetRegionOffset() const { return m_region * m_regionSize; }
+		unsigned int GetRegionSize() const { return m_regionSize; }
+		unsigned int GetRegionUsed() const { return m_head; }
+
+		// Statistics
+		unsigned int GetFenceWaitCount() const { return m_waitCount; }
+		unsigned int GetTotalFenceWaitCount() const { return m_totalWaitCount; }
+		float GetFenceWaitTime() const { return m_waitTime; }
+		unsigned int GetWrapCount() const { return m_wrapCount; }
+
+		void ListenIMGUI(const char* a_label);
+	protected:
+	private:
+		void WaitForFence(unsigned int a_region);
+
+		unsigned int	m_bufferID;
+		char*			m_mappedData;					// Start of the whole buffer, mapped persistently and coherently
+		unsigned int	m_regionSize;					// Rounded up so every region starts on a valid uniform and shader storage binding offset
+
+		unsigned int	m_region;						// Region written this frame
+		unsigned int	m_head;							// Next free byte in the current region
+		void*			m_fences[STREAM_BUFFER_FRAMES];	// GLsync of the last frame that used each region, nullptr once waited on
+
+		// Statistics
+		unsigned int	m_waitCount;					// Fences this frame that were not signalled yet, i.e. the CPU got ahead of the GPU
+		unsigned int	m_totalWaitCount;
+		float			m_waitTime;						// Milliseconds spent blocked on fences this frame
+		unsigned int	m_wrapCount;					// Times a region ran out mid frame and the GPU had to catch up
+	};
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "Texture/DepthTexture.h"
+#include "Texture/TextureBinder.h"
+
+#include <gl_core_4_4.h>
+
+namespace SPRON {
+	DepthTexture::DepthTexture(unsigned int a_width, unsigned int a_height, bool a_isCompared) : TextureWrapperBase(GL_TEXTURE_2D)
+	{
+		// Create texture on GPU
+		glGenTextures(1, &m_ID);
+
+		// Bind to scratch unit so texture calls apply to it
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, m_ID);
+
+		glTexImage2D(
+			GL_TEXTURE_2D,
+			0,							// No mipmapping for depth textures
+			GL_DEPTH_COMPONENT24,
+			a_width,
+			a_height,
+			0,
+			GL_DEPTH_COMPONENT,
+			GL_FLOAT,
+			NULL);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		if (a_isCompared) {		// Linear filtering blends the 4 nearest comparisons (hardware PCF)
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		}
+		else {
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		}
+	}
+
+	DepthTexture::~DepthTexture()
+	{
+		// Clean up openGL texture object
+		TextureBinder::Forget(m_ID);
+		glDeleteTextures(1, &m_ID);
+	}
+}
\ No newline at end of file
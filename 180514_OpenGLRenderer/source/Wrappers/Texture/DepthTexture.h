@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Texture/TextureWrapperBase.h"
+
+namespace SPRON {
+	/**
+	*	@brief Inherited class that handles wrapping depth textures to be attached to frame buffers as their depth attachment.
+	*	NOTE: Depth compared textures can only be sampled with shadow samplers, which filter the results of the comparisons instead of the depths.
+	*/
+	class DepthTexture : public TextureWrapperBase {
+	public:
+		DepthTexture(unsigned int a_width, unsigned int a_height, bool a_isCompared = false);
+		virtual ~DepthTexture();
+	protected:
+	private:
+	};
+}
\ No newline at end of file
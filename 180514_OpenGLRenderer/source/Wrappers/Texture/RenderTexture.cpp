@@ -1,16 +1,16 @@
 #include "Texture/RenderTexture.h"
+#include "Texture/TextureBinder.h"
 
 #include <gl_core_4_4.h>
 
 namespace SPRON {
-	RenderTexture::RenderTexture(unsigned int a_width, unsigned int a_height) : TextureWrapperBase()		// Assign valid texture unit
+	RenderTexture::RenderTexture(unsigned int a_width, unsigned int a_height) : TextureWrapperBase(GL_TEXTURE_2D)
 	{
 		// Create texture on GPU
 		glGenTextures(1, &m_ID);
 
-		// Activate corresponding texture unit so that binding the texture sets it to that texture unit address
-		glActiveTexture(GetTexUnitEnum());
-		glBindTexture(GL_TEXTURE_2D, *this);
+		// Bind to scratch unit so texture calls apply to it
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, m_ID);
 
 		// Set render texture data (usually dimensions of screen, empty data)
 		glTexImage2D(
@@ -33,6 +33,7 @@ namespace SPRON {
 	RenderTexture::~RenderTexture()
 	{
 		// Clean up openGL texture object
+		TextureBinder::Forget(m_ID);
 		glDeleteTextures(1, &m_ID);
 	}
 }
\ No newline at end of file
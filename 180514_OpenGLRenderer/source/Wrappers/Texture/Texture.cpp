@@ -1,4 +1,5 @@
 #include "Texture/Texture.h"
+#include "Texture/TextureArray.h"
 
 #define STB_IMAGE_IMPLEMENTATION	// Modify image loading header file to include relevant source code, like including a .cpp
 #include <stb/stb_image.h>
@@ -13,7 +14,7 @@ namespace SPRON {
 	*	@param a_filePath is the path to the texture file, including its extension.
 	*	@param a_type is the type of texture that is being loaded in (e.g. TEXTURE_DIFFUSE).
 	*/
-	Texture::Texture(const char * a_filePath, const std::string& a_type, eFilteringOption a_filterOption) : TextureWrapperBase() // Assign valid texture unit
+	Texture::Texture(const char * a_filePath, const std::string& a_type, eFilteringOption a_filterOption) : TextureWrapperBase(GL_TEXTURE_2D_ARRAY), m_array(nullptr)
 	{
 		m_type = a_type;
 
@@ -36,50 +37,23 @@ namespace SPRON {
 		}
 		catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
 
-		// Create texture on GPU
-		glGenTextures(1, &m_ID);
+		if (!m_texData) { return; }		// Nothing to upload, texture stays unbound (ID of 0)
 
-		// Activate corresponding texture unit so that binding the texture sets it to that texture unit address
-		glActiveTexture(GetTexUnitEnum());
-		glBindTexture(GL_TEXTURE_2D, *this);
+		// Determine format based off the number of channels in the image (e.g. 3 channels = RGB for stuff like .jpgs)
+		GLenum format = GL_RGB;				// Format of SOURCE texture
+		GLenum internalFormat = GL_RGB8;	// Sized format to STORE texture in, required for immutable array storage
 
-		// Set texture data
-		GLenum format = GL_RGB;			// Determine format based off the number of channels in the image (e.g. 3 channels = RGB for stuff like .jpgs)
+		if (m_channelNum == 1) { format = GL_RED; internalFormat = GL_R8; }
+		if (m_channelNum == 3) { format = GL_RGB; internalFormat = GL_RGB8; }
+		if (m_channelNum == 4) { format = GL_RGBA; internalFormat = GL_RGBA8; }
 
-		if (m_channelNum == 1) { format = GL_RED; }
-		if (m_channelNum == 3) { format = GL_RGB; }
-		if (m_channelNum == 4) { format = GL_RGBA; }
-
-		glTexImage2D(	// NOTE: Applies to currently bound texture
-			GL_TEXTURE_2D,		// Enum for texture dimension
-			0,					// Mipmap level (0 by default)
-			format,				// Format to STORE texture in
-			m_texWidth,			// Width of texture (pixels)
-			m_texHeight,		// Height of texture (pixels)
-			0,					// Legacy parameter, must be 0
-			format,				// Format of SOURCE texture
-			GL_UNSIGNED_BYTE,	// Type of data in source texture
-			m_texData);			// Memory location of texture data
-
-		// Account for one channel specular images
-		if (m_type == "texture_specular") {
-
-			GLint swizzleMask[] = { GL_RED, GL_RED, GL_RED, GL_ALPHA };		// Map red channel across color channels so shaders interpret grayscale
-			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
-		}
-
-		// Set texture attributes
-		switch (a_filterOption) {
-			case FILTERING_LINEAR:
-				EnableFiltering();
-				break;
-			case FILTERING_MIPMAP:
-				EnableMipmapping();
-				break;
-		}
-
-		EnableWrapping();
+		// Pack into array shared with textures of the same size, format and sampling state (sets ID and layer)
+		m_array = TextureArray::Acquire(
+			m_texWidth, m_texHeight, internalFormat,
+			a_filterOption == FILTERING_MIPMAP,		// Mipmapped arrays are allocated with a full mip chain
+			m_type == "texture_specular");			// Account for one channel specular images
 
+		m_array->AddLayer(this, m_texData, format);
 	}
 
 	Texture::~Texture()
@@ -87,51 +61,47 @@ namespace SPRON {
 		// Clean up texture data
 		stbi_image_free(m_texData);
 
-		// Clean up openGL texture object
-		glDeleteTextures(1, &m_ID);
+		// Free layer, the openGL texture object is owned by the array
+		if (m_array) { TextureArray::Release(m_array, m_layer); }
+	}
+
+	/**
+	*	@brief Finish any deferred work on the array before the texture is bound for sampling.
+	*	@return void.
+	*/
+	void Texture::PrepareForSampling()
+	{
+		if (m_array) { m_array->PrepareForSampling(); }
 	}
 
 	/**
 	*	@brief Activate bilinear filtering techniques in upscaling and downscaling textures.
+	*	NOTE: Sampling state belongs to the texture array, so this applies to every texture packed into the same array.
 	*	@return void.
 	*/
 	void Texture::EnableFiltering()
 	{
-		// Bind texture to modify its parameters
-		glBindTexture(GL_TEXTURE_2D, *this);
-
-		// (GL_NEAREST = take color of pixel whose center is closest to texture coord, GL_LINEAR = get average color from neighboring pixels to texture coord)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);			// Filtering mode for scaling down textures
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);			// Filtering mode for scaling up textures (Bilinear)
+		if (m_array) { m_array->EnableFiltering(); }
 	}
 
 	/**
-	*	@brief Generate mip maps and enable downscaling mipmap linear technique and upscale linear filtering on texture.
-	*	NOTE: This is enabled as a more intensive but nicer looking option to enabling just linear filtering.
+	*	@brief Enable downscaling mipmap linear technique and upscale linear filtering on texture.
+	*	NOTE: Sampling state belongs to the texture array, so this applies to every texture packed into the same array.
 	*	@return void.
 	*/
 	void Texture::EnableMipmapping()
 	{
-		glBindTexture(GL_TEXTURE_2D, *this);
-
-		// NOTE: This technique is for downscaling only, setting a mipmap method to the magnification filter will do nothing and will generate an openGL error
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);		// Interpolate between two closest mipmaps needed for scenario, and then get color from image with linear filtering
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// (Create collection of images from one image at varying degrees of resolution to avoid artifacts when viewing high resolution textures from far away)
-		glGenerateMipmap(GL_TEXTURE_2D);
+		if (m_array) { m_array->EnableMipmapping(); }
 	}
 
 	/**
 	*	@brief Enable un-normalised texture coordinates to wrap back around, repeating the image.
+	*	NOTE: Sampling state belongs to the texture array, so this applies to every texture packed into the same array.
 	*	@return void.
 	*/
 	void Texture::EnableWrapping()
 	{
-		glBindTexture(GL_TEXTURE_2D, *this);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);		// 2D Texture wrap mode on x axis
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);		// 2D Texture wrap mode on y axis
+		if (m_array) { m_array->EnableWrapping(); }
 	}
 
 	std::string Texture::GetType()
@@ -9,11 +9,19 @@ namespace SPRON {
 		FILTERING_LINEAR
 	};
 
+	class TextureArray;
+
+	/**
+	*	@brief Inherited class that loads an image file into a layer of a shared texture array.
+	*	NOTE: Textures with the same dimensions, format and filtering share one texture array, sampled with the texture's layer.
+	*/
 	class Texture : public TextureWrapperBase {
 	public:
 		Texture(const char* a_filePath, const std::string& a_type, eFilteringOption a_filterOption);
 		virtual ~Texture();
 
+		void PrepareForSampling() override;
+
 		void EnableFiltering();
 		void EnableMipmapping();
 		void EnableWrapping();
@@ -32,5 +40,7 @@ namespace SPRON {
 		std::string m_fileName;				// Hold onto file name to compare against other textures
 
 		unsigned char*	m_texData;
+
+		TextureArray*	m_array;			// Array the texture is packed into, nullptr if the texture failed to load
 	};
-}
+}
\ No newline at end of file
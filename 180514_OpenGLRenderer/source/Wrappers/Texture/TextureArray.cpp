@@ -0,0 +1,250 @@
+#include "Texture\TextureArray.h"
+#include "Texture\TextureWrapperBase.h"
+#include "Texture\TextureBinder.h"
+
+#include <gl_core_4_4.h>
+#include <algorithm>
+#include <assert.h>
+
+namespace SPRON {
+	/// Static initialisation
+	std::vector<TextureArray*> TextureArray::m_arrays;
+
+	TextureArray::TextureArray(int a_width, int a_height, unsigned int a_internalFormat, bool a_mipmapped, bool a_swizzleRed) :
+		m_ID(0), m_width(a_width), m_height(a_height), m_internalFormat(a_internalFormat), m_mipmapped(a_mipmapped), m_swizzleRed(a_swizzleRed),
+		m_levelCount(1), m_mipsDirty(false), m_minFilter(GL_LINEAR), m_magFilter(GL_LINEAR), m_wrapMode(GL_REPEAT), m_usedLayerCount(0)
+	{
+		if (m_mipmapped) {
+			// Full chain down to 1x1
+			int largestSide = std::max(m_width, m_height);
+			while (largestSide > 1) { largestSide >>= 1; m_levelCount++; }
+
+			m_minFilter = GL_LINEAR_MIPMAP_LINEAR;
+		}
+	}
+
+	TextureArray::~TextureArray()
+	{
+		// Clean up openGL texture object
+		if (m_ID != 0) {
+			TextureBinder::Forget(m_ID);
+			glDeleteTextures(1, &m_ID);
+		}
+	}
+
+	/**
+	*	@brief Find an array the texture can be packed into, or create one if none match.
+	*	@param a_width is the width of the texture in pixels.
+	*	@param a_height is the height of the texture in pixels.
+	*	@param a_internalFormat is the sized format to store the texture in e.g. GL_RGBA8.
+	*	@param a_mipmapped is whether the texture is sampled with mipmaps.
+	*	@param a_swizzleRed is whether the red channel is mapped across the color channels (one channel specular maps).
+	*	@return array to add the texture's layer to.
+	*/
+	TextureArray * TextureArray::Acquire(int a_width, int a_height, unsigned int a_internalFormat, bool a_mipmapped, bool a_swizzleRed)
+	{
+		for (unsigned int i = 0; i < m_arrays.size(); ++i) {
+			TextureArray* arr = m_arrays[i];
+
+			if (arr->m_width == a_width && arr->m_height == a_height && arr->m_internalFormat == a_internalFormat &&
+				arr->m_mipmapped == a_mipmapped && arr->m_swizzleRed == a_swizzleRed) {
+				return arr;
+			}
+		}
+
+		m_arrays.push_back(new TextureArray(a_width, a_height, a_internalFormat, a_mipmapped, a_swizzleRed));
+
+		return m_arrays.back();
+	}
+
+	/**
+	*	@brief Free a texture's layer, deleting the array once no layers are in use.
+	*	@param a_array is the array the texture was added to.
+	*	@param a_layer is the layer the texture was stored in.
+	*	@return void.
+	*/
+	void TextureArray::Release(TextureArray * a_array, int a_layer)
+	{
+		assert(a_layer >= 0 && a_layer < (int)a_array->m_layers.size() && a_array->m_layers[a_layer] && "Texture array layer was not in use.");
+
+		a_array->m_layers[a_layer] = nullptr;
+		a_array->m_usedLayerCount--;
+
+		if (a_array->m_usedLayerCount == 0) {
+			m_arrays.erase(std::find(m_arrays.begin(), m_arrays.end(), a_array));
+			delete a_array;
+		}
+	}
+
+	/**
+	*	@brief Upload a texture's data into a free layer, growing the array if it is full.
+	*	NOTE: Sets the texture's ID and layer so it can be bound and sampled like any other texture.
+	*	@param a_tex is the texture the layer belongs to.
+	*	@param a_data is the texture's pixel data, must match the array's dimensions.
+	*	@param a_format is the format of the SOURCE data e.g. GL_RGBA.
+	*	@return layer the texture was stored in.
+	*/
+	int TextureArray::AddLayer(TextureWrapperBase * a_tex, const unsigned char * a_data, unsigned int a_format)
+	{
+		// Re-use a freed layer before growing
+		int layer = (int)(std::find(m_layers.begin(), m_layers.end(), nullptr) - m_layers.begin());
+
+		if (layer == (int)m_layers.size()) { Grow(); }
+
+		m_layers[layer] = a_tex;
+		m_usedLayerCount++;
+
+		a_tex->m_ID = m_ID;
+		a_tex->m_layer = layer;
+
+		// Set texture data
+		TextureBinder::BindForEdit(GL_TEXTURE_2D_ARRAY, m_ID);
+
+		glTexSubImage3D(	// NOTE: Applies to currently bound texture
+			GL_TEXTURE_2D_ARRAY,	// Enum for texture dimension
+			0,						// Mipmap level, the rest of the chain is generated before the array is next sampled
+			0, 0, layer,			// Offset of the layer in the array
+			m_width,				// Width of texture (pixels)
+			m_height,				// Height of texture (pixels)
+			1,						// Depth (one layer)
+			a_format,				// Format of SOURCE texture
+			GL_UNSIGNED_BYTE,		// Type of data in source texture
+			a_data);				// Memory location of texture data
+
+		m_mipsDirty = m_mipmapped;
+
+		return layer;
+	}
+
+	/**
+	*	@brief Generate mipmaps for layers added since the array was last sampled, so loading many textures only generates them once.
+	*	@return void.
+	*/
+	void TextureArray::PrepareForSampling()
+	{
+		if (m_mipsDirty) {
+			TextureBinder::BindForEdit(GL_TEXTURE_2D_ARRAY, m_ID);
+
+			// (Create collection of images from one image at varying degrees of resolution to avoid artifacts when viewing high resolution textures from far away)
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+			m_mipsDirty = false;
+		}
+	}
+
+	/**
+	*	@brief Activate bilinear filtering techniques in upscaling and downscaling textures.
+	*	@return void.
+	*/
+	void TextureArray::EnableFiltering()
+	{
+		// (GL_NEAREST = take color of pixel whose center is closest to texture coord, GL_LINEAR = get average color from neighboring pixels to texture coord)
+		m_minFilter = GL_LINEAR;		// Filtering mode for scaling down textures
+		m_magFilter = GL_LINEAR;		// Filtering mode for scaling up textures (Bilinear)
+
+		ApplyParameters();
+	}
+
+	/**
+	*	@brief Enable downscaling mipmap linear technique and upscale linear filtering on the array.
+	*	NOTE: Only has an effect on arrays created with mipmaps, the key textures are packed by makes sure these never have to be re-allocated.
+	*	@return void.
+	*/
+	void TextureArray::EnableMipmapping()
+	{
+		if (!m_mipmapped) { return; }
+
+		// NOTE: This technique is for downscaling only, setting a mipmap method to the magnification filter will do nothing and will generate an openGL error
+		m_minFilter = GL_LINEAR_MIPMAP_LINEAR;		// Interpolate between two closest mipmaps needed for scenario, and then get color from image with linear filtering
+		m_magFilter = GL_LINEAR;
+
+		ApplyParameters();
+	}
+
+	/**
+	*	@brief Enable un-normalised texture coordinates to wrap back around, repeating the image.
+	*	@return void.
+	*/
+	void TextureArray::EnableWrapping()
+	{
+		m_wrapMode = GL_REPEAT;
+
+		ApplyParameters();
+	}
+
+	/**
+	*	@brief Get the number of layers in use across all arrays.
+	*	@return number of packed textures.
+	*/
+	unsigned int TextureArray::GetLayerCount()
+	{
+		unsigned int layerCount = 0;
+
+		for (unsigned int i = 0; i < m_arrays.size(); ++i) { layerCount += m_arrays[i]->m_usedLayerCount; }
+
+		return layerCount;
+	}
+
+	/**
+	*	@brief Re-allocate storage at double the capacity and copy the existing layers across, then point every packed texture at the new storage.
+	*	@return void.
+	*/
+	void TextureArray::Grow()
+	{
+		int oldCapacity = (int)m_layers.size();
+		int newCapacity = std::max((int)MIN_CAPACITY, oldCapacity * 2);
+
+		unsigned int newID = 0;
+		glGenTextures(1, &newID);
+
+		TextureBinder::BindForEdit(GL_TEXTURE_2D_ARRAY, newID);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_levelCount, m_internalFormat, m_width, m_height, newCapacity);
+
+		if (m_ID != 0) {
+			// Copy every mip level so clean mipmaps stay clean
+			for (int level = 0; level < m_levelCount; ++level) {
+				int levelWidth = std::max(1, m_width >> level);
+				int levelHeight = std::max(1, m_height >> level);
+
+				glCopyImageSubData(
+					m_ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+					newID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+					levelWidth, levelHeight, oldCapacity);
+			}
+
+			TextureBinder::Forget(m_ID);
+			glDeleteTextures(1, &m_ID);
+		}
+
+		m_ID = newID;
+		m_layers.resize(newCapacity, nullptr);
+
+		// Textures store the ID of the array so the binder can treat them like any other texture
+		for (int i = 0; i < oldCapacity; ++i) {
+			if (m_layers[i]) { m_layers[i]->m_ID = m_ID; }
+		}
+
+		ApplyParameters();
+	}
+
+	/**
+	*	@brief Set the sampling state of the array on its current storage.
+	*	@return void.
+	*/
+	void TextureArray::ApplyParameters()
+	{
+		TextureBinder::BindForEdit(GL_TEXTURE_2D_ARRAY, m_ID);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, m_minFilter);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, m_magFilter);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, m_wrapMode);		// 2D Texture wrap mode on x axis
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, m_wrapMode);		// 2D Texture wrap mode on y axis
+
+		// Account for one channel specular images
+		if (m_swizzleRed) {
+			GLint swizzleMask[] = { GL_RED, GL_RED, GL_RED, GL_ALPHA };		// Map red channel across color channels so shaders interpret grayscale
+			glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
+		}
+	}
+}
\ No newline at end of file
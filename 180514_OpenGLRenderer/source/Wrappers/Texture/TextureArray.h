@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+namespace SPRON {
+	class TextureWrapperBase;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Shared 2D texture array that textures with the same dimensions, format and sampling state are packed into as layers.
+	*	Every layer of an array is sampled through a single binding, so meshes that only differ by texture do not need a texture bind between them.
+	*	NOTE: Storage is immutable, when the array runs out of layers it is re-allocated at double capacity and the old layers are copied across on the GPU.
+	*/
+	class TextureArray {
+	public:
+		static TextureArray* Acquire(int a_width, int a_height, unsigned int a_internalFormat, bool a_mipmapped, bool a_swizzleRed);
+		static void Release(TextureArray* a_array, int a_layer);
+
+		int AddLayer(TextureWrapperBase* a_tex, const unsigned char* a_data, unsigned int a_format);
+
+		void PrepareForSampling();
+
+		void EnableFiltering();
+		void EnableMipmapping();
+		void EnableWrapping();
+
+		static unsigned int GetArrayCount() { return (unsigned int)m_arrays.size(); }
+		static unsigned int GetLayerCount();
+	protected:
+	private:
+		static std::vector<TextureArray*> m_arrays;		// Every live array, searched when a texture is loaded
+
+		static const int MIN_CAPACITY = 4;
+
+		TextureArray(int a_width, int a_height, unsigned int a_internalFormat, bool a_mipmapped, bool a_swizzleRed);
+		~TextureArray();
+
+		void Grow();
+		void ApplyParameters();
+
+		unsigned int	m_ID;
+
+		// Key the array is shared by
+		int				m_width;
+		int				m_height;
+		unsigned int	m_internalFormat;		// Sized format e.g. GL_RGBA8
+		bool			m_mipmapped;
+		bool			m_swizzleRed;			// Map red channel across color channels for one channel images
+
+		int				m_levelCount;			// Number of mipmap levels in storage
+		bool			m_mipsDirty;			// A layer was added since mipmaps were last generated
+
+		// Sampling state, re-applied whenever the storage is re-allocated
+		int				m_minFilter;
+		int				m_magFilter;
+		int				m_wrapMode;
+
+		std::vector<TextureWrapperBase*>	m_layers;		// Texture stored in each layer, nullptr for free layers (size = capacity)
+		int									m_usedLayerCount;
+	};
+}
\ No newline at end of file
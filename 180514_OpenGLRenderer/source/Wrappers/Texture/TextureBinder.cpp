@@ -0,0 +1,169 @@
+#include "Texture\TextureBinder.h"
+#include "Texture\TextureWrapperBase.h"
+#include "Texture\TextureArray.h"
+#include "GLStateCache.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <iostream>
+
+namespace SPRON {
+	/// Static initialisation
+	TextureBinder* TextureBinder::m_stn = nullptr;
+
+	TextureBinder::TextureBinder() : m_useCounter(0),
+		m_hits(0), m_lastHits(0), m_misses(0), m_lastMisses(0), m_evictions(0), m_lastEvictions(0)
+	{
+	}
+
+	TextureBinder::~TextureBinder()
+	{
+	}
+
+	/**
+	*	@brief Create singleton and size the unit table from the queried limit of the context.
+	*	NOTE: Must be called after the openGL functions have been loaded, any future calls will be ignored.
+	*	@return void.
+	*/
+	void TextureBinder::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new TextureBinder();
+
+			int texUnitNum = 0; glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &texUnitNum);
+
+			// Error handling
+			try {
+				if (texUnitNum < 2) {		// Need the scratch unit and at least one unit to sample from
+					char errorMsg[256];
+					sprintf_s(errorMsg, "ERROR::TEXTURE_BINDER::NOT_ENOUGH_TEXTURE_UNITS: %i", texUnitNum);
+
+					throw std::runtime_error(errorMsg);
+				}
+			}
+			catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+
+			UnitSlot emptySlot = { 0, 0, 0 };
+			m_stn->m_units.resize(texUnitNum, emptySlot);
+		}
+	}
+
+	void TextureBinder::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Store the previous frame's statistics and start counting again.
+	*	@return void.
+	*/
+	void TextureBinder::BeginFrame()
+	{
+		m_stn->m_lastHits = m_stn->m_hits;
+		m_stn->m_lastMisses = m_stn->m_misses;
+		m_stn->m_lastEvictions = m_stn->m_evictions;
+
+		m_stn->m_hits = 0;
+		m_stn->m_misses = 0;
+		m_stn->m_evictions = 0;
+	}
+
+	/**
+	*	@brief Make sure a texture is bound to a unit for sampling, evicting the least recently used unit if it is not already bound.
+	*	NOTE: Textures packed into the same texture array share a binding, so binding another layer of an already bound array is free.
+	*	O(U) complexity where U = number of texture units
+	*	@param a_tex is the texture to bind.
+	*	@return texture unit the texture is bound to, to be set on the sampler uniform.
+	*/
+	unsigned int TextureBinder::Bind(TextureWrapperBase * a_tex)
+	{
+		if (*a_tex == 0) { return SCRATCH_UNIT; }		// Texture has no storage (e.g. failed to load), nothing to bind
+
+		a_tex->PrepareForSampling();
+
+		const unsigned int texture = *a_tex;
+		const unsigned int target = a_tex->GetTarget();
+
+		m_stn->m_useCounter++;
+
+		// Find unit the texture is already bound to, or the least recently used unit
+		unsigned int lruUnit = SCRATCH_UNIT + 1;
+
+		for (unsigned int i = SCRATCH_UNIT + 1; i < m_stn->m_units.size(); ++i) {
+			UnitSlot& slot = m_stn->m_units[i];
+
+			if (slot.texture == texture && slot.target == target) {		// Already bound
+				GLStateCache::BindTexture(i, target, texture);			// Filtered by the state cache, only re-issued if the cache was invalidated this frame
+				slot.lastUse = m_stn->m_useCounter;
+				m_stn->m_hits++;
+
+				return i;
+			}
+
+			if (slot.lastUse < m_stn->m_units[lruUnit].lastUse) { lruUnit = i; }
+		}
+
+		// Not bound, replace least recently used unit
+		UnitSlot& slot = m_stn->m_units[lruUnit];
+
+		if (slot.texture != 0) { m_stn->m_evictions++; }
+		m_stn->m_misses++;
+
+		GLStateCache::BindTexture(lruUnit, target, texture);
+
+		slot.target = target;
+		slot.texture = texture;
+		slot.lastUse = m_stn->m_useCounter;
+
+		return lruUnit;
+	}
+
+	/**
+	*	@brief Bind a texture to the scratch unit and make it active, so texture calls like glTexSubImage apply to it.
+	*	@param a_target is the texture target e.g. GL_TEXTURE_2D.
+	*	@param a_texture is the texture object to edit.
+	*	@return void.
+	*/
+	void TextureBinder::BindForEdit(unsigned int a_target, unsigned int a_texture)
+	{
+		GLStateCache::BindTexture(SCRATCH_UNIT, a_target, a_texture);
+		GLStateCache::SetActiveTexture(SCRATCH_UNIT);		// Unit might not have been activated if the texture was already bound to it
+	}
+
+	/**
+	*	@brief Free the units of a deleted texture so a re-used openGL name is not mistaken for an already bound texture.
+	*	@param a_texture is the deleted texture object.
+	*	@return void.
+	*/
+	void TextureBinder::Forget(unsigned int a_texture)
+	{
+		GLStateCache::ForgetTexture(a_texture);
+
+		if (!m_stn) { return; }
+
+		for (unsigned int i = 0; i < m_stn->m_units.size(); ++i) {
+			if (m_stn->m_units[i].texture == a_texture) {
+				m_stn->m_units[i].target = 0;
+				m_stn->m_units[i].texture = 0;
+				m_stn->m_units[i].lastUse = 0;
+			}
+		}
+	}
+
+	/**
+	*	@brief Display the previous frame's binding statistics.
+	*	@return void.
+	*/
+	void TextureBinder::ListenIMGUI()
+	{
+		ImGui::Begin("Texture Binding");
+
+		ImGui::Text("Texture units: %u (1 reserved for editing)", (unsigned int)m_stn->m_units.size());
+		ImGui::Text("Binds already resident: %u", m_stn->m_lastHits);
+		ImGui::Text("Binds issued: %u (%u evictions)", m_stn->m_lastMisses, m_stn->m_lastEvictions);
+		ImGui::Text("Texture arrays: %u (%u layers)", TextureArray::GetArrayCount(), TextureArray::GetLayerCount());
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
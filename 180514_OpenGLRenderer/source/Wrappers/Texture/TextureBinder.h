@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+namespace SPRON {
+	class TextureWrapperBase;
+}
+
+namespace SPRON {
+	/**
+	*	@brief Static singleton class that assigns texture units to textures when they are bound for sampling.
+	*	Units are re-used least recently used first, so any number of textures can exist as long as a single draw does not sample more than the context's unit limit.
+	*	NOTE: Unit 0 is reserved as a scratch unit for uploading and editing textures so edits never evict a texture bound for sampling.
+	*/
+	class TextureBinder {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static void BeginFrame();
+
+		static unsigned int Bind(TextureWrapperBase* a_tex);
+		static void BindForEdit(unsigned int a_target, unsigned int a_texture);
+		static void Forget(unsigned int a_texture);
+
+		static unsigned int GetUnitCount() { return (unsigned int)m_stn->m_units.size(); }
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static TextureBinder* m_stn;		// Singleton instance
+
+		static const unsigned int SCRATCH_UNIT = 0;
+
+		// Texture bound to a texture unit and when it was last used
+		struct UnitSlot {
+			unsigned int	target;
+			unsigned int	texture;
+			uint64_t		lastUse;		// 0 = never used, picked before any other unit
+		};
+
+		// Instance variables
+		std::vector<UnitSlot>	m_units;
+		uint64_t				m_useCounter;
+
+		// Statistics, the previous frame's values are kept for display
+		unsigned int m_hits, m_lastHits;
+		unsigned int m_misses, m_lastMisses;
+		unsigned int m_evictions, m_lastEvictions;
+
+		TextureBinder();
+		~TextureBinder();
+	};
+}
\ No newline at end of file
@@ -3,19 +3,24 @@
 namespace SPRON {
 	/**
 	*	@brief Pure virtual class for openGL texture wrappers.
+	*	NOTE: Textures do not own a texture unit, units are assigned when the texture is bound for sampling by the TextureBinder.
 	*/
 	class TextureWrapperBase {
 	public:
-		TextureWrapperBase();
+		TextureWrapperBase(unsigned int a_target);
 		virtual ~TextureWrapperBase() = 0;
 
-		unsigned char	GetTexUnit();
-		unsigned int	GetTexUnitEnum();
+		virtual void PrepareForSampling() {}	// Called before the texture is bound for sampling, e.g. to finish lazily generated mipmaps
+
+		unsigned int	GetTarget() { return m_target; }
+		int				GetLayer() { return m_layer; }
 
 		operator unsigned int() { return m_ID; }
 	protected:
-		unsigned int m_ID;				// Location ID for texture object
-		unsigned char m_textureUnit;	// Active texture unit that texture object has been bound to
+		unsigned int m_ID;				// Location ID for texture object, shared between all textures packed into the same texture array
+		unsigned int m_target;			// Texture target to bind to e.g. GL_TEXTURE_2D
+		int m_layer;					// Layer of the texture array the texture is stored in, 0 if it is not in an array
 	private:
+		friend class TextureArray;		// Updates the ID when the array's storage is re-allocated
 	};
 }
\ No newline at end of file
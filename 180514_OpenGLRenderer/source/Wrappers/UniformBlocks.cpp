@@ -0,0 +1,231 @@
+#include "UniformBlocks.h"
+#include "RenderCamera.h"
+#include "Transform.h"
+#include "Renderer_Utility_Literals.h"
+
+#include <gl_core_4_4.h>
+#include <imgui.h>
+#include <string.h>
+#include <iostream>
+#include <algorithm>
+
+namespace SPRON {
+	/// Static initialisation
+	UniformBlocks* UniformBlocks::m_stn = nullptr;
+
+	UniformBlocks::UniformBlocks() :
+		m_uniformAlignment(1), m_objectStream(nullptr), m_objectStride(0), m_ringSize(0), m_flushedHead(0), m_dynamicStream(nullptr),
+		m_uploadCount(0), m_uploadedBytes(0)
+	{
+	}
+
+	UniformBlocks::~UniformBlocks()
+	{
+		delete m_objectStream;
+		delete m_dynamicStream;
+	}
+
+	/**
+	*	@brief Create singleton and the stream buffers that per frame data is written to.
+	*	NOTE: Must be called after the openGL functions have been loaded, any future calls will be ignored.
+	*	@return void.
+	*/
+	void UniformBlocks::Initialise()
+	{
+		if (!m_stn) {
+			m_stn = new UniformBlocks();
+
+			int uniformAlignment = 0;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+			m_stn->m_uniformAlignment = (unsigned int)std::max(1, uniformAlignment);
+
+			/// Object stream
+			// Object blocks are indexed as an array instead of bound as ranges, so they are tightly packed at the std430 array stride
+			m_stn->m_objectStride = sizeof(ObjectUniformBlock);
+			m_stn->m_ringSize = OBJECT_UNIFORM_RING_SIZE / m_stn->m_objectStride * m_stn->m_objectStride;
+
+			m_stn->m_objectStream = new StreamBuffer(m_stn->m_ringSize);
+
+			/// Dynamic stream
+			m_stn->m_dynamicStream = new StreamBuffer(DYNAMIC_STREAM_SIZE);
+		}
+	}
+
+	void UniformBlocks::Shutdown()
+	{
+		delete m_stn;
+		m_stn = nullptr;
+	}
+
+	/**
+	*	@brief Move both streams on to their next region and point the object table at it.
+	*	NOTE: Call before anything is allocated for the frame, blocks if the GPU is still reading the region from STREAM_BUFFER_FRAMES frames ago.
+	*	@return void.
+	*/
+	void UniformBlocks::BeginFrame()
+	{
+		m_stn->m_objectStream->BeginFrame();
+		m_stn->m_dynamicStream->BeginFrame();
+
+		m_stn->m_flushedHead = 0;
+
+		BindObjectTable();
+
+		// Statistics are kept per frame
+		m_stn->m_uploadCount = 0;
+		m_stn->m_uploadedBytes = 0;
+	}
+
+	/**
+	*	@brief Fence both streams' regions.
+	*	NOTE: Call after every command that reads this frame's data has been issued, including the UI.
+	*	@return void.
+	*/
+	void UniformBlocks::EndFrame()
+	{
+		m_stn->m_objectStream->EndFrame();
+		m_stn->m_dynamicStream->EndFrame();
+	}
+
+	/**
+	*	@brief Calculate the camera data once and write it to the frame block, shared by every program that declares it.
+	*	@param a_camera is the camera to render from this frame.
+	*	@param a_globalAmbient is the global ambience to take into account when performing the ambient lighting pass.
+	*	@param a_time is the time in seconds since startup.
+	*	@return void.
+	*/
+	void UniformBlocks::SetFrameData(RenderCamera * a_camera, const glm::vec4 & a_globalAmbient, float a_time)
+	{
+		assert(a_camera && "ERROR::UNIFORM_BLOCKS::NULL_CAMERA");
+
+		m_stn->m_frameData.viewTransform = a_camera->CalculateView();
+		m_stn->m_frameData.projectionTransform = a_camera->GetProjection();
+		m_stn->m_frameData.worldViewerPos = a_camera->GetTransform()->GetPosition();
+		m_stn->m_frameData.time = a_time;
+		m_stn->m_frameData.globalAmbient = a_globalAmbient;
+
+		StreamAllocation frameBlock = AllocateDynamic(sizeof(FrameUniformBlock), m_stn->m_uniformAlignment);
+		if (!frameBlock.data) { return; }
+
+		memcpy(frameBlock.data, &m_stn->m_frameData, sizeof(FrameUniformBlock));
+
+		glBindBufferRange(GL_UNIFORM_BUFFER, UNIFORM_BINDING_FRAME, m_stn->m_dynamicStream->GetBufferID(), frameBlock.offset, sizeof(FrameUniformBlock));
+	}
+
+	/**
+	*	@brief Make sure a number of object blocks can be pushed without the ring wrapping, so every index returned for them stays valid until the next reserve.
+	*	NOTE: Use before pushing a batch of objects that are all flushed together and drawn afterwards.
+	*	@param a_objectNum is the number of object blocks that will be pushed.
+	*	@return void.
+	*/
+	void UniformBlocks::Reserve(unsigned int a_objectNum)
+	{
+		unsigned int reserveSize = a_objectNum * m_stn->m_objectStride;
+
+		// Error handling
+		try {
+			if (reserveSize > m_stn->m_ringSize) {		// Batch can never fit, later objects in the batch will overwrite earlier ones
+				char errorMsg[256];
+				sprintf_s(errorMsg, "ERROR::UNIFORM_BLOCKS::RING_TOO_SMALL: %u objects requested, %u fit", a_objectNum, m_stn->m_ringSize / m_stn->m_objectStride);
+
+				throw std::runtime_error(errorMsg);
+			}
+		}
+		catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+
+		if (m_stn->m_objectStream->GetRegionUsed() + reserveSize > m_stn->m_ringSize) {		// Not enough space left before the end, wrap early
+			Flush();
+			Wrap();
+		}
+	}
+
+	/**
+	*	@brief Sub-allocate an object block from the object stream and write the object's data straight to the mapped memory.
+	*	@param a_object is the model transform and material index of the object.
+	*	@return index of the object block in the current region, to be passed as the base instance of the draw.
+	*/
+	unsigned int UniformBlocks::PushObject(const ObjectUniformBlock & a_object)
+	{
+		if (m_stn->m_objectStream->GetRegionUsed() + m_stn->m_objectStride > m_stn->m_ringSize) {		// Region is full, wrap around
+			Flush();
+			Wrap();
+		}
+
+		StreamAllocation block = m_stn->m_objectStream->Allocate(m_stn->m_objectStride, m_stn->m_objectStride);
+
+		memcpy(block.data, &a_object, sizeof(ObjectUniformBlock));
+
+		return (block.offset - m_stn->m_objectStream->GetRegionOffset()) / m_stn->m_objectStride;
+	}
+
+	/**
+	*	@brief Mark every object block pushed since the last flush as ready to be drawn.
+	*	NOTE: The mapping is coherent so the blocks are already visible to the GPU, this only keeps track of how much was written per batch.
+	*	@return void.
+	*/
+	void UniformBlocks::Flush()
+	{
+		unsigned int pendingSize = m_stn->m_objectStream->GetRegionUsed() - m_stn->m_flushedHead;
+		if (pendingSize == 0) { return; }
+
+		m_stn->m_flushedHead = m_stn->m_objectStream->GetRegionUsed();
+
+		m_stn->m_uploadCount++;
+		m_stn->m_uploadedBytes += pendingSize;
+	}
+
+	/**
+	*	@brief Point the object table at the current region, for passes that temporarily bind another buffer in its place.
+	*	@return void.
+	*/
+	void UniformBlocks::BindObjectTable()
+	{
+		// Object indices are relative to the start of the bound range
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_OBJECTS, m_stn->m_objectStream->GetBufferID(),
+			m_stn->m_objectStream->GetRegionOffset(), m_stn->m_ringSize);
+	}
+
+	/**
+	*	@brief Bump allocate per frame data from the dynamic stream e.g. light arrays or debug geometry.
+	*	@param a_size is the number of bytes to allocate.
+	*	@param a_alignment is the alignment of the data, use the uniform or shader storage offset alignment for data bound as a range.
+	*	@return mapped pointer to write the data to and its offset in the dynamic stream's buffer, only valid for the current frame.
+	*/
+	StreamAllocation UniformBlocks::AllocateDynamic(unsigned int a_size, unsigned int a_alignment)
+	{
+		return m_stn->m_dynamicStream->Allocate(a_size, a_alignment);
+	}
+
+	unsigned int UniformBlocks::GetDynamicBufferID()
+	{
+		return m_stn->m_dynamicStream->GetBufferID();
+	}
+
+	/**
+	*	@brief Start writing object blocks from the beginning of the current region again.
+	*	NOTE: Stalls until the GPU has finished every draw issued so far, as they may still read the blocks being overwritten.
+	*	@return void.
+	*/
+	void UniformBlocks::Wrap()
+	{
+		m_stn->m_objectStream->Wrap();
+
+		m_stn->m_flushedHead = 0;
+	}
+
+	/**
+	*	@brief Display the current frame's stream usage and fence statistics.
+	*	NOTE: Fence waits mean the CPU has got STREAM_BUFFER_FRAMES frames ahead of the GPU.
+	*	@return void.
+	*/
+	void UniformBlocks::ListenIMGUI()
+	{
+		ImGui::Begin("Uniform Blocks");
+
+		ImGui::Text("Object writes: %u (%u bytes)", m_stn->m_uploadCount, m_stn->m_uploadedBytes);
+		m_stn->m_objectStream->ListenIMGUI("Objects");
+		m_stn->m_dynamicStream->ListenIMGUI("Dynamic");
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
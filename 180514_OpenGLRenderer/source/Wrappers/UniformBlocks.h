@@ -0,0 +1,115 @@
+#pragma once
+
+#include "StreamBuffer.h"
+
+#include <stddef.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class RenderCamera;
+}
+
+namespace SPRON {
+	// Fixed binding points, must match the binding layout qualifiers of the blocks in the shaders
+	enum eUniformBinding {
+		UNIFORM_BINDING_FRAME = 0
+	};
+
+	// Fixed shader storage binding points, must match the binding layout qualifiers of the buffers in the shaders
+	enum eStorageBinding {
+		STORAGE_BINDING_MATERIALS = 0,
+		STORAGE_BINDING_OBJECTS = 1,
+		STORAGE_BINDING_CULL_DRAWS = 2,			// GPU culling pass, see GPUCuller.h
+		STORAGE_BINDING_CULL_INPUT_COMMANDS = 3,
+		STORAGE_BINDING_CULL_OUTPUT_COMMANDS = 4,
+		STORAGE_BINDING_CULL_COUNTS = 5,
+		STORAGE_BINDING_VIS_DRAWS = 6,			// Visibility buffer, see VisibilityBuffer.h
+		STORAGE_BINDING_VIS_VERTICES = 7,
+		STORAGE_BINDING_VIS_INDICES = 8
+	};
+
+	// Mirror of the std140 "FrameData" shader block
+	struct FrameUniformBlock {
+		glm::mat4	viewTransform;
+		glm::mat4	projectionTransform;
+		glm::vec3	worldViewerPos;			// NOTE: vec3 has a base alignment of 16 in std140, so a float can be packed into its 4th component
+		float		time;
+		glm::vec4	globalAmbient;
+	};
+
+	// Mirror of the std430 "GPU_ObjectData" shader struct, one entry of the object table indexed per draw
+	struct ObjectUniformBlock {
+		glm::mat4	modelTransform;
+		int			materialIndex;			// Entry in the material table
+		int			padding[3];				// NOTE: Array stride is rounded up to the struct's alignment (16, from the mat4)
+	};
+
+	/// Validate C++ layouts against std140/std430 at compile time
+	static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::mat4) == 64, "ERROR::UNIFORM_BLOCKS::GLM_TYPES_NOT_TIGHTLY_PACKED");
+
+	static_assert(offsetof(FrameUniformBlock, viewTransform) == 0, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+	static_assert(offsetof(FrameUniformBlock, projectionTransform) == 64, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+	static_assert(offsetof(FrameUniformBlock, worldViewerPos) == 128, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+	static_assert(offsetof(FrameUniformBlock, time) == 140, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+	static_assert(offsetof(FrameUniformBlock, globalAmbient) == 144, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+	static_assert(sizeof(FrameUniformBlock) % 16 == 0, "ERROR::UNIFORM_BLOCKS::FRAME_BLOCK_NOT_STD140");
+
+	static_assert(offsetof(ObjectUniformBlock, modelTransform) == 0, "ERROR::UNIFORM_BLOCKS::OBJECT_BLOCK_NOT_STD430");
+	static_assert(offsetof(ObjectUniformBlock, materialIndex) == 64, "ERROR::UNIFORM_BLOCKS::OBJECT_BLOCK_NOT_STD430");
+	static_assert(sizeof(ObjectUniformBlock) == 80, "ERROR::UNIFORM_BLOCKS::OBJECT_BLOCK_NOT_STD430");
+
+	/**
+	*	@brief Static singleton class that owns the buffers shared by every shader program.
+	*	Object blocks are written straight into a persistently mapped stream buffer whose current region is bound as a shader storage buffer,
+	*	everything else that changes per frame (the frame block, light arrays, debug geometry, UI vertices) is bump allocated from a second, general stream.
+	*	NOTE: Draws select their object block by passing its index as the base instance, which the geometry pool's draw ID attribute turns into a vertex input.
+	*/
+	class UniformBlocks {
+	public:
+		static void Initialise();
+		static void Shutdown();
+
+		static void BeginFrame();
+		static void EndFrame();
+
+		static void SetFrameData(RenderCamera* a_camera, const glm::vec4& a_globalAmbient, float a_time);
+		static const FrameUniformBlock& GetFrameData() { return m_stn->m_frameData; }
+
+		static void Reserve(unsigned int a_objectNum);
+		static unsigned int PushObject(const ObjectUniformBlock& a_object);
+		static void Flush();
+		static void BindObjectTable();
+
+		static unsigned int GetObjectCapacity() { return m_stn->m_ringSize / m_stn->m_objectStride; }
+
+		static StreamAllocation AllocateDynamic(unsigned int a_size, unsigned int a_alignment = 16);
+		static unsigned int GetDynamicBufferID();
+
+		static void ListenIMGUI();
+	protected:
+	private:
+		static UniformBlocks* m_stn;		// Singleton instance
+
+		static void Wrap();
+
+		// Instance variables
+		FrameUniformBlock	m_frameData;
+		unsigned int		m_uniformAlignment;		// Offset alignment of uniform buffer ranges
+
+		StreamBuffer*		m_objectStream;
+		unsigned int		m_objectStride;			// Array stride of an object block in the shader storage buffer
+		unsigned int		m_ringSize;				// Bytes of object blocks per frame, a whole number of blocks
+		unsigned int		m_flushedHead;			// Everything in the current region before this has been flushed
+
+		StreamBuffer*		m_dynamicStream;
+
+		// Statistics
+		unsigned int		m_uploadCount;
+		unsigned int		m_uploadedBytes;
+
+		UniformBlocks();
+		~UniformBlocks();
+	};
+}
\ No newline at end of file
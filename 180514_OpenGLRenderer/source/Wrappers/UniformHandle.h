@@ -0,0 +1,139 @@
+#pragma once
+
+#include <stdint.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace SPRON {
+	class TextureWrapperBase;
+}
+
+namespace SPRON {
+	/**
+	*	@brief FNV-1a hash of a uniform name, usable at compile time.
+	*	NOTE: The hash can be continued from a previous hash, so hashing "material" and then ".diffuseMap" gives the same result as hashing "material.diffuseMap".
+	*	@param a_str is the null terminated string to hash.
+	*	@param a_hash is the hash to continue from.
+	*	@return 32 bit hash of the string.
+	*/
+	constexpr uint32_t HashUniformName(const char* a_str, uint32_t a_hash = 2166136261u) {
+		return (*a_str ? HashUniformName(a_str + 1, (a_hash ^ (uint32_t)(unsigned char)*a_str) * 16777619u) : a_hash);
+	}
+
+	/**
+	*	@brief Pre-hashed uniform name, typed by the value it is set with so the wrong setter can't be called for it.
+	*/
+	template <typename T>
+	struct UniformHandle {
+		constexpr explicit UniformHandle(const char* a_name) : hash(HashUniformName(a_name)), name(a_name) {}
+		constexpr UniformHandle(const char* a_prefix, const char* a_member) : hash(HashUniformName(a_member, HashUniformName(a_prefix))), name(a_member) {}
+
+		uint32_t	hash;
+		const char*	name;		// Only used for error messages, just the member name if constructed with a prefix
+	};
+
+	/// Handles for the members of shader structs, constructed with the struct instance name as the prefix
+	// NOTE: Only the texture maps, the rest of the material is read from the material table
+	struct MaterialMapUniforms {
+		constexpr explicit MaterialMapUniforms(const char* a_prefix) :
+			diffuseMap(a_prefix, ".diffuseMap"), specularMap(a_prefix, ".specularMap"), normalMap(a_prefix, ".normalMap") {}
+
+		UniformHandle<TextureWrapperBase*>	diffuseMap;
+		UniformHandle<TextureWrapperBase*>	specularMap;
+		UniformHandle<TextureWrapperBase*>	normalMap;
+	};
+
+	struct BaseLightUniforms {
+		constexpr explicit BaseLightUniforms(const char* a_prefix) :
+			ambient(a_prefix, ".base.ambient"), diffuse(a_prefix, ".base.diffuse"), specular(a_prefix, ".base.specular") {}
+
+		UniformHandle<glm::vec4> ambient;
+		UniformHandle<glm::vec4> diffuse;
+		UniformHandle<glm::vec4> specular;
+	};
+
+	struct DirLightUniforms {
+		constexpr explicit DirLightUniforms(const char* a_prefix) :
+			base(a_prefix), castDir(a_prefix, ".castDir") {}
+
+		BaseLightUniforms			base;
+		UniformHandle<glm::vec3>	castDir;
+	};
+
+	struct PointLightUniforms {
+		constexpr explicit PointLightUniforms(const char* a_prefix) :
+			base(a_prefix), position(a_prefix, ".position"),
+			illuminationRadius(a_prefix, ".attenuation.illuminationRadius"), minIllumination(a_prefix, ".attenuation.minIllumination") {}
+
+		BaseLightUniforms			base;
+		UniformHandle<glm::vec4>	position;
+		UniformHandle<float>		illuminationRadius;
+		UniformHandle<float>		minIllumination;
+	};
+
+	struct SpotLightUniforms {
+		constexpr explicit SpotLightUniforms(const char* a_prefix) :
+			base(a_prefix), position(a_prefix, ".position"), spotDir(a_prefix, ".spotDir"),
+			spotInnerCosine(a_prefix, ".spotInnerCosine"), spotOuterCosine(a_prefix, ".spotOuterCosine") {}
+
+		BaseLightUniforms			base;
+		UniformHandle<glm::vec4>	position;
+		UniformHandle<glm::vec3>	spotDir;
+		UniformHandle<float>		spotInnerCosine;
+		UniformHandle<float>		spotOuterCosine;
+	};
+
+	/// Uniforms set every frame, hashed at compile time
+	/// NOTE: Camera data, model transforms and material parameters are in uniform blocks and the material table (see UniformBlocks.h and MaterialTable.h)
+	namespace Uniforms {
+		//// Ambient pass
+		constexpr UniformHandle<TextureWrapperBase*>	TEX_SAMPLE("texSample");
+		constexpr UniformHandle<bool>					USE_TEX("useTex");
+
+		//// Light passes
+		constexpr MaterialMapUniforms	MATERIAL_MAPS("materialMaps");
+		constexpr DirLightUniforms		LIGHT_DIR("dirLight");
+		constexpr PointLightUniforms	LIGHT_POINT("ptLight");
+		constexpr SpotLightUniforms		LIGHT_SPOT("spotLight");
+
+		//// Debug pass
+		constexpr UniformHandle<float>		DRAW_SCALE("drawScale");
+		constexpr UniformHandle<glm::vec4>	NORMAL_COLOR("normalColor");
+		constexpr UniformHandle<glm::vec4>	TANGENT_COLOR("tangentColor");
+		constexpr UniformHandle<glm::vec4>	BITANGENT_COLOR("bitangentColor");
+
+		//// Post-processing
+		constexpr UniformHandle<TextureWrapperBase*>	SCREEN_RENDER_TEX("screenRenderTex");
+		constexpr UniformHandle<bool>					HDR_ENABLED("enableHDR");
+		constexpr UniformHandle<float>					EXPOSURE("exposure");
+		constexpr UniformHandle<float>					CLARITY_FACTOR("clarityFactor");
+
+		//// GPU culling
+		constexpr UniformHandle<int>		CULL_DRAW_COUNT("drawCount");
+		constexpr UniformHandle<bool>		CULL_USE_PYRAMID("usePyramid");
+		constexpr UniformHandle<glm::mat4>	CULL_PYRAMID_PROJECTION_VIEW("pyramidProjectionView");
+		constexpr UniformHandle<int>		CULL_DEPTH_PYRAMID("depthPyramid");
+		constexpr UniformHandle<int>		CULL_DEPTH_TEX("depthTex");
+
+		//// Visibility buffer
+		// NOTE: Light arrays are set through handles built from the element's name, see VisibilityBuffer.cpp
+		constexpr UniformHandle<int>		VIS_TEX("visibilityTex");
+		constexpr UniformHandle<int>		VIS_MAP_SET("mapSet");
+		constexpr UniformHandle<int>		VIS_DIR_LIGHT_COUNT("dirLightCount");
+		constexpr UniformHandle<int>		VIS_POINT_LIGHT_COUNT("ptLightCount");
+		constexpr UniformHandle<int>		VIS_SPOT_LIGHT_COUNT("spotLightCount");
+
+		//// Shadows
+		// NOTE: Arrays are set with a count through the handle of the array's base name, see ShadowAtlas.cpp
+		constexpr UniformHandle<TextureWrapperBase*>	SHADOW_ATLAS("shadowAtlas");
+		constexpr UniformHandle<int>					SHADOW_VIEW_COUNT("shadowViewCount");
+		constexpr UniformHandle<glm::mat4>				SHADOW_MATRICES("shadowMatrices");
+		constexpr UniformHandle<glm::vec4>				SHADOW_TILES("shadowTiles");
+		constexpr UniformHandle<glm::vec4>				SHADOW_CASCADE_ENDS("shadowCascadeEnds");
+		constexpr UniformHandle<glm::mat4>				SHADOW_VIEW_PROJECTIONS("viewProjections");
+		constexpr UniformHandle<int>					SHADOW_CASTER_VIEW_COUNT("viewCount");
+		constexpr UniformHandle<bool>					SHADOW_CASTER_INSTANCED("isInstanced");
+	}
+}
\ No newline at end of file
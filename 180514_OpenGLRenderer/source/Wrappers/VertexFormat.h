@@ -3,23 +3,20 @@
 #include <vector>
 
 namespace SPRON {
+	/**
+	*	@brief Draw order of a mesh's vertices.
+	*	NOTE: Vertex layout and index storage live in the geometry pool, so formats only hold the indices until meshes using them are allocated.
+	*/
 	class VertexFormat {
 	public:
 		VertexFormat();
 		VertexFormat(const std::vector<unsigned int>& a_indices);
 		~VertexFormat();
 
-		void AddAttribute(unsigned int a_vertBufferID, unsigned int a_attributeLocation, unsigned int a_elementNum, unsigned int a_elementType, bool a_isNormalised, int a_stride, const void* a_offset);
-		void SetAsContext();
-
+		const std::vector<unsigned int>& GetIndices() const { return m_indiceData; }
 		unsigned int GetElementNum() { return (unsigned int)m_indiceData.size(); }
-
-		operator unsigned int() { return m_ID; }	// Allow class to be used in parameters of openGL functions
 	protected:
 	private:
-		unsigned int m_ID;				// OpenGL vertex array object identifier
-		unsigned int m_elementBufferID;
-
-		std::vector<unsigned int> m_indiceData;		// Keep track of vertex draw order to ensure it stays in scope for openGL
+		std::vector<unsigned int> m_indiceData;		// Vertex draw order, copied into the geometry pool by every mesh that uses this format
 	};
 }
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include "VisibilityBuffer.h"
+#include "ShaderWrapper.h"
+#include "GLStateCache.h"
+#include "UniformBlocks.h"
+#include "PassQueries.h"
+#include "Renderer_Utility_Literals.h"
+#include "Light\PhongLight_Dir.h"
+#include "Light\PhongLight_Point.h"
+#include "Light\PhongLight_Spot.h"
+#include "Texture\TextureBinder.h"
+
+#include <gl_core_4_4.h>
+#include <algorithm>
+#include <iostream>
+#include <assert.h>
+
+namespace SPRON {
+
+	VisibilityBuffer::VisibilityBuffer() : m_visibilityTexID(0), m_depthBufferID(0), m_width(0), m_height(0),
+		m_indirectCapacity(0), m_drawCapacity(0), m_droppedLights(0)
+	{
+		m_visibilityProgram = new ShaderWrapper("visibility_buffer");
+		m_visibilityProgram->LoadShader("./shaders/visibility/vis_buffer.vert", VERT_SHADER);
+		m_visibilityProgram->LoadShader("./shaders/visibility/vis_buffer.frag", FRAG_SHADER);
+		m_visibilityProgram->LinkShaders();
+
+		m_resolveProgram = new ShaderWrapper("visibility_resolve");
+		m_resolveProgram->LoadShader("./shaders/visibility/vis_resolve.vert", VERT_SHADER);
+		m_resolveProgram->LoadShader("./shaders/visibility/vis_resolve.frag", FRAG_SHADER);
+		m_resolveProgram->LinkShaders();
+
+		glGenFramebuffers(1, &m_frameBufferID);
+		glGenBuffers(1, &m_indirectBufferID);
+		glGenBuffers(1, &m_drawBufferID);
+
+		// Struct members are hashed on from the element's name, so each element is only built once
+		for (unsigned int i = 0; i < VIS_MAX_LIGHTS; ++i) {
+			char prefix[32];
+
+			sprintf_s(prefix, "dirLights[%u]", i);
+			m_dirLightHandles.push_back(DirLightUniforms(prefix));
+
+			sprintf_s(prefix, "ptLights[%u]", i);
+			m_pointLightHandles.push_back(PointLightUniforms(prefix));
+
+			sprintf_s(prefix, "spotLights[%u]", i);
+			m_spotLightHandles.push_back(SpotLightUniforms(prefix));
+		}
+
+		m_queries = new PassQueries(VIS_PASS_COUNT);
+	}
+
+	VisibilityBuffer::~VisibilityBuffer()
+	{
+		delete m_visibilityProgram;
+		delete m_resolveProgram;
+		delete m_queries;
+
+		GLStateCache::ForgetFramebuffer(m_frameBufferID);
+		glDeleteFramebuffers(1, &m_frameBufferID);
+
+		if (m_visibilityTexID) {
+			TextureBinder::Forget(m_visibilityTexID);
+			glDeleteTextures(1, &m_visibilityTexID);
+			glDeleteRenderbuffers(1, &m_depthBufferID);
+		}
+
+		glDeleteBuffers(1, &m_indirectBufferID);
+		glDeleteBuffers(1, &m_drawBufferID);
+	}
+
+	/**
+	*	@brief Draw every command into the visibility buffer, then resolve the covered pixels into the frame buffer that was bound.
+	*	The resolve writes the depth of each covered pixel, pixels nothing covered are left as they were.
+	*	NOTE: Object blocks must already be flushed, the commands' base instances index the draw table instead of the object blocks.
+	*	@param a_commands is the draw commands, each instance's draw ID is its entry in the draw table.
+	*	@param a_draws is the draw table, one entry per drawn instance.
+	*	@param a_mapSets is a material with each distinct set of texture maps, indexed by the draw table's map sets.
+	*	@param a_lights is every light to shade with.
+	*	@return void.
+	*/
+	void VisibilityBuffer::Render(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<VisDrawData>& a_draws,
+		const std::vector<Material*>& a_mapSets, const std::vector<PhongLight*>& a_lights)
+	{
+		assert(a_draws.size() <= UniformBlocks::GetObjectCapacity() && "ERROR::VISIBILITY_BUFFER::DRAW_IDS_EXCEEDED");
+
+		// Match the visibility buffer to the viewport
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		if ((unsigned int)viewport[2] != m_width || (unsigned int)viewport[3] != m_height) {
+			Resize(viewport[2], viewport[3]);
+		}
+
+		int targetFrameBuffer = 0;		// Resolved into whatever the queue was rendering to
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFrameBuffer);
+
+		m_queries->Begin();
+
+		//// Visibility pass
+		GLStateCache::BindFramebuffer(m_frameBufferID);
+		GLStateCache::SetColorMask(true);		// Clears are masked too
+		GLStateCache::SetDepthMask(true);
+		GLStateCache::SetDepthTest(true);
+		GLStateCache::SetDepthFunc(GL_LESS);
+		GLStateCache::SetBlending(false);
+
+		const unsigned int clearIDs[4] = { 0, 0, 0, 0 };
+		const float clearDepth = 1.f;
+		glClearBufferuiv(GL_COLOR, 0, clearIDs);
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+		if (!a_commands.empty()) {
+			// NOTE: Storage is orphaned every frame so the upload does not wait on last frame's draws still reading it
+			ReserveBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBufferID, sizeof(VisDrawData) * (unsigned int)a_draws.size(), m_drawCapacity);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(VisDrawData) * a_draws.size(), &a_draws[0]);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_VIS_DRAWS, m_drawBufferID);
+
+			// Only positions are needed to find the closest triangle
+			GeometryPool::BindPositions();
+			GLStateCache::UseProgram(*m_visibilityProgram);
+
+			m_queries->SwitchPass(VIS_PASS_VISIBILITY);
+
+#if USE_MULTI_DRAW_INDIRECT
+			ReserveBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBufferID, sizeof(IndirectDrawCommand) * (unsigned int)a_commands.size(), m_indirectCapacity);
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(IndirectDrawCommand) * a_commands.size(), &a_commands[0]);
+
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)a_commands.size(), 0);
+
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#else
+			for (unsigned int i = 0; i < a_commands.size(); ++i) {
+				const IndirectDrawCommand& draw = a_commands[i];
+
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, draw.count, GL_UNSIGNED_INT,
+					(void*)(sizeof(unsigned int) * draw.firstIndex), draw.instanceCount, draw.baseVertex, draw.baseInstance);
+			}
+#endif
+		}
+
+		//// Resolve
+		GLStateCache::BindFramebuffer(targetFrameBuffer);
+		GeometryPool::Bind();		// NOTE: The full screen triangle reads no attributes, but a vertex array must be bound to draw
+
+		// Triangles are fetched by hand from the geometry pool's buffers, which move when the pool grows
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_VIS_VERTICES, GeometryPool::GetVertexBuffer());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STORAGE_BINDING_VIS_INDICES, GeometryPool::GetIndexBuffer());
+
+		SetLights(a_lights);
+
+		GLStateCache::SetDepthFunc(GL_ALWAYS);		// Every resolved pixel writes the depth of its visibility pass fragment
+		GLStateCache::UseProgram(*m_resolveProgram);
+
+		m_queries->SwitchPass(VIS_PASS_RESOLVE);
+
+		for (unsigned int i = 0; i < a_mapSets.size(); ++i) {
+			m_resolveProgram->SetMaterialMaps(Uniforms::MATERIAL_MAPS, *a_mapSets[i]);
+			m_resolveProgram->SetInt(Uniforms::VIS_MAP_SET, (int)i);
+
+			// NOTE: Sampled from the scratch unit after the maps are bound, binding the maps never uses it
+			TextureBinder::BindForEdit(GL_TEXTURE_2D, m_visibilityTexID);
+			m_resolveProgram->SetInt(Uniforms::VIS_TEX, 0);
+
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		}
+
+		m_queries->End();
+
+		GLStateCache::SetDepthFunc(GL_LESS);
+	}
+
+	/**
+	*	@brief Get the samples that passed the depth test in a pass, a few frames late.
+	*	@param a_pass is the pass to get the samples of.
+	*	@return samples passed, the pixels shaded by the resolve.
+	*/
+	uint64_t VisibilityBuffer::GetSamples(unsigned int a_pass) const
+	{
+		return m_queries->GetSamples(a_pass);
+	}
+
+	/**
+	*	@brief Get the GPU time of a pass, a few frames late.
+	*	@param a_pass is the pass to get the time of.
+	*	@return milliseconds.
+	*/
+	float VisibilityBuffer::GetTime(unsigned int a_pass) const
+	{
+		return m_queries->GetTime(a_pass);
+	}
+
+	/**
+	*	@brief Re-create the visibility buffer's attachments at a new size.
+	*	@param a_width is the width in pixels.
+	*	@param a_height is the height in pixels.
+	*	@return void.
+	*/
+	void VisibilityBuffer::Resize(unsigned int a_width, unsigned int a_height)
+	{
+		if (m_visibilityTexID) {		// NOTE: Storage is immutable, so the attachments are replaced
+			TextureBinder::Forget(m_visibilityTexID);
+			glDeleteTextures(1, &m_visibilityTexID);
+			glDeleteRenderbuffers(1, &m_depthBufferID);
+		}
+
+		m_width = a_width;
+		m_height = a_height;
+
+		GLStateCache::BindFramebuffer(m_frameBufferID);
+
+		/// Triangle and draw IDs, fetched per pixel so they are never filtered
+		glGenTextures(1, &m_visibilityTexID);
+
+		TextureBinder::BindForEdit(GL_TEXTURE_2D, m_visibilityTexID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG32UI, m_width, m_height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_visibilityTexID, 0);
+
+		/// Depth, the resolve reconstructs it from the triangle instead of sampling it
+		glGenRenderbuffers(1, &m_depthBufferID);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferID);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_width, m_height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferID);
+
+		// Error handling
+		try {
+			GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+			if (status != GL_FRAMEBUFFER_COMPLETE) {
+				char errorMsg[256];
+				sprintf_s(errorMsg, "ERROR::VISIBILITY_BUFFER::FRAME_BUFFER_INCOMPLETE: %#x", status);
+
+				throw std::runtime_error(errorMsg);
+			}
+		}
+		catch (std::exception const& e) { std::cout << "Exception: " << e.what() << std::endl; }
+	}
+
+	/**
+	*	@brief Send the lights to the resolve's light arrays, grouped by type.
+	*	@param a_lights is the lights to send, lights over the size of their type's array are dropped.
+	*	@return void.
+	*/
+	void VisibilityBuffer::SetLights(const std::vector<PhongLight*>& a_lights)
+	{
+		unsigned int dirCount = 0, pointCount = 0, spotCount = 0;
+		m_droppedLights = 0;
+
+		for (unsigned int i = 0; i < a_lights.size(); ++i) {
+			PhongLight* light = a_lights[i];
+
+			switch (light->GetType()) {
+				case DIRECTIONAL_LIGHT:
+					if (dirCount == VIS_MAX_LIGHTS) { m_droppedLights++; break; }
+					m_resolveProgram->SetDirectionalLight(m_dirLightHandles[dirCount++], (PhongLight_Dir*)light);
+					break;
+				case POINT_LIGHT:
+					if (pointCount == VIS_MAX_LIGHTS) { m_droppedLights++; break; }
+					m_resolveProgram->SetPointLight(m_pointLightHandles[pointCount++], (PhongLight_Point*)light);
+					break;
+				case SPOT_LIGHT:
+					if (spotCount == VIS_MAX_LIGHTS) { m_droppedLights++; break; }
+					m_resolveProgram->SetSpotLight(m_spotLightHandles[spotCount++], (PhongLight_Spot*)light);
+					break;
+			}
+		}
+
+		m_resolveProgram->SetInt(Uniforms::VIS_DIR_LIGHT_COUNT, (int)dirCount);
+		m_resolveProgram->SetInt(Uniforms::VIS_POINT_LIGHT_COUNT, (int)pointCount);
+		m_resolveProgram->SetInt(Uniforms::VIS_SPOT_LIGHT_COUNT, (int)spotCount);
+	}
+
+	/**
+	*	@brief Bind a buffer and give it fresh storage of at least the given size, growing its capacity if needed.
+	*	@param a_target is the target to bind the buffer to.
+	*	@param a_bufferID is the buffer.
+	*	@param a_size is the bytes needed.
+	*	@param a_capacity is the buffer's capacity in bytes, updated when grown.
+	*	@return void.
+	*/
+	void VisibilityBuffer::ReserveBuffer(unsigned int a_target, unsigned int a_bufferID, unsigned int a_size, unsigned int & a_capacity)
+	{
+		if (a_size > a_capacity) {		// Out of storage, grow
+			a_capacity = std::max(a_size, a_capacity * 2);
+		}
+
+		glBindBuffer(a_target, a_bufferID);
+		glBufferData(a_target, a_capacity, nullptr, GL_STREAM_DRAW);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "GeometryPool.h"
+#include "UniformHandle.h"
+
+namespace SPRON {
+	class ShaderWrapper;
+	class PassQueries;
+	class PhongLight;
+	struct Material;
+}
+
+namespace SPRON {
+	// Mirror of the std430 "GPU_VisDraw" shader struct, how the resolve pass finds the triangles and object block of one drawn instance
+	struct VisDrawData {
+		unsigned int	objectIndex;	// Index of the instance's object block in the object ring buffer
+		unsigned int	firstIndex;		// First index of the draw in the geometry pool's index buffer
+		int				baseVertex;
+		unsigned int	mapSet;			// Material map set the instance is resolved with
+	};
+
+	static_assert(sizeof(VisDrawData) == 16, "ERROR::VISIBILITY_BUFFER::VIS_DRAW_NOT_STD430");
+
+	enum eVisibilityPass {
+		VIS_PASS_VISIBILITY,		// Triangle and draw IDs plus depth
+		VIS_PASS_RESOLVE,			// Material and lighting, once per covered pixel
+		VIS_PASS_COUNT
+	};
+
+	/**
+	*	@brief Renders opaque draws in two passes instead of forward shading them: the visibility pass writes only a 32 bit triangle ID, a 32 bit draw ID
+	*	and depth, then full screen resolve passes fetch the covered triangle's vertices, reconstruct its perspective correct barycentrics and their
+	*	screen space derivatives, and evaluate the material and every light once per pixel. Nothing is shaded more than once and no G-buffer is written.
+	*	Draws reach their draw table entry through the draw ID attribute, so each instance of a draw needs an entry of its own.
+	*	NOTE: Material maps are packed into several texture arrays, so one resolve is drawn per distinct set of maps and skips pixels of other sets.
+	*	Only VIS_MAX_LIGHTS lights of each type are resolved, the rest are dropped.
+	*/
+	class VisibilityBuffer {
+	public:
+		VisibilityBuffer();
+		~VisibilityBuffer();
+
+		void Render(const std::vector<IndirectDrawCommand>& a_commands, const std::vector<VisDrawData>& a_draws,
+			const std::vector<Material*>& a_mapSets, const std::vector<PhongLight*>& a_lights);
+
+		unsigned int GetWidth() const { return m_width; }
+		unsigned int GetHeight() const { return m_height; }
+		unsigned int GetDroppedLights() const { return m_droppedLights; }
+
+		uint64_t GetSamples(unsigned int a_pass) const;
+		float GetTime(unsigned int a_pass) const;
+	protected:
+	private:
+		void Resize(unsigned int a_width, unsigned int a_height);
+		void SetLights(const std::vector<PhongLight*>& a_lights);
+		static void ReserveBuffer(unsigned int a_target, unsigned int a_bufferID, unsigned int a_size, unsigned int& a_capacity);
+
+		ShaderWrapper*	m_visibilityProgram;
+		ShaderWrapper*	m_resolveProgram;
+
+		unsigned int	m_frameBufferID;
+		unsigned int	m_visibilityTexID;		// RG32UI, triangle of the draw and draw table entry + 1 (0 where nothing was drawn)
+		unsigned int	m_depthBufferID;		// Only tested, never sampled
+		unsigned int	m_width;
+		unsigned int	m_height;
+
+		unsigned int	m_indirectBufferID;
+		unsigned int	m_indirectCapacity;		// Bytes of storage in each buffer
+		unsigned int	m_drawBufferID;			// Draw table
+		unsigned int	m_drawCapacity;
+
+		// Handles of each element of the resolve's light arrays
+		std::vector<DirLightUniforms>	m_dirLightHandles;
+		std::vector<PointLightUniforms>	m_pointLightHandles;
+		std::vector<SpotLightUniforms>	m_spotLightHandles;
+		unsigned int					m_droppedLights;		// Lights over the array sizes last frame
+
+		PassQueries*	m_queries;
+	};
+}
\ No newline at end of file